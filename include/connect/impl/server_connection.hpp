@@ -63,6 +63,7 @@ class CServer_ConnectionPool;
 class IServer_ConnectionBase
 {
 public:
+    IServer_ConnectionBase() : polled(false) { }
     virtual ~IServer_ConnectionBase() { }
     virtual EIO_Event GetEventsToPollFor(const CTime** /*alarm_time*/) const
         { return eIO_Read; }
@@ -84,6 +85,9 @@ private:
     CTime expiration;
     CFastMutex type_lock;
     volatile EServerConnType type;
+    // epoll backend: the connection is registered for events
+    // (or about to be) by the poll thread
+    bool polled;
 };
 
 class NCBI_XCONNECT_EXPORT CServer_Connection : public IServer_ConnectionBase,
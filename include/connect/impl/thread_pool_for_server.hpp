@@ -90,8 +90,13 @@ public:
     };
 
     /// Constructor
-    CBlockingQueue_ForServer(void)
-    {}
+    ///
+    /// @param work_queues
+    ///   Number of per-thread queues to use instead of the single shared
+    ///   one.  Requests are spread over them round-robin; a thread takes
+    ///   requests from its own queue first and steals from the others
+    ///   when it runs dry.  0 means a single shared FIFO queue.
+    CBlockingQueue_ForServer(unsigned int work_queues = 0);
 
     /// Put a request into the queue.  If the queue remains full for
     /// the duration of the (optional) timeout, throw an exception.
@@ -103,7 +108,13 @@ public:
     /// Get the first available request from the queue, and return a
     /// handle to it.
     /// Blocks politely if empty.
-    TItemHandle  GetHandle(void);
+    ///
+    /// @param own_queue
+    ///   Per-thread queue of the calling thread (see AssignWorkQueue())
+    TItemHandle  GetHandle(unsigned int own_queue = 0);
+
+    /// Get the per-thread queue for a new thread
+    unsigned int AssignWorkQueue(void);
 
     class CQueueItem : public CQueueItemBase_ForServer
     {
@@ -140,7 +151,25 @@ protected:
     CConditionVariable  m_GetCond;
     mutable CMutex      m_Mutex;     ///< Guards access to queue
 
+    /// Per-thread queue
+    struct SWorkQueue
+    {
+        CFastMutex       mutex;
+        TRealQueue       queue;
+        volatile size_t  size;   ///< Hint to skip empty queues unlocked
+
+        SWorkQueue(void) : size(0) {}
+    };
+
+    vector< AutoPtr<SWorkQueue> > m_WorkQueues;
+    CAtomicCounter      m_WorkQueued;     ///< Requests in per-thread queues
+    CAtomicCounter      m_WaitingThreads; ///< Threads sleeping on m_GetCond
+    CAtomicCounter      m_NextWorkQueue;  ///< Round-robin position for Put
+    CAtomicCounter      m_NextThreadQueue;///< Round-robin position for threads
+
 private:
+    TItemHandle x_PopWorkItem(unsigned int own_queue);
+
     /// forbidden
     CBlockingQueue_ForServer(const CBlockingQueue_ForServer&);
     CBlockingQueue_ForServer& operator=(const CBlockingQueue_ForServer&);
@@ -161,10 +190,10 @@ public:
     ///
     /// @param pool
     ///   A pool where this thead is placed
-    /// @param mode
-    ///   A running mode of this thread
-    CThreadInPool_ForServer(TPool* pool) 
-        : m_Pool(pool), m_Counted(false)
+    /// @param work_queue
+    ///   Per-thread queue of this thread in the pool's request queue
+    CThreadInPool_ForServer(TPool* pool, unsigned int work_queue = 0)
+        : m_Pool(pool), m_Counted(false), m_WorkQueue(work_queue)
     {}
     void CountSelf(void);
 
@@ -204,8 +233,9 @@ private:
     friend class CAutoUnregGuard;
 
 
-    TPool*   m_Pool;     ///< The pool that holds this thread
-    bool     m_Counted;
+    TPool*        m_Pool;      ///< The pool that holds this thread
+    bool          m_Counted;
+    unsigned int  m_WorkQueue; ///< Own queue when work stealing is on
 };
 
 
@@ -222,7 +252,11 @@ public:
     ///
     /// @param max_threads
     ///   The maximum number of threads that this pool can run
-    CPoolOfThreads_ForServer(unsigned int max_threads, const string& thr_suffix);
+    /// @param work_stealing
+    ///   Give every thread its own request queue and let idle threads
+    ///   steal from the others instead of sharing one locked queue
+    CPoolOfThreads_ForServer(unsigned int max_threads, const string& thr_suffix,
+                             bool work_stealing = false);
 
     /// Destructor
     virtual ~CPoolOfThreads_ForServer(void);
@@ -238,7 +272,7 @@ public:
     /// @param request
     ///   A request
     void AcceptRequest(const TRequest& request);
-    TItemHandle GetHandle(void);
+    TItemHandle GetHandle(unsigned int own_queue = 0);
 
     /// Causes all threads in the pool to exit cleanly after finishing
     /// all pending requests, optionally waiting for them to die.
@@ -252,7 +286,7 @@ private:
 
     /// Create a new thread
     TThread* NewThread(void)
-    { return new CThreadInPool_ForServer(this); }
+    { return new CThreadInPool_ForServer(this, m_Queue.AssignWorkQueue()); }
 
     /// Register a thread. It is called by TThread::Main.
     ///
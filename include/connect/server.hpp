@@ -446,6 +446,17 @@ struct NCBI_XCONNECT_EXPORT SServer_Parameters
     unsigned int    max_threads;     ///< Maximum simultaneous threads
     unsigned int    spawn_threshold; ///< Controls when to spawn more threads
 
+    /// Wait for socket events using persistent epoll registrations
+    /// instead of polling all connections on every cycle, so that idle
+    /// connections cost nothing per wakeup (Linux only, ignored elsewhere;
+    /// default:  false)
+    bool            use_epoll;
+
+    /// Give every worker thread its own request queue, with idle threads
+    /// stealing from the busy ones, instead of one queue shared under a
+    /// single lock (default:  false)
+    bool            work_stealing;
+
     /// Create structure with the default set of parameters
     SServer_Parameters();
 };
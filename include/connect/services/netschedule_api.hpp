@@ -641,6 +641,29 @@ class NCBI_XCONNECT_EXPORT CNetScheduleExecutor
                 unsigned         wait_time,
                 const string&    affinity_list = kEmptyStr);
 
+    /// Get up to max_count pending jobs in one round trip per server.
+    ///
+    /// The servers are asked in turn until max_count jobs are received.
+    /// Each server provides the jobs that share affinities with the jobs
+    /// already in the batch ahead of the others. This call never waits
+    /// for jobs to appear in the queue.
+    ///
+    /// @param jobs
+    ///     The received jobs are appended to this vector.
+    ///
+    /// @param max_count
+    ///     The maximum number of jobs to receive.
+    ///
+    /// @param affinity_list
+    ///     Comma-separated list of affinity tokens.
+    ///
+    /// @return
+    ///     The number of received jobs.
+    ///
+    size_t GetJobs(vector<CNetScheduleJob>& jobs,
+                   size_t                   max_count,
+                   const string&            affinity_list = kEmptyStr);
+
     /// Put job result (job should be received by GetJob() or WaitJob())
     ///
     /// @param job
@@ -649,6 +672,22 @@ class NCBI_XCONNECT_EXPORT CNetScheduleExecutor
     ///
     void PutResult(const CNetScheduleJob& job);
 
+    /// Put the results of several jobs in one round trip per server.
+    ///
+    /// @param jobs
+    ///     NetSchedule job description structures. Their ret_code
+    ///     and output fields should be set.
+    ///
+    /// @param errors
+    ///     If not NULL, receives one element per job: an empty string
+    ///     if the job results were accepted, the reason otherwise.
+    ///
+    /// @return
+    ///     The number of jobs whose results were accepted.
+    ///
+    size_t PutResults(const vector<CNetScheduleJob>& jobs,
+                      vector<string>* errors = NULL);
+
     /// Put job interim (progress) message.
     ///
     /// @note The progress message must be first saved to a NetCache blob,
@@ -63,6 +63,7 @@ class CSeq_annot_Info;
 class CSeq_annot_SNP_Info;
 class CSeq_annot_SortedIter;
 class CSeqTableInfo;
+class CTSEAnnotLockReadGuard;
 struct SSNP_Info;
 struct SIdAnnotObjs;
 class CSeq_loc_Conversion;
@@ -428,7 +429,7 @@ private:
     // Calls: x_SearchRange()
     void x_SearchObjects(const CTSE_Handle&    tse,
                          const SIdAnnotObjs*   objs,
-                         CMutexGuard&          guard,
+                         CTSEAnnotLockReadGuard& guard,
                          const CAnnotName&     name,
                          const CSeq_id_Handle& id,
                          const CHandleRange&   hr,
@@ -438,7 +439,7 @@ private:
     // Calls: x_SearchLoc() for annotations of type locs.
     void x_SearchRange(const CTSE_Handle&    tse,
                        const SIdAnnotObjs*   objs,
-                       CMutexGuard&          guard,
+                       CTSEAnnotLockReadGuard& guard,
                        const CAnnotName&     name,
                        const CSeq_id_Handle& id,
                        const CHandleRange&   hr,
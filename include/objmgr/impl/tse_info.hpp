@@ -82,6 +82,60 @@ class IEditSaver;
 
 class CSeq_annot_Finder;
 class CMasterSeqSegments;
+class CTSEAnnotLockReadGuard;
+
+////////////////////////////////////////////////////////////////////
+//
+//  CTSEAnnotLock::
+//
+//    Lock of TSE annot index.
+//    WriteLock() is exclusive and recursive, like the mutex it replaces.
+//    ReadLock() is shared between threads.
+//    A thread holding the lock shared may lock it exclusively too
+//    (e.g. on annot index update during a search): its shared lock is
+//    suspended until the exclusive one is released, instead of the
+//    W-after-R deadlock of plain CRWLock.
+//
+
+class NCBI_XOBJMGR_EXPORT CTSEAnnotLock
+{
+public:
+    CTSEAnnotLock(void);
+    ~CTSEAnnotLock(void);
+
+    typedef CGuard<CTSEAnnotLock, SSimpleWriteLock<CTSEAnnotLock> >
+                                                        TWriteLockGuard;
+
+    void WriteLock(void);
+    void Unlock(void);
+
+    void ReadLock(void);
+    void ReadUnlock(void);
+
+private:
+    bool x_IsWriter(TThreadSystemID self) const
+        {
+            return m_WriteDepth > 0 && m_Owner == self;
+        }
+
+    typedef vector< pair<TThreadSystemID, int> > TReaders;
+
+    CRWLock             m_Lock;
+    // guards the members below
+    CFastMutex          m_StateMutex;
+    // thread holding m_Lock for writing
+    TThreadSystemID     m_Owner;
+    int                 m_WriteDepth;
+    // threads holding m_Lock for reading, and the ones with read locks
+    // suspended by their write lock, with counts of their read locks
+    TReaders            m_Readers;
+    TReaders            m_Suspended;
+
+private:
+    CTSEAnnotLock(const CTSEAnnotLock&);
+    CTSEAnnotLock& operator=(const CTSEAnnotLock&);
+};
+
 
 ////////////////////////////////////////////////////////////////////
 //
@@ -376,11 +430,14 @@ public:
     const CSeq_id_Handle& GetRequestedId(void) const;
     void SetRequestedId(const CSeq_id_Handle& requested_id) const;
 
-    // annot object map mutex
-    typedef CMutex                      TAnnotLock;
-    typedef TAnnotLock::TReadLockGuard  TAnnotLockReadGuard;
+    // annot object map lock
+    typedef CTSEAnnotLock               TAnnotLock;
+    typedef CTSEAnnotLockReadGuard      TAnnotLockReadGuard;
     typedef TAnnotLock::TWriteLockGuard TAnnotLockWriteGuard;
     TAnnotLock& GetAnnotLock(void) const;
+    // true if no split chunks can modify this TSE anymore,
+    // so its annot index can be read concurrently
+    bool x_IsFullyLoaded(void) const;
 
     CRef<IEditSaver> GetEditSaver() const;
 
@@ -895,6 +952,40 @@ CRef<IEditSaver> CTSE_Info::GetEditSaver() const
 }
 
 
+// Read access to TSE annot index.
+// Fully loaded TSEs are searched under shared lock by many threads.
+// Others are locked exclusively because chunks loaded during the search
+// update the index from the same thread.
+class NCBI_XOBJMGR_EXPORT CTSEAnnotLockReadGuard
+{
+public:
+    CTSEAnnotLockReadGuard(void)
+        : m_Lock(0), m_Shared(false)
+        {
+        }
+    explicit CTSEAnnotLockReadGuard(const CTSE_Info& tse)
+        : m_Lock(0), m_Shared(false)
+        {
+            Guard(tse);
+        }
+    ~CTSEAnnotLockReadGuard(void)
+        {
+            Release();
+        }
+
+    void Guard(const CTSE_Info& tse);
+    void Release(void);
+
+private:
+    CTSE_Info::TAnnotLock* m_Lock;
+    bool                   m_Shared;
+
+private:
+    CTSEAnnotLockReadGuard(const CTSEAnnotLockReadGuard&);
+    CTSEAnnotLockReadGuard& operator=(const CTSEAnnotLockReadGuard&);
+};
+
+
 class CTSEAnnotObjectMapper
 {
 public:
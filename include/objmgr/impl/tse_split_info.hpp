@@ -110,6 +110,7 @@ public:
     void LoadChunks(const TChunkIds& ids) const;
 
     bool x_HasDelayedMainChunk(void) const;
+    bool x_AllChunksLoaded(void) const;
     bool x_NeedsDelayedMainChunk(void) const;
     void x_LoadDelayedMainChunk(void) const;
 
@@ -173,6 +174,7 @@ private:
     // Split chunks
     TChunks                m_Chunks;
     TChunkId               m_BioseqChunkId;
+    mutable bool           m_AllChunksLoaded;
 
     // loading
     CInitMutexPool         m_MutexPool;
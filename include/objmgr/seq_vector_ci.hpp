@@ -131,6 +131,12 @@ public:
     /// Fill the buffer string with the count bytes of sequence data
     /// starting with current iterator position
     void GetSeqData(string& buffer, TSeqPos count);
+    /// Decode the sequence data for the interval [start, stop) directly
+    /// into the buffer, which must have room for stop-start chars.
+    /// The segments of the interval are resolved once, and their data
+    /// is converted without going through the iterator cache.
+    /// The iterator position is not changed.
+    void GetSeqData(TSeqPos start, TSeqPos stop, char* buffer);
 
     /// Get number of chars from current position to the current buffer end
     TSeqPos GetBufferSize(void) const;
@@ -242,6 +248,10 @@ private:
     void x_UpdateCacheUp(TSeqPos pos);
     void x_UpdateCacheDown(TSeqPos pos);
     void x_FillCache(TSeqPos start, TSeqPos count);
+    void x_DecodeData(char* dst, TSeqPos start, TSeqPos count,
+                      const CSeq_data& data, TSeqPos data_pos,
+                      bool reverse);
+    void x_DecodeGap(char* dst, TSeqPos start, TSeqPos count);
     void x_UpdateSeg(TSeqPos pos);
     void x_InitSeg(TSeqPos pos);
     void x_IncSeg(void);
@@ -1588,7 +1588,12 @@ public:
         */
     }
 
-    bool IsMapped(){return m_Mapped;}
+    /// Returns true once Init() has attached this lease to a mapping.
+    ///
+    /// The mapping may be shared with (and owned by) another lease, so
+    /// this does not check m_Mapped; otherwise every access through a
+    /// shared mapping would repeat the file map lookup.
+    bool IsMapped(){return m_MappedFile != NULL;}
 
     //Not used
     int UnmapAllIndex(void)
@@ -228,6 +228,15 @@ public:
     ///     The lock holder object for this thread. [in]
     void OpenSeqFile(CSeqDBLockHold &locked) const;
 
+    /// Open header file
+    ///
+    /// By default, header file is opened on a "lazy" schedule.
+    /// This method will force the header file to be opened.
+    ///
+    /// @param locked
+    ///     The lock holder object for this thread. [in]
+    void OpenHdrFile(CSeqDBLockHold &locked) const;
+
     /// Sequence length for protein databases.
     ///
     /// This method returns the length of the sequence in bases, and
@@ -295,6 +304,46 @@ public:
     GetFilteredHeader(int                    oid,
                       CSeqDBLockHold       & locked) const;
 
+    /// Returns true if headers from this volume need filtering.
+    ///
+    /// Headers are filtered when a membership bit or an ID list
+    /// applies to this volume; GetFilteredHeader() must then be used.
+    bool HasHeaderFilter() const
+    {
+        return m_MemBit || x_HaveIdFilter();
+    }
+
+    /// Get the unfiltered headers for a sequence.
+    ///
+    /// The headers are deserialized directly from the memory mapped
+    /// header file and are not cached, so this method does not modify
+    /// the volume and may be called without the atlas lock once the
+    /// header file has been opened (see OpenHdrFile()).
+    ///
+    /// @param oid
+    ///   The OID of the sequence. [in]
+    /// @return
+    ///   The set of blast-def-lines describing this sequence.
+    CRef<CBlast_def_line_set> GetUnfilteredHeader(int oid) const
+    {
+        return x_GetHdrAsn1(oid, true, NULL);
+    }
+
+    /// Advise the OS that sequence and header data will be needed.
+    ///
+    /// The sequence data (including nucleotide ambiguity data) and
+    /// headers of the given OIDs are located in the memory mapped
+    /// files, adjacent regions are merged, and read-ahead is requested
+    /// for each merged region.  This only issues advice; it does not
+    /// wait for the data to be read.
+    ///
+    /// @param oids
+    ///   The OIDs within this volume, in increasing order. [in]
+    /// @param locked
+    ///   The lock holder object for this thread. [in]
+    void PrefetchData(const vector<int> & oids,
+                      CSeqDBLockHold    & locked) const;
+
     /// Get the sequence type stored in this database.
     ///
     /// This method returns the type of sequences stored in this
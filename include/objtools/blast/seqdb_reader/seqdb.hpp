@@ -952,6 +952,91 @@ public:
     /// iterations to be performed over the same CSeqDB object
     void ResetInternalChunkBookmark();
 
+    /// A range of OIDs, from the first included OID to the OID after
+    /// the last included OID.
+    typedef pair<int, int> TOidRange;
+
+    /// Split the database into disjoint OID ranges for parallel scans.
+    ///
+    /// This divides the iteration range of the database into at most
+    /// num_ranges non-overlapping ranges, in OID order, which together
+    /// cover the whole iteration range.  When the entire database is
+    /// being iterated, the ranges contain approximately equal numbers
+    /// of residues (see GetOidAtOffset()); when an OID range has been
+    /// restricted, they contain approximately equal numbers of OIDs.
+    /// Each range can be handed to a different thread, which can then
+    /// fetch its sequences with GetSequenceBatch() without contending
+    /// with the other threads.  Fewer ranges are returned if the
+    /// database does not have enough sequences to fill them.
+    ///
+    /// @param num_ranges
+    ///   Maximum number of ranges to produce. [in]
+    /// @param ranges
+    ///   The OID ranges, replacing any previous contents. [out]
+    void GetOidRanges(int num_ranges, vector<TOidRange> & ranges) const;
+
+    /// A sequence returned by GetSequenceBatch().
+    struct SBatchSequence {
+        /// The OID of the sequence.
+        TOID oid;
+
+        /// The sequence data, in the same encoding as GetSequence().
+        const char * data;
+
+        /// The length of the sequence in bases.
+        int length;
+
+        /// The deflines for the sequence, or NULL if not requested.
+        CRef<CBlast_def_line_set> deflines;
+    };
+
+    /// A batch of sequences.
+    typedef vector<SBatchSequence> TSequenceBatch;
+
+    /// Get all included sequences in a range of OIDs.
+    ///
+    /// This method fetches the sequence data, lengths, and optionally
+    /// the deflines of every included OID in [begin, end) in a single
+    /// call.  The atlas lock is acquired once per call to resolve the
+    /// OIDs; the data itself is then read from the memory mapped
+    /// volume files without holding the lock, so many threads can
+    /// scan disjoint ranges (see GetOidRanges()) concurrently.  The
+    /// data pointers refer directly to the memory mapped files; they
+    /// remain valid for the lifetime of this object and must not be
+    /// passed to RetSequence().  Deflines are returned unfiltered
+    /// unless the database has a membership bit or ID list, in which
+    /// case the same filtering as GetHdr() is applied (and the lock is
+    /// taken to do so).
+    ///
+    /// @param begin
+    ///   The first OID to consider. [in]
+    /// @param end
+    ///   The OID after the last OID to consider. [in]
+    /// @param batch
+    ///   The sequences, replacing any previous contents. [out]
+    /// @param get_deflines
+    ///   Specify true to deserialize the deflines of each sequence. [in]
+    /// @return
+    ///   The number of sequences returned.
+    int GetSequenceBatch(int              begin,
+                         int              end,
+                         TSequenceBatch & batch,
+                         bool             get_deflines = false) const;
+
+    /// Advise the OS that data for a set of sequences will be needed.
+    ///
+    /// This requests read-ahead (madvise) for the memory mapped
+    /// sequence, ambiguity and header data of the given OIDs.  The
+    /// OIDs are sorted and grouped by volume, and nearby regions of
+    /// each file are merged, so a large set of randomly ordered OIDs
+    /// is turned into a mostly sequential read of each volume.  Call
+    /// this before fetching a large batch of sequences; it returns
+    /// without waiting for the I/O to finish.
+    ///
+    /// @param oids
+    ///   The OIDs that will be fetched, in any order. [in]
+    void PrefetchSequences(const vector<TOID> & oids) const;
+
     /// Get list of database names.
     ///
     /// This returns the database name list used at construction.
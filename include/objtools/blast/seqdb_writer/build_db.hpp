@@ -389,6 +389,17 @@ public:
     /// @param max_file_size Maximum file size in bytes.
     void SetMaxFileSize(Uint8 max_file_size);
 
+    /// Set the number of threads used to build the database.
+    ///
+    /// With more than one thread, sequences from a Bioseq source are
+    /// read, converted, and written to the database concurrently,
+    /// and the index files are sorted and written in parallel.  The
+    /// database produced does not depend on the number of threads.
+    /// The default is 1.
+    ///
+    /// @param num_threads Maximum number of threads to use.
+    void SetNumThreads(int num_threads);
+
     /// Define a masking algorithm.
     ///
     /// The returned integer ID will be defined as corresponding to the
@@ -493,13 +504,55 @@ private:
     /// affected).  In particular, the taxid is set (0 is used if no
     /// taxid is known), and linkout and membership bits are set.
     ///
+    /// If the deflines were already extracted from the Bioseq, they
+    /// can be provided as `headers'; they will be edited in place.
+    ///
     /// @param bs Bioseq to add to the database.
     /// @param bs Sequence data to add to the database.
     /// @param add_pig true if PIG should be added if available
+    /// @param headers Deflines extracted from bs, or null.
     /// @return ture if bioseq has been added, otherwise false
     bool x_EditAndAddBioseq(CConstRef<objects::CBioseq>   bs,
                             objects::CSeqVector         * sv,
-                            bool 						  add_pig = false);
+                            bool 						  add_pig = false,
+                            CRef<objects::CBlast_def_line_set> headers =
+                                CRef<objects::CBlast_def_line_set>());
+
+    /// A sequence read from an IBioseqSource.
+    struct SSourceBioseq;
+
+    /// Read the next usable sequence from a Bioseq source.
+    ///
+    /// Sequences of the wrong molecule type are skipped, and Seq-ids
+    /// of the wrong molecule type are converted to local ids.
+    ///
+    /// @param src Source of Bioseqs. [in]
+    /// @param entry The sequence that was read. [out]
+    /// @return false if the source is exhausted.
+    bool x_ReadSourceBioseq(IBioseqSource & src, SSourceBioseq & entry);
+
+    /// Read up to `max_count' sequences from a Bioseq source.
+    /// @param src Source of Bioseqs. [in]
+    /// @param batch Sequences read are appended here. [out]
+    /// @param max_count Maximum number of sequences to read. [in]
+    void x_ReadSourceBatch(IBioseqSource         & src,
+                           vector<SSourceBioseq> & batch,
+                           size_t                  max_count);
+
+    /// Extract deflines and convert sequence data for a batch.
+    ///
+    /// This is the part of adding a sequence that does not depend on
+    /// the state of the database being built, so it is done for all
+    /// sequences of the batch in parallel.
+    ///
+    /// @param batch Sequences to prepare. [in|out]
+    void x_PrepareSourceBatch(vector<SSourceBioseq> & batch);
+
+    /// Add a sequence read from a Bioseq source to the database.
+    /// @param entry Sequence to add. [in]
+    /// @param add_pig true if PIG should be added if available. [in]
+    /// @return true if the sequence was added.
+    bool x_AddSourceBioseq(SSourceBioseq & entry, bool add_pig);
 
     /// Add the masks for the Seq-id(s) (usually just one) to the database
     /// being created
@@ -630,6 +683,9 @@ private:
     /// If true, use long sequence ids (database|accession)
     bool m_LongIDs;
 
+    /// Number of threads used to build the database.
+    int m_NumThreads;
+
     /// If true, there were sequences whose IDs matched those in the provided
     /// masking locations (via SetMaskDataSource). Used to display a warning in
     /// case this didn't happen
@@ -341,6 +341,15 @@ public:
     /// @param letters Maximum letters to pack in one volume. [in]
     void SetMaxVolumeLetters(Uint8 letters);
 
+    /// Set the number of threads used to build the indices.
+    ///
+    /// The ISAM index files of each volume are sorted and written
+    /// using up to this many threads.  The default is 1; the files
+    /// produced are identical for any number of threads.
+    ///
+    /// @param num_threads Maximum number of threads to use. [in]
+    void SetNumThreads(int num_threads);
+
     /// Extract Deflines From Bioseq.
     ///
     /// Deflines are extracted from the CBioseq and returned to the
@@ -43,6 +43,7 @@
 /// Implemented for: UNIX, MS-Windows
 
 #include <objects/seq/seq__.hpp>
+#include <functional>
 
 BEGIN_NCBI_SCOPE
 
@@ -395,7 +396,12 @@ public:
     void Insert(const char * x, int L);
     
     /// Sort all contained data.
-    void Sort();
+    ///
+    /// Each first level prefix is sorted independently, so the work
+    /// can be spread over several threads.
+    ///
+    /// @param num_threads Maximum number of threads to use. [in]
+    void Sort(int num_threads = 1);
     
     /// Return the number of contained entries.
     int Size() const
@@ -511,6 +517,90 @@ private:
 };
 #endif
 
+#ifndef NCBI_SWIG
+/// A unit of work for WriteDB_RunTasks.
+typedef std::function<void()> TWriteDB_Task;
+
+/// Run independent tasks using up to the given number of threads.
+///
+/// Tasks are started in list order; the calling thread runs tasks
+/// too.  If a task throws, no further tasks are started and the first
+/// exception is rethrown in the calling thread after all running
+/// tasks have finished.  With one thread (or one task) the tasks are
+/// simply run in order in the calling thread.
+///
+/// @param tasks The tasks to run. [in]
+/// @param num_threads Maximum number of threads to use. [in]
+void WriteDB_RunTasks(const vector<TWriteDB_Task> & tasks, int num_threads);
+
+/// Sort a vector using up to the given number of threads.
+///
+/// The vector is split into one range per thread, the ranges are
+/// sorted concurrently, and then merged pairwise.  The result is
+/// identical to that of std::sort for any strict weak ordering whose
+/// equivalent elements are indistinguishable (such as a total order).
+///
+/// @param data The vector to sort. [in|out]
+/// @param num_threads Maximum number of threads to use. [in]
+template<class T>
+void WriteDB_ParallelSort(vector<T> & data, int num_threads)
+{
+    // Below this size, starting threads costs more than it saves.
+    const size_t kMinPerThread = 64 * 1024;
+    
+    size_t chunks = data.size() / kMinPerThread;
+    
+    if (num_threads > 0 && chunks > (size_t) num_threads) {
+        chunks = num_threads;
+    }
+    
+    if (chunks <= 1) {
+        std::sort(data.begin(), data.end());
+        return;
+    }
+    
+    typedef typename vector<T>::iterator TIter;
+    
+    vector<size_t> bounds;
+    vector<TWriteDB_Task> tasks;
+    
+    for(size_t i = 0; i <= chunks; i++) {
+        bounds.push_back(data.size() * i / chunks);
+    }
+    
+    for(size_t i = 0; i < chunks; i++) {
+        TIter b = data.begin() + bounds[i], e = data.begin() + bounds[i+1];
+        tasks.push_back([b, e]() { std::sort(b, e); });
+    }
+    WriteDB_RunTasks(tasks, num_threads);
+    
+    // Merge neighboring ranges until only one is left.
+    
+    while(bounds.size() > 2) {
+        vector<size_t> merged;
+        size_t i = 0;
+        
+        tasks.clear();
+        
+        for(; i + 2 < bounds.size(); i += 2) {
+            TIter b = data.begin() + bounds[i],
+                m = data.begin() + bounds[i+1],
+                e = data.begin() + bounds[i+2];
+            
+            tasks.push_back([b, m, e]() { std::inplace_merge(b, m, e); });
+            merged.push_back(bounds[i]);
+        }
+        if (i + 1 < bounds.size()) {
+            merged.push_back(bounds[i]);
+        }
+        merged.push_back(data.size());
+        
+        WriteDB_RunTasks(tasks, num_threads);
+        bounds.swap(merged);
+    }
+}
+#endif
+
 /// Compute length of sequence from raw packing.
 /// @param protein Specify true for protein formats, false for nucleotide.
 /// @param seq Sequence data (in na2 format for nucletide).
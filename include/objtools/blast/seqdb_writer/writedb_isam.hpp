@@ -152,6 +152,13 @@ public:
     /// @return True if no sequences were added.
     bool Empty() const;
     
+    /// Set the number of threads used to sort the index.
+    /// @param num_threads Maximum number of threads to use. [in]
+    void SetNumThreads(int num_threads)
+    {
+        m_NumThreads = num_threads;
+    }
+    
 private:
     enum {
         eKeyOffset       = 9*4,  ///< Offset of the key offset table.
@@ -359,6 +366,9 @@ private:
     int                     m_Oid;  
     /// Keep track of string seqids associated with current value of m_Oid
     set<string>             m_OidStringData;
+    
+    /// Number of threads used to sort the index.
+    int                     m_NumThreads;
 };
 
 /// CWriteDB_IsamData class
@@ -494,6 +504,10 @@ public:
     ///   The set of resolved database path names. [out]
     void ListFiles(vector<string> & files) const;
     
+    /// Set the number of threads used to sort the index.
+    /// @param num_threads Maximum number of threads to use. [in]
+    void SetNumThreads(int num_threads);
+    
 private:
     /// Index file, contains meta data and samples of the key/oid pairs.
     CRef<CWriteDB_IsamIndex> m_IFile;
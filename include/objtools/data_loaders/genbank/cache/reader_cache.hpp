@@ -218,6 +218,12 @@ protected:
                        const TBlobId& blob_id,
                        TChunkId chunk_id,
                        CNcbiIstream& stream);
+    // process blob from the cache reader and release the connection
+    void x_ProcessBlob(CReaderRequestResult& result,
+                       const TBlobId& blob_id,
+                       TChunkId chunk_id,
+                       IReader* reader,
+                       CConn& conn);
     void x_SetBlobVersionAsCurrent(CReaderRequestResult& result,
                                    const string& key,
                                    const string& subkey,
@@ -59,6 +59,8 @@
 
 BEGIN_NCBI_SCOPE
 
+class CThreadPool;
+
 BEGIN_SCOPE(objects)
 
 class CReadDispatcher;
@@ -413,12 +415,22 @@ private:
     bool                    m_AlwaysLoadNamedAcc;
     bool                    m_AddWGSMasterDescr;
 
+    // number of threads loading blobs of bulk requests, 0 - no threads
+    unsigned int            m_BulkLoadThreads;
+    AutoPtr<CThreadPool>    m_BulkLoadPool;
+    CFastMutex              m_BulkLoadPoolMutex;
+
     //
     // private code
     //
 
     void x_CreateDriver(const CGBLoaderParams& params);
 
+    // resolve and load blobs of bulk request on the thread pool
+    void x_LoadBlobSetParallel(CGBReaderRequestResult& result,
+                               const TIds& ids,
+                               vector<CTSE_LoadLock>& locks);
+
     string GetReaderName(const TParamTree* params) const;
     string GetWriterName(const TParamTree* params) const;
     bool x_CreateReaders(const string& str,
@@ -67,5 +67,7 @@
 #define NCBI_GBLOADER_PARAM_ALWAYS_LOAD_NAMED_ACC "ALWAYS_LOAD_NAMED_ACC"
 /* Add WGS master descriptors to all WGS sequences */
 #define NCBI_GBLOADER_PARAM_ADD_WGS_MASTER "ADD_WGS_MASTER"
+/* Number of threads loading blobs of bulk requests (default: 0 - serial) */
+#define NCBI_GBLOADER_PARAM_BULK_LOAD_THREADS "BULK_LOAD_THREADS"
 
 #endif
@@ -160,6 +160,9 @@ public:
                     const TChunkIds& chunk_ids);
     void LoadBlobSet(CReaderRequestResult& result,
                      const TIds& seq_ids);
+    // resolve Seq-ids to Blob-ids in bulk, without loading the blobs
+    void LoadSeq_idBlob_idsSet(CReaderRequestResult& result,
+                               const TIds& seq_ids);
 
     void CheckReaders(void) const;
     void Process(CReadDispatcherCommand& command,
@@ -140,6 +140,8 @@ public:
                     const TChunkIds& chunk_ids);
     bool LoadBlobSet(CReaderRequestResult& result,
                      const TSeqIds& seq_ids);
+    bool LoadSeq_idBlob_idsSet(CReaderRequestResult& result,
+                               const TSeqIds& seq_ids);
 
     static TBlobId GetBlobId(const CID2_Blob_Id& blob_id);
     
@@ -250,9 +252,6 @@ protected:
                            SId2LoadedSet& data,
                            const SAnnotSelector* sel);
 
-    bool x_LoadSeq_idBlob_idsSet(CReaderRequestResult& result,
-                                 const TSeqIds& seq_ids);
-
     friend class CId2ReaderProcessorResolver;
 
     void x_DumpPacket(TConn conn, const CID2_Request_Packet& packet, const char* msg = "Sending");
@@ -1219,6 +1219,10 @@ public:
 
     bool IsInProcessor(void) const { return m_InProcessor > 0; }
 
+    // bulk request is loaded by several threads sharing reader connections
+    bool IsBulkLoad(void) const { return m_BulkLoad; }
+    void SetBulkLoad(bool bulk_load = true) { m_BulkLoad = bulk_load; }
+
 private:
     friend class CLoadLockBlob;
     friend class CLoadLockSetter;
@@ -1237,6 +1241,7 @@ private:
     CReaderAllocatedConnection* m_AllocatedConnection;
     double          m_RetryDelay;
     TExpirationTime m_StartTime;
+    bool            m_BulkLoad;
 
 private: // hide methods
     void* operator new(size_t size);
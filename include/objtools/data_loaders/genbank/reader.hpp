@@ -146,6 +146,9 @@ public:
                             const TChunkIds& chunk_ids);
     virtual bool LoadBlobSet(CReaderRequestResult& result,
                              const TSeqIds& seq_ids);
+    // resolve all Seq-ids to their Blob-ids, in as few requests as possible
+    virtual bool LoadSeq_idBlob_idsSet(CReaderRequestResult& result,
+                                       const TSeqIds& seq_ids);
 
     void SetAndSaveSeq_idSeq_ids(CReaderRequestResult& result,
                                  const CSeq_id_Handle& seq_id,
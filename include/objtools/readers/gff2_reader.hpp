@@ -64,6 +64,7 @@ public:
         fNewCode =      0x1000, // for now don't clobber CGFFReader flags
         fGenbankMode =  0x2000,
         fRetainLocusIds = 0x4000,
+        fStreaming =    0x8000, // one annot per sequence, see ReadSeqAnnot()
     } TFlags;
 
     typedef map<string, CRef<CSeq_feat> > IdToFeatureMap;
@@ -90,6 +91,11 @@ public:
     unsigned int 
     ObjectType() const { return OT_SEQENTRY; };
     
+    /// Read the next annot.
+    /// With fStreaming, an annot ends at the first feature on another
+    /// sequence, or at a "###" directive, and the ID lookup tables are
+    /// released as soon as it is complete. Call this in a loop and dispose
+    /// of every annot to read a large sorted file in bounded memory.
     virtual CRef< CSeq_annot >
     ReadSeqAnnot(
         ILineReader& lr,
@@ -333,6 +339,11 @@ public:
 
     virtual bool xReadInit();
 
+    virtual void xClearFeatureMaps();
+
+    bool xIsNewSequence(
+        const string&);
+
     virtual bool xAnnotPostProcess(
         CRef<CSeq_annot>);
     virtual bool xGenerateParentChildXrefs(
@@ -421,6 +432,7 @@ protected:
     bool mParsingAlignment;
     CRef<CAnnotdesc> m_CurrentBrowserInfo;
     CRef<CAnnotdesc> m_CurrentTrackInfo;
+    string mCurrentSeqId;
 };
 
 END_SCOPE(objects)
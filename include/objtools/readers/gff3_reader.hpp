@@ -151,6 +151,8 @@ protected:
 
     virtual bool xReadInit();
 
+    virtual void xClearFeatureMaps();
+
     string xNextGenericId();
 
     bool xVerifyExonLocation(
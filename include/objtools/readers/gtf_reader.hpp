@@ -210,6 +210,8 @@ protected:
     bool x_CdsIsPartial(
         const CGff2Record& );
 
+    virtual void xClearFeatureMaps();
+
     typedef map< string, CRef< CSeq_feat > > TIdToFeature;
     TIdToFeature m_GeneMap;
     TIdToFeature m_CdsMap;
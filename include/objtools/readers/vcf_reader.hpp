@@ -39,12 +39,17 @@
 #include <objtools/readers/message_listener.hpp>
 #include <objects/seq/Seq_annot.hpp>
 
+#include <deque>
+
 
 BEGIN_NCBI_SCOPE
 
+class CThreadPool;
+
 BEGIN_SCOPE(objects) // namespace ncbi::objects::
 
 class CVcfData;
+class CVcfParseTask;
 
 //  ----------------------------------------------------------------------------
 enum ESpecType
@@ -167,6 +172,27 @@ public:
         ILineReader&,
         ILineErrorListener* =0 );
 
+    /// Parse data lines on a pool of threads. The data lines are collected
+    /// into batches, every batch is parsed by one thread, and the features
+    /// and messages are merged back in input order, so the result is the
+    /// same as with single threaded reading.
+    /// @param threads
+    ///   number of parser threads, 0 means the number of CPUs, 1 (default)
+    ///   parses on the calling thread.
+    void
+    SetThreads(
+        unsigned int threads );
+
+    /// Parse only the given FORMAT fields of the sample columns.
+    /// The sample columns are then scanned for the requested fields only,
+    /// and the feature gets a "genotype-columns" user field with one entry
+    /// per field, holding its values for all samples in "genotype-headers"
+    /// order. Fields missing in a sample are reported as ".". An empty list
+    /// skips the sample columns altogether.
+    void
+    SetFormatFields(
+        const vector<string>& fields );
+
     //
     //  helpers:
     //
@@ -293,6 +319,11 @@ protected:
         CVcfData&,
         CRef<CSeq_feat> );
 
+    virtual bool
+    xProcessFormatColumns(
+        CVcfData&,
+        CRef<CSeq_feat> );
+
     virtual bool
     xParseData(
         const string&,
@@ -304,6 +335,43 @@ protected:
         CVcfData&,
         ILineErrorListener* =0);
 
+    virtual CVcfReader*
+    xCreateBatchParser() const;
+
+    bool
+    xIsDataLine(
+        const string& );
+
+    unsigned int
+    xBatchDataLine(
+        const string&,
+        CRef<CSeq_annot>,
+        ILineErrorListener*);
+
+    void
+    xSubmitBatch();
+
+    unsigned int
+    xProcessDataBatch(
+        const vector<string>&,
+        const vector<unsigned int>&,
+        CRef<CSeq_annot>,
+        ILineErrorListener*);
+
+    unsigned int
+    xCollectBatches(
+        size_t,
+        CRef<CSeq_annot>,
+        ILineErrorListener*);
+
+    unsigned int
+    xFlushBatches(
+        CRef<CSeq_annot>,
+        ILineErrorListener*);
+
+    void
+    xDiscardBatches();
+
     //
     //  data:
     //
@@ -316,6 +384,14 @@ protected:
     vector<string> m_GenotypeHeaders;
     CMessageListenerLenient m_ErrorsPrivate;
     bool m_MetaHandled;
+    bool m_FormatColumnar;
+    vector<string> m_FormatFields;
+    unsigned int m_Threads;
+    CThreadPool* m_pThreadPool;
+    CRef<CVcfParseTask> m_pBatch;
+    deque< CRef<CVcfParseTask> > m_PendingBatches;
+
+    friend class CVcfParseTask;
 };
 
 END_SCOPE(objects)
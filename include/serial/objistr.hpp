@@ -62,6 +62,7 @@ class CVariantInfo;
 class CDelayBuffer;
 class CByteSource;
 class CByteSourceReader;
+class CMemoryFile;
 
 class CObjectInfo;
 class CObjectInfoMI;
@@ -253,6 +254,18 @@ public:
     /// @param size
     ///   Memory buffer size
     void OpenFromBuffer(const char* buffer, size_t size);
+
+    /// Attach reader to a memory mapped file
+    ///
+    /// The file is mapped read-only and parsed in place, without copying
+    /// it through an intermediate stream buffer. The mapping is released
+    /// by Close(). Binary ASN.1 input can then hand out string and
+    /// OCTET STRING values as views into the mapped data, see
+    /// CObjectIStreamAsnBinary::ReadStringView().
+    ///
+    /// @param fileName
+    ///   Input file name
+    void OpenFromMemoryFile(const string& fileName);
     
     /// Detach reader from a data source
     void Close(void);
@@ -1027,6 +1040,7 @@ protected:
     }
 
     CIStreamBuffer m_Input;
+    AutoPtr<CMemoryFile> m_MemoryFile;
     bool m_DiscardCurrObject;
     ESerialDataFormat   m_DataFormat;
     EDelayBufferParsing  m_ParseDelayBuffers;
@@ -139,6 +139,24 @@ public:
     virtual void ReadBitString(CBitString& obj);
     virtual void SkipBitString(void);
 
+    /// Read string value without copying it, if possible.
+    ///
+    /// When the stream reads from a memory buffer (OpenFromBuffer,
+    /// OpenFromMemoryFile) the returned view points directly into the
+    /// input data and stays valid until the stream is closed.
+    /// Otherwise, or when visible characters had to be fixed, the view
+    /// refers to an internal buffer which is overwritten by the next call.
+    /// Intended for read and skip hooks which only inspect the value.
+    ///
+    /// @param type
+    ///   String type, as in ReadString()
+    CTempString ReadStringView(EStringType type = eStringTypeVisible);
+
+    /// Read OCTET STRING value without copying it, if possible.
+    ///
+    /// Lifetime of the returned data is the same as in ReadStringView().
+    CTempString ReadOctetStringView(void);
+
 protected:
     virtual bool ReadBool(void);
     virtual char ReadChar(void);
@@ -263,6 +281,7 @@ private:
 #endif
     size_t m_CurrentTagLength;  // length of tag header (without length field)
     bool m_SkipNextTag;
+    string m_ViewBuffer;        // value storage for Read*View() methods
 #if USE_DEF_LEN
     Int8 m_CurrentDataLimit;
     vector<Int8> m_DataLimits;
@@ -333,6 +352,7 @@ private:
     void SkipBytes(size_t count);
 
     void ReadStringValue(size_t length, string& s, EFixNonPrint fix_type);
+    CTempString x_ReadBytesView(size_t length);
     void SkipTagData(void);
     bool HaveMoreElements(void);
     void UnexpectedMember(TLongTag tag, const CItemsInfo& items);
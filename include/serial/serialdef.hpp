@@ -130,7 +130,9 @@ enum ESerialOpenFlags {
     eSerial_StdWhenStd   = 1 << 2, ///< use std when filename is "stdin"/"stdout"
     eSerial_StdWhenMask  = 15,
     eSerial_StdWhenAny   = eSerial_StdWhenMask,
-    eSerial_UseFileForReread = 1 << 4
+    eSerial_UseFileForReread = 1 << 4,
+    eSerial_UseMemoryMap = 1 << 5  ///< parse the file in place from a
+                                   ///< read-only memory mapping
 };
 typedef int TSerialOpenFlags;
 
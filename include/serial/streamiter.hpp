@@ -37,12 +37,14 @@
 #include <corelib/ncbistd.hpp>
 #include <corelib/ncbithr.hpp>
 #include <serial/objistr.hpp>
+#include <serial/objectio.hpp>
 
 #include <queue>
 #include <future>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
+#include <exception>
 
 
 /** @addtogroup ObjStreamSupport
@@ -193,6 +195,8 @@ public:
         bool      m_SameThread;
 
         template<typename...> friend class CObjectIStreamAsyncIterator;
+        template<typename, typename>
+        friend class CObjectIStreamContainerAsyncIterator;
     };
 
 
@@ -1339,6 +1343,489 @@ CObjectIStreamAsyncIterator<TRoot, TChild>::sx_ClearGarbageAndParse(
 }
 
 
+/////////////////////////////////////////////////////////////////////////////
+///   CObjectIStreamContainerAsyncIterator<TRoot, TElement>
+///
+///  Parse elements of a container (SET OF, SEQUENCE OF) data member of
+///  a single top-level TRoot object in parallel, and return them in their
+///  original order.
+///  @sa CObjectIStreamAsyncIterator
+///
+///  Typical input is a release file which consists of one huge Bioseq-set
+///  whose "seq-set" member holds numerous Seq-entry objects:
+///  @code
+///
+///  CObjectIStreamContainerAsyncIterator<CBioseq_set, CSeq_entry>
+///      it(istr, "seq-set");
+///  for (CSeq_entry& entry : it) {
+///      // ...do something with "entry" here...
+///  }
+///  // the rest of the top-level Bioseq-set is available now
+///  const CBioseq_set& root = it.GetRoot();
+///
+///  @endcode
+///
+///  A reader thread reads the TRoot object. Elements of the container member
+///  are not parsed there: their boundaries are found by skipping them, and
+///  the raw data of each element is stored. Batches of raw elements are then
+///  parsed by asynchronous tasks, up to MaxParserThreads at a time.
+///  The container member of the root object itself remains empty.
+///
+///  Only ASN.1 text and binary data formats are supported.
+///  ReadAndSkipInTheSameThread parameter is ignored.
+///
+///  @attention
+///    TElement must be derived from CSerialObject, and must be the element
+///    type (or the type pointed to by the element) of the container member.
+
+template<typename TRoot, typename TElement>
+class CObjectIStreamContainerAsyncIterator
+    : public iterator< input_iterator_tag, TElement, ptrdiff_t, TElement*, TElement& >
+{
+public:
+    /// Construct iterator upon an object serialization stream
+    ///
+    /// @param istr
+    ///   Serial object stream positioned at the TRoot object
+    /// @param container_member
+    ///   Name of the container data member of TRoot
+    /// @param own_istr
+    ///   eTakeOwnership means that the input stream will be deleted
+    ///   automatically when the iterator gets destroyed
+    /// @param params
+    ///   Parsing algorithm's parameters
+    CObjectIStreamContainerAsyncIterator(
+        CObjectIStream& istr,
+        const string& container_member,
+        EOwnership deleteInStream = eNoOwnership,
+        const CObjectIStreamAsyncIterator<>::CParams& params
+            = CObjectIStreamAsyncIterator<>::CParams());
+    CObjectIStreamContainerAsyncIterator(void);
+    CObjectIStreamContainerAsyncIterator(const CObjectIStreamContainerAsyncIterator&);
+    CObjectIStreamContainerAsyncIterator& operator=(const CObjectIStreamContainerAsyncIterator&);
+    ~CObjectIStreamContainerAsyncIterator();
+
+    CObjectIStreamContainerAsyncIterator& operator++(void);
+    bool operator==(const CObjectIStreamContainerAsyncIterator&) const;
+    bool operator!=(const CObjectIStreamContainerAsyncIterator&) const;
+    bool IsValid(void) const;
+
+    TElement& operator*();
+    TElement* operator->();
+
+    CObjectIStreamContainerAsyncIterator& begin(void);
+    CObjectIStreamContainerAsyncIterator  end(void);
+
+    /// Top-level object, without the container elements.
+    /// It is completely read only when the iteration is over.
+    const TRoot& GetRoot(void) const;
+
+private:
+    typedef queue< CRef<TElement> >      TObjectsQueue;
+    typedef vector< CRef<CByteSource> > TRawElements;
+
+    static TObjectsQueue sx_ClearGarbageAndParse(
+            TRawElements elements,  ESerialDataFormat format,
+#if !NCBI_COMPILER_MSVC || _MSC_VER >= 1900
+            TObjectsQueue&& garbage
+#else
+            TObjectsQueue garbage
+#endif
+            );
+
+    struct CData {
+        CData(CObjectIStream& istr, const string& container_member,
+            EOwnership deleteInStream,
+            const CObjectIStreamAsyncIterator<>::CParams& params);
+        ~CData(void);
+
+        using future_queue_t  = future<TObjectsQueue>;
+        using futures_queue_t = queue<future_queue_t>;
+
+        void x_UpdateObjectsQueue();
+        void x_UpdateFuturesQueue();
+        TRawElements x_GetNextData(void);
+        void x_PutData(TRawElements& elements, size_t size);
+        void x_ReaderThread(void);
+        void x_SkipElements(CObjectIStream& in, const CObjectInfoMI& member);
+
+        TObjectsQueue m_ObjectsQueue; // current queue of objects
+        TObjectsQueue m_GarbageQueue; // popped so-far from objects-queue
+        futures_queue_t m_FuturesQueue; // queue-of-futures-of-object-queues
+
+        CObjectIStream* m_Istr;
+        EOwnership      m_Own;
+        CRef<TRoot>     m_Root;
+        string          m_Member;
+        size_t          m_ParserCount;
+        size_t          m_RawBufferSize;
+        size_t          m_MaxRawSize;
+        size_t          m_CurrentRawSize;
+        launch          m_Policy;
+        bool            m_EndOfData;  // consumer side
+        bool            m_Stop;       // reader side, guarded by m_ReaderMutex
+        exception_ptr   m_ReaderError;
+
+        mutex                        m_ReaderMutex;
+        condition_variable           m_ReaderCv;
+        thread                       m_Reader;
+        queue< TRawElements >        m_ReaderData;
+        queue< size_t >              m_ReaderDataSize;
+    };
+
+    class CReadContainerHook : public CReadClassMemberHook
+    {
+    public:
+        CReadContainerHook(CData& data)
+            : m_Data(data) {
+        }
+        virtual void ReadClassMember(CObjectIStream& in,
+                                     const CObjectInfoMI& member) {
+            m_Data.x_SkipElements(in, member);
+        }
+        CData& m_Data;
+    };
+
+    shared_ptr<CData> m_Data;
+    CRef<TRoot>       m_Root;
+};
+
+
+/////////////////////////////////////////////////////////////////////////////
+///  CObjectIStreamContainerAsyncIterator<TRoot, TElement> implementation
+
+template<typename TRoot, typename TElement>
+CObjectIStreamContainerAsyncIterator<TRoot, TElement>::CObjectIStreamContainerAsyncIterator(void)
+    : m_Data(nullptr)
+{
+}
+
+template<typename TRoot, typename TElement>
+CObjectIStreamContainerAsyncIterator<TRoot, TElement>::CObjectIStreamContainerAsyncIterator(
+        CObjectIStream& istr, const string& container_member,
+        EOwnership deleteInStream,
+        const CObjectIStreamAsyncIterator<>::CParams& params)
+    : m_Data(new CData(istr, container_member, deleteInStream, params))
+{
+    m_Root = m_Data->m_Root;
+    ++(*this);
+}
+
+template<typename TRoot, typename TElement>
+CObjectIStreamContainerAsyncIterator<TRoot, TElement>::CObjectIStreamContainerAsyncIterator(
+    const CObjectIStreamContainerAsyncIterator& v)
+        : m_Data(v.m_Data), m_Root(v.m_Root)
+{
+}
+
+template<typename TRoot, typename TElement>
+CObjectIStreamContainerAsyncIterator<TRoot, TElement>&
+CObjectIStreamContainerAsyncIterator<TRoot, TElement>::operator=(
+    const CObjectIStreamContainerAsyncIterator& v) {
+    m_Data = v.m_Data;
+    m_Root = v.m_Root;
+    return *this;
+}
+
+template<typename TRoot, typename TElement>
+CObjectIStreamContainerAsyncIterator<TRoot, TElement>::~CObjectIStreamContainerAsyncIterator() {
+}
+
+template<typename TRoot, typename TElement>
+CObjectIStreamContainerAsyncIterator<TRoot, TElement>&
+CObjectIStreamContainerAsyncIterator<TRoot, TElement>::operator++() {
+    if (m_Data.get() != nullptr) {
+        m_Data->x_UpdateFuturesQueue();
+        m_Data->x_UpdateObjectsQueue();
+        if (!IsValid()) {
+            exception_ptr error = m_Data->m_ReaderError;
+            m_Data.reset();
+            if (error) {
+                rethrow_exception(error);
+            }
+        }
+    }
+    return *this;
+}
+
+template<typename TRoot, typename TElement>
+bool
+CObjectIStreamContainerAsyncIterator<TRoot, TElement>::operator==(
+    const CObjectIStreamContainerAsyncIterator& v) const {
+    return m_Data.get() == v.m_Data.get();
+}
+
+template<typename TRoot, typename TElement>
+bool
+CObjectIStreamContainerAsyncIterator<TRoot, TElement>::operator!=(
+    const CObjectIStreamContainerAsyncIterator& v) const {
+    return m_Data.get() != v.m_Data.get();
+}
+
+template<typename TRoot, typename TElement>
+bool CObjectIStreamContainerAsyncIterator<TRoot, TElement>::IsValid() const {
+    return m_Data.get() != nullptr && !m_Data->m_ObjectsQueue.empty();
+}
+
+template<typename TRoot, typename TElement>
+TElement&
+CObjectIStreamContainerAsyncIterator<TRoot, TElement>::operator*() {
+    return m_Data->m_ObjectsQueue.front().GetObject();
+}
+
+template<typename TRoot, typename TElement>
+TElement*
+CObjectIStreamContainerAsyncIterator<TRoot, TElement>::operator->() {
+    return IsValid() ? m_Data->m_ObjectsQueue.front().GetPointer() : nullptr;
+}
+
+template<typename TRoot, typename TElement>
+CObjectIStreamContainerAsyncIterator<TRoot, TElement>&
+CObjectIStreamContainerAsyncIterator<TRoot, TElement>::begin(void) {
+    return *this;
+}
+
+template<typename TRoot, typename TElement>
+CObjectIStreamContainerAsyncIterator<TRoot, TElement>
+CObjectIStreamContainerAsyncIterator<TRoot, TElement>::end(void) {
+    return CObjectIStreamContainerAsyncIterator<TRoot, TElement>();
+}
+
+template<typename TRoot, typename TElement>
+const TRoot&
+CObjectIStreamContainerAsyncIterator<TRoot, TElement>::GetRoot(void) const {
+    return m_Root.GetObject();
+}
+
+template<typename TRoot, typename TElement>
+typename CObjectIStreamContainerAsyncIterator<TRoot, TElement>::TObjectsQueue
+CObjectIStreamContainerAsyncIterator<TRoot, TElement>::sx_ClearGarbageAndParse(
+        TRawElements elements,
+        ESerialDataFormat format,
+#if !NCBI_COMPILER_MSVC || _MSC_VER >= 1900
+        TObjectsQueue&& garbage
+#else
+        TObjectsQueue garbage
+#endif
+        )
+{
+    {{
+        TObjectsQueue dummy;
+        swap(garbage, dummy);
+        // garbage now gets destroyed, if last-reference
+    }}
+
+    // each element was stored separately, without container delimiters
+    TObjectsQueue queue;
+    for (CRef<CByteSource>& raw : elements) {
+        unique_ptr<CObjectIStream> istr { CObjectIStream::Create(format, *raw) };
+        raw.Reset();
+        CRef<TElement> object(new TElement);
+        istr->ReadObject(&*object, object->GetThisTypeInfo());
+        queue.push(object);
+    }
+    return queue;
+}
+
+template<typename TRoot, typename TElement>
+CObjectIStreamContainerAsyncIterator<TRoot, TElement>::CData::CData(
+        CObjectIStream& istr, const string& container_member,
+        EOwnership deleteInStream,
+        const CObjectIStreamAsyncIterator<>::CParams& params)
+    : m_Istr(&istr)
+    , m_Own(deleteInStream)
+    , m_Root(new TRoot)
+    , m_ParserCount(   params.m_MaxParserThreads != 0 ? params.m_MaxParserThreads : 16)
+    , m_RawBufferSize( params.m_MinRawBufferSize)
+    , m_MaxRawSize(    params.m_MaxTotalRawSize)
+    , m_CurrentRawSize(0)
+    , m_Policy(params.m_ThreadPolicy)
+    , m_EndOfData(false)
+    , m_Stop(false)
+{
+    if (istr.GetDataFormat() != eSerial_AsnText &&
+        istr.GetDataFormat() != eSerial_AsnBinary) {
+        NCBI_THROW(CSerialException, eNotImplemented,
+            "CObjectIStreamContainerAsyncIterator: unsupported data format");
+    }
+    CObjectTypeInfoMI member =
+        CObjectTypeInfo(TRoot::GetTypeInfo()).FindMember(container_member);
+    CObjectTypeInfo element;
+    if (member.Valid() &&
+        member.GetMemberType().GetTypeFamily() == eTypeFamilyContainer) {
+        element = member.GetMemberType().GetElementType();
+        if (element.GetTypeFamily() == eTypeFamilyPointer) {
+            element = element.GetPointedType();
+        }
+    }
+    if (element.GetTypeInfo() != TElement::GetTypeInfo()) {
+        NCBI_THROW(CSerialException, eIllegalCall,
+            "CObjectIStreamContainerAsyncIterator: " + container_member +
+            " is not a container of " + TElement::GetTypeInfo()->GetName());
+    }
+    m_Member = container_member;
+    member.SetLocalReadHook(istr, new CReadContainerHook(*this));
+    m_Reader = thread(
+        mem_fun<void, CObjectIStreamContainerAsyncIterator<TRoot, TElement>::CData >(
+            &CObjectIStreamContainerAsyncIterator<TRoot, TElement>::CData::x_ReaderThread), this);
+}
+
+template<typename TRoot, typename TElement>
+CObjectIStreamContainerAsyncIterator<TRoot, TElement>::CData::~CData() {
+    if (m_Reader.joinable()) {
+        {
+            unique_lock<mutex> lck(m_ReaderMutex);
+            m_Stop = true;
+        }
+        m_ReaderCv.notify_all();
+        m_Reader.join();
+    }
+    if (m_Istr && m_Own == eTakeOwnership) {
+        delete m_Istr;
+    }
+}
+
+template<typename TRoot, typename TElement>
+void
+CObjectIStreamContainerAsyncIterator<TRoot, TElement>::CData::x_UpdateObjectsQueue()
+{
+    // bring the next objects up front; save the garbage
+    if(!m_ObjectsQueue.empty()) {
+        m_GarbageQueue.push( m_ObjectsQueue.front());
+        m_ObjectsQueue.pop();
+    }
+
+    // unpack the next objects-queue from futures-queue if empty
+    if(    m_ObjectsQueue.empty()
+        && !m_FuturesQueue.empty())
+    {
+        m_ObjectsQueue = m_FuturesQueue.front().get();
+        m_FuturesQueue.pop();
+    }
+}
+
+template<typename TRoot, typename TElement>
+void
+CObjectIStreamContainerAsyncIterator<TRoot, TElement>::CData::x_UpdateFuturesQueue()
+{
+    // nothing to deserialize, or already full
+    if( m_EndOfData || m_FuturesQueue.size() >= m_ParserCount) {
+        return;
+    }
+    {
+        // no raw data ready yet, but we still have work to do
+        unique_lock<mutex> lck(m_ReaderMutex);
+        if (m_ReaderData.empty() && !m_FuturesQueue.empty()) {
+            return;
+        }
+    }
+    TRawElements data = x_GetNextData();
+    if (data.empty()) {
+        m_EndOfData = true;
+        return;
+    }
+
+    TObjectsQueue tmp_garbage_queue;
+    swap(m_GarbageQueue, tmp_garbage_queue);
+
+    m_FuturesQueue.push( async( m_Policy,
+        &CObjectIStreamContainerAsyncIterator<TRoot, TElement>::sx_ClearGarbageAndParse,
+        move(data),  m_Istr->GetDataFormat(), move(tmp_garbage_queue)));
+}
+
+template<typename TRoot, typename TElement>
+typename CObjectIStreamContainerAsyncIterator<TRoot, TElement>::TRawElements
+CObjectIStreamContainerAsyncIterator<TRoot, TElement>::CData::x_GetNextData(void)
+{
+    // get raw data prepared by reader
+    unique_lock<mutex> lck(m_ReaderMutex);
+    while (m_ReaderData.empty()) {
+        m_ReaderCv.wait(lck);
+    }
+    TRawElements data;
+    data.swap(m_ReaderData.front());
+    m_ReaderData.pop();
+    m_CurrentRawSize -= m_ReaderDataSize.front();
+    m_ReaderDataSize.pop();
+    m_ReaderCv.notify_one();
+    return data;
+}
+
+template<typename TRoot, typename TElement>
+void
+CObjectIStreamContainerAsyncIterator<TRoot, TElement>::CData::x_PutData(
+    TRawElements& elements, size_t size)
+{
+    unique_lock<mutex> lck(m_ReaderMutex);
+    // make sure we do not consume too much memory
+    while (!m_Stop && m_CurrentRawSize >= m_MaxRawSize) {
+        m_ReaderCv.wait(lck);
+    }
+    if (m_Stop) {
+        NCBI_THROW(CSerialException, eFail,
+            "CObjectIStreamContainerAsyncIterator: reading stopped");
+    }
+    m_ReaderData.push(TRawElements());
+    m_ReaderData.back().swap(elements);
+    m_ReaderDataSize.push(size);
+    m_CurrentRawSize += size;
+    m_ReaderCv.notify_one();
+}
+
+template<typename TRoot, typename TElement>
+void
+CObjectIStreamContainerAsyncIterator<TRoot, TElement>::CData::x_SkipElements(
+    CObjectIStream& in, const CObjectInfoMI& member)
+{
+    // Skip the elements without parsing, storing the raw data of each one,
+    // up to buffer_size per batch.
+    TTypeInfo element_type =
+        member.GetMemberType().GetElementType().GetTypeInfo();
+    TRawElements elements;
+    size_t size = 0;
+    for (CIStreamContainerIterator it(in, member.GetMemberType()); it; ++it) {
+        const CNcbiStreampos startpos = in.GetStreamPos();
+        {
+            CStreamDelayBufferGuard guard(in);
+            in.SkipObject(element_type);
+            elements.push_back(guard.EndDelayBuffer());
+        }
+        size += (size_t)(in.GetStreamPos() - startpos);
+        it.NextElement();
+        if (size >= m_RawBufferSize) {
+            x_PutData(elements, size);
+            size = 0;
+        }
+    }
+    if (!elements.empty()) {
+        x_PutData(elements, size);
+    }
+}
+
+template<typename TRoot, typename TElement>
+void
+CObjectIStreamContainerAsyncIterator<TRoot, TElement>::CData::x_ReaderThread(void)
+{
+    try {
+        m_Istr->Read(m_Root.GetPointer(), m_Root->GetThisTypeInfo());
+    }
+    catch (...) {
+        unique_lock<mutex> lck(m_ReaderMutex);
+        if (!m_Stop) {
+            m_ReaderError = current_exception();
+        }
+    }
+    CObjectTypeInfo(TRoot::GetTypeInfo()).FindMember(m_Member)
+        .ResetLocalReadHook(*m_Istr);
+    // empty batch marks the end of data
+    m_ReaderMutex.lock();
+    m_ReaderData.push(TRawElements());
+    m_ReaderDataSize.push(0);
+    m_ReaderMutex.unlock();
+    m_ReaderCv.notify_one();
+}
+
+
 /////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////
 // Iterate over objects in input stream
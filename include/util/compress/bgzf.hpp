@@ -0,0 +1,280 @@
+#ifndef UTIL_COMPRESS__BGZF__HPP
+#define UTIL_COMPRESS__BGZF__HPP
+
+/*  $Id$
+ * ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ *
+ */
+
+/// @file bgzf.hpp
+/// BGZF (blocked gzip) format support.
+///
+/// BGZF file is a series of gzip members, each holding no more than 64KB
+/// of uncompressed data, with the compressed size of the member stored
+/// in the gzip header "BC" extra field. Any gzip decompressor can read it,
+/// and, with an index of the block positions, the data can be accessed
+/// randomly by decompressing only the blocks covering a requested range.
+/// The format is used by BAM, tabix and "bgzip" utility.
+///
+/// CBGZFIndex             - block index, compatible with "bgzip -i" (.gzi).
+/// CBGZFCompressor        - compression processor writing BGZF.
+/// CBGZFStreamCompressor  - stream processor for CCompressionOStream.
+/// CBGZFReader            - random access reader.
+
+#include <util/compress/zlib.hpp>
+#include <vector>
+
+
+/** @addtogroup Compression
+ *
+ * @{
+ */
+
+BEGIN_NCBI_SCOPE
+
+
+/////////////////////////////////////////////////////////////////////////////
+///
+/// CBGZFIndex --
+///
+/// Positions of BGZF blocks in the compressed file and in the uncompressed
+/// data. The virtual offset of a byte is the position of its block in
+/// the compressed file shifted left by 16 bits, plus the offset of the byte
+/// within the uncompressed block.
+/// The empty end-of-file block is indexed too, so the virtual offset
+/// of the end of data can be resolved, as with "bgzip -i" index.
+
+class NCBI_XUTIL_EXPORT CBGZFIndex
+{
+public:
+    typedef Uint8 TPosition;   ///< Position in the file/data
+    typedef Uint8 TVirtualPos; ///< Virtual offset
+
+    /// Block start positions.
+    struct SBlock {
+        TPosition raw_pos;     ///< Position in the compressed file
+        TPosition data_pos;    ///< Position in the uncompressed data
+    };
+    typedef vector<SBlock> TBlocks;
+
+    CBGZFIndex(void) {}
+
+    /// Add next block. Blocks must be added in the file order.
+    void AddBlock(TPosition raw_pos, TPosition data_pos);
+
+    /// Remove all blocks.
+    void Clear(void) { m_Blocks.clear(); }
+
+    /// Get all blocks.
+    const TBlocks& GetBlocks(void) const { return m_Blocks; }
+
+    /// Find the block containing the uncompressed data position.
+    /// Return the first block position for an empty index.
+    SBlock FindBlock(TPosition data_pos) const;
+
+    /// Get virtual offset for the uncompressed data position.
+    TVirtualPos GetVirtualPos(TPosition data_pos) const;
+
+    /// Get uncompressed data position for the virtual offset.
+    /// Throw CCompressionException if the virtual offset does not
+    /// point to the start of any indexed block.
+    TPosition GetDataPos(TVirtualPos virtual_pos) const;
+
+    /// Write index in "bgzip -i" (.gzi) format: the number of blocks
+    /// and pairs of compressed/uncompressed offsets, all as little-endian
+    /// 64-bit integers. The first block, at zero offset, is not written.
+    /// Throw CCompressionException on error.
+    void Write(CNcbiOstream& os) const;
+
+    /// Read index in "bgzip -i" (.gzi) format.
+    /// Throw CCompressionException on error.
+    void Read(CNcbiIstream& is);
+
+private:
+    TBlocks m_Blocks;
+};
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+///
+/// CBGZFCompressor -- BGZF compressor
+///
+/// Collect data into 64KB blocks and write each block as a separate gzip
+/// member. The blocks are registered in the index, which can be saved
+/// when compression is finished. Each Flush() ends the current block.
+/// An empty end-of-file block is written on Finish(), as "bgzip" does,
+/// even if there was no data at all.
+/// @note
+///   The block positions in the index are counted from the beginning of
+///   the compressed data produced by this compressor.
+/// @sa CBGZFStreamCompressor, CBGZFIndex, CZipCompression
+
+class NCBI_XUTIL_EXPORT CBGZFCompressor : public CZipCompression,
+                                          public CCompressionProcessor
+{
+public:
+    /// Constructor.
+    /// The flags are not used, empty data always produce
+    /// the end-of-file block.
+    CBGZFCompressor(ELevel level = eLevel_Default, TZipFlags flags = 0);
+    /// Destructor.
+    virtual ~CBGZFCompressor(void);
+
+    /// Get index of the written blocks.
+    const CBGZFIndex& GetIndex(void) const { return m_Index; }
+
+protected:
+    virtual EStatus Init   (void);
+    virtual EStatus Process(const char* in_buf,  size_t  in_len,
+                            char*       out_buf, size_t  out_size,
+                            /* out */            size_t* in_avail,
+                            /* out */            size_t* out_avail);
+    virtual EStatus Flush  (char*       out_buf, size_t  out_size,
+                            /* out */            size_t* out_avail);
+    virtual EStatus Finish (char*       out_buf, size_t  out_size,
+                            /* out */            size_t* out_avail);
+    virtual EStatus End    (int abandon = 0);
+
+private:
+    /// Compress current block into the output cache.
+    bool   x_CompressBlock(void);
+    /// Copy cached output into the output buffer.
+    size_t x_CopyOutput(char* out_buf, size_t out_size);
+
+private:
+    string      m_Block;      ///< Uncompressed data of the current block.
+    string      m_Output;     ///< Compressed blocks to write out.
+    size_t      m_OutputPos;  ///< Written part of m_Output.
+    Uint8       m_RawPos;     ///< Position of the next compressed block.
+    Uint8       m_DataPos;    ///< Position of the next uncompressed block.
+    bool        m_Finished;   ///< End-of-file block is added.
+    CBGZFIndex  m_Index;      ///< Block index.
+};
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+///
+/// CBGZFStreamCompressor -- BGZF compression stream processor
+///
+/// See util/compress/stream.hpp for details of stream processing.
+/// The index is available after the stream finalization.
+/// @sa CCompressionStreamProcessor, CBGZFCompressor
+
+class NCBI_XUTIL_EXPORT CBGZFStreamCompressor
+    : public CCompressionStreamProcessor
+{
+public:
+    /// Conventional constructor
+    CBGZFStreamCompressor(
+        CZipCompression::ELevel    level = CZipCompression::eLevel_Default,
+        CZipCompression::TZipFlags flags = 0
+        )
+        : CCompressionStreamProcessor(
+              new CBGZFCompressor(level, flags),
+              eDelete, kCompressionDefaultBufSize, kCompressionDefaultBufSize)
+    {}
+
+    /// Get index of the written blocks.
+    const CBGZFIndex& GetIndex(void) const
+        { return static_cast<CBGZFCompressor*>(GetProcessor())->GetIndex(); }
+};
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+///
+/// CBGZFReader -- random access to BGZF data
+///
+/// Read uncompressed data at any position, decompressing only the blocks
+/// that cover the requested range. The last decompressed block is cached,
+/// so sequential reads decompress every block once.
+/// Throw CCompressionException on errors.
+
+class NCBI_XUTIL_EXPORT CBGZFReader
+{
+public:
+    typedef CBGZFIndex::TPosition   TPosition;
+    typedef CBGZFIndex::TVirtualPos TVirtualPos;
+
+    /// Constructor.
+    /// @param is
+    ///   Seekable input stream with BGZF data, opened in binary mode.
+    /// @param index
+    ///   Block index. If NULL, the index is built by scanning the block
+    ///   headers of the whole stream, without decompression.
+    CBGZFReader(CNcbiIstream& is, const CBGZFIndex* index = NULL);
+    /// Destructor.
+    ~CBGZFReader(void);
+
+    /// Get the block index.
+    const CBGZFIndex& GetIndex(void) const { return m_Index; }
+
+    /// Read up to 'count' bytes of uncompressed data starting at 'pos'.
+    /// Return the number of bytes read, less than 'count' only at the end
+    /// of data.
+    size_t Read(TPosition pos, void* buf, size_t count);
+
+    /// Read uncompressed data in the range [from, to).
+    string ReadRange(TPosition from, TPosition to);
+
+    /// Read up to 'count' bytes starting at the virtual offset.
+    size_t ReadVirtual(TVirtualPos pos, void* buf, size_t count);
+
+private:
+    /// Read and decompress the block at 'raw_pos'.
+    /// Return FALSE at the end of the stream.
+    bool x_ReadBlock(TPosition raw_pos, TPosition data_pos);
+    /// Read block header at 'raw_pos', return its compressed size,
+    /// or 0 at the end of the stream.
+    size_t x_ReadHeader(TPosition raw_pos, size_t* header_size);
+    /// Build index by scanning the stream.
+    void x_BuildIndex(void);
+
+private:
+    CNcbiIstream& m_Stream;     ///< Underlying stream.
+    CBGZFIndex    m_Index;      ///< Block index.
+    string        m_RawBlock;   ///< Compressed block buffer.
+    string        m_Data;       ///< Decompressed data of the current block.
+    TPosition     m_RawPos;     ///< Current block position in the stream.
+    TPosition     m_DataPos;    ///< Current block position in the data.
+    size_t        m_RawSize;    ///< Current block compressed size.
+    bool          m_HaveBlock;  ///< Current block is valid.
+
+private:
+    /// Private copy constructor to prohibit copy.
+    CBGZFReader(const CBGZFReader&);
+    /// Private assignment operator to prohibit assignment.
+    CBGZFReader& operator= (const CBGZFReader&);
+};
+
+
+END_NCBI_SCOPE
+
+
+/* @} */
+
+#endif  /* UTIL_COMPRESS__BGZF__HPP */
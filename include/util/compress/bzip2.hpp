@@ -100,7 +100,12 @@ public:
         fAllowTransparentRead = (1<<0),
         ///< Allow to "compress/decompress" empty data. 
         ///< The output compressed data will have header and footer only.
-        fAllowEmptyData       = (1<<1)
+        fAllowEmptyData       = (1<<1),
+        ///< Allow concatenated bzip2 streams on decompression, like
+        ///< bunzip2 does. The decompressor restarts after the end of
+        ///< each stream instead of reporting the end of data.
+        ///< See CParallelCompressor, it writes such streams.
+        fAllowConcatenatedStreams = (1<<2)
     };
     typedef CBZip2Compression::TFlags TBZip2Flags; ///< Bitwise OR of EFlags
 
@@ -404,6 +409,10 @@ protected:
     virtual EStatus Finish (char*       out_buf, size_t  out_size,
                             /* out */            size_t* out_avail);
     virtual EStatus End    (int abandon = 0);
+
+private:
+    bool m_StreamEnd;  ///< End of a stream reached, no data of the next one
+                       ///< (fAllowConcatenatedStreams).
 };
 
 
@@ -0,0 +1,218 @@
+#ifndef UTIL_COMPRESS__PARALLEL__HPP
+#define UTIL_COMPRESS__PARALLEL__HPP
+
+/*  $Id$
+ * ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ *
+ */
+
+/// @file parallel.hpp
+/// Multi-threaded block compression.
+///
+/// The input data is split into blocks of fixed size, each block is
+/// compressed independently on a pool of threads, and the compressed
+/// blocks are written out in the original order. Every block is a complete
+/// gzip member or bzip2 stream, so the result is a standard concatenated
+/// .gz/.bz2 file that can be read by gunzip/bunzip2 and by the toolkit
+/// decompressors (see CZipCompression::fAllowConcatenatedGZip and
+/// CBZip2Compression::fAllowConcatenatedStreams).
+///
+/// CParallelCompressor        - compression processor.
+/// CParallelStreamCompressor  - stream processor, can be used with
+///                              CCompressionOStream or CCompressionIStream.
+///
+/// @note
+///   Each block is compressed without any knowledge of the previous one,
+///   so the compression ratio is a bit worse than for a single-threaded
+///   compressor. Bigger blocks reduce this difference.
+/// @note
+///   Flushing a stream forces compression of an incomplete block and waits
+///   for all pending blocks. Avoid frequent flushes (like std::endl),
+///   they serialize the compression.
+
+#include <util/compress/stream.hpp>
+#include <deque>
+
+
+/** @addtogroup CompressionStreams
+ *
+ * @{
+ */
+
+BEGIN_NCBI_SCOPE
+
+
+// Forward declaration
+class CThreadPool;
+class CParallelCompressionTask;
+
+
+/// Default size of a block of uncompressed data compressed by one thread.
+const size_t kParallelCompressionDefaultBlockSize = 1024*1024;
+
+
+/////////////////////////////////////////////////////////////////////////////
+///
+/// CParallelCompressor -- multi-threaded block compressor
+///
+/// Used in CParallelStreamCompressor.
+/// @sa CParallelStreamCompressor, CCompressionProcessor
+
+class NCBI_XUTIL_EXPORT CParallelCompressor : public CCompressionProcessor
+{
+public:
+    /// Output format.
+    enum EMethod {
+        eGZipFile,       ///< concatenated .gz members
+        eBZip2           ///< concatenated bzip2 streams
+    };
+
+    /// Constructor.
+    ///
+    /// @param method
+    ///   Output format.
+    /// @param level
+    ///   Compression level.
+    /// @param flags
+    ///   Algorithm-specific flags (CZipCompression::EFlags or
+    ///   CBZip2Compression::EFlags). For eGZipFile the gzip format
+    ///   is always written.
+    /// @param threads
+    ///   Number of compression threads, 0 means the number of CPUs.
+    /// @param block_size
+    ///   Size of uncompressed data in each block.
+    CParallelCompressor(
+        EMethod              method,
+        ICompression::ELevel level      = ICompression::eLevel_Default,
+        ICompression::TFlags flags      = 0,
+        unsigned int         threads    = 0,
+        size_t               block_size = kParallelCompressionDefaultBlockSize
+    );
+
+    /// Destructor.
+    virtual ~CParallelCompressor(void);
+
+    /// Return number of compression threads.
+    unsigned int GetThreads(void) const
+        { return m_Threads; }
+
+protected:
+    virtual EStatus Init   (void);
+    virtual EStatus Process(const char* in_buf,  size_t  in_len,
+                            char*       out_buf, size_t  out_size,
+                            /* out */            size_t* in_avail,
+                            /* out */            size_t* out_avail);
+    virtual EStatus Flush  (char*       out_buf, size_t  out_size,
+                            /* out */            size_t* out_avail);
+    virtual EStatus Finish (char*       out_buf, size_t  out_size,
+                            /* out */            size_t* out_avail);
+    virtual EStatus End    (int abandon = 0);
+
+private:
+    typedef CRef<CParallelCompressionTask> TTask;
+
+    /// Pass the current block to the thread pool.
+    void   x_SubmitBlock(void);
+    /// Move compressed blocks, in order, into the output cache.
+    /// Wait until no more than 'max_pending' blocks remain in progress.
+    /// Return FALSE if some block failed to compress.
+    bool   x_CollectBlocks(size_t max_pending);
+    /// Copy cached output into the output buffer.
+    size_t x_CopyOutput(char* out_buf, size_t out_size);
+    /// Complete the current block and all submitted ones, and write
+    /// them out. Helper method for Flush/Finish.
+    EStatus x_Drain(char* out_buf, size_t out_size, size_t* out_avail);
+
+private:
+    EMethod              m_Method;      ///< Output format.
+    ICompression::ELevel m_Level;       ///< Compression level.
+    ICompression::TFlags m_Flags;       ///< Compressor flags.
+    unsigned int         m_Threads;     ///< Number of threads.
+    size_t               m_BlockSize;   ///< Size of uncompressed block.
+    size_t               m_MaxPending;  ///< Max number of submitted blocks.
+
+    CThreadPool*         m_Pool;        ///< Compression threads.
+    string               m_Block;       ///< Block being filled.
+    deque<TTask>         m_Pending;     ///< Submitted blocks, in order.
+    string               m_Output;      ///< Compressed data to write out.
+    size_t               m_OutputPos;   ///< Written part of m_Output.
+    bool                 m_HaveData;    ///< Any data passed to Process().
+
+private:
+    /// Private copy constructor to prohibit copy.
+    CParallelCompressor(const CParallelCompressor&);
+    /// Private assignment operator to prohibit assignment.
+    CParallelCompressor& operator= (const CParallelCompressor&);
+};
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+///
+/// CParallelStreamCompressor -- multi-threaded compression stream processor
+///
+/// See util/compress/stream.hpp for details of stream processing.
+/// @sa CCompressionStreamProcessor, CParallelCompressor
+
+class NCBI_XUTIL_EXPORT CParallelStreamCompressor
+    : public CCompressionStreamProcessor
+{
+public:
+    /// Full constructor
+    CParallelStreamCompressor(
+        CParallelCompressor::EMethod method,
+        ICompression::ELevel         level,
+        ICompression::TFlags         flags,
+        unsigned int                 threads,
+        size_t                       block_size,
+        streamsize                   in_bufsize,
+        streamsize                   out_bufsize
+        )
+        : CCompressionStreamProcessor(
+              new CParallelCompressor(method, level, flags, threads,
+                                      block_size),
+              eDelete, in_bufsize, out_bufsize)
+    {}
+
+    /// Conventional constructor
+    CParallelStreamCompressor(
+        CParallelCompressor::EMethod method,
+        ICompression::ELevel         level   = ICompression::eLevel_Default,
+        ICompression::TFlags         flags   = 0,
+        unsigned int                 threads = 0
+        )
+        : CCompressionStreamProcessor(
+              new CParallelCompressor(method, level, flags, threads),
+              eDelete, kCompressionDefaultBufSize, kCompressionDefaultBufSize)
+    {}
+};
+
+
+END_NCBI_SCOPE
+
+
+/* @} */
+
+#endif  /* UTIL_COMPRESS__PARALLEL__HPP */
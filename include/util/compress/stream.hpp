@@ -236,6 +236,12 @@ public:
         return m_Processor  &&  m_Processor->IsBusy()  &&  m_State != eDone;
     }
 
+protected:
+    /// Get (de)compression processor.
+    CCompressionProcessor* GetProcessor(void) const {
+        return m_Processor;
+    }
+
 private:
     CCompressionProcessor* m_Processor;   ///< (De)compression processor.
     CT_CHAR_TYPE*          m_InBuf;       ///< Buffer of unprocessed data.
@@ -46,6 +46,7 @@
 ///                         MDecompress_ConcatenatedGZipFile
 
 
+#include <corelib/ncbi_param.hpp>
 #include <util/compress/stream.hpp>
 #include <util/compress/bzip2.hpp>
 #include <util/compress/zlib.hpp>
@@ -60,6 +61,12 @@
 BEGIN_NCBI_SCOPE
 
 
+/// Number of threads used by CCompressOStream for eGZipFile method,
+/// see CCompressOStream. Default value is 1 (no threads).
+NCBI_PARAM_DECL_EXPORT(NCBI_XUTIL_EXPORT, unsigned int, Compress, Threads);
+typedef NCBI_PARAM_TYPE(Compress, Threads) TParamCompressThreads;
+
+
 /////////////////////////////////////////////////////////////////////////////
 ///
 /// CCompressStream --
@@ -141,6 +148,15 @@ public:
 /// So, do not forget to call Finalize() after the last data is written to
 /// this stream. Otherwise, finalization will occur only in the stream's
 /// destructor.
+/// @note
+///   For eGZipFile method the compression can be done by several threads,
+///   see [Compress]Threads configuration parameter (environment variable
+///   COMPRESS_THREADS). The output in this case is a sequence of
+///   independently compressed gzip members, which is read back by
+///   CDecompressIStream as usual. bzip2 data is not affected, because
+///   concatenated bzip2 streams are not read by default; use
+///   CParallelStreamCompressor explicitly for it.
+/// @sa CParallelCompressor
 
 class NCBI_XUTIL_EXPORT CCompressOStream : public CCompressStream,
                                            public CCompressionOStream
@@ -69,6 +69,12 @@ public:
     typedef ECodingType  TCodingType;
 
     static ECodingType GetCodingType(TCoding coding);
+
+    // Vectorized (SSSE3 / AVX2) conversion kernels are used when the CPU
+    // supports them.  Disabling them forces the table driven code,
+    // which gives identical results (e.g. for benchmarking).
+    static void SetSimdEnabled(bool enabled);
+    static bool IsSimdEnabled(void);
 };
 
 
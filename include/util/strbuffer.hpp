@@ -123,6 +123,14 @@ public:
         THROWS1((CIOException));
 
     const char* GetCurrentPos(void) const THROWS1_NONE;
+    // action: make sure there is at least one char in buffer
+    // return: number of chars available at GetCurrentPos()
+    //         without filling the buffer again
+    size_t PeekAvailable(void)
+        THROWS1((CIOException, bad_alloc));
+    // true when reading from a caller-supplied memory buffer:
+    // pointers returned by GetCurrentPos() stay valid until Close()
+    bool IsMemoryBuffer(void) const THROWS1_NONE;
     // returns true if succeeded
     bool TrySetCurrentPos(const char* pos);
 
@@ -155,6 +155,22 @@ const char* CIStreamBuffer::GetCurrentPos(void) const
     return m_CurrentPos;
 }
 
+inline
+size_t CIStreamBuffer::PeekAvailable(void)
+    THROWS1((CIOException, bad_alloc))
+{
+    if ( m_CurrentPos >= m_DataEndPos )
+        FillBuffer(m_CurrentPos);
+    return m_DataEndPos - m_CurrentPos;
+}
+
+inline
+bool CIStreamBuffer::IsMemoryBuffer(void) const
+    THROWS1_NONE
+{
+    return m_BufferSize == 0;
+}
+
 inline
 size_t CIStreamBuffer::GetLine(void) const
     THROWS1_NONE
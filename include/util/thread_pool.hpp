@@ -207,6 +207,19 @@ private:
 class NCBI_XUTIL_EXPORT CThreadPool
 {
 public:
+    /// How queued tasks are handed over to the threads
+    enum EScheduling {
+        /// One queue for the whole pool, tasks are executed strictly in
+        /// the order of their priorities
+        ePriorityQueue,
+        /// Each thread has its own queue and takes tasks from the queues of
+        /// other threads when its own one is empty.  Tasks added by a pool
+        /// thread go to the queue of that thread, others are spread over
+        /// all queues.  There is no pool-wide lock on adding and taking
+        /// tasks, but priorities of the tasks are ignored.
+        eWorkStealing
+    };
+
     /// Constructor
     /// @param queue_size
     ///   Maximum number of tasks waiting in the queue. If 0 then tasks
@@ -224,12 +237,15 @@ public:
     /// @param threads_mode
     ///   Running mode of all threads in thread pool. Values fRunDetached and
     ///   fRunAllowST are ignored.
+    /// @param scheduling
+    ///   How queued tasks are distributed among the threads
     ///
-    /// @sa AddTask()
+    /// @sa AddTask(), EScheduling
     CThreadPool(unsigned int      queue_size,
                 unsigned int      max_threads,
                 unsigned int      min_threads = 2,
-                CThread::TRunMode threads_mode = CThread::fRunDefault);
+                CThread::TRunMode threads_mode = CThread::fRunDefault,
+                EScheduling       scheduling = ePriorityQueue);
 
     /// Add task to the pool for execution.
     /// @note
@@ -303,9 +319,12 @@ public:
     /// @param threads_mode
     ///   Running mode of all threads in thread pool. Values fRunDetached and
     ///   fRunAllowST are ignored.
+    /// @param scheduling
+    ///   How queued tasks are distributed among the threads
     CThreadPool(unsigned int            queue_size,
                 CThreadPool_Controller* controller,
-                CThread::TRunMode       threads_mode = CThread::fRunDefault);
+                CThread::TRunMode       threads_mode = CThread::fRunDefault,
+                EScheduling             scheduling = ePriorityQueue);
 
     /// Set timeout to wait for all threads to finish before the pool
     /// should be able to destroy.
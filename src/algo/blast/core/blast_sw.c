@@ -34,6 +34,23 @@
 
 #include <algo/blast/core/blast_sw.h>
 #include <algo/blast/core/blast_util.h> /* for NCBI2NA_UNPACK_BASE */
+#include <algo/blast/core/blast_encoding.h> /* for BLASTAA_SIZE */
+#include "blast_sw_priv.h"
+
+/* The striped score-only kernels need SSE2, which every x86-64 CPU
+   has. The AVX2 kernel is compiled with a function-level target
+   attribute and only selected when the CPU reports AVX2 at runtime */
+#if defined(__GNUC__) && \
+    (defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__)))
+#  define BLAST_SW_SSE2 1
+#  include <emmintrin.h>
+#  if !defined(__clang__) && \
+      (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#    define BLAST_SW_AVX2 1
+#    define BLAST_SW_TARGET_AVX2 __attribute__((target("avx2")))
+#    include <immintrin.h>
+#  endif
+#endif
 
 /** swap (pointers to) a pair of sequences */
 #define SWAP_SEQS(A, B) {const Uint1 *tmp = (A); (A) = (B); (B) = tmp; }
@@ -147,6 +164,372 @@ static Int4 s_SmithWatermanScoreOnly(const Uint1 *A, Int4 a_size,
 }
 
 
+#ifdef BLAST_SW_SSE2
+
+/** Byte alignment of the scratch space used by the striped kernels */
+#define SW_SIMD_ALIGN 32
+
+/** Allocate scratch space for a striped Smith-Waterman kernel, and
+ *  fill in the query profile. The profile contains, for every letter
+ *  of the protein alphabet, the scores of that letter against all of
+ *  sequence A, rearranged so that vector lane k of segment s holds
+ *  the score for offset k * seg_len + s of A. Scratch space for the
+ *  two score columns and the gap-in-B scores follows the profile
+ * @param A The sequence to stripe [in]
+ * @param a_size Length of A [in]
+ * @param matrix Score matrix, or PSSM if is_pssm is TRUE [in]
+ * @param is_pssm TRUE if matrix is position-specific [in]
+ * @param seg_len Number of vectors in one stripe [in]
+ * @param lanes Number of 16-bit lanes in one vector [in]
+ * @param profile The aligned start of the profile [out]
+ * @return The memory to be freed by the caller, or NULL if
+ *         memory ran out or a score does not fit in 16 bits
+ */
+static void * s_SWSimdProfileNew(const Uint1 *A, Int4 a_size,
+                                 Int4 **matrix, Boolean is_pssm,
+                                 Int4 seg_len, Int4 lanes,
+                                 Int2 **profile)
+{
+   Int4 i, j, k;
+   Int4 vec_size = seg_len * lanes;
+   void *mem;
+   Int2 *p;
+
+   mem = malloc((BLASTAA_SIZE + 3) * vec_size * sizeof(Int2) +
+                SW_SIMD_ALIGN);
+   if (mem == NULL)
+      return NULL;
+
+   p = (Int2 *)(((size_t)mem + SW_SIMD_ALIGN - 1) &
+                 ~((size_t)SW_SIMD_ALIGN - 1));
+   *profile = p;
+
+   for (i = 0; i < BLASTAA_SIZE; i++) {
+      for (j = 0; j < seg_len; j++) {
+         for (k = 0; k < lanes; k++, p++) {
+            Int4 offset = k * seg_len + j;
+            Int4 score = 0;
+
+            /* padding at the end of A scores zero; it can only
+               repeat scores found earlier in the same stripe */
+            if (offset < a_size) {
+               if (is_pssm)
+                  score = matrix[offset][i];
+               else
+                  score = matrix[A[offset]][i];
+            }
+
+            if (score > INT2_MAX) {
+               free(mem);
+               return NULL;
+            }
+            *p = (Int2)MAX(score, INT2_MIN);
+         }
+      }
+   }
+
+   /* the score columns and gap scores start out zero */
+   memset(p, 0, 3 * vec_size * sizeof(Int2));
+   return mem;
+}
+
+/** Score-only Smith-Waterman using the striped algorithm of
+ * <PRE>
+ * Michael Farrar, "Striped Smith-Waterman speeds database searches
+ * six times over other SIMD implementations".
+ * Bioinformatics, (2007), 23, pp. 156-161
+ * </PRE>
+ *  with eight 16-bit scores per SSE2 register. Gap scores are clamped
+ *  at zero with unsigned saturation; this cannot change the best score
+ *  because a gap with a negative score never beats starting a new
+ *  alignment. Unlike most published versions, the lazy F loop also
+ *  updates the gap-in-B scores, so that a gap in one sequence may be
+ *  followed directly by a gap in the other exactly as in the scalar code.
+ *  Arguments are as for s_SmithWatermanScoreOnly
+ * @return The best score, or -1 if the vectorized kernel cannot be
+ *         used (the score may not fit in 16 bits, or memory ran out)
+ */
+static Int4 s_SmithWatermanScoreOnlySSE2(const Uint1 *A, Int4 a_size,
+                                         const Uint1 *B, Int4 b_size,
+                                         Int4 gap_open, Int4 gap_extend,
+                                         BlastGapAlignStruct *gap_align)
+{
+   const Int4 kLanes = sizeof(__m128i) / sizeof(Int2);
+   Int4 seg_len = (a_size + kLanes - 1) / kLanes;
+   Int4 i, j;
+   Int4 **matrix;
+   Int2 *profile_mem;
+   Int2 lane_scores[sizeof(__m128i) / sizeof(Int2)];
+   Int2 final_best_score;
+   void *mem;
+   __m128i *profile, *h_store, *h_load, *e_vals, *tmp;
+   __m128i v_gap_open_extend, v_gap_extend, v_zero;
+   __m128i v_best, v_h, v_e, v_f, v_tmp;
+
+   if (gap_align->positionBased)
+      matrix = gap_align->sbp->psi_matrix->pssm->data;
+   else
+      matrix = gap_align->sbp->matrix->data;
+
+   mem = s_SWSimdProfileNew(A, a_size, matrix, gap_align->positionBased,
+                            seg_len, kLanes, &profile_mem);
+   if (mem == NULL)
+      return -1;
+
+   profile = (__m128i *)profile_mem;
+   h_store = profile + BLASTAA_SIZE * seg_len;
+   h_load = h_store + seg_len;
+   e_vals = h_load + seg_len;
+
+   v_gap_open_extend = _mm_set1_epi16((Int2)(gap_open + gap_extend));
+   v_gap_extend = _mm_set1_epi16((Int2)gap_extend);
+   v_zero = _mm_setzero_si128();
+   v_best = v_zero;
+
+   for (j = 0; j < b_size; j++) {
+      const __m128i *v_profile = profile + B[j] * seg_len;
+
+      /* the diagonal score for the first segment comes from
+         the last segment of the previous column, moved up
+         by one lane */
+      v_f = v_zero;
+      v_h = _mm_slli_si128(_mm_load_si128(h_store + seg_len - 1),
+                           sizeof(Int2));
+      tmp = h_load;
+      h_load = h_store;
+      h_store = tmp;
+
+      for (i = 0; i < seg_len; i++) {
+         v_h = _mm_adds_epi16(v_h, _mm_load_si128(v_profile + i));
+         v_e = _mm_load_si128(e_vals + i);
+         v_h = _mm_max_epi16(v_h, v_e);
+         v_h = _mm_max_epi16(v_h, v_f);
+         v_h = _mm_max_epi16(v_h, v_zero);
+         v_best = _mm_max_epi16(v_best, v_h);
+         _mm_store_si128(h_store + i, v_h);
+
+         v_h = _mm_subs_epu16(v_h, v_gap_open_extend);
+         v_e = _mm_subs_epu16(v_e, v_gap_extend);
+         _mm_store_si128(e_vals + i, _mm_max_epi16(v_e, v_h));
+         v_f = _mm_subs_epu16(v_f, v_gap_extend);
+         v_f = _mm_max_epi16(v_f, v_h);
+
+         v_h = _mm_load_si128(h_load + i);
+      }
+
+      /* propagate gaps in A across segment boundaries, until
+         they can no longer improve any score in the column */
+      v_f = _mm_slli_si128(v_f, sizeof(Int2));
+      i = 0;
+      v_tmp = _mm_subs_epu16(_mm_load_si128(h_store), v_gap_open_extend);
+      while (_mm_movemask_epi8(_mm_cmpgt_epi16(v_f, v_tmp))) {
+         v_h = _mm_max_epi16(_mm_load_si128(h_store + i), v_f);
+         _mm_store_si128(h_store + i, v_h);
+         v_best = _mm_max_epi16(v_best, v_h);
+
+         v_h = _mm_subs_epu16(v_h, v_gap_open_extend);
+         _mm_store_si128(e_vals + i,
+                         _mm_max_epi16(_mm_load_si128(e_vals + i), v_h));
+         v_f = _mm_subs_epu16(v_f, v_gap_extend);
+
+         if (++i == seg_len) {
+            v_f = _mm_slli_si128(v_f, sizeof(Int2));
+            i = 0;
+         }
+         v_tmp = _mm_subs_epu16(_mm_load_si128(h_store + i),
+                                v_gap_open_extend);
+      }
+   }
+
+   _mm_storeu_si128((__m128i *)lane_scores, v_best);
+   final_best_score = 0;
+   for (i = 0; i < kLanes; i++)
+      final_best_score = MAX(final_best_score, lane_scores[i]);
+
+   free(mem);
+
+   /* a saturated score may be smaller than the true score */
+   return (final_best_score == INT2_MAX) ? -1 : final_best_score;
+}
+
+#endif /* BLAST_SW_SSE2 */
+
+#ifdef BLAST_SW_AVX2
+
+/** Move every 16-bit lane of an AVX2 register up by one, across
+ *  the 128-bit halves, shifting in zero
+ * @param v The register to shift [in]
+ * @return The shifted register
+ */
+static BLAST_SW_TARGET_AVX2 __m256i s_SWShiftLanesAVX2(__m256i v)
+{
+   /* the second operand holds (zero, low half of v) */
+   return _mm256_alignr_epi8(v, _mm256_permute2x128_si256(v, v, 0x08),
+                             sizeof(__m128i) - sizeof(Int2));
+}
+
+/** The AVX2 version of s_SmithWatermanScoreOnlySSE2, with sixteen
+ *  16-bit scores per register
+ * @return The best score, or -1 if the vectorized kernel cannot be used
+ */
+static BLAST_SW_TARGET_AVX2
+Int4 s_SmithWatermanScoreOnlyAVX2(const Uint1 *A, Int4 a_size,
+                                  const Uint1 *B, Int4 b_size,
+                                  Int4 gap_open, Int4 gap_extend,
+                                  BlastGapAlignStruct *gap_align)
+{
+   const Int4 kLanes = sizeof(__m256i) / sizeof(Int2);
+   Int4 seg_len = (a_size + kLanes - 1) / kLanes;
+   Int4 i, j;
+   Int4 **matrix;
+   Int2 *profile_mem;
+   Int2 lane_scores[sizeof(__m256i) / sizeof(Int2)];
+   Int2 final_best_score;
+   void *mem;
+   __m256i *profile, *h_store, *h_load, *e_vals, *tmp;
+   __m256i v_gap_open_extend, v_gap_extend, v_zero;
+   __m256i v_best, v_h, v_e, v_f, v_tmp;
+
+   if (gap_align->positionBased)
+      matrix = gap_align->sbp->psi_matrix->pssm->data;
+   else
+      matrix = gap_align->sbp->matrix->data;
+
+   mem = s_SWSimdProfileNew(A, a_size, matrix, gap_align->positionBased,
+                            seg_len, kLanes, &profile_mem);
+   if (mem == NULL)
+      return -1;
+
+   profile = (__m256i *)profile_mem;
+   h_store = profile + BLASTAA_SIZE * seg_len;
+   h_load = h_store + seg_len;
+   e_vals = h_load + seg_len;
+
+   v_gap_open_extend = _mm256_set1_epi16((Int2)(gap_open + gap_extend));
+   v_gap_extend = _mm256_set1_epi16((Int2)gap_extend);
+   v_zero = _mm256_setzero_si256();
+   v_best = v_zero;
+
+   for (j = 0; j < b_size; j++) {
+      const __m256i *v_profile = profile + B[j] * seg_len;
+
+      v_f = v_zero;
+      v_h = s_SWShiftLanesAVX2(_mm256_load_si256(h_store + seg_len - 1));
+      tmp = h_load;
+      h_load = h_store;
+      h_store = tmp;
+
+      for (i = 0; i < seg_len; i++) {
+         v_h = _mm256_adds_epi16(v_h, _mm256_load_si256(v_profile + i));
+         v_e = _mm256_load_si256(e_vals + i);
+         v_h = _mm256_max_epi16(v_h, v_e);
+         v_h = _mm256_max_epi16(v_h, v_f);
+         v_h = _mm256_max_epi16(v_h, v_zero);
+         v_best = _mm256_max_epi16(v_best, v_h);
+         _mm256_store_si256(h_store + i, v_h);
+
+         v_h = _mm256_subs_epu16(v_h, v_gap_open_extend);
+         v_e = _mm256_subs_epu16(v_e, v_gap_extend);
+         _mm256_store_si256(e_vals + i, _mm256_max_epi16(v_e, v_h));
+         v_f = _mm256_subs_epu16(v_f, v_gap_extend);
+         v_f = _mm256_max_epi16(v_f, v_h);
+
+         v_h = _mm256_load_si256(h_load + i);
+      }
+
+      v_f = s_SWShiftLanesAVX2(v_f);
+      i = 0;
+      v_tmp = _mm256_subs_epu16(_mm256_load_si256(h_store),
+                                v_gap_open_extend);
+      while (_mm256_movemask_epi8(_mm256_cmpgt_epi16(v_f, v_tmp))) {
+         v_h = _mm256_max_epi16(_mm256_load_si256(h_store + i), v_f);
+         _mm256_store_si256(h_store + i, v_h);
+         v_best = _mm256_max_epi16(v_best, v_h);
+
+         v_h = _mm256_subs_epu16(v_h, v_gap_open_extend);
+         _mm256_store_si256(e_vals + i,
+                      _mm256_max_epi16(_mm256_load_si256(e_vals + i), v_h));
+         v_f = _mm256_subs_epu16(v_f, v_gap_extend);
+
+         if (++i == seg_len) {
+            v_f = s_SWShiftLanesAVX2(v_f);
+            i = 0;
+         }
+         v_tmp = _mm256_subs_epu16(_mm256_load_si256(h_store + i),
+                                   v_gap_open_extend);
+      }
+   }
+
+   _mm256_storeu_si256((__m256i *)lane_scores, v_best);
+   final_best_score = 0;
+   for (i = 0; i < kLanes; i++)
+      final_best_score = MAX(final_best_score, lane_scores[i]);
+
+   free(mem);
+   return (final_best_score == INT2_MAX) ? -1 : final_best_score;
+}
+
+#endif /* BLAST_SW_AVX2 */
+
+/* See blast_sw_priv.h for details */
+EBlastSWKernel BlastSWGetBestKernel(void)
+{
+#ifdef BLAST_SW_AVX2
+   if (__builtin_cpu_supports("avx2"))
+      return eBlastSWKernelAVX2;
+#endif
+#ifdef BLAST_SW_SSE2
+   return eBlastSWKernelSSE2;
+#else
+   return eBlastSWKernelScalar;
+#endif
+}
+
+/* See blast_sw_priv.h for details */
+Int4 BlastSWScoreOnly(EBlastSWKernel kernel,
+                      const Uint1 *A, Int4 a_size,
+                      const Uint1 *B, Int4 b_size,
+                      Int4 gap_open, Int4 gap_extend,
+                      BlastGapAlignStruct *gap_align)
+{
+   Int4 score = -1;
+   EBlastSWKernel best_kernel = BlastSWGetBestKernel();
+
+   if (kernel > best_kernel)
+      kernel = best_kernel;
+
+   /* the striped kernels need a nonempty stripe, gap
+      penalties that fit in 16 bits, and a strictly positive
+      extension penalty so that the lazy F loop terminates */
+   if (a_size <= 0 || b_size <= 0 || gap_extend <= 0 ||
+       gap_open < 0 || gap_open + gap_extend > INT2_MAX)
+      kernel = eBlastSWKernelScalar;
+
+   switch (kernel) {
+#ifdef BLAST_SW_AVX2
+   case eBlastSWKernelAVX2:
+      score = s_SmithWatermanScoreOnlyAVX2(A, a_size, B, b_size,
+                                           gap_open, gap_extend, gap_align);
+      break;
+#endif
+#ifdef BLAST_SW_SSE2
+   case eBlastSWKernelSSE2:
+      score = s_SmithWatermanScoreOnlySSE2(A, a_size, B, b_size,
+                                           gap_open, gap_extend, gap_align);
+      break;
+#endif
+   default:
+      break;
+   }
+
+   if (score < 0) {
+      score = s_SmithWatermanScoreOnly(A, a_size, B, b_size,
+                                       gap_open, gap_extend, gap_align);
+   }
+   return score;
+}
+
+
 /** Compute the score of the best local alignment between
  *  two nucleotide sequences. One of the sequences must be in
  *  packed format. For nucleotide Smith-Waterman, the vast
@@ -692,7 +1075,7 @@ Int2 BLAST_SmithWatermanGetGappedScore (EBlastProgramType program_number,
       }
 
       if (is_prot) {
-         score = s_SmithWatermanScoreOnly(
+         score = BlastSWScoreOnly(BlastSWGetBestKernel(),
                               query->sequence + curr_ctx->query_offset,
                               curr_ctx->query_length,
                               subject->sequence,
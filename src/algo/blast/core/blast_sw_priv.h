@@ -0,0 +1,83 @@
+/*  $Id$
+ * ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ *
+ */
+
+/** @file blast_sw_priv.h
+ *  Private interface for blast_sw.c, used to select and benchmark the
+ *  score-only Smith-Waterman kernels
+ */
+
+#ifndef ALGO_BLAST_CORE___BLAST_SW_PRIV__H
+#define ALGO_BLAST_CORE___BLAST_SW_PRIV__H
+
+#include <algo/blast/core/ncbi_std.h>
+#include <algo/blast/core/blast_gapalign.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Implementations of the protein score-only Smith-Waterman recurrence.
+ *  All kernels return bit-identical scores; the vectorized kernels fall
+ *  back to the scalar one when a score would not fit in 16 bits.
+ */
+typedef enum EBlastSWKernel {
+   eBlastSWKernelScalar = 0,  /**< Plain row-by-row dynamic programming */
+   eBlastSWKernelSSE2,        /**< Striped (Farrar) kernel, 8 x 16 bits */
+   eBlastSWKernelAVX2         /**< Striped (Farrar) kernel, 16 x 16 bits */
+} EBlastSWKernel;
+
+/** Return the fastest Smith-Waterman kernel supported by the CPU
+ *  and compiler in use
+ */
+EBlastSWKernel BlastSWGetBestKernel(void);
+
+/** Compute the score of the best local alignment between two protein
+ *  sequences using a specific kernel. If the kernel is not supported
+ *  on this CPU, the best supported kernel that is not faster than the
+ *  requested one is used instead.
+ * @param kernel The kernel to use [in]
+ * @param A The first sequence [in]
+ * @param a_size Length of the first sequence [in]
+ * @param B The second sequence [in]
+ * @param b_size Length of the second sequence [in]
+ * @param gap_open Gap open penalty [in]
+ * @param gap_extend Gap extension penalty [in]
+ * @param gap_align Auxiliary data for gapped alignment
+ *             (used for score matrix info) [in]
+ * @return The score of the best local alignment between A and B
+ */
+Int4 BlastSWScoreOnly(EBlastSWKernel kernel,
+                      const Uint1 *A, Int4 a_size,
+                      const Uint1 *B, Int4 b_size,
+                      Int4 gap_open, Int4 gap_extend,
+                      BlastGapAlignStruct *gap_align);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* !ALGO_BLAST_CORE___BLAST_SW_PRIV__H */
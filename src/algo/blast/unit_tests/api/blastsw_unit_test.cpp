@@ -0,0 +1,198 @@
+/*  $Id$
+* ===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+* File Description:
+*   Unit tests and throughput benchmark for the score-only
+*   Smith-Waterman kernels in blast_sw.c
+*
+* ===========================================================================
+*/
+#include <ncbi_pch.hpp>
+#include <corelib/test_boost.hpp>
+#include <corelib/ncbitime.hpp>
+
+#include <algo/blast/core/blast_options.h>
+#include <algo/blast/core/blast_setup.h>
+#include <algo/blast/core/blast_stat.h>
+#include <algo/blast/core/blast_encoding.h>
+#include "blast_sw_priv.h"
+
+#include <vector>
+
+using namespace std;
+using namespace ncbi;
+
+/// Scoring setup shared by all the test cases
+struct SSmithWatermanFixture
+{
+    BlastScoreBlk* m_Sbp;
+    BlastGapAlignStruct m_GapAlign;
+    Uint4 m_Seed;
+
+    SSmithWatermanFixture() : m_Seed(12345)
+    {
+        BlastScoringOptions* score_options = NULL;
+        BlastScoringOptionsNew(eBlastTypeBlastp, &score_options);
+        BLAST_FillScoringOptions(score_options, eBlastTypeBlastp, FALSE,
+                                 0, 0, NULL, BLAST_GAP_OPEN_PROT,
+                                 BLAST_GAP_EXTN_PROT);
+        m_Sbp = BlastScoreBlkNew(BLASTAA_SEQ_CODE, 1);
+        Blast_ScoreBlkMatrixInit(eBlastTypeBlastp, score_options, m_Sbp,
+                                 NULL);
+        BlastScoringOptionsFree(score_options);
+
+        memset(&m_GapAlign, 0, sizeof(m_GapAlign));
+        m_GapAlign.sbp = m_Sbp;
+    }
+
+    ~SSmithWatermanFixture()
+    {
+        sfree(m_GapAlign.dp_mem);
+        BlastScoreBlkFree(m_Sbp);
+    }
+
+    /// Deterministic pseudo-random numbers, independent of the platform
+    Uint4 x_Rand(Uint4 range)
+    {
+        m_Seed = m_Seed * 1103515245 + 12345;
+        return (m_Seed >> 16) % range;
+    }
+
+    /// Random protein sequence in ncbistdaa; if template_seq is given,
+    /// about two thirds of the letters are copied from it
+    vector<Uint1> x_RandomSequence(size_t length,
+                                   const vector<Uint1>* template_seq = NULL)
+    {
+        vector<Uint1> seq(length);
+        for (size_t i = 0;  i < length;  i++) {
+            if (template_seq  &&  i < template_seq->size()
+                &&  x_Rand(3) != 0) {
+                seq[i] = (*template_seq)[i];
+            } else {
+                // skip the gap letter
+                seq[i] = (Uint1)(1 + x_Rand(BLASTAA_SIZE - 4));
+            }
+        }
+        return seq;
+    }
+
+    Int4 x_Score(EBlastSWKernel kernel,
+                 const vector<Uint1>& a, const vector<Uint1>& b,
+                 Int4 gap_open = BLAST_GAP_OPEN_PROT,
+                 Int4 gap_extend = BLAST_GAP_EXTN_PROT)
+    {
+        return BlastSWScoreOnly(kernel, &a[0], (Int4)a.size(),
+                                &b[0], (Int4)b.size(),
+                                gap_open, gap_extend, &m_GapAlign);
+    }
+};
+
+BOOST_FIXTURE_TEST_SUITE(blastsw, SSmithWatermanFixture)
+
+BOOST_AUTO_TEST_CASE(testKernelsMatchScalarScores)
+{
+    for (int i = 0;  i < 500;  i++) {
+        vector<Uint1> a = x_RandomSequence(1 + x_Rand(400));
+        vector<Uint1> b = x_RandomSequence(1 + x_Rand(400), &a);
+        Int4 gap_open = x_Rand(15);
+        Int4 gap_extend = 1 + x_Rand(3);
+
+        Int4 expected = x_Score(eBlastSWKernelScalar, a, b,
+                                gap_open, gap_extend);
+        BOOST_REQUIRE_EQUAL(expected, x_Score(eBlastSWKernelSSE2, a, b,
+                                              gap_open, gap_extend));
+        BOOST_REQUIRE_EQUAL(expected, x_Score(eBlastSWKernelAVX2, a, b,
+                                              gap_open, gap_extend));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testKernelsMatchScalarScoresWithPssm)
+{
+    const size_t kQueryLength = 333;
+    vector<Uint1> a = x_RandomSequence(kQueryLength);
+
+    m_Sbp->psi_matrix = SPsiBlastScoreMatrixNew(kQueryLength);
+    for (size_t i = 0;  i < kQueryLength;  i++) {
+        for (int j = 0;  j < BLASTAA_SIZE;  j++) {
+            // include the minimum score, which must not wrap around
+            // in 16-bit arithmetic
+            m_Sbp->psi_matrix->pssm->data[i][j] = (x_Rand(40) == 0)
+                ? BLAST_SCORE_MIN
+                : m_Sbp->matrix->data[a[i]][j] + (Int4)x_Rand(3) - 1;
+        }
+    }
+    m_GapAlign.positionBased = TRUE;
+
+    for (int i = 0;  i < 100;  i++) {
+        vector<Uint1> b = x_RandomSequence(1 + x_Rand(600), &a);
+        Int4 expected = x_Score(eBlastSWKernelScalar, a, b);
+        BOOST_REQUIRE_EQUAL(expected, x_Score(eBlastSWKernelSSE2, a, b));
+        BOOST_REQUIRE_EQUAL(expected, x_Score(eBlastSWKernelAVX2, a, b));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testScoreOverflowFallsBackToScalar)
+{
+    // the self-score of this sequence does not fit in 16 bits
+    const Uint1 kTrp = 22;
+    vector<Uint1> a(4000, kTrp);
+    BOOST_REQUIRE(m_Sbp->matrix->data[kTrp][kTrp] * 4000 > kMax_I2);
+
+    Int4 expected = x_Score(eBlastSWKernelScalar, a, a);
+    BOOST_REQUIRE_EQUAL(expected, m_Sbp->matrix->data[kTrp][kTrp] * 4000);
+    BOOST_REQUIRE_EQUAL(expected, x_Score(eBlastSWKernelSSE2, a, a));
+    BOOST_REQUIRE_EQUAL(expected, x_Score(eBlastSWKernelAVX2, a, a));
+}
+
+BOOST_AUTO_TEST_CASE(testKernelThroughput)
+{
+    const size_t kLength = 3000;
+    const int kIterations = 3;
+    vector<Uint1> a = x_RandomSequence(kLength);
+    vector<Uint1> b = x_RandomSequence(kLength, &a);
+    const EBlastSWKernel kKernels[] = {
+        eBlastSWKernelScalar, eBlastSWKernelSSE2, eBlastSWKernelAVX2
+    };
+    const char* kNames[] = { "scalar", "SSE2", "AVX2" };
+    Int4 expected = x_Score(eBlastSWKernelScalar, a, b);
+
+    for (size_t k = 0;  k < sizeof(kKernels) / sizeof(*kKernels);  k++) {
+        if (kKernels[k] > BlastSWGetBestKernel()) {
+            LOG_POST(Info << kNames[k] << " kernel not supported");
+            continue;
+        }
+        CStopWatch sw(CStopWatch::eStart);
+        for (int i = 0;  i < kIterations;  i++) {
+            BOOST_REQUIRE_EQUAL(expected, x_Score(kKernels[k], a, b));
+        }
+        double elapsed = sw.Elapsed();
+        double cells = (double)kLength * kLength * kIterations;
+        LOG_POST(Info << kNames[k] << " kernel: "
+                 << (elapsed > 0 ? cells / elapsed / 1e6 : 0.0)
+                 << " million cells/second");
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
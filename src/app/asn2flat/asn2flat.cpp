@@ -58,6 +58,7 @@
 
 #include <util/compress/zlib.hpp>
 #include <util/compress/stream.hpp>
+#include <util/sync_queue.hpp>
 
 #include <objmgr/util/objutil.hpp>
 
@@ -244,6 +245,28 @@ void CHTMLFormatterEx::FormatGeneralId(CNcbiOstream& os, const string& id) const
 
 #endif
 
+
+// Top-level entry formatted by a worker thread in the threaded mode.
+// The text is kept per output stream and written out by the writer thread
+// in the input order.
+class CFlatfileJob : public CObject
+{
+public:
+    typedef map<CNcbiOstream*, string> TOutput;
+
+    CFlatfileJob(CSeq_entry& entry)
+        : m_Entry(&entry), m_Done(0, 1)
+        {
+        }
+
+    CRef<CSeq_entry> m_Entry;
+    TOutput          m_Output;
+    // error message if the entry could not be formatted
+    string           m_Error;
+    CSemaphore       m_Done;
+};
+
+
 class CAsn2FlatApp : public CNcbiApplication, public CGBReleaseFile::ISeqEntryHandler
 {
 public:
@@ -274,6 +297,11 @@ private:
     CObjectIStream* x_OpenIStream(const CArgs& args);
 
     CFlatFileGenerator* x_CreateFlatFileGenerator(const CArgs& args);
+    CFlatFileGenerator* x_NewFlatFileGenerator(const CArgs& args,
+                                               CRef<CScope> scope);
+    bool x_HandleSeqEntry(const CSeq_entry_Handle& seh,
+                          CFlatFileGenerator& generator,
+                          CFlatfileJob::TOutput* output);
     TGenbankBlockCallback* x_GetGenbankCallback(const CArgs& args);
     TSeqPos x_GetFrom(const CArgs& args);
     TSeqPos x_GetTo  (const CArgs& args);
@@ -283,6 +311,18 @@ private:
     CBioseq_Handle x_DeduceTarget(const CSeq_entry_Handle& entry);
     void x_CreateCancelBenchmarkCallback(void);
 
+    // threaded mode
+    friend class CFlatfileWorker;
+    friend class CFlatfileWriter;
+    typedef CSyncQueue< CRef<CFlatfileJob> > TJobQueue;
+
+    bool x_IsThreadedInput(CObjectIStream& is, const string& asn_type);
+    CRef<CSeq_entry> x_ReadSeqEntry(CObjectIStream& is,
+                                    const string& asn_type);
+    void x_StartThreads(void);
+    void x_QueueSeqEntry(CSeq_entry& entry);
+    void x_StopThreads(void);
+
     // data
     CRef<CObjectManager>        m_Objmgr;       // Object Manager
     CRef<CScope>                m_Scope;
@@ -300,13 +340,120 @@ private:
     CRef<CFlatFileGenerator>    m_FFGenerator;  // Flat-file generator
     auto_ptr<ICanceled>         m_pCanceledCallback;
     bool                        m_do_cleanup;
+
+    int                         m_Threads;      // formatting threads
+    auto_ptr<TJobQueue>         m_WorkQueue;    // entries to format
+    auto_ptr<TJobQueue>         m_OutputQueue;  // entries in input order
+    vector< CRef<CThread> >     m_Workers;
+    CRef<CThread>               m_Writer;
+    CAtomicCounter              m_Errors;
+};
+
+
+// Worker thread of the threaded mode: formats entries from the work queue
+// with its own scope and flat-file generator.
+class CFlatfileWorker : public CThread
+{
+public:
+    CFlatfileWorker(CAsn2FlatApp& app)
+        : m_App(app)
+        {
+        }
+
+protected:
+    virtual void* Main(void);
+
+private:
+    CAsn2FlatApp& m_App;
+};
+
+
+void* CFlatfileWorker::Main(void)
+{
+    CRef<CScope> scope(new CScope(*m_App.m_Objmgr));
+    scope->AddDefaults();
+    CRef<CFlatFileGenerator> generator
+        (m_App.x_NewFlatFileGenerator(m_App.GetArgs(), scope));
+
+    for ( ;; ) {
+        CRef<CFlatfileJob> job = m_App.m_WorkQueue->Pop();
+        if ( !job ) {
+            break;
+        }
+        try {
+            CSeq_entry_Handle seh = scope->AddTopLevelSeqEntry(*job->m_Entry);
+            m_App.x_HandleSeqEntry(seh, *generator, &job->m_Output);
+        }
+        catch (CException& e) {
+            job->m_Error = e.ReportAll();
+        }
+        catch (exception& e) {
+            job->m_Error = e.what();
+        }
+        // same as in the batch mode - do not let the scope grow
+        scope->ResetDataAndHistory();
+        job->m_Entry.Reset();
+        job->m_Done.Post();
+    }
+    return 0;
+}
+
+
+// Writer thread of the threaded mode: emits the formatted entries in the
+// input order, so the output is identical to the one of a serial run.
+class CFlatfileWriter : public CThread
+{
+public:
+    CFlatfileWriter(CAsn2FlatApp& app)
+        : m_App(app)
+        {
+        }
+
+protected:
+    virtual void* Main(void);
+
+private:
+    CAsn2FlatApp& m_App;
 };
 
 
+void* CFlatfileWriter::Main(void)
+{
+    for ( ;; ) {
+        CRef<CFlatfileJob> job = m_App.m_OutputQueue->Pop();
+        if ( !job ) {
+            break;
+        }
+        job->m_Done.Wait();
+        if ( m_App.m_Errors.Get() ) {
+            // stop writing after the first failure, like a serial run
+            continue;
+        }
+        if ( !job->m_Error.empty() ) {
+            ERR_POST(Error << job->m_Error);
+            m_App.m_Errors.Add(1);
+            continue;
+        }
+        try {
+            ITERATE ( CFlatfileJob::TOutput, it, job->m_Output ) {
+                it->first->write(it->second.data(), it->second.size());
+            }
+        }
+        catch (exception& e) {
+            ERR_POST(Error << "Cannot write flat file: " << e.what());
+            m_App.m_Errors.Add(1);
+        }
+    }
+    return 0;
+}
+
+
 // constructor
 CAsn2FlatApp::CAsn2FlatApp (void)
+    : m_Threads(1)
 {
     SetVersionByBuild(1);
+    m_Errors.Set(0);
 }
 
 // destructor
@@ -387,6 +534,12 @@ void CAsn2FlatApp::Init(void)
          arg_desc->AddFlag("c", "Compressed file");
          // propogate top descriptors
          arg_desc->AddFlag("p", "Propagate top descriptors");
+         // threads
+         arg_desc->AddDefaultKey("threads", "Threads",
+             "Number of threads formatting top-level entries in parallel "
+             "(batch mode and Seq-entry, Bioseq or Bioseq-set input)",
+             CArgDescriptions::eInteger, "1");
+         arg_desc->SetConstraint("threads", new CArgAllow_Integers(1, 128));
      }}
 
     // in flat_file_config.cpp
@@ -473,21 +626,7 @@ int CAsn2FlatApp::Run(void)
 
     // create the flat-file generator
     m_FFGenerator.Reset(x_CreateFlatFileGenerator(args));
-    if (args["no-external"]) {
-        m_FFGenerator->SetAnnotSelector().SetExcludeExternal(true);
-    }
-    if( args["resolve-all"]) {
-        m_FFGenerator->SetAnnotSelector().SetResolveAll();
-    }
-    if( args["depth"] ) {
-        m_FFGenerator->SetAnnotSelector().SetResolveDepth(args["depth"].AsInteger());
-    }
-    if( args["max_search_segments"] ) {
-        m_FFGenerator->SetAnnotSelector().SetMaxSearchSegments(args["max_search_segments"].AsInteger());
-    }
-    if( args["max_search_time"] ) {
-        m_FFGenerator->SetAnnotSelector().SetMaxSearchTime(float(args["max_search_time"].AsDouble()));
-    }
+    m_Threads = args["threads"].AsInteger();
 
     auto_ptr<CObjectIStream> is;
     is.reset( x_OpenIStream( args ) );
@@ -506,6 +645,18 @@ int CAsn2FlatApp::Run(void)
         bool propagate = args[ "p" ];
         CGBReleaseFile in( *is.release(), propagate );
         in.RegisterHandler( this );
+        if ( m_Threads > 1 ) {
+            x_StartThreads();
+            try {
+                in.Read();  // HandleSeqEntry will queue the entries
+            }
+            catch (...) {
+                x_StopThreads();
+                throw;
+            }
+            x_StopThreads();
+            return m_Errors.Get() ? 1 : 0;
+        }
         in.Read();  // HandleSeqEntry will be called from this function
         return 0;
     }
@@ -537,6 +688,25 @@ int CAsn2FlatApp::Run(void)
 
     string asn_type = args["type"].AsString();
 
+    if ( m_Threads > 1  &&  x_IsThreadedInput(*is, asn_type) ) {
+        //
+        //  Read top-level entries and format them in the worker threads:
+        //
+        x_StartThreads();
+        try {
+            while ( !is->EndOfData()  &&  !m_Errors.Get() ) {
+                CRef<CSeq_entry> se = x_ReadSeqEntry(*is, asn_type);
+                x_QueueSeqEntry(*se);
+            }
+        }
+        catch (...) {
+            x_StopThreads();
+            throw;
+        }
+        x_StopThreads();
+        return m_Errors.Get() ? 1 : 0;
+    }
+
     if ( asn_type == "seq-entry" ) {
         //
         //  Straight through processing: Read a seq_entry, then process
@@ -701,6 +871,16 @@ void CAsn2FlatApp::HandleSeqId(
 //  ============================================================================
 bool CAsn2FlatApp::HandleSeqEntry(const CSeq_entry_Handle& seh )
 //  ============================================================================
+{
+    return x_HandleSeqEntry(seh, *m_FFGenerator, NULL);
+}
+
+//  ============================================================================
+bool CAsn2FlatApp::x_HandleSeqEntry(
+    const CSeq_entry_Handle& seh,
+    CFlatFileGenerator& generator,
+    CFlatfileJob::TOutput* output )
+//  ============================================================================
 {
     const CArgs& args = GetArgs();
 
@@ -733,7 +913,7 @@ bool CAsn2FlatApp::HandleSeqEntry(const CSeq_entry_Handle& seh )
         }
     }
 
-    m_FFGenerator->SetFeatTree(new feature::CFeatTree(seh));
+    generator.SetFeatTree(new feature::CFeatTree(seh));
     
     for (CBioseq_CI bioseq_it(seh);  bioseq_it;  ++bioseq_it) {
         CBioseq_Handle bsh = *bioseq_it;
@@ -821,11 +1001,19 @@ bool CAsn2FlatApp::HandleSeqEntry(const CSeq_entry_Handle& seh )
 
         if ( flatfile_os == NULL ) continue;
 
+        // in the threaded mode format into memory, the writer thread
+        // sends the text to flatfile_os
+        CNcbiOstrstream buffer;
+        CNcbiOstream& os = output ? buffer : *flatfile_os;
+
         // generate flat file
         if ( args["from"]  ||  args["to"]  ||  args["strand"] ) {
             CSeq_loc loc;
             x_GetLocation( seh, args, loc );
-            m_FFGenerator->Generate(loc, seh.GetScope(), *flatfile_os);
+            generator.Generate(loc, seh.GetScope(), os);
+            if ( output ) {
+                (*output)[flatfile_os] += CNcbiOstrstreamToString(buffer);
+            }
             // emulate the C Toolkit: only produce flatfile for first sequence
             // when range is specified
             return true;
@@ -833,9 +1021,11 @@ bool CAsn2FlatApp::HandleSeqEntry(const CSeq_entry_Handle& seh )
         else {
             int count = args["count"].AsInteger();
             for ( int i = 0; i < count; ++i ) {
-                m_FFGenerator->Generate( bsh, *flatfile_os);
+                generator.Generate( bsh, os);
+            }
+            if ( output ) {
+                (*output)[flatfile_os] += CNcbiOstrstreamToString(buffer);
             }
-
         }
     }
     return true;
@@ -892,6 +1082,11 @@ bool CAsn2FlatApp::HandleSeqEntry(CRef<CSeq_entry>& se)
         return false;
     }
 
+    if ( m_Threads > 1 ) {
+        x_QueueSeqEntry(*se);
+        return m_Errors.Get() == 0;
+    }
+
     // add entry to scope
     CSeq_entry_Handle entry = m_Scope->AddTopLevelSeqEntry(*se);
     if ( !entry ) {
@@ -955,16 +1150,35 @@ CObjectIStream* CAsn2FlatApp::x_OpenIStream(const CArgs& args)
 
 
 CFlatFileGenerator* CAsn2FlatApp::x_CreateFlatFileGenerator(const CArgs& args)
+{
+    m_do_cleanup = ( ! args["nocleanup"]);
+
+    CRef<TGenbankBlockCallback> genbank_callback( x_GetGenbankCallback(args) );
+
+    if( args["benchmark-cancel-checking"] ) {
+        x_CreateCancelBenchmarkCallback();
+    }
+
+    //CFlatFileConfig cfg(
+    //    format, mode, style, flags, view, gff_options, genbank_blocks,
+    //    genbank_callback.GetPointerOrNull(), m_pCanceledCallback.get(),
+    //    args["cleanup"] );
+    return x_NewFlatFileGenerator(args, m_Scope);
+}
+
+
+// generator configured from the arguments, also used by the worker threads
+CFlatFileGenerator* CAsn2FlatApp::x_NewFlatFileGenerator(const CArgs& args,
+                                                         CRef<CScope> scope)
 {
     CFlatFileConfig cfg;
     cfg.FromArguments(args);
-    m_do_cleanup = ( ! args["nocleanup"]);
     cfg.BasicCleanup(false);
 
 #ifdef NEW_HTML_FMT
     if (args["html"])
     {
-        CRef<IHTMLFormatter> html_fmt(new CHTMLFormatterEx(m_Scope));
+        CRef<IHTMLFormatter> html_fmt(new CHTMLFormatterEx(scope));
         cfg.SetHTMLFormatter(html_fmt);
     }
     else
@@ -974,17 +1188,112 @@ CFlatFileGenerator* CAsn2FlatApp::x_CreateFlatFileGenerator(const CArgs& args)
     }
 #endif
 
-    CRef<TGenbankBlockCallback> genbank_callback( x_GetGenbankCallback(args) );
+    CFlatFileGenerator* generator = new CFlatFileGenerator(cfg);
+    if (args["no-external"]) {
+        generator->SetAnnotSelector().SetExcludeExternal(true);
+    }
+    if( args["resolve-all"]) {
+        generator->SetAnnotSelector().SetResolveAll();
+    }
+    if( args["depth"] ) {
+        generator->SetAnnotSelector().SetResolveDepth(args["depth"].AsInteger());
+    }
+    if( args["max_search_segments"] ) {
+        generator->SetAnnotSelector().SetMaxSearchSegments(args["max_search_segments"].AsInteger());
+    }
+    if( args["max_search_time"] ) {
+        generator->SetAnnotSelector().SetMaxSearchTime(float(args["max_search_time"].AsDouble()));
+    }
+    return generator;
+}
 
-    if( args["benchmark-cancel-checking"] ) {
-        x_CreateCancelBenchmarkCallback();
+
+// The threaded mode works on streams of top-level entries.  With "any"
+// input type the type has to be known from the stream (text ASN.1 or XML).
+bool CAsn2FlatApp::x_IsThreadedInput(CObjectIStream& is,
+                                     const string& asn_type)
+{
+    if ( asn_type == "seq-entry"  ||  asn_type == "bioseq"  ||
+         asn_type == "bioseq-set" ) {
+        return true;
+    }
+    if ( asn_type == "any"  &&  !is.EndOfData() ) {
+        string type_name = is.PeekNextTypeName();
+        return type_name == CSeq_entry::GetTypeInfo()->GetName()  ||
+            type_name == CBioseq::GetTypeInfo()->GetName()  ||
+            type_name == CBioseq_set::GetTypeInfo()->GetName();
     }
+    return false;
+}
 
-    //CFlatFileConfig cfg(
-    //    format, mode, style, flags, view, gff_options, genbank_blocks,
-    //    genbank_callback.GetPointerOrNull(), m_pCanceledCallback.get(),
-    //    args["cleanup"] );
-    return new CFlatFileGenerator(cfg);
+
+CRef<CSeq_entry> CAsn2FlatApp::x_ReadSeqEntry(CObjectIStream& is,
+                                              const string& asn_type)
+{
+    string type_name = asn_type;
+    if ( asn_type == "any" ) {
+        type_name = is.PeekNextTypeName();
+    }
+
+    CRef<CSeq_entry> se(new CSeq_entry);
+    if ( type_name == "bioseq"  ||
+         type_name == CBioseq::GetTypeInfo()->GetName() ) {
+        is >> se->SetSeq();
+    }
+    else if ( type_name == "bioseq-set"  ||
+              type_name == CBioseq_set::GetTypeInfo()->GetName() ) {
+        is >> se->SetSet();
+    }
+    else {
+        is >> *se;
+        if (se->Which() == CSeq_entry::e_not_set) {
+            NCBI_THROW(CException, eUnknown,
+                       "provided Seq-entry is empty");
+        }
+    }
+    return se;
+}
+
+
+void CAsn2FlatApp::x_StartThreads(void)
+{
+    // keep a limited number of entries in memory
+    m_WorkQueue.reset(new TJobQueue(m_Threads * 2));
+    m_OutputQueue.reset(new TJobQueue(m_Threads * 4));
+    m_Errors.Set(0);
+
+    m_Writer.Reset(new CFlatfileWriter(*this));
+    m_Writer->Run();
+    for ( int i = 0; i < m_Threads; ++i ) {
+        CRef<CThread> worker(new CFlatfileWorker(*this));
+        worker->Run();
+        m_Workers.push_back(worker);
+    }
+}
+
+
+void CAsn2FlatApp::x_QueueSeqEntry(CSeq_entry& entry)
+{
+    CRef<CFlatfileJob> job(new CFlatfileJob(entry));
+    // the writer gets the entries in the input order
+    m_OutputQueue->Push(job);
+    m_WorkQueue->Push(job);
+}
+
+
+void CAsn2FlatApp::x_StopThreads(void)
+{
+    // an empty job stops a thread
+    for ( size_t i = 0; i < m_Workers.size(); ++i ) {
+        m_WorkQueue->Push(CRef<CFlatfileJob>());
+    }
+    NON_CONST_ITERATE ( vector< CRef<CThread> >, it, m_Workers ) {
+        (*it)->Join();
+    }
+    m_Workers.clear();
+    m_OutputQueue->Push(CRef<CFlatfileJob>());
+    m_Writer->Join();
+    m_Writer.Reset();
 }
 
 CAsn2FlatApp::TGenbankBlockCallback*
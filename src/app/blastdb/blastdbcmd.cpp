@@ -45,6 +45,8 @@
 #include <algo/blast/blastinput/blast_input.hpp>
 #include "../blast/blast_app_util.hpp"
 #include <iomanip>
+#include <functional>
+#include <exception>
 
 
 #ifndef SKIP_DOXYGEN_PROCESSING
@@ -52,6 +54,51 @@ USING_NCBI_SCOPE;
 USING_SCOPE(blast);
 #endif
 
+/// One line of an -entry_batch file, resolved to the OIDs to write
+struct SBatchEntry {
+    /// Sequence identifier as given in the input
+    string m_Id;
+    /// Range, strand and masking for this entry
+    CBlastDB_FormatterConfig m_Config;
+    /// Range, strand or masking of the input line is invalid
+    bool m_BadConfig;
+    /// OIDs to write, empty if the entry was not found
+    vector<CSeqDB::TOID> m_Oids;
+    /// Formatted output for this entry
+    string m_Output;
+};
+
+/// Thread running one share of the batch formatting work
+class CBatchFormatThread : public CThread
+{
+public:
+    /// Constructor
+    /// @param work function formatting this thread's share [in]
+    CBatchFormatThread(const std::function<void()> & work)
+        : m_Work(work) {}
+
+    /// Exception thrown by the work function, if any
+    std::exception_ptr GetError() const { return m_Error; }
+
+protected:
+    /** @inheritDoc */
+    virtual void* Main()
+    {
+        try {
+            m_Work();
+        } catch (...) {
+            m_Error = std::current_exception();
+        }
+        return NULL;
+    }
+
+private:
+    /// Work function
+    std::function<void()> m_Work;
+    /// Exception thrown by m_Work
+    std::exception_ptr m_Error;
+};
+
 /// The application class
 class CBlastDBCmdApp : public CNcbiApplication
 {
@@ -80,6 +127,8 @@ private:
     bool m_GetDuplicates;
     /// should we output target sequence only?
     bool m_TargetOnly;
+    /// output format specification for CBlastDB_SeqFormatter
+    string m_OutFmt;
 
     CBlastDB_FormatterConfig m_Config;
 
@@ -96,11 +145,29 @@ private:
     /// @return 0 on success; 1 if some sequences were not retrieved
     int x_ProcessSearchRequest();
 
+    /// Create the formatter selected by the output format options
+    /// @param out stream the formatter writes to [in]
+    /// @return newly allocated formatter
+    CBlastDB_Formatter* x_CreateFormatter(CNcbiOstream& out);
+
     /// Process batch entry with range, strand and filter id
-    /// @param args program input args
-    /// @param seq_fmt sequence formatter object
+    ///
+    /// Entries are read in blocks.  All identifiers in a block are
+    /// resolved first, the sequences are then prefetched and formatted
+    /// in OID order (on several threads if requested), and the output
+    /// is written in input order.
     /// @return 0 on sucess; 1 if some queries were not processed
-    int x_ProcessBatchEntry(CBlastDB_Formatter & seq_fmt);
+    int x_ProcessBatchEntry();
+
+    /// Resolve the identifiers of a block of batch entries to OIDs,
+    /// entries not found are left with empty m_Oids
+    /// @param entries block of entries [in|out]
+    void x_ResolveBatchEntries(vector<SBatchEntry> & entries);
+
+    /// Format a block of resolved batch entries into their m_Output
+    /// @param entries block of entries [in|out]
+    /// @param num_threads number of threads to use [in]
+    void x_FormatBatchEntries(vector<SBatchEntry> & entries, int num_threads);
 
     /// Process entry with range, strand and filter id
     /// @param args program input args
@@ -112,6 +179,9 @@ private:
 
     bool x_GetOids(const string & acc, vector<int> & oids);
 
+    /// Same as x_GetOids, but does not report missing entries
+    bool x_LookupOids(const string & acc, vector<int> & oids);
+
     int x_ModifyConfigForBatchEntry(const vector<string> & tmp);
 
     bool x_UseLongSeqIds();
@@ -119,6 +189,16 @@ private:
 
 bool
 CBlastDBCmdApp::x_GetOids(const string & acc, vector<int> & oids)
+{
+	if(!x_LookupOids(acc, oids)) {
+		ERR_POST(Error <<  "Entry not found: " << acc);
+		return false;
+	}
+	return true;
+}
+
+bool
+CBlastDBCmdApp::x_LookupOids(const string & acc, vector<int> & oids)
 {
 	Int8 num_id = NStr::StringToNumeric<Int8>(acc, NStr::fConvErr_NoThrow);
 	if(!errno) {
@@ -135,11 +215,7 @@ CBlastDBCmdApp::x_GetOids(const string & acc, vector<int> & oids)
 	else {
 		m_BlastDb->AccessionToOids(acc, oids);
 	}
-	if(oids.empty()) {
-		ERR_POST(Error <<  "Entry not found: " << acc);
-		return false;
-	}
-	return true;
+	return !oids.empty();
 }
 
 int
@@ -235,48 +311,146 @@ int CBlastDBCmdApp::x_ModifyConfigForBatchEntry(const vector<string> & tmp)
    	return status;
 }
 
+void
+CBlastDBCmdApp::x_ResolveBatchEntries(vector<SBatchEntry> & entries)
+{
+    // Look the identifiers up in sorted order, so that consecutive
+    // ISAM lookups touch neighbouring index pages.
+    vector<size_t> order(entries.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    sort(order.begin(), order.end(), [&entries](size_t a, size_t b) {
+        return entries[a].m_Id < entries[b].m_Id;
+    });
+
+    ITERATE(vector<size_t>, i, order) {
+        SBatchEntry & entry = entries[*i];
+        if (entry.m_BadConfig || !x_LookupOids(entry.m_Id, entry.m_Oids)) {
+            continue;
+        }
+        if (!m_GetDuplicates) {
+            entry.m_Oids.resize(1);
+        }
+    }
+}
+
+void
+CBlastDBCmdApp::x_FormatBatchEntries(vector<SBatchEntry> & entries,
+                                     int num_threads)
+{
+    // Format in OID order, so that each thread reads its share of the
+    // database sequentially.
+    vector<size_t> order;
+    vector<CSeqDB::TOID> oids;
+    for (size_t i = 0; i < entries.size(); i++) {
+        if ( !entries[i].m_Oids.empty() ) {
+            order.push_back(i);
+            oids.insert(oids.end(), entries[i].m_Oids.begin(),
+                        entries[i].m_Oids.end());
+        }
+    }
+    if (order.empty()) {
+        return;
+    }
+    sort(order.begin(), order.end(), [&entries](size_t a, size_t b) {
+        return entries[a].m_Oids.front() < entries[b].m_Oids.front();
+    });
+    m_BlastDb->PrefetchSequences(oids);
+
+    auto format_range = [this, &entries, &order](size_t begin, size_t end) {
+        ostringstream buffer;
+        auto_ptr<CBlastDB_Formatter> fmt(x_CreateFormatter(buffer));
+        for (size_t i = begin; i < end; i++) {
+            SBatchEntry & entry = entries[order[i]];
+            if (m_TargetOnly) {
+                fmt->Write(entry.m_Oids.front(), entry.m_Config, entry.m_Id);
+            } else {
+                ITERATE(vector<CSeqDB::TOID>, oid, entry.m_Oids) {
+                    fmt->Write(*oid, entry.m_Config);
+                }
+            }
+            entry.m_Output = buffer.str();
+            buffer.str(kEmptyStr);
+        }
+    };
+
+    num_threads = (int) min((size_t) num_threads, order.size());
+    if (num_threads <= 1) {
+        format_range(0, order.size());
+        return;
+    }
+
+    vector< CRef<CBatchFormatThread> > threads;
+    for (int t = 0; t < num_threads; t++) {
+        size_t begin = order.size() * t / num_threads;
+        size_t end = order.size() * (t + 1) / num_threads;
+        threads.push_back(CRef<CBatchFormatThread>(new CBatchFormatThread(
+            [format_range, begin, end]() { format_range(begin, end); })));
+        threads.back()->Run();
+    }
+    std::exception_ptr error;
+    NON_CONST_ITERATE(vector< CRef<CBatchFormatThread> >, thr, threads) {
+        (*thr)->Join();
+        if ( !error ) {
+            error = (*thr)->GetError();
+        }
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
 int
-CBlastDBCmdApp::x_ProcessBatchEntry(CBlastDB_Formatter & fmt)
+CBlastDBCmdApp::x_ProcessBatchEntry()
 {
+    // Number of input lines resolved, sorted and formatted together.
+    // Small enough to keep the memory use low and the output streaming.
+    static const size_t kBlockSize = 4096;
+
 	int err_found = 0;
    	const CArgs& args = GetArgs();
     CNcbiIstream& input = args["entry_batch"].AsInputFile();
+    CNcbiOstream& out = args[kArgOutput].AsOutputFile();
+    int num_threads = 1;
+    if (args.Exist(kArgNumThreads) && args[kArgNumThreads].HasValue()) {
+        num_threads = args[kArgNumThreads].AsInteger();
+    }
 
     while (input) {
-        string line;
-        NcbiGetlineEOL(input, line);
-        if ( !line.empty() ) {
-        	vector<string> tmp;
-        	NStr::Split(line, " \t", tmp, NStr::fSplit_MergeDelims);
-        	if(tmp.empty()) {
-        		continue;
-        	}
-        	if(x_ModifyConfigForBatchEntry(tmp))  {
-        		err_found ++;
-        		ERR_POST (Error << "Skipped " << tmp[0]);
-        		continue;
-        	}
-   			vector<int> oids;
-         	if(!x_GetOids(tmp[0], oids)) {
-         		err_found ++;
-        		ERR_POST (Error << "Skipped " << tmp[0]);
-        		continue;
-         	}
-
-         	if (m_GetDuplicates) {
-         		for(unsigned int j=0; j < oids.size(); j++) {
-         			fmt.Write(oids[j], m_Config);
-         		}
-           	}
-         	else {
-         		if(m_TargetOnly) {
-         			fmt.Write(oids[0], m_Config, tmp[0]);
-         		}
-         		else {
-         			fmt.Write(oids[0], m_Config);
-         		}
-         	}
+        vector<SBatchEntry> entries;
+        while (input && entries.size() < kBlockSize) {
+            string line;
+            NcbiGetlineEOL(input, line);
+            if ( line.empty() ) {
+                continue;
+            }
+            vector<string> tmp;
+            NStr::Split(line, " \t", tmp, NStr::fSplit_MergeDelims);
+            if(tmp.empty()) {
+                continue;
+            }
+            entries.push_back(SBatchEntry());
+            entries.back().m_Id = tmp[0];
+            entries.back().m_BadConfig = x_ModifyConfigForBatchEntry(tmp) != 0;
+            entries.back().m_Config = m_Config;
+        }
+
+        x_ResolveBatchEntries(entries);
+        x_FormatBatchEntries(entries, num_threads);
+        // Write the block and report errors in input order
+        ITERATE(vector<SBatchEntry>, entry, entries) {
+            if (entry->m_BadConfig || entry->m_Oids.empty()) {
+                if ( !entry->m_BadConfig ) {
+                    ERR_POST(Error <<  "Entry not found: " << entry->m_Id);
+                }
+                err_found ++;
+                ERR_POST (Error << "Skipped " << entry->m_Id);
+                continue;
+            }
+            out << entry->m_Output;
         }
+        out.flush();
     }
     return (err_found) ? 1 : 0;
 }
@@ -423,7 +597,7 @@ CBlastDBCmdApp::x_ProcessSearchType(CBlastDB_Formatter & fmt)
 		fmt.DumpAll(m_Config);
 	}
 	else if (args["entry_batch"].HasValue()) {
-		return x_ProcessBatchEntry(fmt);
+		return x_ProcessBatchEntry();
 	}
 	else if (args["entry"].HasValue() || args["pig"].HasValue()) {
 		return x_ProcessEntry(fmt);
@@ -451,6 +625,19 @@ bool CBlastDBCmdApp::x_UseLongSeqIds()
 	return false;
 }
 
+CBlastDB_Formatter*
+CBlastDBCmdApp::x_CreateFormatter(CNcbiOstream& out)
+{
+	const CArgs& args = GetArgs();
+	if (m_FASTA) {
+		return new CBlastDB_FastaFormatter(*m_BlastDb, out, args["line_length"].AsInteger(), x_UseLongSeqIds());
+	}
+	else if (m_Asn1Bioseq) {
+		return new CBlastDB_BioseqFormatter(*m_BlastDb, out);
+	}
+	return new CBlastDB_SeqFormatter(m_OutFmt, *m_BlastDb, out);
+}
+
 int
 CBlastDBCmdApp::x_ProcessSearchRequest()
 {
@@ -458,20 +645,9 @@ CBlastDBCmdApp::x_ProcessSearchRequest()
     try {
     	const CArgs& args = GetArgs();
     	CNcbiOstream& out = args[kArgOutput].AsOutputFile();
-    	string outfmt = x_InitSearchRequest();
-    	/* Special case: full db dump when no range and mask data is specified */
-    	if (m_FASTA) {
-    		CBlastDB_FastaFormatter fasta_fmt(*m_BlastDb, out, args["line_length"].AsInteger(), x_UseLongSeqIds());
-    		err_found = x_ProcessSearchType(fasta_fmt);
-    	}
-    	else if (m_Asn1Bioseq) {
-    		CBlastDB_BioseqFormatter bioseq_fmt(*m_BlastDb, out);
-    		err_found = x_ProcessSearchType(bioseq_fmt);
-    	}
-    	else {
-    		CBlastDB_SeqFormatter seq_fmt(outfmt, *m_BlastDb, out);
-    		err_found = x_ProcessSearchType(seq_fmt);
-    	}
+    	m_OutFmt = x_InitSearchRequest();
+    	auto_ptr<CBlastDB_Formatter> fmt(x_CreateFormatter(out));
+    	err_found = x_ProcessSearchType(*fmt);
     }
     catch (const CException& e) {
     	ERR_POST(Error << e.GetMsg());
@@ -519,6 +695,14 @@ void CBlastDBCmdApp::Init()
     arg_desc->SetDependency("entry_batch", CArgDescriptions::eExcludes, "range");
     arg_desc->SetDependency("entry_batch", CArgDescriptions::eExcludes, "strand");
     arg_desc->SetDependency("entry_batch", CArgDescriptions::eExcludes, "mask_sequence_with");
+#ifdef NCBI_THREADS
+    arg_desc->AddDefaultKey(kArgNumThreads, "int_value",
+                            "Number of threads to use to format -entry_batch "
+                            "entries",
+                            CArgDescriptions::eInteger, "1");
+    arg_desc->SetConstraint(kArgNumThreads,
+                            new CArgAllowValuesGreaterThanOrEqual(1));
+#endif
 
     arg_desc->AddOptionalKey("pig", "PIG", "PIG to retrieve",
                              CArgDescriptions::eInteger);
@@ -35,6 +35,7 @@
 #include <ncbi_pch.hpp>
 #include <algo/blast/api/version.hpp>
 #include <algo/blast/blastinput/blast_input_aux.hpp>
+#include <algo/blast/blastinput/cmdline_flags.hpp>
 #include <corelib/ncbiapp.hpp>
 
 #include <serial/iterator.hpp>
@@ -279,6 +280,13 @@ void CMakeBlastDBApp::Init()
     arg_desc->AddDefaultKey("max_file_sz", "number_of_bytes",
                             "Maximum file size for BLAST database files",
                             CArgDescriptions::eString, "1GB");
+#ifdef NCBI_THREADS
+    arg_desc->AddDefaultKey(kArgNumThreads, "int_value",
+                            "Number of threads to use to build the database",
+                            CArgDescriptions::eInteger, "1");
+    arg_desc->SetConstraint(kArgNumThreads,
+                            new CArgAllowValuesGreaterThanOrEqual(1));
+#endif
     arg_desc->AddOptionalKey("logfile", "File_Name",
                              "File to which the program log should be redirected",
                              CArgDescriptions::eOutputFile,
@@ -1132,6 +1140,10 @@ void CMakeBlastDBApp::x_BuildDatabase()
 
     m_DB->SetMaxFileSize(bytes);
 
+    if (args.Exist(kArgNumThreads) && args[kArgNumThreads].HasValue()) {
+        m_DB->SetNumThreads(args[kArgNumThreads].AsInteger());
+    }
+
     if (args["taxid"].HasValue()) {
         _ASSERT( !args["taxid_map"].HasValue() );
         CRef<CTaxIdSet> taxids(new CTaxIdSet(args["taxid"].AsInteger()));
@@ -38,6 +38,8 @@
 #include <corelib/ncbi_system.hpp>
 #include <util/format_guess.hpp>
 #include <util/line_reader.hpp>
+#include <util/compress/stream.hpp>
+#include <util/compress/zlib.hpp>
 
 #include <serial/iterator.hpp>
 #include <serial/objistr.hpp>
@@ -563,6 +565,26 @@ void CMultiReaderApp::Init(void)
         "generate gene->mrna and gene->cds xrefs",
         true );    
 
+    //
+    //  vcf reader specific arguments:
+    //
+
+    arg_desc->SetCurrentGroup("VCF READER SPECIFIC");
+
+    arg_desc->AddDefaultKey(
+        "threads",
+        "INTEGER",
+        "Number of parser threads, 0 for one per CPU",
+        CArgDescriptions::eInteger,
+        "1");
+
+    arg_desc->AddOptionalKey(
+        "format-fields",
+        "STRING",
+        "Comma separated FORMAT fields to extract per sample, "
+            "\"-\" for none",
+        CArgDescriptions::eString);
+
     //
     //  alignment reader specific arguments:
     //
@@ -1016,9 +1038,28 @@ void CMultiReaderApp::xProcessVcf(
     if (args["show-progress"]) {
         reader.SetProgressReportInterval(10);
     }
+    reader.SetThreads(args["threads"].AsInteger());
+    if (args["format-fields"]) {
+        vector<string> fields;
+        if (args["format-fields"].AsString() != "-") {
+            NStr::Split(args["format-fields"].AsString(), ",", fields);
+        }
+        reader.SetFormatFields(fields);
+    }
    //TestCanceler canceler;
    //reader.SetCanceler(&canceler);
-    reader.ReadSeqAnnots(annots, istr, m_pErrors);
+
+    // gzip'ed or bgzip'ed input, bgzip files are concatenated gzip members
+    if (istr.peek() == 0x1f) {
+        CCompressionIStream zistr(istr, 
+            new CZipStreamDecompressor(CZipCompression::fCheckFileHeader |
+                CZipCompression::fAllowConcatenatedGZip),
+            CCompressionIStream::fOwnProcessor);
+        reader.ReadSeqAnnots(annots, zistr, m_pErrors);
+    }
+    else {
+        reader.ReadSeqAnnots(annots, istr, m_pErrors);
+    }
     for (ANNOTS::iterator cit = annots.begin(); cit != annots.end(); ++cit){
         xWriteObject(args, **cit, ostr);
     }
@@ -30,6 +30,7 @@
 #include "nc_pch.hpp"
 
 #include <corelib/request_ctx.hpp>
+#include <zlib.h>
 
 #include "netcached.hpp"
 #include "active_handler.hpp"
@@ -161,7 +162,8 @@ CNCActiveHandler::CNCActiveHandler(Uint8 srv_id, CNCPeerControl* peer)
       m_CmdStarted(false),
       m_GotAnyAnswer(false),
       m_CmdFromClient(false),
-      m_Purge(false)
+      m_Purge(false),
+      m_MirrorBatch(false)
 {
 #if __NC_TASKS_MONITOR
     m_TaskName = "CNCActiveHandler";
@@ -392,7 +394,13 @@ CNCActiveHandler::CopyUpdate(const CNCBlobKeyLight& nc_key, Uint8 create_time)
 void CNCActiveHandler::CopyRemove(const CNCBlobKeyLight& nc_key, Uint8 create_time)
 {
     m_CurCmd = eNeedOnlyConfirm;
+    x_MakeCopyRemoveCmd(nc_key, create_time);
+    x_SetStateAndStartProcessing(&CNCActiveHandler::x_SendCmdToExecute);
+}
 
+void
+CNCActiveHandler::x_MakeCopyRemoveCmd(const CNCBlobKeyLight& nc_key, Uint8 create_time)
+{
     m_CmdToSend.resize(0);
     m_CmdToSend += "COPY_RMV \"";
     m_CmdToSend += nc_key.Cache();
@@ -404,8 +412,18 @@ void CNCActiveHandler::CopyRemove(const CNCBlobKeyLight& nc_key, Uint8 create_ti
     m_CmdToSend += NStr::UInt8ToString(create_time);
     m_CmdToSend += " ";
     m_CmdToSend += NStr::UInt8ToString( CNCDistributionConf::GetSelfID());
+}
 
-    x_SetStateAndStartProcessing(&CNCActiveHandler::x_SendCmdToExecute);
+void
+CNCActiveHandler::CopyBatch(TNCMirrorQueue& events)
+{
+    m_MirrorBatch = true;
+    m_BatchEvents.swap(events);
+    m_BatchCnt = 0;
+    m_BatchData.resize(0);
+    Uint4 start_word = 0x01020304;
+    m_BatchData.append((const char*)&start_word, sizeof(start_word));
+    x_SetStateAndStartProcessing(&CNCActiveHandler::x_PrepareBatch);
 }
 
 void
@@ -1262,6 +1280,17 @@ CNCActiveHandler::x_CleanCmdResources(void)
         hub->SetStatus(m_CmdSuccess? eNCHubSuccess: eNCHubError);
     }
     x_FinishSyncCmd(m_CmdSuccess ? eSynOK : eSynNetworkError, NC_SYNC_HINT);
+    if (m_MirrorBatch) {
+        // events not sent yet are lost, periodic sync will pick them up
+        ITERATE(TNCMirrorQueue, it, m_BatchEvents) {
+            delete *it;
+        }
+        m_BatchEvents.clear();
+        TNCBufferType empty_buf;
+        m_BatchData.swap(empty_buf);
+        m_MirrorBatch = false;
+        m_Peer->MirrorBatchDone();
+    }
     m_ErrMsg.clear();
     m_Response.clear();
     m_CmdStarted = false;
@@ -1379,6 +1408,13 @@ CNCActiveHandler::x_SendCopyPutCmd(void)
     if (m_Proxy->NeedEarlyClose()  ||  (m_CmdFromClient  &&  !m_Client))
         return &CNCActiveHandler::x_CloseCmdAndConn;
 
+    x_MakeCopyPutCmd();
+    return &CNCActiveHandler::x_SendCmdToExecute;
+}
+
+void
+CNCActiveHandler::x_MakeCopyPutCmd(void)
+{
     m_CmdToSend.resize(0);
     if (m_SyncCtrl) {
         m_CmdToSend += "SYNC_PUT ";
@@ -1425,7 +1461,6 @@ CNCActiveHandler::x_SendCopyPutCmd(void)
     m_CmdToSend += "\" \"";
     m_CmdToSend += GetDiagCtx()->GetSessionID();
     m_CmdToSend.append(1, '"');
-    return &CNCActiveHandler::x_SendCmdToExecute;
 }
 
 CNCActiveHandler::State
@@ -2032,12 +2067,17 @@ CNCActiveHandler::x_ReadBlobData(void)
             CNCStat::PeerDataWrite(n_read);
         if (m_Proxy->NeedEarlyClose())
             return &CNCActiveHandler::x_CloseCmdAndConn;
-        if (n_read == 0)
+        if (n_read == 0) {
+            // Wait for the rest of the data (capped by SetReadLowWater()),
+            // always lowering the mark for the short tail.
+            m_Proxy->SetReadLowWater(size_t(m_SizeToRead));
             return NULL;
+        }
 
         m_BlobAccess->MoveWritePos(n_read);
         m_SizeToRead -= n_read;
     }
+    m_Proxy->SetReadLowWater(1);
 
     m_BlobAccess->Finalize();
     if (m_BlobAccess->HasError()) {
@@ -2254,6 +2294,10 @@ CNCActiveHandler::x_WaitOneLineAnswer(void)
         return &CNCActiveHandler::x_ReadSyncProInfoAnswer;
     case ePeerVersion:
         return &CNCActiveHandler::x_ReadPeerVersion;
+    case eCopyBatch:
+        return &CNCActiveHandler::x_WriteBatchData;
+    case eCopyBatchResult:
+        return &CNCActiveHandler::x_ReadCopyBatch;
     default:
         SRV_FATAL("Unexpected command: " << m_CurCmd);
     }
@@ -2307,7 +2351,12 @@ CNCActiveHandler::x_WriteBlobData(void)
         if (m_ChunkSize < want_read)
             want_read = m_ChunkSize;
 
-        Uint4 n_written = Uint4(m_Proxy->Write(m_BlobAccess->GetReadMemPtr(), want_read));
+        int file_fd;
+        Uint8 file_offset;
+        m_BlobAccess->GetReadFileCoord(file_fd, file_offset);
+        Uint4 n_written = Uint4(m_Proxy->WriteFromFile(
+                                            m_BlobAccess->GetReadMemPtr(),
+                                            file_fd, file_offset, want_read));
         if (n_written != 0)
             CNCStat::PeerDataRead(n_written);
         if (m_Proxy->NeedEarlyClose()  ||  (m_CmdFromClient  &&  !m_Client))
@@ -2320,6 +2369,154 @@ CNCActiveHandler::x_WriteBlobData(void)
     }
 }
 
+void
+CNCActiveHandler::x_AddBatchRecord(const char* data, Uint4 size)
+{
+    m_BatchData.append((const char*)&size, sizeof(size));
+    if (size != 0)
+        m_BatchData.append(data, size);
+}
+
+CNCActiveHandler::State
+CNCActiveHandler::x_PrepareBatch(void)
+{
+    if (m_Proxy->NeedEarlyClose())
+        return &CNCActiveHandler::x_CloseCmdAndConn;
+
+    while (!m_BatchEvents.empty()) {
+        SNCMirrorEvent* event = m_BatchEvents.front();
+        if (event->evt_type == eSyncWrite) {
+            m_BlobKey = event->key;
+            x_SetSlotAndBucketAndVerifySlot(event->slot);
+            m_OrigRecNo = event->orig_rec_no;
+            m_BlobAccess = CNCBlobStorage::GetBlobAccess(eNCReadData,
+                                    m_BlobKey.PackedKey(), kEmptyStr, m_TimeBucket);
+            m_BlobAccess->RequestMetaInfo(this);
+            return &CNCActiveHandler::x_AddBatchBlob;
+        }
+        x_MakeCopyRemoveCmd(event->key, event->orig_rec_no);
+        x_AddBatchRecord(m_CmdToSend.data(), Uint4(m_CmdToSend.size()));
+        x_AddBatchRecord(NULL, 0);
+        ++m_BatchCnt;
+        m_BatchEvents.pop_front();
+        delete event;
+    }
+    return &CNCActiveHandler::x_SendCopyBatchCmd;
+}
+
+CNCActiveHandler::State
+CNCActiveHandler::x_AddBatchBlob(void)
+{
+    if (!m_BlobAccess->IsMetaInfoReady())
+        return NULL;
+
+    SNCMirrorEvent* event = m_BatchEvents.front();
+    m_BatchEvents.pop_front();
+    if (!m_BlobAccess->HasError()  &&  m_BlobAccess->IsBlobExists()
+        &&  !m_BlobAccess->IsCurBlobDead())
+    {
+        Uint8 blob_size = m_BlobAccess->GetCurBlobSize();
+        if (blob_size > CNCDistributionConf::GetMirrorBatchMaxSize()
+            ||  blob_size > CNCDistributionConf::GetSmallBlobBoundary())
+        {
+            // blob was re-written since the event, mirror it separately
+            m_Peer->RequeueMirrorEvent(event, blob_size);
+            event = NULL;
+        }
+        else {
+            size_t rec_start = m_BatchData.size();
+            x_MakeCopyPutCmd();
+            x_AddBatchRecord(m_CmdToSend.data(), Uint4(m_CmdToSend.size()));
+            Uint4 data_size = Uint4(blob_size);
+            m_BatchData.append((const char*)&data_size, sizeof(data_size));
+            m_BlobAccess->SetPosition(0);
+            while (m_BlobAccess->GetPosition() < blob_size) {
+                Uint4 n_read = m_BlobAccess->GetReadMemSize();
+                if (m_BlobAccess->HasError())
+                    break;
+                m_BatchData.append((const char*)m_BlobAccess->GetReadMemPtr(), n_read);
+                m_BlobAccess->MoveReadPos(n_read);
+            }
+            if (m_BlobAccess->HasError())
+                m_BatchData.resize(rec_start);
+            else
+                ++m_BatchCnt;
+        }
+    }
+    delete event;
+    m_BlobAccess->Release();
+    m_BlobAccess = NULL;
+    return &CNCActiveHandler::x_PrepareBatch;
+}
+
+CNCActiveHandler::State
+CNCActiveHandler::x_SendCopyBatchCmd(void)
+{
+    if (m_BatchCnt == 0)
+        return &CNCActiveHandler::x_FinishCommand;
+
+    m_BatchRawSize = m_BatchData.size();
+    if (CNCDistributionConf::GetMirrorBatchCompress()) {
+        uLongf packed_size = compressBound(uLong(m_BatchRawSize));
+        TNCBufferType packed;
+        packed.resize_mem(packed_size);
+        if (compress2((Bytef*)packed.data(), &packed_size,
+                      (const Bytef*)m_BatchData.data(), uLong(m_BatchRawSize),
+                      Z_BEST_SPEED) == Z_OK
+            &&  packed_size < m_BatchRawSize)
+        {
+            packed.resize(packed_size);
+            m_BatchData.swap(packed);
+        }
+    }
+
+    m_CurCmd = eCopyBatch;
+    m_BatchPos = 0;
+    m_CmdToSend.resize(0);
+    m_CmdToSend += "COPY_BATCH ";
+    m_CmdToSend += NStr::UInt8ToString(CNCDistributionConf::GetSelfID());
+    m_CmdToSend.append(1, ' ');
+    m_CmdToSend += NStr::UIntToString(m_BatchCnt);
+    m_CmdToSend.append(1, ' ');
+    m_CmdToSend += NStr::UInt8ToString(m_BatchData.size());
+    m_CmdToSend.append(1, ' ');
+    m_CmdToSend += NStr::UInt8ToString(m_BatchRawSize);
+    return &CNCActiveHandler::x_SendCmdToExecute;
+}
+
+CNCActiveHandler::State
+CNCActiveHandler::x_WriteBatchData(void)
+{
+    while (m_BatchPos < m_BatchData.size()) {
+        size_t n_written = m_Proxy->Write(m_BatchData.data() + m_BatchPos,
+                                          m_BatchData.size() - m_BatchPos);
+        if (n_written != 0)
+            CNCStat::PeerDataRead(n_written);
+        if (m_Proxy->NeedEarlyClose())
+            return &CNCActiveHandler::x_CloseCmdAndConn;
+        if (n_written == 0)
+            return NULL;
+        m_BatchPos += n_written;
+    }
+    CNCStat::MirrorBatchSent(m_BatchCnt, m_BatchRawSize, m_BatchData.size());
+    m_Proxy->RequestFlush();
+    m_CurCmd = eCopyBatchResult;
+    return &CNCActiveHandler::x_WaitOneLineAnswer;
+}
+
+CNCActiveHandler::State
+CNCActiveHandler::x_ReadCopyBatch(void)
+{
+    SIZE_TYPE pos = NStr::FindCase(m_Response, "ERR=");
+    if (pos != NPOS) {
+        Uint4 cnt_errors = NStr::StringToUInt(m_Response.substr(pos + 4),
+                              NStr::fConvErr_NoThrow | NStr::fAllowTrailingSymbols);
+        if (cnt_errors != 0)
+            CNCStat::MirrorBatchErrors(cnt_errors);
+    }
+    return &CNCActiveHandler::x_FinishCommand;
+}
+
 CNCActiveHandler::State
 CNCActiveHandler::x_WaitClientRelease(void)
 {
@@ -2380,7 +2577,8 @@ CNCAlerts::Register(CNCAlerts::eDebugSyncAborted2, "CheckCommandTimeout");
 
     int delay_time = CSrvTime::CurSecs() - proxy->m_LastActive;
     if (delay_time > CNCDistributionConf::GetPeerTimeout()
-        &&  ((m_CurCmd != eSyncBList  &&  m_CurCmd != eSyncStart)
+        &&  ((m_CurCmd != eSyncBList  &&  m_CurCmd != eSyncStart
+              &&  m_CurCmd != eCopyBatch  &&  m_CurCmd != eCopyBatchResult)
              ||  delay_time > CNCDistributionConf::GetBlobListTimeout()))
     {
         proxy->m_NeedToClose = true;
@@ -48,8 +48,11 @@ class CNCPeerControl;
 class CNCActiveSyncControl;
 struct SNCBlobSummary;
 struct SNCSyncEvent;
+struct SNCMirrorEvent;
 class CNCBlobAccessor;
 
+typedef list<SNCMirrorEvent*>   TNCMirrorQueue;
+
 
 enum ENCClientHubStatus {
     eNCHubError,
@@ -150,6 +153,13 @@ public:
                  const CNCBlobKeyLight& key,
                  Uint2 slot,
                  Uint8 orig_rec_no);
+    /*
+        takes ownership of events (removals and writes of small blobs)
+        x_PrepareBatch -> x_AddBatchBlob (for each write, after meta info) ->
+        x_SendCopyBatchCmd -> x_SendCmdToExecute -> x_WaitOneLineAnswer ->
+        x_WriteBatchData -> x_WaitOneLineAnswer -> x_ReadCopyBatch -> x_FinishCommand
+    */
+    void CopyBatch(TNCMirrorQueue& events);
     // x_SendCmdToExecute ->  x_WaitOneLineAnswer -> x_ReadCopyProlong -> x_FinishCommand
     void CopyProlong(const CNCBlobKeyLight& key,
                      Uint2 slot,
@@ -281,7 +291,9 @@ private:
         eSyncGet,
         eSyncProlongPeer,
         eSyncProInfo,
-        ePeerVersion
+        ePeerVersion,
+        eCopyBatch,
+        eCopyBatchResult
     };
 
 
@@ -304,6 +316,9 @@ private:
     void x_DoCopyPut(void);
     void x_DoSyncGet(void);
     void x_SendCopyProlongCmd(const SNCBlobSummary& blob_sum);
+    void x_MakeCopyRemoveCmd(const CNCBlobKeyLight& key, Uint8 create_time);
+    void x_MakeCopyPutCmd(void);
+    void x_AddBatchRecord(const char* data, Uint4 size);
     State x_ReadSizeToRead(void);
     void x_DoProlongOur(void);
 
@@ -339,6 +354,11 @@ private:
     State x_ReadSyncProInfoAnswer(void);
     State x_ReadPeerVersion(void);
     State x_ExecuteProInfoCmd(void);
+    State x_PrepareBatch(void);
+    State x_AddBatchBlob(void);
+    State x_SendCopyBatchCmd(void);
+    State x_WriteBatchData(void);
+    State x_ReadCopyBatch(void);
 
     void x_SetSlotAndBucketAndVerifySlot(Uint2 slot);
 
@@ -373,10 +393,16 @@ private:
     bool m_CmdSuccess;
     bool m_CmdFromClient;
     bool m_Purge;
+    bool m_MirrorBatch;
     Uint2 m_KeySize;
     string m_ErrMsg;
     string m_SyncStartExtra;
     TNCBufferType m_ReadBuf;
+    TNCMirrorQueue m_BatchEvents;
+    TNCBufferType m_BatchData;
+    Uint8 m_BatchPos;
+    Uint8 m_BatchRawSize;
+    Uint4 m_BatchCnt;
 
     Uint8 m_SizeToWriteReq;
     Uint8 m_SizeToReadReq;
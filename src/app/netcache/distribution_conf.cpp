@@ -118,6 +118,10 @@ static Uint1    s_PeerTimeout = 2;
 static Uint1    s_BlobListTimeout = 10;
 static Uint8    s_SmallBlobBoundary = 65535;
 static Uint2    s_MaxMirrorQueueSize = 10000;
+static Uint4    s_MirrorBatchSize = 0;
+static Uint8    s_MirrorBatchMaxSize = 1024 * 1024;
+static Uint8    s_MirrorBatchDelay = 100 * kUSecsPerMSec;
+static bool     s_MirrorBatchCompress = false;
 static string   s_SyncLogFileName;
 static Uint4    s_MaxSlotLogEvents = 0;
 static Uint4    s_CleanLogReserve = 0;
@@ -200,6 +204,14 @@ CNCDistributionConf::Initialize(Uint2 control_port)
         s_SmallBlobBoundary = reg.GetInt(kNCReg_NCPoolSection, "small_blob_max_size", 100);
         s_SmallBlobBoundary *= 1000;
         s_MaxMirrorQueueSize = reg.GetInt(kNCReg_NCPoolSection, "max_instant_queue_size", 10000);
+        s_MirrorBatchSize = reg.GetInt(kNCReg_NCPoolSection, "mirror_batch_size", 0);
+        s_MirrorBatchMaxSize = NStr::StringToUInt8_DataSize(reg.GetString(
+                           kNCReg_NCPoolSection, "mirror_batch_max_size", "1 MB"));
+        if (s_MirrorBatchMaxSize == 0)
+            s_MirrorBatchSize = 0;
+        s_MirrorBatchDelay = reg.GetInt(kNCReg_NCPoolSection, "mirror_batch_delay", 100);
+        s_MirrorBatchDelay *= kUSecsPerMSec;
+        s_MirrorBatchCompress = reg.GetBool(kNCReg_NCPoolSection, "mirror_batch_compress", false);
 
         s_SyncLogFileName = reg.GetString(kNCReg_NCPoolSection, "sync_log_file", "./cache/sync_events.log");
         s_MaxSlotLogEvents = reg.GetInt(kNCReg_NCPoolSection, "max_slot_log_records", 100000);
@@ -561,6 +573,12 @@ void CNCDistributionConf::WriteSetup(CSrvSocketTask& task)
     task.WriteText(eol).WriteText("peer_blob_list_timeout"     ).WriteText(is).WriteNumber(s_BlobListTimeout);
     task.WriteText(eol).WriteText("small_blob_max_size"        ).WriteText(is).WriteNumber(s_SmallBlobBoundary/1000);
     task.WriteText(eol).WriteText("max_instant_queue_size"     ).WriteText(is).WriteNumber(s_MaxMirrorQueueSize);
+    task.WriteText(eol).WriteText("mirror_batch_size"          ).WriteText(is).WriteNumber(s_MirrorBatchSize);
+    task.WriteText(eol).WriteText("mirror_batch_max_size").WriteText(str).WriteText(iss)
+                                                   .WriteText(NStr::UInt8ToString_DataSize( s_MirrorBatchMaxSize)).WriteText(eos);
+    task.WriteText(eol).WriteText("mirror_batch_max_size").WriteText(is ).WriteNumber( s_MirrorBatchMaxSize);
+    task.WriteText(eol).WriteText("mirror_batch_delay"         ).WriteText(is).WriteNumber(s_MirrorBatchDelay/kUSecsPerMSec);
+    task.WriteText(eol).WriteText("mirror_batch_compress"      ).WriteText(is).WriteBool(s_MirrorBatchCompress);
     task.WriteText(eol).WriteText("max_slot_log_records"       ).WriteText(is).WriteNumber(s_MaxSlotLogEvents);
     task.WriteText(eol).WriteText("clean_slot_log_reserve"     ).WriteText(is).WriteNumber(s_CleanLogReserve);
     task.WriteText(eol).WriteText("max_clean_log_batch"        ).WriteText(is).WriteNumber(s_MaxCleanLogBatch);
@@ -1003,6 +1021,30 @@ CNCDistributionConf::GetMaxMirrorQueueSize(void)
     return s_MaxMirrorQueueSize;
 }
 
+Uint4
+CNCDistributionConf::GetMirrorBatchSize(void)
+{
+    return s_MirrorBatchSize;
+}
+
+Uint8
+CNCDistributionConf::GetMirrorBatchMaxSize(void)
+{
+    return s_MirrorBatchMaxSize;
+}
+
+Uint8
+CNCDistributionConf::GetMirrorBatchDelay(void)
+{
+    return s_MirrorBatchDelay;
+}
+
+bool
+CNCDistributionConf::GetMirrorBatchCompress(void)
+{
+    return s_MirrorBatchCompress;
+}
+
 const string&
 CNCDistributionConf::GetSyncLogFileName(void)
 {
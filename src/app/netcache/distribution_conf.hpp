@@ -118,6 +118,10 @@ public:
     static Uint1 GetBlobListTimeout(void);
     static Uint8 GetSmallBlobBoundary(void);
     static Uint2 GetMaxMirrorQueueSize(void);
+    static Uint4 GetMirrorBatchSize(void);
+    static Uint8 GetMirrorBatchMaxSize(void);
+    static Uint8 GetMirrorBatchDelay(void);
+    static bool  GetMirrorBatchCompress(void);
     static const string& GetSyncLogFileName(void);
     static Uint4 GetMaxSlotLogEvents(void);
     static Uint4 GetCleanLogReserve(void);
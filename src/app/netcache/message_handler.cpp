@@ -35,6 +35,8 @@
 #include <corelib/ncbi_bswap.hpp>
 #include <util/md5.hpp>
 
+#include <zlib.h>
+
 #include "netcached.hpp"
 #include "message_handler.hpp"
 #include "netcache_version.hpp"
@@ -360,6 +362,26 @@ static CNCMessageHandler::SCommandDef s_CommandMap[] = {
           // quorum-related functionality, i.e. before client received
           // confirmation of blob writing.
           { "sid",     eNSPT_Str,  eNSPA_Optional } } },
+    // Execute a batch of mirroring commands. Command is issued only by other
+    // servers while mirroring blob writes and removals. After OK response
+    // peer sends "size" bytes of batch data: signature word followed by
+    // records of COPY_PUT or COPY_RMV command line and blob data, each
+    // prefixed with its length. Data is compressed with zlib if "size" is
+    // less than "raw_size". Commands are executed one by one and final
+    // response reports number of executed commands and number of failed ones.
+    { "COPY_BATCH",
+        {&CNCMessageHandler::x_DoCmd_CopyBatch,
+            "COPY_BATCH",
+            fNeedsStorageCache | fNeedsSpaceAsPeer | fDoNotProxyToPeers,
+            eNCNone, eProxyNone},
+          // Server id of the server sending the batch.
+        { { "srv_id",  eNSPT_Int,  eNSPA_Required },
+          // Number of commands in the batch.
+          { "cnt",     eNSPT_Int,  eNSPA_Required },
+          // Size of batch data as it is sent.
+          { "size",    eNSPT_Int,  eNSPA_Required },
+          // Size of batch data after decompression.
+          { "raw_size",eNSPT_Int,  eNSPA_Required } } },
     // Prolong blob lifetime. Command is issued only by other servers while
     // mirroring prolonged blobs.
     { "COPY_PROLONG",
@@ -1669,7 +1691,15 @@ CNCMessageHandler::CNCMessageHandler(void)
       m_write_event(NULL),
       m_ChunkLen(0),
       m_SrvsIndex(0),
-      m_ActiveHub(NULL)
+      m_ActiveHub(NULL),
+      m_BatchPos(0),
+      m_BatchCnt(0),
+      m_BatchRawSize(0),
+      m_BatchLeft(0),
+      m_BatchDone(0),
+      m_BatchErrors(0),
+      m_InBatch(false),
+      m_BatchCmd(false)
 {
     LOG_CURRENT_FUNCTION
 #if __NC_TASKS_MONITOR
@@ -1926,6 +1956,11 @@ CNCMessageHandler::x_AssignCmdParams(void)
                         m_CmdVersion = NStr::StringToUInt(val);
                     }
                     break;
+                case 'n':
+                    if (key == "cnt") {
+                        m_BatchCnt = NStr::StringToUInt(val);
+                    }
+                    break;
                 case 'o':
                     if (key == "confirm") {
                         if (val == "1")
@@ -2065,6 +2100,9 @@ CNCMessageHandler::x_AssignCmdParams(void)
                 else if (key == "rec_your") {
                     m_LocalRecNo = NStr::StringToUInt8(val);
                 }
+                else if (key == "raw_size") {
+                    m_BatchRawSize = NStr::StringToUInt8(val);
+                }
                 break;
             case 's':
                 switch (key[1]) {
@@ -2446,7 +2484,10 @@ CNCMessageHandler::x_ReadCommand(void)
     }
 
     CTempString cmd_line;
-    if (x_IsHttpMode() && !m_PosponedCmd.empty()) {
+    if (m_InBatch) {
+        if (!x_ReadBatchRecord(cmd_line))
+            return &CNCMessageHandler::x_FinishBatch;
+    } else if (x_IsHttpMode() && !m_PosponedCmd.empty()) {
         cmd_line = m_PosponedCmd;
     } else if (!ReadLine(&cmd_line)) {
         if (!HasError()  &&  CanHaveMoreRead())
@@ -2462,9 +2503,22 @@ CNCMessageHandler::x_ReadCommand(void)
         }
         catch (CNSProtoParserException& ex) {
             SRV_LOG(Warning, "Error parsing command: " << ex);
+            if (m_BatchCmd) {
+                ++m_BatchErrors;
+                return &CNCMessageHandler::x_ReadCommand;
+            }
             GetDiagCtx()->SetRequestStatus(eStatus_BadCmd);
             return &CNCMessageHandler::x_SaveStatsAndClose;
         }
+        if (m_BatchCmd
+            &&  strcmp(m_ParsedCmd.command->cmd, "COPY_PUT") != 0
+            &&  strcmp(m_ParsedCmd.command->cmd, "COPY_RMV") != 0)
+        {
+            SRV_LOG(Warning, "Command is not allowed in mirroring batch: "
+                             << m_ParsedCmd.command->cmd);
+            ++m_BatchErrors;
+            return &CNCMessageHandler::x_ReadCommand;
+        }
     } else {
         list<CTempString> arr;
         ncbi_NStr_Split(cmd_line, " ", arr);
@@ -2529,12 +2583,73 @@ CNCMessageHandler::x_ReadCommand(void)
         ReleaseDiagCtx();
         SRV_LOG(Warning, "Error while parsing command '" << cmd_line
                          << "': " << ex);
+        if (m_BatchCmd) {
+            ++m_BatchErrors;
+            return &CNCMessageHandler::x_ReadCommand;
+        }
         GetDiagCtx()->SetRequestStatus(eStatus_BadCmd);
         return &CNCMessageHandler::x_SaveStatsAndClose;
     }
+    // Commands from mirroring batch are answered all at once in x_FinishBatch
+    if (m_BatchCmd)
+        x_SetFlag(fNoReplyOnFinish);
     return &CNCMessageHandler::x_StartCommand;
 }
 
+bool
+CNCMessageHandler::x_ReadBatchRecord(CTempString& cmd_line)
+{
+    m_BatchCmd = false;
+    if (m_BatchLeft == 0)
+        return false;
+
+    const char* data = m_BatchData.data();
+    size_t data_size = m_BatchData.size();
+    Uint4 line_len = 0, blob_len = 0;
+    if (data_size - m_BatchPos >= sizeof(line_len)) {
+        memcpy(&line_len, data + m_BatchPos, sizeof(line_len));
+        m_BatchPos += sizeof(line_len);
+    }
+    if (line_len == 0  ||  data_size - m_BatchPos < line_len + sizeof(blob_len)) {
+        SRV_LOG(Error, "Mirroring batch data is corrupted, "
+                       << m_BatchLeft << " commands are lost");
+        m_BatchErrors += m_BatchLeft;
+        m_BatchLeft = 0;
+        return false;
+    }
+    cmd_line.assign(data + m_BatchPos, line_len);
+    m_BatchPos += line_len;
+    memcpy(&blob_len, data + m_BatchPos, sizeof(blob_len));
+    m_BatchPos += sizeof(blob_len);
+    if (data_size - m_BatchPos < blob_len) {
+        SRV_LOG(Error, "Mirroring batch data is corrupted, "
+                       << m_BatchLeft << " commands are lost");
+        m_BatchErrors += m_BatchLeft;
+        m_BatchLeft = 0;
+        return false;
+    }
+    m_BatchBlob.assign(data + m_BatchPos, blob_len);
+    m_BatchPos += blob_len;
+    --m_BatchLeft;
+    ++m_BatchDone;
+    m_BatchCmd = true;
+    return true;
+}
+
+CNCMessageHandler::State
+CNCMessageHandler::x_FinishBatch(void)
+{
+    LOG_CURRENT_FUNCTION
+    WriteText("OK:CNT=").WriteNumber(m_BatchDone)
+        .WriteText(", ERR=").WriteNumber(m_BatchErrors).WriteText("\n");
+    Flush();
+    m_InBatch = false;
+    m_BatchBlob.clear();
+    TNCBufferType empty_buf;
+    m_BatchData.swap(empty_buf);
+    return &CNCMessageHandler::x_ReadCommand;
+}
+
 void
 CNCMessageHandler::x_GetCurSlotServers(void)
 {
@@ -2882,6 +2997,9 @@ CNCMessageHandler::x_CleanCmdResources(void)
             CNCPeriodicSync::Cancel(m_SrvId, m_Slot, m_SyncId);
         }
     }
+    if (m_BatchCmd  &&  !x_IsCmdSucceeded(cmd_status)) {
+        ++m_BatchErrors;
+    }
     if (!x_IsFlagSet(fNoReplyOnFinish)) {
         if (!x_IsHttpMode()) {
             if (x_IsCmdSucceeded(cmd_status)) {
@@ -2937,6 +3055,10 @@ CNCMessageHandler::x_CleanCmdResources(void)
         SetPriority(1);
 
     m_SendBuff.reset();
+    if (!m_InBatch  &&  m_BatchData.capacity() != 0) {
+        TNCBufferType empty_buf;
+        m_BatchData.swap(empty_buf);
+    }
     ReleaseDiagCtx();
 
     m_PosponedCmd.clear();
@@ -2963,6 +3085,8 @@ CNCMessageHandler::State
 CNCMessageHandler::x_StartReadingBlob(void)
 {
     LOG_CURRENT_FUNCTION
+    if (m_BatchCmd)
+        return &CNCMessageHandler::x_ReadBatchBlob;
     // Flushing the initial response line that client should receive before it
     // will start writing blob data.
     Flush();
@@ -2977,7 +3101,7 @@ CNCMessageHandler::x_FinishReadingBlob(void)
 {
     LOG_CURRENT_FUNCTION
     x_LogCmdEvent("FinishReadingBlob");
-    bool fail = false, keep_conn = !x_IsFlagSet(fNoReplyOnFinish);
+    bool fail = false, keep_conn = !x_IsFlagSet(fNoReplyOnFinish)  ||  m_BatchCmd;
     string errmsg;
     if (x_IsFlagSet(fReadExactBlobSize)  &&  m_BlobSize != m_Size) {
         fail = true;
@@ -3041,7 +3165,7 @@ CNCMessageHandler::x_FinishReadingBlob(void)
     if (m_BlobAccess->HasError()) {
         delete write_event;
         GetDiagCtx()->SetRequestStatus(eStatus_ServerError);
-        if (x_IsFlagSet(fNoReplyOnFinish))
+        if (x_IsFlagSet(fNoReplyOnFinish)  &&  !m_BatchCmd)
             return &CNCMessageHandler::x_CloseCmdAndConn;
 
         x_ReportError("ERR:Error while reading blob");
@@ -3291,16 +3415,100 @@ CNCMessageHandler::x_ReadBlobChunk(void)
         }
         if (NeedEarlyClose())
             return &CNCMessageHandler::x_CloseCmdAndConn;
-        if (n_read == 0)
+        if (n_read == 0) {
+            // For large chunks wait until a good portion of data comes
+            // instead of waking up on each network packet. The mark is
+            // updated every time, so the short tail of a chunk is not
+            // waited for with a stale larger mark.
+            SetReadLowWater(m_ChunkLen);
             return NULL;
+        }
 
         m_BlobAccess->MoveWritePos(n_read);
         m_ChunkLen -= n_read;
         m_BlobSize += n_read;
     }
+    SetReadLowWater(1);
     return &CNCMessageHandler::x_ReadBlobChunkLength;
 }
 
+CNCMessageHandler::State
+CNCMessageHandler::x_ReadBatchBlob(void)
+{
+    LOG_CURRENT_FUNCTION
+    while (!m_BatchBlob.empty()) {
+        Uint4 write_len = Uint4(m_BlobAccess->GetWriteMemSize());
+        if (m_BlobAccess->HasError()) {
+            GetDiagCtx()->SetRequestStatus(eStatus_ServerError);
+            return &CNCMessageHandler::x_FinishCommand;
+        }
+        if (write_len == 0)
+            return NULL;
+        if (write_len > m_BatchBlob.size())
+            write_len = Uint4(m_BatchBlob.size());
+
+        memcpy(m_BlobAccess->GetWriteMemPtr(), m_BatchBlob.data(), write_len);
+        m_BlobAccess->MoveWritePos(write_len);
+        m_BatchBlob = m_BatchBlob.substr(write_len);
+        m_BlobSize += write_len;
+    }
+    return &CNCMessageHandler::x_FinishReadingBlob;
+}
+
+CNCMessageHandler::State
+CNCMessageHandler::x_ReadBatchData(void)
+{
+    LOG_CURRENT_FUNCTION
+    while (m_BatchPos < m_BatchData.size()) {
+        size_t n_read = Read(m_BatchData.data() + m_BatchPos,
+                             m_BatchData.size() - m_BatchPos);
+        if (n_read != 0)
+            CNCStat::PeerDataWrite(n_read);
+        if (NeedEarlyClose())
+            return &CNCMessageHandler::x_CloseCmdAndConn;
+        if (n_read == 0) {
+            // Lower the mark for the tail too, a stale one would not let
+            // the task wake up until the peer times out
+            SetReadLowWater(m_BatchData.size() - m_BatchPos);
+            return NULL;
+        }
+        m_BatchPos += n_read;
+    }
+    SetReadLowWater(1);
+
+    if (m_Size < m_BatchRawSize) {
+        TNCBufferType raw_data;
+        raw_data.resize_mem(size_t(m_BatchRawSize));
+        uLongf raw_size = uLongf(m_BatchRawSize);
+        if (uncompress((Bytef*)raw_data.data(), &raw_size,
+                       (const Bytef*)m_BatchData.data(), uLong(m_BatchData.size())) != Z_OK
+            ||  raw_size != m_BatchRawSize)
+        {
+            SRV_LOG(Error, "Cannot decompress mirroring batch of "
+                           << m_Size << " bytes");
+            x_ReportError(eStatus_BadCmd);
+            return &CNCMessageHandler::x_FinishCommand;
+        }
+        m_BatchData.swap(raw_data);
+    }
+    Uint4 start_word = 0;
+    if (m_BatchData.size() >= sizeof(start_word))
+        memcpy(&start_word, m_BatchData.data(), sizeof(start_word));
+    if (start_word != 0x01020304) {
+        SRV_LOG(Error, "Wrong signature of mirroring batch: " << start_word);
+        x_ReportError(eStatus_BadCmd);
+        return &CNCMessageHandler::x_FinishCommand;
+    }
+
+    m_BatchPos = sizeof(start_word);
+    m_BatchLeft = m_BatchCnt;
+    m_BatchDone = m_BatchErrors = 0;
+    m_InBatch = true;
+    // the answer is given when all commands are executed
+    x_SetFlag(fNoReplyOnFinish);
+    return &CNCMessageHandler::x_FinishCommand;
+}
+
 CNCMessageHandler::State
 CNCMessageHandler::x_WriteBlobData(void)
 {
@@ -3318,7 +3526,11 @@ CNCMessageHandler::x_WriteBlobData(void)
         if (m_Size != Uint8(-1)  &&  m_Size < want_read)
             want_read = Uint4(m_Size);
 
-        Uint4 n_written = Uint4(Write(m_BlobAccess->GetReadMemPtr(), want_read));
+        int file_fd;
+        Uint8 file_offset;
+        m_BlobAccess->GetReadFileCoord(file_fd, file_offset);
+        Uint4 n_written = Uint4(WriteFromFile(m_BlobAccess->GetReadMemPtr(),
+                                              file_fd, file_offset, want_read));
         x_LogCmdEvent("Write");
         if (n_written != 0) {
             if (m_Flags & fComesFromClient)
@@ -4504,14 +4716,16 @@ CNCMessageHandler::x_DoCmd_CopyPut(void)
         if (m_BlobAccess->IsBlobExists()) {
             m_BlobAccess->UpdateMetaInfo(m_CopyBlobInfo->create_server, m_CopyBlobInfo->create_time);
         }
-        WriteText("OK:\n");
+        if (!m_BatchCmd)
+            WriteText("OK:\n");
     }
     else {
         GetDiagCtx()->SetRequestStatus(eStatus_NewerBlob);
         x_SetFlag(fNoBlobAccessStats);
         x_SetFlag(fSyncCmdSuccessful);
         x_UnsetFlag(fCopyLogEvent);
-        WriteText("OK:HAVE_NEWER1\n");
+        if (!m_BatchCmd)
+            WriteText("OK:HAVE_NEWER1\n");
     }
     // Old NC servers (those which used CNetCacheAPI instead of
     // CNCActiveHandler) always started to write blob data in SYNC_PUT and
@@ -4528,6 +4742,25 @@ CNCMessageHandler::x_DoCmd_CopyPut(void)
     return &CNCMessageHandler::x_StartReadingBlob;
 }
 
+CNCMessageHandler::State
+CNCMessageHandler::x_DoCmd_CopyBatch(void)
+{
+    LOG_CURRENT_FUNCTION
+    if (m_BatchCnt == 0  ||  m_Size == 0  ||  m_Size > m_BatchRawSize
+        ||  m_BatchRawSize > CNCBlobStorage::GetMaxBlobSizeStore())
+    {
+        SRV_LOG(Error, "Invalid mirroring batch: " << m_BatchCnt << " commands, "
+                       << m_Size << " bytes (" << m_BatchRawSize << " raw)");
+        x_ReportError(eStatus_BadCmd);
+        return &CNCMessageHandler::x_FinishCommand;
+    }
+    m_BatchData.resize_mem(size_t(m_Size));
+    m_BatchPos = 0;
+    WriteText("OK:\n");
+    Flush();
+    return &CNCMessageHandler::x_ReadBatchData;
+}
+
 CNCMessageHandler::State
 CNCMessageHandler::x_DoCmd_CopyProlong(void)
 {
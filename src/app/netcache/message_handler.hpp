@@ -197,6 +197,7 @@ public:
     State x_DoCmd_SyncStart(void);
     State x_DoCmd_SyncBlobsList(void);
     State x_DoCmd_CopyPut(void);
+    State x_DoCmd_CopyBatch(void);
     State x_DoCmd_CopyProlong(void);
     State x_DoCmd_SyncGet(void);
     State x_DoCmd_SyncProlongInfo(void);
@@ -250,6 +251,12 @@ private:
     State x_ReadBlobChunkLength(void);
     /// Read chunk data in blob transfer protocol
     State x_ReadBlobChunk(void);
+    /// Read whole data of mirroring batch
+    State x_ReadBatchData(void);
+    /// Copy blob data of current batch command into blob
+    State x_ReadBatchBlob(void);
+    /// Send final response for the mirroring batch
+    State x_FinishBatch(void);
     /// Write data from blob to socket
     State x_WriteBlobData(void);
     State x_WriteSendBuff(void);
@@ -282,6 +289,8 @@ private:
     State x_StartCommand(void);
     /// Command execution is finished, do cleanup work
     void x_CleanCmdResources(void);
+    /// Get next command line and blob data from the mirroring batch
+    bool x_ReadBatchRecord(CTempString& cmd_line);
     /// Start reading blob from socket
     State x_StartReadingBlob(void);
     /// Client finished sending blob, do cleanup
@@ -372,6 +381,20 @@ private:
     TServersList              m_CheckSrvs;
     TServersList              m_MirrorsDone;
     CNCActiveClientHub*       m_ActiveHub;
+    /// Data of mirroring batch being executed
+    TNCBufferType             m_BatchData;
+    size_t                    m_BatchPos;
+    Uint4                     m_BatchCnt;
+    Uint8                     m_BatchRawSize;
+    Uint4                     m_BatchLeft;
+    Uint4                     m_BatchDone;
+    Uint4                     m_BatchErrors;
+    /// Blob data of current command from the batch
+    CTempString               m_BatchBlob;
+    /// Commands are read from m_BatchData instead of socket
+    bool                      m_InBatch;
+    /// Current command came from the batch
+    bool                      m_BatchCmd;
     string                    m_LastPeerError;
     string                    m_StatType;
     Uint8                     m_AgeMax;
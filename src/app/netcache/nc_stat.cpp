@@ -247,10 +247,21 @@ CNCStat::x_ClearStats(void)
     m_DiskWrBlobSize = 0;
     m_DiskWrBySize.resize(0);
     m_DiskWrBySize.resize(40, 0);
+    m_RAMDataRead = 0;
+    m_RAMHits = 0;
+    m_RAMMisses = 0;
+    m_RAMAdmits = 0;
+    m_RAMRejects = 0;
+    m_RAMEvicts = 0;
     m_PeerSyncs = 0;
     m_PeerSynOps = 0;
     m_CntCleanedFiles = 0;
     m_CntFailedFiles = 0;
+    m_CntReclaimedFiles = 0;
+    m_ReclaimedSize = 0;
+    m_BatchRawSize = 0;
+    m_BatchSentSize = 0;
+    m_BatchErrors = 0;
     m_CmdLens.Initialize();
     m_CmdsByName.clear();
     m_LensByStatus.clear();
@@ -262,6 +273,7 @@ CNCStat::x_ClearStats(void)
     m_CheckedRecs.Initialize();
     m_MovedRecs.Initialize();
     m_MovedSize.Initialize();
+    m_BatchEvents.Initialize();
     m_CntFiles.Initialize();
     m_DBSize.Initialize();
     m_GarbageSize.Initialize();
@@ -274,6 +286,7 @@ CNCStat::x_ClearStats(void)
     m_WBMemSize.Initialize();
     m_WBReleasable.Initialize();
     m_WBReleasing.Initialize();
+    m_RAMSize.Initialize();
 }
 
 void
@@ -356,13 +369,25 @@ CNCStat::x_AddStats(CNCStat* src_stat)
     m_ClRdBlobSize += src_stat->m_ClRdBlobSize;
     m_DiskWrBlobs += src_stat->m_DiskWrBlobs;
     m_DiskWrBlobSize += src_stat->m_DiskWrBlobSize;
+    m_RAMDataRead += src_stat->m_RAMDataRead;
+    m_RAMHits += src_stat->m_RAMHits;
+    m_RAMMisses += src_stat->m_RAMMisses;
+    m_RAMAdmits += src_stat->m_RAMAdmits;
+    m_RAMRejects += src_stat->m_RAMRejects;
+    m_RAMEvicts += src_stat->m_RAMEvicts;
     m_PeerSyncs += src_stat->m_PeerSyncs;
     m_PeerSynOps += src_stat->m_PeerSynOps;
     m_CntCleanedFiles += src_stat->m_CntCleanedFiles;
     m_CntFailedFiles += src_stat->m_CntFailedFiles;
+    m_CntReclaimedFiles += src_stat->m_CntReclaimedFiles;
+    m_ReclaimedSize += src_stat->m_ReclaimedSize;
+    m_BatchRawSize += src_stat->m_BatchRawSize;
+    m_BatchSentSize += src_stat->m_BatchSentSize;
+    m_BatchErrors += src_stat->m_BatchErrors;
     m_CheckedRecs.AddValues(src_stat->m_CheckedRecs);
     m_MovedRecs.AddValues(src_stat->m_MovedRecs);
     m_MovedSize.AddValues(src_stat->m_MovedSize);
+    m_BatchEvents.AddValues(src_stat->m_BatchEvents);
     m_CntFiles.AddValues(src_stat->m_CntFiles);
     m_DBSize.AddValues(src_stat->m_DBSize);
     m_GarbageSize.AddValues(src_stat->m_GarbageSize);
@@ -375,6 +400,7 @@ CNCStat::x_AddStats(CNCStat* src_stat)
     m_WBMemSize.AddValues(src_stat->m_WBMemSize);
     m_WBReleasable.AddValues(src_stat->m_WBReleasable);
     m_WBReleasing.AddValues(src_stat->m_WBReleasing);
+    m_RAMSize.AddValues(src_stat->m_RAMSize);
 }
 
 void
@@ -549,6 +575,23 @@ CNCStat::PeerDataRead(size_t data_size)
     AtomicAdd(s_Stat()->m_PeerDataRead, data_size);
 }
 
+void
+CNCStat::MirrorBatchSent(Uint4 cnt_events, Uint8 raw_size, Uint8 sent_size)
+{
+    CNCStat* stat = s_Stat();
+    stat->m_StatLock.Lock();
+    stat->m_BatchEvents.AddValue(cnt_events);
+    stat->m_BatchRawSize += raw_size;
+    stat->m_BatchSentSize += sent_size;
+    stat->m_StatLock.Unlock();
+}
+
+void
+CNCStat::MirrorBatchErrors(Uint4 cnt_errors)
+{
+    AtomicAdd(s_Stat()->m_BatchErrors, cnt_errors);
+}
+
 void
 CNCStat::PeerSyncFinished(Uint8 srv_id, Uint2 slot, Uint8 cnt_ops, bool success)
 {
@@ -590,6 +633,36 @@ CNCStat::DiskBlobWrite(Uint8 blob_size)
     stat->m_StatLock.Unlock();
 }
 
+void
+CNCStat::RAMDataRead(size_t data_size)
+{
+    AtomicAdd(s_Stat()->m_RAMDataRead, data_size);
+}
+
+void
+CNCStat::RAMCacheLookup(bool hit)
+{
+    if (hit)
+        AtomicAdd(s_Stat()->m_RAMHits, 1);
+    else
+        AtomicAdd(s_Stat()->m_RAMMisses, 1);
+}
+
+void
+CNCStat::RAMCacheAdmission(bool admitted)
+{
+    if (admitted)
+        AtomicAdd(s_Stat()->m_RAMAdmits, 1);
+    else
+        AtomicAdd(s_Stat()->m_RAMRejects, 1);
+}
+
+void
+CNCStat::RAMCacheEvicted(Uint4 cnt_blobs)
+{
+    AtomicAdd(s_Stat()->m_RAMEvicts, cnt_blobs);
+}
+
 void
 CNCStat::DBFileCleaned(bool success, Uint4 seen_recs,
                        Uint4 moved_recs, Uint4 moved_size)
@@ -606,6 +679,13 @@ CNCStat::DBFileCleaned(bool success, Uint4 seen_recs,
     stat->m_StatLock.Unlock();
 }
 
+void
+CNCStat::DBFileReclaimed(Uint8 file_size)
+{
+    AtomicAdd(s_Stat()->m_CntReclaimedFiles, 1);
+    AtomicAdd(s_Stat()->m_ReclaimedSize, file_size);
+}
+
 void
 CNCStat::SaveCurStateStat(const SNCStateStat& state)
 {
@@ -623,6 +703,7 @@ CNCStat::SaveCurStateStat(const SNCStateStat& state)
     stat->m_WBMemSize.AddValue(state.wb_size);
     stat->m_WBReleasable.AddValue(state.wb_releasable);
     stat->m_WBReleasing.AddValue(state.wb_releasing);
+    stat->m_RAMSize.AddValue(state.ram_size);
     stat->m_StatLock.Unlock();
 
     CSrvRef<CNCStat> stat_5s = GetStat(kStatPeriodName[0], false);
@@ -773,7 +854,13 @@ CNCStat::PrintToLogs(CTempString stat_name)
         .PrintParam("start_wb_releasing", m_StartState.wb_releasing)
         .PrintParam("end_wb_releasing", m_EndState.wb_releasing)
         .PrintParam("avg_wb_releasing", m_WBReleasing.GetAverage())
-        .PrintParam("max_wb_releasing", m_WBReleasing.GetMaximum());
+        .PrintParam("max_wb_releasing", m_WBReleasing.GetMaximum())
+        .PrintParam("start_ram_size", m_StartState.ram_size)
+        .PrintParam("end_ram_size", m_EndState.ram_size)
+        .PrintParam("avg_ram_size", m_RAMSize.GetAverage())
+        .PrintParam("max_ram_size", m_RAMSize.GetMaximum())
+        .PrintParam("end_ram_blobs", m_EndState.ram_blobs)
+        .PrintParam("end_shrink_files", m_EndState.shrink_files);
     if (m_StartState.min_dead_time != 0) {
         t.Sec() = m_StartState.min_dead_time;
         t.Print(buf, CSrvTime::eFmtLogging);
@@ -792,10 +879,19 @@ CNCStat::PrintToLogs(CTempString stat_name)
         .PrintParam("avg_peer_write", m_PeerDataWrite / time_secs)
         .PrintParam("peer_read", m_PeerDataRead)
         .PrintParam("avg_peer_read", m_PeerDataRead / time_secs)
+        .PrintParam("mirror_batches", m_BatchEvents.GetCount())
+        .PrintParam("mirror_batch_events", m_BatchEvents.GetSum())
+        .PrintParam("avg_mirror_batch_events", m_BatchEvents.GetAverage())
+        .PrintParam("max_mirror_batch_events", m_BatchEvents.GetMaximum())
+        .PrintParam("mirror_batch_raw", m_BatchRawSize)
+        .PrintParam("mirror_batch_sent", m_BatchSentSize)
+        .PrintParam("mirror_batch_errors", m_BatchErrors)
         .PrintParam("disk_write", m_DiskDataWrite)
         .PrintParam("avg_disk_write", m_DiskDataWrite / time_secs)
         .PrintParam("disk_read", m_DiskDataRead)
-        .PrintParam("avg_disk_read", m_DiskDataRead / time_secs);
+        .PrintParam("avg_disk_read", m_DiskDataRead / time_secs)
+        .PrintParam("ram_read", m_RAMDataRead)
+        .PrintParam("avg_ram_read", m_RAMDataRead / time_secs);
     diag.PrintParam("cl_wr_blobs", m_ClWrBlobs)
         .PrintParam("cl_wr_avg_blobs", m_ClWrBlobs / time_secs)
         .PrintParam("cl_wr_size", m_ClWrBlobSize)
@@ -806,7 +902,12 @@ CNCStat::PrintToLogs(CTempString stat_name)
         .PrintParam("cl_rd_size", m_ClRdBlobSize)
         .PrintParam("disk_wr_blobs", m_DiskWrBlobs)
         .PrintParam("disk_wr_avg_blobs", m_DiskWrBlobs / time_secs)
-        .PrintParam("disk_wr_size", m_DiskWrBlobSize);
+        .PrintParam("disk_wr_size", m_DiskWrBlobSize)
+        .PrintParam("ram_hits", m_RAMHits)
+        .PrintParam("ram_misses", m_RAMMisses)
+        .PrintParam("ram_admits", m_RAMAdmits)
+        .PrintParam("ram_rejects", m_RAMRejects)
+        .PrintParam("ram_evicts", m_RAMEvicts);
     diag.PrintParam("peer_syncs", m_PeerSyncs)
         .PrintParam("peer_syn_ops", m_PeerSynOps)
         .PrintParam("cleaned_files", m_CntCleanedFiles)
@@ -816,7 +917,9 @@ CNCStat::PrintToLogs(CTempString stat_name)
         .PrintParam("moved_recs", m_MovedRecs.GetSum())
         .PrintParam("avg_moved_recs", m_MovedRecs.GetAverage())
         .PrintParam("moved_size", m_MovedSize.GetSum())
-        .PrintParam("avg_moved_size", m_MovedSize.GetAverage());
+        .PrintParam("avg_moved_size", m_MovedSize.GetAverage())
+        .PrintParam("reclaimed_files", m_CntReclaimedFiles)
+        .PrintParam("reclaimed_size", m_ReclaimedSize);
     diag.Flush();
 
     CSrvPrintProxy proxy(ctx);
@@ -844,6 +947,13 @@ void CNCStat::PrintState(CSrvSocketTask& task)
     task.WriteText(eol).WriteText("peer_active_conns"     ).WriteText(is ).WriteNumber( m_EndState.peer_active_conns);
     task.WriteText(eol).WriteText("peer_bg_conns"     ).WriteText(is ).WriteNumber( m_EndState.peer_bg_conns);
     task.WriteText(eol).WriteText("mirror_queue_size"     ).WriteText(is ).WriteNumber( m_EndState.mirror_queue_size);
+    task.WriteText(eol).WriteText("mirror_batches"     ).WriteText(is ).WriteNumber( m_BatchEvents.GetCount());
+    task.WriteText(eol).WriteText("mirror_batch_events").WriteText(is ).WriteNumber( m_BatchEvents.GetSum());
+    task.WriteText(eol).WriteText("avg_mirror_batch_events").WriteText(is ).WriteNumber( m_BatchEvents.GetAverage());
+    task.WriteText(eol).WriteText("max_mirror_batch_events").WriteText(is ).WriteNumber( m_BatchEvents.GetMaximum());
+    task.WriteText(eol).WriteText("mirror_batch_raw"   ).WriteText(is ).WriteNumber( m_BatchRawSize);
+    task.WriteText(eol).WriteText("mirror_batch_sent"  ).WriteText(is ).WriteNumber( m_BatchSentSize);
+    task.WriteText(eol).WriteText("mirror_batch_errors").WriteText(is ).WriteNumber( m_BatchErrors);
     task.WriteText(eol).WriteText("sync_log_size"     ).WriteText(is ).WriteNumber( m_EndState.sync_log_size);
     task.WriteText(eol).WriteText("wb_size"      ).WriteText(str).WriteText(iss)
                                       .WriteText(NStr::UInt8ToString_DataSize( m_EndState.wb_size)).WriteText("\"");
@@ -854,6 +964,17 @@ void CNCStat::PrintState(CSrvSocketTask& task)
     task.WriteText(eol).WriteText("wb_releasing" ).WriteText(str).WriteText(iss)
                                       .WriteText(NStr::UInt8ToString_DataSize( m_EndState.wb_releasing)).WriteText("\"");
     task.WriteText(eol).WriteText("wb_releasing" ).WriteText(is ).WriteNumber( m_EndState.wb_releasing);
+    task.WriteText(eol).WriteText("ram_size"     ).WriteText(str).WriteText(iss)
+                                      .WriteText(NStr::UInt8ToString_DataSize( m_EndState.ram_size)).WriteText("\"");
+    task.WriteText(eol).WriteText("ram_size"     ).WriteText(is ).WriteNumber( m_EndState.ram_size);
+    task.WriteText(eol).WriteText("ram_blobs"    ).WriteText(is ).WriteNumber( m_EndState.ram_blobs);
+    task.WriteText(eol).WriteText("shrink_files" ).WriteText(is ).WriteNumber( m_EndState.shrink_files);
+    task.WriteText(eol).WriteText("shrink_file_id").WriteText(is ).WriteNumber( m_EndState.shrink_file_id);
+    task.WriteText(eol).WriteText("shrink_file_used").WriteText(is ).WriteNumber( m_EndState.shrink_file_used);
+    task.WriteText(eol).WriteText("reclaimed_files").WriteText(is ).WriteNumber( m_CntReclaimedFiles);
+    task.WriteText(eol).WriteText("reclaimed_size").WriteText(str).WriteText(iss)
+                                      .WriteText(NStr::UInt8ToString_DataSize( m_ReclaimedSize)).WriteText("\"");
+    task.WriteText(eol).WriteText("reclaimed_size").WriteText(is ).WriteNumber( m_ReclaimedSize);
     
     task.WriteText(eol).WriteText("cnt_another_server_main" ).WriteText(is ).WriteNumber( m_EndState.cnt_another_server_main);
     task.WriteText(eol).WriteText("avg_tdiff_blobcopy" ).WriteText(is ).WriteNumber( m_EndState.avg_tdiff_blobcopy);
@@ -1005,6 +1126,16 @@ CNCStat::PrintToSocket(CSrvSocketTask* sock)
                     << g_ToSizeStr(m_WBMemSize.GetMaximum()) << ", releasable "
                     << g_ToSizeStr(m_WBReleasable.GetMaximum()) << ", releasing "
                     << g_ToSizeStr(m_WBReleasing.GetMaximum()) << endl;
+    proxy << "RAM start - "
+                    << g_ToSizeStr(m_StartState.ram_size) << ", "
+                    << g_ToSmartStr(m_StartState.ram_blobs) << " blobs" << endl;
+    proxy << "RAM end - "
+                    << g_ToSizeStr(m_EndState.ram_size) << ", "
+                    << g_ToSmartStr(m_EndState.ram_blobs) << " blobs" << endl;
+    proxy << "RAM avg - "
+                    << g_ToSizeStr(m_RAMSize.GetAverage()) << endl;
+    proxy << "RAM max - "
+                    << g_ToSizeStr(m_RAMSize.GetMaximum()) << endl;
     proxy << "Blob storage start - "
                     << m_StartState.cnt_another_server_main << " requests for alien blobs, "
                     << "blob update delay: "
@@ -1072,6 +1203,16 @@ CNCStat::PrintToSocket(CSrvSocketTask* sock)
     proxy << "Peer reads - "
                     << g_ToSizeStr(m_PeerDataRead) << ", "
                     << g_ToSizeStr(m_PeerDataRead / time_secs) << "/s" << endl;
+    if (m_BatchEvents.GetCount() != 0) {
+        proxy << "Mirror batches - "
+                    << g_ToSmartStr(m_BatchEvents.GetCount()) << " batches of "
+                    << g_ToSmartStr(m_BatchEvents.GetSum()) << " events ("
+                    << g_ToSmartStr(m_BatchEvents.GetAverage()) << " avg, "
+                    << g_ToSmartStr(m_BatchEvents.GetMaximum()) << " max), "
+                    << g_ToSizeStr(m_BatchRawSize) << " raw, "
+                    << g_ToSizeStr(m_BatchSentSize) << " sent, "
+                    << g_ToSmartStr(m_BatchErrors) << " errors" << endl;
+    }
     proxy << "Peer syncs - "
                     << g_ToSmartStr(m_PeerSyncs) << " syncs of "
                     << g_ToSmartStr(m_PeerSynOps) << " ops";
@@ -1086,6 +1227,15 @@ CNCStat::PrintToSocket(CSrvSocketTask* sock)
     proxy << "Disk reads - "
                     << g_ToSizeStr(m_DiskDataRead) << ", "
                     << g_ToSizeStr(m_DiskDataRead / time_secs) << "/s" << endl;
+    proxy << "RAM reads - "
+                    << g_ToSizeStr(m_RAMDataRead) << ", "
+                    << g_ToSizeStr(m_RAMDataRead / time_secs) << "/s, "
+                    << g_ToSmartStr(m_RAMHits) << " hits, "
+                    << g_ToSmartStr(m_RAMMisses) << " misses" << endl;
+    proxy << "RAM admission - "
+                    << g_ToSmartStr(m_RAMAdmits) << " admitted, "
+                    << g_ToSmartStr(m_RAMRejects) << " rejected, "
+                    << g_ToSmartStr(m_RAMEvicts) << " evicted" << endl;
     proxy << "Shrink check - "
                     << g_ToSmartStr(m_CntCleanedFiles) << " files ("
                     << g_ToSmartStr(m_CntFailedFiles) << " failed), "
@@ -1096,6 +1246,15 @@ CNCStat::PrintToSocket(CSrvSocketTask* sock)
                     << g_ToSizeStr(m_MovedSize.GetSum()) << " (per file "
                     << g_ToSmartStr(m_MovedRecs.GetAverage()) << " recs, "
                     << g_ToSizeStr(m_MovedSize.GetAverage()) << ")" << endl;
+    proxy << "Shrink reclaimed - "
+                    << g_ToSmartStr(m_CntReclaimedFiles) << " files, "
+                    << g_ToSizeStr(m_ReclaimedSize) << " ("
+                    << g_ToSizeStr(m_ReclaimedSize / time_secs) << "/s)" << endl;
+    if (m_EndState.shrink_file_id != 0) {
+        proxy << "Shrink now - file " << m_EndState.shrink_file_id << ", "
+                    << g_ToSizeStr(m_EndState.shrink_file_used) << " left to move, "
+                    << m_EndState.shrink_files << " files to clean" << endl;
+    }
     proxy << endl;
 
     m_SrvStat->PrintToSocket(proxy);
@@ -62,6 +62,11 @@ struct SNCStateStat
     size_t wb_size;
     size_t wb_releasable;
     size_t wb_releasing;
+    size_t ram_size;
+    Uint8  ram_blobs;
+    Uint4  shrink_files;     // number of db files worth cleaning
+    Uint4  shrink_file_id;   // db file being cleaned now, 0 if none
+    Uint8  shrink_file_used; // live data left in that file
     Uint8  cnt_another_server_main;
     Uint8  avg_tdiff_blobcopy; // average time diff between blob creation time and the time it is sent to mirror
     Uint8  max_tdiff_blobcopy; // maximum time diff between blob creation time and the time it is sent to mirror
@@ -97,12 +102,19 @@ public:
     static void ClientBlobRead(Uint8 blob_size, Uint8 len_usec);
     static void PeerDataWrite(size_t data_size);
     static void PeerDataRead(size_t data_size);
+    static void MirrorBatchSent(Uint4 cnt_events, Uint8 raw_size, Uint8 sent_size);
+    static void MirrorBatchErrors(Uint4 cnt_errors);
     static void PeerSyncFinished(Uint8 srv_id, Uint2 slot, Uint8 cnt_ops, bool success);
     static void DiskDataWrite(size_t data_size);
     static void DiskDataRead(size_t data_size);
     static void DiskBlobWrite(Uint8 blob_size);
+    static void RAMDataRead(size_t data_size);
+    static void RAMCacheLookup(bool hit);
+    static void RAMCacheAdmission(bool admitted);
+    static void RAMCacheEvicted(Uint4 cnt_blobs);
     static void DBFileCleaned(bool success, Uint4 seen_recs,
                               Uint4 moved_recs, Uint4 moved_size);
+    static void DBFileReclaimed(Uint8 file_size);
     static void SaveCurStateStat(const SNCStateStat& state);
 
 public:
@@ -153,10 +165,21 @@ private:
     Uint8 m_DiskWrBlobs;
     Uint8 m_DiskWrBlobSize;
     vector<Uint8> m_DiskWrBySize;
+    Uint8 m_RAMDataRead;
+    Uint8 m_RAMHits;
+    Uint8 m_RAMMisses;
+    Uint8 m_RAMAdmits;
+    Uint8 m_RAMRejects;
+    Uint8 m_RAMEvicts;
     Uint8 m_PeerSyncs;
     Uint8 m_PeerSynOps;
     Uint8 m_CntCleanedFiles;
     Uint8 m_CntFailedFiles;
+    Uint8 m_CntReclaimedFiles;
+    Uint8 m_ReclaimedSize;
+    Uint8 m_BatchRawSize;
+    Uint8 m_BatchSentSize;
+    Uint8 m_BatchErrors;
     TSrvTimeTerm m_CmdLens;
     TCmdCountsMap m_CmdsByName;
     TStatusCmdLens m_LensByStatus;
@@ -164,6 +187,7 @@ private:
     CSrvStatTerm<Uint4> m_CheckedRecs;
     CSrvStatTerm<Uint4> m_MovedRecs;
     CSrvStatTerm<Uint4> m_MovedSize;
+    CSrvStatTerm<Uint4> m_BatchEvents;
     CSrvStatTerm<Uint4> m_CntFiles;
     CSrvStatTerm<Uint8> m_DBSize;
     CSrvStatTerm<Uint8> m_GarbageSize;
@@ -176,6 +200,7 @@ private:
     CSrvStatTerm<size_t> m_WBMemSize;
     CSrvStatTerm<size_t> m_WBReleasable;
     CSrvStatTerm<size_t> m_WBReleasing;
+    CSrvStatTerm<size_t> m_RAMSize;
     auto_ptr<CSrvStat> m_SrvStat;
 };
 
@@ -75,6 +75,7 @@ static const char* kNCStorage_GarbagePctParam   = "max_garbage_pct";
 static const char* kNCStorage_MinDBSizeParam    = "min_storage_size";
 static const char* kNCStorage_MoveLifeParam     = "min_lifetime_to_move";
 static const char* kNCStorage_FailedMoveParam   = "failed_move_delay";
+static const char* kNCStorage_MoveRateParam     = "max_move_rate";
 static const char* kNCStorage_GCBatchParam      = "gc_batch_size";
 static const char* kNCStorage_FlushTimeParam    = "sync_time_period";
 static const char* kNCStorage_ExtraGCOnParam    = "db_limit_del_old_on";
@@ -216,6 +217,11 @@ static int s_FlushTimePeriod = 0;
 static int s_MaxGarbagePct = 0;
 static int s_MinMoveLife     = 0;
 static int s_FailedMoveDelay = 0;
+static Uint8 s_MaxMoveRate  = 0;
+/// Number of files worth compacting found during the last check
+static Uint4 s_CntShrinkFiles = 0;
+/// Database file being compacted now
+static Uint4 s_ShrinkFileId = 0;
 static Int8 s_MinDBSize     = 0;
 /// Name of guard file excluding several instances to run on the same
 /// database.
@@ -533,6 +539,8 @@ s_ReadVariableParams(const CNcbiRegistry& reg)
     s_MinDBSize = NStr::StringToUInt8_DataSize(str);
     s_MinMoveLife = reg.GetInt(kNCStorage_RegSection, kNCStorage_MoveLifeParam, 1000);
     s_FailedMoveDelay = reg.GetInt(kNCStorage_RegSection, kNCStorage_FailedMoveParam, 10);
+    str = reg.GetString(kNCStorage_RegSection, kNCStorage_MoveRateParam, "0");
+    s_MaxMoveRate = NStr::StringToUInt8_DataSize(str);
 
     s_MinRecNoSavePeriod = reg.GetInt(kNCStorage_RegSection, kNCStorage_MinRecNoSaveParam, 30);
     s_FlushTimePeriod = reg.GetInt(kNCStorage_RegSection, kNCStorage_FlushTimeParam, 0);
@@ -576,6 +584,10 @@ s_ReadVariableParams(const CNcbiRegistry& reg)
     int to1 = reg.GetInt(kNCStorage_RegSection, "write_back_timeout_startup", to2);
     SetWBWriteTimeout( CNCServer::IsInitiallySynced() ? to2 : to1, to2);
     SetWBFailedWriteDelay(reg.GetInt(kNCStorage_RegSection, "write_back_failed_delay", 2));
+    SetRAMCacheSizeLimit(NStr::StringToUInt8_DataSize(reg.GetString(
+                       kNCStorage_RegSection, "ram_cache_size_limit", "0")));
+    SetRAMCacheMaxBlobSize(NStr::StringToUInt8_DataSize(reg.GetString(
+                       kNCStorage_RegSection, "ram_cache_max_blob_size", "64 KB")));
 
     int failed_write = reg.GetInt(kNCStorage_RegSection, kNCStorage_FailedWriteSize, 0);
     CNCBlobAccessor::SetFailedWriteCount((Uint4)failed_write);
@@ -1348,6 +1360,9 @@ void CNCBlobStorage::WriteSetup(CSrvSocketTask& task)
     task.WriteText(eol).WriteText(kNCStorage_MinDBSizeParam   ).WriteText(is ).WriteNumber( s_MinDBSize);
     task.WriteText(eol).WriteText(kNCStorage_MoveLifeParam    ).WriteText(is ).WriteNumber( s_MinMoveLife);
     task.WriteText(eol).WriteText(kNCStorage_FailedMoveParam  ).WriteText(is ).WriteNumber( s_FailedMoveDelay);
+    task.WriteText(eol).WriteText(kNCStorage_MoveRateParam    ).WriteText(str).WriteText(iss)
+                                                   .WriteText(NStr::UInt8ToString_DataSize( s_MaxMoveRate)).WriteText(eos);
+    task.WriteText(eol).WriteText(kNCStorage_MoveRateParam    ).WriteText(is ).WriteNumber( s_MaxMoveRate);
     task.WriteText(eol).WriteText(kNCStorage_MinRecNoSaveParam).WriteText(is ).WriteNumber( s_MinRecNoSavePeriod);
     task.WriteText(eol).WriteText(kNCStorage_FlushTimeParam   ).WriteText(is ).WriteNumber( s_FlushTimePeriod);
     task.WriteText(eol).WriteText(kNCStorage_ExtraGCOnParam   ).WriteText(is ).WriteNumber( s_ExtraGCOnSize);
@@ -1373,6 +1388,10 @@ void CNCBlobStorage::WriteSetup(CSrvSocketTask& task)
     task.WriteText(eol).WriteText("write_back_hard_size_limit").WriteText(is ).WriteNumber( GetWBHardSizeLimit());
     task.WriteText(eol).WriteText("write_back_timeout"        ).WriteText(is ).WriteNumber( GetWBWriteTimeout());
     task.WriteText(eol).WriteText("write_back_failed_delay"   ).WriteText(is ).WriteNumber( GetWBFailedWriteDelay());
+    task.WriteText(eol).WriteText("ram_cache_size_limit"      ).WriteText(str).WriteText(iss)
+                                                   .WriteText(NStr::UInt8ToString_DataSize( GetRAMCacheSizeLimit())).WriteText(eos);
+    task.WriteText(eol).WriteText("ram_cache_size_limit"      ).WriteText(is ).WriteNumber( GetRAMCacheSizeLimit());
+    task.WriteText(eol).WriteText("ram_cache_max_blob_size"   ).WriteText(is ).WriteNumber( GetRAMCacheMaxBlobSize());
     task.WriteText(eol).WriteText(kNCStorage_FailedWriteSize  ).WriteText(is ).WriteNumber( CNCBlobAccessor::GetFailedWriteCount());
 }
 
@@ -2515,6 +2534,24 @@ CNCAlerts::Register(CNCAlerts::eDebugReadChunkData4, "ReadChunkData: data_inf");
     return true;
 }
 
+bool
+CNCBlobStorage::FindDBFile(const char* data, CSrvRef<SNCDBFileInfo>& file_info)
+{
+    file_info.Reset();
+    s_DBFilesLock.Lock();
+    ITERATE(TNCDBFilesMap, it, (*s_DBFiles)) {
+        const SNCDBFileInfo* info = it->second.GetPointerOrNull();
+        if (info->file_map  &&  data >= info->file_map
+            &&  data < info->file_map + info->file_size)
+        {
+            file_info = it->second;
+            break;
+        }
+    }
+    s_DBFilesLock.Unlock();
+    return file_info.NotNull();
+}
+
 char*
 CNCBlobStorage::WriteChunkData(SNCBlobVerData* ver_data,
                                SNCChunkMaps* maps,
@@ -2853,6 +2890,14 @@ CNCBlobStorage::MeasureDB(SNCStateStat& state)
     }
     if (state.min_dead_time == numeric_limits<int>::max())
         state.min_dead_time = 0;
+
+    state.shrink_files = s_CntShrinkFiles;
+    state.shrink_file_id = s_ShrinkFileId;
+    if (state.shrink_file_id != 0) {
+        CSrvRef<SNCDBFileInfo> file_info = s_GetDBFileTry(state.shrink_file_id);
+        if (file_info.NotNull())
+            state.shrink_file_used = file_info->used_size;
+    }
 }
 
 void
@@ -4058,6 +4103,11 @@ CNCAlerts::Register(CNCAlerts::eDebugMoveRecord3,"eFileRecChunkData");
 
     ++m_CntMoved;
     m_SizeMoved += m_IndRec->rec_size + sizeof(SFileIndexRec);
+    if (m_RateTime != CSrvTime::CurSecs()) {
+        m_RateTime = CSrvTime::CurSecs();
+        m_RateSize = 0;
+    }
+    m_RateSize += m_IndRec->rec_size + sizeof(SFileIndexRec);
 
     return &CSpaceShrinker::x_FinishMoveRecord;
 
@@ -4083,7 +4133,9 @@ CSpaceShrinker::x_PrepareToShrink(void)
                      &&  s_GarbageSize * 100 > s_CurDBSize * s_MaxGarbagePct;
     m_MaxFile = NULL;
 
+    // share of the file which will be reclaimed when all live data is moved
     double max_pct = 0;
+    Uint4 cnt_shrink_files = 0;
     Uint8 total_rel_used = 0;
     Uint8 total_rel_garb = 0;
 
@@ -4112,12 +4164,12 @@ CSpaceShrinker::x_PrepareToShrink(void)
                 this_file->info_lock.Lock();
                 this_file->is_releasing = false;
                 if (this_file->garb_size + this_file->used_size != 0) {
-#if 0
-                    double this_pct = double(this_file->garb_size)
-                                      / (this_file->garb_size + this_file->used_size);
-#else
-                    double this_pct = double(this_file->garb_size) / double(this_file->file_size);
-#endif
+                    // Files with the least live data give the most space
+                    // back for the least amount of moving
+                    double this_pct = 1 - double(this_file->used_size)
+                                          / double(this_file->file_size);
+                    if (this_pct * 100 > s_MaxGarbagePct)
+                        ++cnt_shrink_files;
                     if (this_pct > max_pct) {
                         max_pct = this_pct;
                         m_MaxFile = this_file;
@@ -4134,6 +4186,7 @@ CSpaceShrinker::x_PrepareToShrink(void)
         }
     }
     s_DBFilesLock.Unlock();
+    s_CntShrinkFiles = cnt_shrink_files;
 
     if (max_pct < 0.9) {
         Uint8 proj_garbage = s_GarbageSize - total_rel_garb;
@@ -4166,6 +4219,7 @@ CSpaceShrinker::x_DeleteNextFile(void)
 #ifdef _DEBUG
 CNCAlerts::Register(CNCAlerts::eDebugDeleteFile,"x_DeleteNextFile");
 #endif
+    CNCStat::DBFileReclaimed((*m_CurDelFile)->file_size);
     s_DeleteDBFile(*m_CurDelFile, true);
     m_CurDelFile->Reset();
     ++m_CurDelFile;
@@ -4189,6 +4243,7 @@ CSpaceShrinker::x_StartMoves(void)
                  .PrintParam("_type", "move")
                  .PrintParam("file_id", m_MaxFile->file_id);
 
+    s_ShrinkFileId = m_MaxFile->file_id;
     m_Failed = false;
     m_PrevRecNum = 0;
     m_LastAlive = 0;
@@ -4204,6 +4259,10 @@ CSpaceShrinker::x_MoveNextRecord(void)
 {
     if (CTaskServer::IsInShutdown())
         return &CSpaceShrinker::x_FinishMoves;
+    if (x_NeedThrottle()) {
+        RunAfter(1);
+        return NULL;
+    }
 
     int cur_time = CSrvTime::CurSecs();
     m_MaxFile->info_lock.Lock();
@@ -4421,13 +4480,25 @@ CSpaceShrinker::x_FinishMoveRecord(void)
     return NULL;
 }
 
+bool
+CSpaceShrinker::x_NeedThrottle(void)
+{
+    // When writes are already stopped the space should be reclaimed
+    // as fast as possible.
+    if (s_MaxMoveRate == 0  ||  CNCBlobStorage::NeedStopWrite())
+        return false;
+    return m_RateTime == CSrvTime::CurSecs()  &&  m_RateSize >= s_MaxMoveRate;
+}
+
 CSpaceShrinker::State
 CSpaceShrinker::x_FinishMoves(void)
 {
     if (!m_Failed) {
         m_MaxFile->is_releasing = true;
-        if (m_MaxFile->used_size == 0)
+        if (m_MaxFile->used_size == 0) {
+            CNCStat::DBFileReclaimed(m_MaxFile->file_size);
             s_DeleteDBFile(m_MaxFile, true);
+        }
         else if (m_CntProcessed == 0) {
             SRV_LOG(Warning, "Didn't find anything to process in the file");
             m_MaxFile->next_shrink_time = CSrvTime::CurSecs() + max(s_MinMoveLife, 300);
@@ -4440,6 +4511,7 @@ CSpaceShrinker::x_FinishMoves(void)
         m_MaxFile->next_shrink_time = CSrvTime::CurSecs() + s_FailedMoveDelay;
     }
     m_MaxFile.Reset();
+    s_ShrinkFileId = 0;
 
     CSrvDiagMsg().PrintExtra()
                  .PrintParam("cnt_processed", m_CntProcessed)
@@ -4466,6 +4538,8 @@ CSpaceShrinker::x_FinishSession(void)
 }
 
 CSpaceShrinker::CSpaceShrinker(void)
+    : m_RateTime(0),
+      m_RateSize(0)
 {
 #if __NC_TASKS_MONITOR
     m_TaskName = "CSpaceShrinker";
@@ -173,6 +173,11 @@ public:
                                 Uint8 chunk_num,
                                 char* buffer,
                                 Uint4 buf_size);
+    /// Find database file which memory mapping contains the given address.
+    ///
+    /// @return
+    ///   TRUE if the file is found and stored in file_info.
+    static bool FindDBFile(const char* data, CSrvRef<SNCDBFileInfo>& file_info);
 
     static void ReferenceCacheData(SNCCacheData* cache_data);
     static void ReleaseCacheData(SNCCacheData* cache_data);
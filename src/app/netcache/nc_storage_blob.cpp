@@ -36,6 +36,7 @@
 #include "storage_types.hpp"
 #include "nc_stat.hpp"
 #include <set>
+#include <functional>
 
 BEGIN_NCBI_SCOPE
 
@@ -96,6 +97,29 @@ static Uint8 s_BlobNotify = 0;
 static Uint8 s_BlobNotifyTDiff = 0;
 static Uint8 s_BlobNotifyMaxTDiff = 0;
 
+typedef map<string, CSrvRef<SNCRAMBlob> > TRAMBlobMap;
+
+/// Number of rows in the access frequency sketch
+static const Uint1 kRAMSketchDepth = 4;
+/// Maximum access frequency counted by the sketch
+static const Uint1 kRAMMaxFreq = 15;
+/// Blob accessed less times than this is not admitted to RAM cache even if
+/// there's free space in it.
+static const Uint1 kRAMMinAdmitFreq = 2;
+
+static CMiniMutex s_RAMLock;
+static size_t s_RAMSizeLimit = 0;
+static size_t s_RAMMaxBlobSize = 65536;
+static size_t s_RAMCurSize = 0;
+static TRAMBlobMap s_RAMBlobs;
+/// Blobs in RAM cache, least recently used first
+static TRAMBlobList s_RAMList;
+/// Count-min sketch of blob access frequencies (kRAMSketchDepth rows)
+static vector<Uint1> s_RAMFreqs;
+static Uint4 s_RAMFreqMask = 0;
+static Uint4 s_RAMFreqAdds = 0;
+static Uint4 s_RAMResetPeriod = 0;
+
 
 static const size_t kVerManagerSize = sizeof(CNCBlobVerManager)
                                       + sizeof(CCurVerReader);
@@ -173,6 +197,151 @@ SetWBFailedWriteDelay(int delay)
     s_WBFailedWriteDelay = Uint2(delay);
 }
 
+static void
+s_RAMFreqIndexes(const string& key, Uint4* idx)
+{
+    Uint8 hash = Uint8(std::hash<string>()(key));
+    Uint4 h1 = Uint4(hash);
+    Uint4 h2 = Uint4(hash >> 32) | 1;
+    for (Uint1 i = 0; i < kRAMSketchDepth; ++i) {
+        idx[i] = i * (s_RAMFreqMask + 1) + ((h1 + i * h2) & s_RAMFreqMask);
+    }
+}
+
+static Uint1
+s_RAMEstimateFreq(const string& key)
+{
+    if (s_RAMFreqs.empty())
+        return 0;
+
+    Uint4 idx[kRAMSketchDepth];
+    s_RAMFreqIndexes(key, idx);
+    Uint1 freq = kRAMMaxFreq;
+    for (Uint1 i = 0; i < kRAMSketchDepth; ++i)
+        freq = min(freq, s_RAMFreqs[idx[i]]);
+    return freq;
+}
+
+static Uint1
+s_RAMIncrementFreq(const string& key)
+{
+    if (s_RAMFreqs.empty())
+        return 0;
+
+    Uint4 idx[kRAMSketchDepth];
+    s_RAMFreqIndexes(key, idx);
+    Uint1 freq = kRAMMaxFreq;
+    for (Uint1 i = 0; i < kRAMSketchDepth; ++i)
+        freq = min(freq, s_RAMFreqs[idx[i]]);
+    if (freq < kRAMMaxFreq) {
+        // conservative update: only the minimal counters are incremented
+        for (Uint1 i = 0; i < kRAMSketchDepth; ++i) {
+            if (s_RAMFreqs[idx[i]] == freq)
+                ++s_RAMFreqs[idx[i]];
+        }
+        ++freq;
+    }
+    // aging: all frequencies are halved periodically so that blobs hot
+    // long ago could be evicted by currently hot ones
+    if (++s_RAMFreqAdds >= s_RAMResetPeriod) {
+        for (size_t i = 0; i < s_RAMFreqs.size(); ++i)
+            s_RAMFreqs[i] >>= 1;
+        s_RAMFreqAdds /= 2;
+    }
+    return freq;
+}
+
+static void
+s_RAMResizeSketch(size_t size_limit)
+{
+    Uint4 width = 0;
+    if (size_limit != 0) {
+        // assume 1 KB for an average blob in cache
+        size_t cnt_blobs = size_limit / 1024;
+        width = 1024;
+        while (width < cnt_blobs  &&  width < (Uint4(1) << 22))
+            width <<= 1;
+    }
+    if (width == s_RAMFreqMask + 1  &&  !s_RAMFreqs.empty())
+        return;
+
+    vector<Uint1> freqs(size_t(width) * kRAMSketchDepth, 0);
+    s_RAMFreqs.swap(freqs);
+    s_RAMFreqMask = width - 1;
+    s_RAMFreqAdds = 0;
+    s_RAMResetPeriod = width * 10;
+}
+
+static void
+s_RAMRemoveBlob(TRAMBlobMap::iterator it)
+{
+    SNCRAMBlob* blob = it->second;
+    s_RAMCurSize -= blob->size;
+    s_RAMList.erase(s_RAMList.iterator_to(*blob));
+    s_RAMBlobs.erase(it);
+}
+
+static Uint4
+s_RAMEvict(size_t need_size)
+{
+    Uint4 cnt_evicted = 0;
+    while (s_RAMCurSize + need_size > s_RAMSizeLimit  &&  !s_RAMList.empty()) {
+        s_RAMRemoveBlob(s_RAMBlobs.find(s_RAMList.front().key));
+        ++cnt_evicted;
+    }
+    return cnt_evicted;
+}
+
+static bool
+s_RAMIsAdmissible(Uint1 freq, size_t size)
+{
+    if (freq < kRAMMinAdmitFreq  ||  size > s_RAMSizeLimit)
+        return false;
+
+    // TinyLFU: blob is admitted only if all blobs that would be evicted
+    // for it are accessed less frequently
+    size_t freed = 0;
+    TRAMBlobList::iterator it = s_RAMList.begin();
+    while (s_RAMCurSize - freed + size > s_RAMSizeLimit) {
+        if (s_RAMEstimateFreq(it->key) >= freq)
+            return false;
+        freed += it->size;
+        ++it;
+    }
+    return true;
+}
+
+Uint8
+GetRAMCacheSizeLimit(void)
+{
+    return s_RAMSizeLimit;
+}
+
+Uint8
+GetRAMCacheMaxBlobSize(void)
+{
+    return s_RAMMaxBlobSize;
+}
+
+void
+SetRAMCacheSizeLimit(Uint8 limit)
+{
+    s_RAMLock.Lock();
+    s_RAMSizeLimit = size_t(limit);
+    s_RAMResizeSketch(s_RAMSizeLimit);
+    Uint4 cnt_evicted = s_RAMEvict(0);
+    s_RAMLock.Unlock();
+
+    if (cnt_evicted != 0)
+        CNCStat::RAMCacheEvicted(cnt_evicted);
+}
+
+void
+SetRAMCacheMaxBlobSize(Uint8 size)
+{
+    s_RAMMaxBlobSize = size_t(size);
+}
+
 static inline SWriteBackData*
 s_GetWBData(void)
 {
@@ -599,6 +768,90 @@ CWriteBackControl::ResetStatCounters(void)
 }
 
 
+CSrvRef<SNCRAMBlob>
+CNCRAMCache::Find(const string&         key,
+                  const SNCBlobVerData* ver_data,
+                  bool&                 try_admit)
+{
+    CSrvRef<SNCRAMBlob> blob;
+    try_admit = false;
+    if (ACCESS_ONCE(s_RAMSizeLimit) == 0  ||  ver_data->size == 0
+        ||  ver_data->size > ACCESS_ONCE(s_RAMMaxBlobSize))
+    {
+        return blob;
+    }
+
+    s_RAMLock.Lock();
+    Uint1 freq = s_RAMIncrementFreq(key);
+    TRAMBlobMap::iterator it = s_RAMBlobs.find(key);
+    if (it != s_RAMBlobs.end()  &&  it->second->IsSameVersion(ver_data)) {
+        blob = it->second;
+        s_RAMList.erase(s_RAMList.iterator_to(*blob));
+        s_RAMList.push_back(*blob);
+    }
+    else {
+        try_admit = s_RAMIsAdmissible(freq, size_t(ver_data->size));
+    }
+    s_RAMLock.Unlock();
+
+    CNCStat::RAMCacheLookup(blob.NotNull());
+    return blob;
+}
+
+void
+CNCRAMCache::Insert(SNCRAMBlob* blob)
+{
+    CSrvRef<SNCRAMBlob> blob_ref(blob);
+    Uint4 cnt_evicted = 0;
+
+    s_RAMLock.Lock();
+    TRAMBlobMap::iterator it = s_RAMBlobs.find(blob->key);
+    if (it != s_RAMBlobs.end())
+        s_RAMRemoveBlob(it);
+    bool admitted = blob->size <= s_RAMMaxBlobSize
+                    &&  s_RAMIsAdmissible(s_RAMEstimateFreq(blob->key),
+                                          size_t(blob->size));
+    if (admitted) {
+        cnt_evicted = s_RAMEvict(size_t(blob->size));
+        s_RAMBlobs[blob->key] = blob_ref;
+        s_RAMList.push_back(*blob);
+        s_RAMCurSize += size_t(blob->size);
+    }
+    s_RAMLock.Unlock();
+
+    CNCStat::RAMCacheAdmission(admitted);
+    if (cnt_evicted != 0)
+        CNCStat::RAMCacheEvicted(cnt_evicted);
+}
+
+bool
+CNCRAMCache::BlobWritten(const string& key, Uint8 new_size)
+{
+    if (ACCESS_ONCE(s_RAMSizeLimit) == 0)
+        return false;
+
+    s_RAMLock.Lock();
+    TRAMBlobMap::iterator it = s_RAMBlobs.find(key);
+    if (it != s_RAMBlobs.end())
+        s_RAMRemoveBlob(it);
+    bool need_copy = new_size != 0  &&  new_size <= s_RAMMaxBlobSize
+                     &&  s_RAMIsAdmissible(s_RAMEstimateFreq(key),
+                                           size_t(new_size));
+    s_RAMLock.Unlock();
+
+    return need_copy;
+}
+
+void
+CNCRAMCache::ReadState(SNCStateStat& state)
+{
+    s_RAMLock.Lock();
+    state.ram_size = s_RAMCurSize;
+    state.ram_blobs = s_RAMList.size();
+    s_RAMLock.Unlock();
+}
+
+
 void
 CNCBlobVerManager::x_DeleteCurVersion(void)
 {
@@ -1059,6 +1312,33 @@ CWBMemDeleter::ExecuteRCU(void)
 }
 
 
+SNCRAMBlob::SNCRAMBlob(const string& blob_key, const SNCBlobVerData* ver_data)
+    : key(blob_key),
+      create_time(ver_data->create_time),
+      create_server(ver_data->create_server),
+      create_id(ver_data->create_id),
+      size(ver_data->size),
+      chunk_size(ver_data->chunk_size)
+{
+    data = (char*)malloc(size_t(size));
+}
+
+SNCRAMBlob::~SNCRAMBlob(void)
+{
+    free(data);
+}
+
+bool
+SNCRAMBlob::IsSameVersion(const SNCBlobVerData* ver_data) const
+{
+    return create_time == ver_data->create_time
+           &&  create_server == ver_data->create_server
+           &&  create_id == ver_data->create_id
+           &&  size == ver_data->size
+           &&  chunk_size == ver_data->chunk_size;
+}
+
+
 SNCBlobVerData::SNCBlobVerData(CNCBlobVerManager* mgr)
     :   size(0),
         create_time(0),
@@ -1505,6 +1785,7 @@ CNCBlobAccessor::Prepare(const string& key,
     m_CurChunk      = 0;
     m_ChunkPos      = 0;
     m_SizeRead      = 0;
+    m_RAMChecked    = false;
 }
 
 void
@@ -1528,6 +1809,8 @@ CNCBlobAccessor::Deinitialize(void)
             delete m_ChunkMaps;
             m_ChunkMaps = NULL;
         }
+        m_ReadFile.Reset();
+        m_RAMBlob.Reset();
         break;
     case eNCCreate:
     case eNCCopyCreate:
@@ -1613,7 +1896,8 @@ CNCBlobAccessor::GetReadMemSize(void)
     }
     if (m_Buffer) {
         if (m_ChunkPos < m_ChunkSize) {
-            m_Buffer = m_CurData->chunks[m_CurChunk];
+            if (m_RAMBlob.IsNull())
+                m_Buffer = m_CurData->chunks[m_CurChunk];
             return m_ChunkSize - m_ChunkPos;
         }
         ++m_CurChunk;
@@ -1624,6 +1908,14 @@ CNCBlobAccessor::GetReadMemSize(void)
     if (need_size > m_CurData->chunk_size)
         need_size = m_CurData->chunk_size;
 
+    if (!m_RAMChecked)
+        x_FindInRAMCache();
+    if (m_RAMBlob.NotNull()) {
+        m_Buffer = m_RAMBlob->data + m_CurChunk * m_CurData->chunk_size;
+        m_ChunkSize = Uint4(need_size);
+        return m_ChunkSize - m_ChunkPos;
+    }
+
     m_Buffer = ACCESS_ONCE(m_CurData->chunks[m_CurChunk]);
     if (m_Buffer) {
         m_ChunkSize = Uint4(need_size);
@@ -1654,13 +1946,100 @@ CNCBlobAccessor::MoveReadPos(Uint4 move_size)
 {
     m_ChunkPos += move_size;
     m_SizeRead += move_size;
-    if (m_CurData->cur_chunk_num > m_CurChunk
+    if (m_RAMBlob.NotNull()) {
+        CNCStat::RAMDataRead(move_size);
+    }
+    else if (m_CurData->cur_chunk_num > m_CurChunk
         &&  m_Buffer == m_CurData->chunks[m_CurChunk])
     {
         CNCStat::DiskDataRead(move_size);
     }
 }
 
+void
+CNCBlobAccessor::GetReadFileCoord(int& file_fd, Uint8& offset)
+{
+    file_fd = -1;
+    offset = 0;
+    // Chunks which are not written to disk yet live in write-back memory
+    if (m_RAMBlob.NotNull()  ||  m_CurData->cur_chunk_num <= m_CurChunk)
+        return;
+
+    const char* data = m_Buffer + m_ChunkPos;
+    if (m_ReadFile.IsNull()
+        ||  data < m_ReadFile->file_map
+        ||  data >= m_ReadFile->file_map + m_ReadFile->file_size)
+    {
+        if (!CNCBlobStorage::FindDBFile(data, m_ReadFile))
+            return;
+    }
+#ifdef NCBI_OS_LINUX
+    file_fd = m_ReadFile->fd;
+    offset = Uint8(data - m_ReadFile->file_map);
+#endif
+}
+
+void
+CNCBlobAccessor::x_FindInRAMCache(void)
+{
+    m_RAMChecked = true;
+    // Blobs not completely written to disk yet are in write-back memory anyway
+    if (m_CurData->cur_chunk_num != m_CurData->cnt_chunks)
+        return;
+
+    bool try_admit = false;
+    m_RAMBlob = CNCRAMCache::Find(m_BlobKey, m_CurData, try_admit);
+    if (try_admit)
+        m_RAMBlob = x_CopyToRAMCache(m_CurData);
+}
+
+CSrvRef<SNCRAMBlob>
+CNCBlobAccessor::x_CopyToRAMCache(SNCBlobVerData* ver_data)
+{
+    CSrvRef<SNCRAMBlob> blob(new SNCRAMBlob(m_BlobKey, ver_data));
+    if (!blob->data)
+        return CSrvRef<SNCRAMBlob>();
+
+    // Chunk maps are allocated here only for the copy (the accessor can be
+    // writing a blob), so they are freed before return
+    SNCChunkMaps* chunk_maps = NULL;
+    bool copied = true;
+    for (Uint8 num = 0; num < ver_data->cnt_chunks; ++num) {
+        Uint8 pos = num * ver_data->chunk_size;
+        Uint4 need_size = Uint4(min(ver_data->size - pos,
+                                    Uint8(ver_data->chunk_size)));
+        char* chunk = ACCESS_ONCE(ver_data->chunks[num]);
+        if (!chunk) {
+            if (!chunk_maps) {
+                chunk_maps = new SNCChunkMaps(ver_data->map_size);
+                s_AddCurrentMem(s_CalcChunkMapsSize(ver_data->map_size));
+            }
+            Uint4 chunk_size = 0;
+            // Errors will be reported when the data is read without cache
+            if (!CNCBlobStorage::ReadChunkData(ver_data, chunk_maps, num,
+                                               chunk, chunk_size)
+                ||  chunk_size != need_size)
+            {
+                copied = false;
+                break;
+            }
+            ACCESS_ONCE(ver_data->chunks[num]) = chunk;
+        }
+        if (ver_data->cur_chunk_num > num)
+            CNCStat::DiskDataRead(need_size);
+        memcpy(blob->data + pos, chunk, need_size);
+    }
+    if (chunk_maps) {
+        s_SubCurrentMem(s_CalcChunkMapsSize(ver_data->map_size));
+        delete chunk_maps;
+    }
+    if (!copied)
+        return CSrvRef<SNCRAMBlob>();
+
+    CNCRAMCache::Insert(blob.GetPointerOrNull());
+    return blob;
+}
+
 void
 CNCBlobAccessor::x_CreateNewData(void)
 {
@@ -1706,6 +2085,8 @@ CNCBlobAccessor::Finalize(void)
         m_Buffer = NULL;
     }
     m_VerManager->FinalizeWriting(m_NewData);
+    if (CNCRAMCache::BlobWritten(m_BlobKey, m_NewData->size))
+        x_CopyToRAMCache(m_NewData);
     if (m_CurData.NotNull() && m_CurData->update_received != 0) {
         CWriteBackControl::RecordNotifyUpdateBlob(m_CurData->update_received);
     }
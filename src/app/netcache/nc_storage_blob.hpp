@@ -99,6 +99,37 @@ private:
 };
 
 
+struct SRAMList_tag;
+typedef intr::list_base_hook<intr::tag<SRAMList_tag> >  TRAMBlobListHook;
+
+/// Copy of all data of a small blob version kept in RAM cache
+struct SNCRAMBlob : public CObject,
+                    public TRAMBlobListHook
+{
+    string  key;
+    Uint8   create_time;
+    Uint8   create_server;
+    Uint4   create_id;
+    Uint8   size;
+    Uint4   chunk_size;
+    char*   data;
+
+    SNCRAMBlob(const string& blob_key, const SNCBlobVerData* ver_data);
+    virtual ~SNCRAMBlob(void);
+
+    /// Check if this is a copy of the given blob version
+    bool IsSameVersion(const SNCBlobVerData* ver_data) const;
+
+private:
+    SNCRAMBlob(const SNCRAMBlob&);
+    SNCRAMBlob& operator= (const SNCRAMBlob&);
+};
+
+typedef intr::list<SNCRAMBlob,
+                   intr::base_hook<TRAMBlobListHook>,
+                   intr::constant_time_size<true> >     TRAMBlobList;
+
+
 class CNCBlobAccessor : public CSrvTransConsumer
 {
 public:
@@ -135,6 +166,11 @@ public:
     Uint4 GetReadMemSize(void);
     const void* GetReadMemPtr(void);
     void MoveReadPos(Uint4 move_size);
+    /// Get database file and offset in it of the data returned by
+    /// GetReadMemPtr(), so that it could be sent to socket directly from
+    /// the file (see CSrvSocketTask::WriteFromFile()). file_fd is set to -1
+    /// if data is not on disk yet.
+    void GetReadFileCoord(int& file_fd, Uint8& offset);
     unsigned int GetCurBlobTTL(void) const;
     unsigned int GetNewBlobTTL(void) const;
     /// Set blob's timeout after last access before it will be deleted.
@@ -227,6 +263,8 @@ private:
 
     void x_CreateNewData(void);
     void x_DelCorruptedVersion(void);
+    void x_FindInRAMCache(void);
+    CSrvRef<SNCRAMBlob> x_CopyToRAMCache(SNCBlobVerData* ver_data);
 
 
     /// Type of access requested for the blob
@@ -238,6 +276,12 @@ private:
     CSrvRef<SNCBlobVerData> m_CurData;
     CSrvRef<SNCBlobVerData> m_NewData;
     SNCChunkMaps*           m_ChunkMaps;
+    /// Database file the last data read was found in. Reference keeps
+    /// the file descriptor open while data is sent from it.
+    CSrvRef<SNCDBFileInfo>  m_ReadFile;
+    /// Copy of blob's data in RAM cache the data is read from
+    CSrvRef<SNCRAMBlob>     m_RAMBlob;
+    bool        m_RAMChecked;
     bool        m_HasError;
     bool        m_MetaInfoReady;
     bool        m_WriteMemRequested;
@@ -298,6 +342,40 @@ void SetWBFailedWriteDelay(int delay);
 void SetWBInitialSyncComplete(void);
 
 
+/// RAM cache for small frequently read blobs.
+/// Cache keeps copies of blobs data which is written to the database as
+/// usual, so hot reads don't touch database files at all, and hot blobs are
+/// not pushed out of OS page cache by large cold ones. Admission to the cache
+/// is TinyLFU-like: blob is admitted only if it was accessed more frequently
+/// than the least recently used blobs it would evict from the cache.
+class CNCRAMCache
+{
+public:
+    /// Find copy of the blob version data in cache and register access to
+    /// the blob. If the blob is not in cache then try_admit is set to TRUE
+    /// when it's worth copying blob data and calling Insert().
+    static CSrvRef<SNCRAMBlob> Find(const string&         key,
+                                    const SNCBlobVerData* ver_data,
+                                    bool&                 try_admit);
+    /// Add blob copy to cache if admission policy allows that.
+    static void Insert(SNCRAMBlob* blob);
+    /// Remove old copy of the blob after it was re-written.
+    ///
+    /// @return
+    ///   TRUE if the blob is hot enough for its new data to be copied to
+    ///   cache immediately.
+    static bool BlobWritten(const string& key, Uint8 new_size);
+    static void ReadState(SNCStateStat& state);
+};
+
+
+Uint8 GetRAMCacheSizeLimit(void);
+Uint8 GetRAMCacheMaxBlobSize(void);
+
+void SetRAMCacheSizeLimit(Uint8 limit);
+void SetRAMCacheMaxBlobSize(Uint8 size);
+
+
 class CWBMemDeleter : public CSrvRCUUser
 {
 public:
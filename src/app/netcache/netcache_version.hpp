@@ -41,7 +41,7 @@
 #define NETCACHED_STORAGE_VERSION_PATCH 0
 #define NETCACHED_PROTOCOL_VERSION_MAJOR 6
 #define NETCACHED_PROTOCOL_VERSION_MINOR 11
-#define NETCACHED_PROTOCOL_VERSION_PATCH 7
+#define NETCACHED_PROTOCOL_VERSION_PATCH 8
 #define NETCACHED_STORAGE_VERSION                           \
     BOOST_STRINGIZE(NETCACHED_STORAGE_VERSION_MAJOR) "."    \
     BOOST_STRINGIZE(NETCACHED_STORAGE_VERSION_MINOR) "."    \
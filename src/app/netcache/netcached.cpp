@@ -1012,6 +1012,7 @@ CNCServer::ReadCurState(SNCStateStat& state)
     CNCPeerControl::ReadCurState(state);
     state.sync_log_size = CNCSyncLog::GetLogSize();
     CWriteBackControl::ReadState(state);
+    CNCRAMCache::ReadState(state);
 }
 
 bool s_ReportPid(const string& pid_file)
@@ -1388,6 +1389,7 @@ cout << "inuse     = " << state.db_size - state.db_garb << endl;
 cout << "wb_size   = " << state.wb_size << endl;
 cout << "wb_releasable   = " << state.wb_releasable << endl;
 cout << "wb_releasing   = " << state.wb_releasing << endl;
+cout << "ram_size   = " << state.ram_size << endl;
 cout << "===============" << endl;
 }
 
@@ -61,6 +61,17 @@ static Uint4 s_ServersToSync = 0;
 
 
 
+static void
+s_LogMirrorQueueSize(int queue_size)
+{
+    if (s_MirrorLogFile) {
+        Uint8 cur_time = CSrvTime::Current().AsUSec();
+        fprintf(s_MirrorLogFile, "%" NCBI_UINT8_FORMAT_SPEC ",%d\n",
+                                 cur_time, queue_size);
+    }
+}
+
+
 static CMiniMutex s_RndLock;
 static CRandom s_Rnd(CRandom::TValue(time(NULL)));
 
@@ -195,7 +206,9 @@ CNCPeerControl::CNCPeerControl(Uint8 srv_id)
       m_InThrottle(false),
       m_MaybeThrottle(false),
       m_HasBGTasks(false),
-      m_InitiallySynced(false)
+      m_InitiallySynced(false),
+      m_BatchBytes(0),
+      m_BatchesInFlight(0)
 {
 #if __NC_TASKS_MONITOR
     m_TaskName = "CNCPeerControl";
@@ -537,6 +550,16 @@ retry:
         }
         is_locked = false;
     }
+    else if (conn && x_IsBatchReady(true)) {
+        // m_ObjLock is locked
+        TNCMirrorQueue batch;
+        x_TakeBatch(batch);
+        conn->SetReservedForBG(true);
+        x_IncBGConns();
+        m_ObjLock.Unlock();
+        is_locked = false;
+        conn->CopyBatch(batch);
+    }
     else if (m_HasBGTasks && conn) {
         // m_ObjLock is locked
         if (!m_SmallMirror.empty() || !m_BigMirror.empty()) {
@@ -677,6 +700,28 @@ CNCPeerControl::x_AddMirrorEvent(SNCMirrorEvent* event, Uint8 size)
 {
     sm_TotalCopyRequests.Add(1);
 
+    if (CNCDistributionConf::GetMirrorBatchSize() != 0  &&  AcceptsMirrorBatch()
+        &&  (event->evt_type == eSyncRemove
+             ||  (event->evt_type == eSyncWrite
+                  &&  size <= CNCDistributionConf::GetSmallBlobBoundary()
+                  &&  size <= CNCDistributionConf::GetMirrorBatchMaxSize())))
+    {
+        x_AddBatchEvent(event, size);
+    }
+    else {
+        x_QueueMirrorEvent(event, size);
+    }
+}
+
+void
+CNCPeerControl::RequeueMirrorEvent(SNCMirrorEvent* event, Uint8 size)
+{
+    x_QueueMirrorEvent(event, size);
+}
+
+void
+CNCPeerControl::x_QueueMirrorEvent(SNCMirrorEvent* event, Uint8 size)
+{
     m_ObjLock.Lock();
 // all blobs (size!=0) go into queue
 // this reduces response time
@@ -700,12 +745,7 @@ CNCPeerControl::x_AddMirrorEvent(SNCMirrorEvent* event, Uint8 size)
             m_HasBGTasks = true;
             m_ObjLock.Unlock();
 
-            int queue_size = s_MirrorQueueSize.Add(1);
-            if (s_MirrorLogFile) {
-                Uint8 cur_time = CSrvTime::Current().AsUSec();
-                fprintf(s_MirrorLogFile, "%" NCBI_UINT8_FORMAT_SPEC ",%d\n",
-                                         cur_time, queue_size);
-            }
+            s_LogMirrorQueueSize(s_MirrorQueueSize.Add(1));
         }
         else {
             m_ObjLock.Unlock();
@@ -715,6 +755,103 @@ CNCPeerControl::x_AddMirrorEvent(SNCMirrorEvent* event, Uint8 size)
     }
 }
 
+void
+CNCPeerControl::x_AddBatchEvent(SNCMirrorEvent* event, Uint8 size)
+{
+    event->blob_size = size;
+    event->queue_time = CSrvTime::Current().AsUSec();
+
+    m_ObjLock.Lock();
+    if (m_BatchMirror.size() >= CNCDistributionConf::GetMaxMirrorQueueSize()) {
+        m_ObjLock.Unlock();
+        sm_CopyReqsRejected.Add(1);
+        x_DeleteMirrorEvent(event);
+        return;
+    }
+    m_BatchMirror.push_back(event);
+    m_BatchBytes += size;
+    m_ObjLock.Unlock();
+
+    s_LogMirrorQueueSize(s_MirrorQueueSize.Add(1));
+    x_FlushMirrorBatch();
+}
+
+bool
+CNCPeerControl::x_IsBatchReady(bool conn_free)
+// m_ObjLock is locked on entrance
+{
+    if (m_BatchMirror.empty())
+        return false;
+    if (m_BatchMirror.size() >= CNCDistributionConf::GetMirrorBatchSize()
+        ||  m_BatchBytes >= CNCDistributionConf::GetMirrorBatchMaxSize())
+    {
+        return true;
+    }
+    Uint8 cur_time = CSrvTime::Current().AsUSec();
+    if (cur_time - m_BatchMirror.front()->queue_time
+                                >= CNCDistributionConf::GetMirrorBatchDelay())
+    {
+        return true;
+    }
+// while the previous batch is in flight let events accumulate;
+// otherwise there's no reason to wait if a connection is available
+    if (m_BatchesInFlight != 0)
+        return false;
+    return conn_free  ||  m_BusyConns.empty()  ||  CTaskServer::IsInShutdown();
+}
+
+void
+CNCPeerControl::x_TakeBatch(TNCMirrorQueue& batch)
+// m_ObjLock is locked on entrance
+{
+    Uint4 max_cnt = CNCDistributionConf::GetMirrorBatchSize();
+    Uint8 max_bytes = CNCDistributionConf::GetMirrorBatchMaxSize();
+    Uint8 bytes = 0;
+    while (!m_BatchMirror.empty()  &&  batch.size() < max_cnt) {
+        SNCMirrorEvent* event = m_BatchMirror.front();
+        if (!batch.empty()  &&  bytes + event->blob_size > max_bytes)
+            break;
+        bytes += event->blob_size;
+        batch.push_back(event);
+        m_BatchMirror.pop_front();
+    }
+    m_BatchBytes -= bytes;
+    ++m_BatchesInFlight;
+    s_MirrorQueueSize.Add(-int(batch.size()));
+}
+
+void
+CNCPeerControl::x_FlushMirrorBatch(void)
+{
+    m_ObjLock.Lock();
+    if (!x_IsBatchReady(false)  ||  !x_ReserveBGConn()) {
+        m_ObjLock.Unlock();
+        return;
+    }
+    TNCMirrorQueue batch;
+    x_TakeBatch(batch);
+    CNCActiveHandler* conn = x_GetBGConnImpl(); // m_ObjLock.Unlock
+    if (conn) {
+        conn->CopyBatch(batch);
+    }
+    else {
+        sm_CopyReqsRejected.Add(int(batch.size()));
+        ITERATE(TNCMirrorQueue, it, batch) {
+            x_DeleteMirrorEvent(*it);
+        }
+        MirrorBatchDone();
+        x_UnreserveBGConn();
+    }
+}
+
+void
+CNCPeerControl::MirrorBatchDone(void)
+{
+    m_ObjLock.Lock();
+    --m_BatchesInFlight;
+    m_ObjLock.Unlock();
+}
+
 void
 CNCPeerControl::MirrorUpdate(const CNCBlobKeyLight& key,
                               Uint2 slot,
@@ -802,7 +939,8 @@ CNCPeerControl::GetMirrorQueueSize(Uint8 srv_id)
 {
     CNCPeerControl* peer = Peer(srv_id);
     CMiniMutexGuard guard(peer->m_ObjLock);
-    return peer->m_SmallMirror.size() + peer->m_BigMirror.size();
+    return peer->m_SmallMirror.size() + peer->m_BigMirror.size()
+           + peer->m_BatchMirror.size();
 }
 
 void
@@ -902,6 +1040,8 @@ void CNCPeerControl::PrintState(CSrvSocketTask& task)
         task.WriteText(eol).WriteText("bGConns").WriteText(is).WriteNumber(peer->m_BGConns);
         task.WriteText(eol).WriteText("cntBusyConns").WriteText(is).WriteNumber(peer->m_BusyConns.size());
         task.WriteText(eol).WriteText("cntPooledConns").WriteText(is).WriteNumber(peer->m_PooledConns.size());
+        task.WriteText(eol).WriteText("batchQueueSize").WriteText(is).WriteNumber(peer->m_BatchMirror.size());
+        task.WriteText(eol).WriteText("batchesInFlight").WriteText(is).WriteNumber(peer->m_BatchesInFlight);
         task.WriteText("\n}");
     }
     task.WriteText("]");
@@ -1114,6 +1254,7 @@ CNCPeerControl::ExecuteSlice(TSrvThreadNum /* thr_num */)
 
     m_ObjLock.Unlock();
 
+    x_FlushMirrorBatch();
     RunAfter(1);
 }
 
@@ -1122,8 +1263,17 @@ CNCPeerControl::GetReadyForShutdown(void)
 {
     bool result = true;
 
+    x_FlushMirrorBatch();
     m_ObjLock.Lock();
     if (CTaskServer::IsInHardShutdown()) {
+        if (!m_BatchMirror.empty()) {
+            s_MirrorQueueSize.Add(-int(m_BatchMirror.size()));
+            ITERATE(TNCMirrorQueue, it, m_BatchMirror) {
+                x_DeleteMirrorEvent(*it);
+            }
+            m_BatchMirror.clear();
+            m_BatchBytes = 0;
+        }
         while (!m_Clients.empty()) {
             CNCActiveClientHub* hub = m_Clients.front();
             m_Clients.pop_front();
@@ -1150,7 +1300,7 @@ CNCPeerControl::GetReadyForShutdown(void)
     m_SyncList.clear();
     m_NextTaskSync = m_SyncList.end();
     x_UpdateHasTasks();
-    if (m_HasBGTasks)
+    if (m_HasBGTasks  ||  !m_BatchMirror.empty()  ||  m_BatchesInFlight != 0)
         result = false;
 
     if (result) {
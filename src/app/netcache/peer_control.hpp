@@ -62,6 +62,9 @@ struct SNCMirrorEvent
     Uint2   slot;
     CNCBlobKeyLight  key;
     Uint8   orig_rec_no;
+    // size of blob and time when event was put into batch queue
+    Uint8   blob_size;
+    Uint8   queue_time;
 
 
     SNCMirrorEvent(ENCSyncEvent typ,
@@ -71,7 +74,9 @@ struct SNCMirrorEvent
         : evt_type(typ),
           slot(slot_),
           key(key_),
-          orig_rec_no(rec_no)
+          orig_rec_no(rec_no),
+          blob_size(0),
+          queue_time(0)
     {}
 };
 
@@ -157,6 +162,8 @@ public:
     bool CreateNewSocket(CNCActiveHandler* conn);
     void PutConnToPool(CNCActiveHandler* conn);
     void ReleaseConn(CNCActiveHandler* conn);
+    void MirrorBatchDone(void);
+    void RequeueMirrorEvent(SNCMirrorEvent* event, Uint8 size);
 
     bool GetReadyForShutdown(void);
 
@@ -177,6 +184,7 @@ public:
     bool AcceptsBList2(void) const;
     bool AcceptsUserFlags(void) const;
     bool AcceptsPurge2(void) const;
+    bool AcceptsMirrorBatch(void) const;
 
 private:
     CNCPeerControl(Uint8 srv_id);
@@ -203,6 +211,11 @@ private:
     void x_ProcessUpdateEvent(SNCMirrorEvent* event);
     void x_ProcessMirrorEvent(CNCActiveHandler* conn, SNCMirrorEvent* event);
     void x_AddMirrorEvent(SNCMirrorEvent* event, Uint8 size);
+    void x_QueueMirrorEvent(SNCMirrorEvent* event, Uint8 size);
+    void x_AddBatchEvent(SNCMirrorEvent* event, Uint8 size);
+    bool x_IsBatchReady(bool conn_free);
+    void x_TakeBatch(TNCMirrorQueue& batch);
+    void x_FlushMirrorBatch(void);
     void x_UpdateHasTasks(void);
 
 
@@ -232,6 +245,9 @@ private:
     TNCClientHubsList m_Clients;
     TNCMirrorQueue m_SmallMirror;
     TNCMirrorQueue m_BigMirror;
+    TNCMirrorQueue m_BatchMirror;
+    Uint8 m_BatchBytes;
+    int m_BatchesInFlight;
     TNCActiveSyncList m_SyncList;
     TNCActiveSyncListIt m_NextTaskSync;
 };
@@ -323,6 +339,12 @@ CNCPeerControl::AcceptsPurge2(void) const
     return m_HostProtocol >= 61107;
 }
 
+inline bool
+CNCPeerControl::AcceptsMirrorBatch(void) const
+{
+    return m_HostProtocol >= 61108;
+}
+
 inline void
 CNCPeerControl::ConnOk(void)
 {
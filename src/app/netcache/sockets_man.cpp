@@ -45,6 +45,7 @@
 # include <arpa/inet.h>
 # include <netdb.h>
 # include <sys/epoll.h>
+# include <sys/sendfile.h>
 # include <unistd.h>
 # include <fcntl.h>
 # include <errno.h>
@@ -80,6 +81,10 @@ static const Uint2 kSockWriteBufSize = 2000;
 /// 16 Uint4s on x86_64 is the size of CPU's cacheline. And it should be more
 /// than enough for NetCache.
 static const Uint1 kMaxCntListeningSocks = 16;
+/// Maximum amount of data requested to be waited for in the socket before
+/// reading it with SetReadLowWater(). Kernel caps it at half of the socket's
+/// receive buffer anyway.
+static const Uint4 kSockMaxReadLowWater = 256 * 1024;
 
 
 #if NC_SOCKLIST_USE_TYPE == NC_SOCKLIST_USE_MEMBER_HOOK
@@ -164,6 +169,7 @@ static Uint1 s_OldSocksDelBatch = 0;
 static Uint8 s_ConnTimeout = 10;
 static string s_HostName;
 static Uint8 s_AcceptDelay = 1000000;
+static bool s_UseSendFile = false;
 
 
 extern Uint8 s_CurJiffies;
@@ -185,6 +191,7 @@ ConfigureSockets(const CNcbiRegistry* reg, CTempString section)
     if (s_OldSocksDelBatch < 10)
         s_OldSocksDelBatch = 10;
     s_AcceptDelay = Uint8(reg->GetInt(section, "socket_accept_delay", 1000)) * kUSecsPerMSec;
+    s_UseSendFile = reg->GetBool(section, "use_sendfile", false);
 }
 
 bool ReConfig_Sockets(const CTempString& section, const CNcbiRegistry& new_reg, string&)
@@ -202,6 +209,7 @@ void WriteSetup_Sockets(CSrvSocketTask& task)
     task.WriteText(eol).WriteText("min_socket_inactivity").WriteText(is ).WriteNumber( s_SocketTimeout);
     task.WriteText(eol).WriteText("sockets_cleaning_batch").WriteText(is ).WriteNumber( s_OldSocksDelBatch);
     task.WriteText(eol).WriteText("socket_accept_delay").WriteText(is ).WriteNumber( s_AcceptDelay / kUSecsPerMSec);
+    task.WriteText(eol).WriteText("use_sendfile").WriteText(is ).WriteBool( s_UseSendFile);
 }
 
 void
@@ -457,6 +465,7 @@ static void
 s_CleanSockResources(CSrvSocketTask* task)
 {
     task->m_Fd = -1;
+    task->m_RdLowWater = 1;
     CRequestContext* ctx = task->GetDiagCtx();
     ctx->SetBytesRd(task->m_ReadBytes);
     ctx->SetBytesWr(task->m_WrittenBytes);
@@ -882,7 +891,8 @@ retry:
 }
 
 static size_t
-s_WriteToSocket(CSrvSocketTask* task, const void* buf, size_t size)
+s_WriteToSocket(CSrvSocketTask* task, const void* buf, size_t size,
+                int flags = 0)
 {
     if (!task->m_SockCanWrite  &&  task->m_SeenWriteEvts == task->m_RegWriteEvts)
         return 0;
@@ -893,7 +903,7 @@ s_WriteToSocket(CSrvSocketTask* task, const void* buf, size_t size)
     ssize_t n_written = 0;
 #ifdef NCBI_OS_LINUX
 retry:
-    n_written = send(task->m_Fd, buf, size, 0);
+    n_written = send(task->m_Fd, buf, size, flags);
     if (n_written == -1) {
         int x_errno = errno;
         if (x_errno == EINTR)
@@ -915,6 +925,46 @@ retry:
     return size_t(n_written);
 }
 
+#ifdef NCBI_OS_LINUX
+/// Same as s_WriteToSocket() but data is taken directly from the file, so
+/// that it's not copied through user space. Returns size_t(-1) if the file
+/// cannot be sent this way.
+static size_t
+s_SendFileToSocket(CSrvSocketTask* task, int file_fd, Uint8 offset, size_t size)
+{
+    if (!task->m_SockCanWrite  &&  task->m_SeenWriteEvts == task->m_RegWriteEvts)
+        return 0;
+    if (size == 0)
+        return 0;
+
+    task->m_SeenWriteEvts = task->m_RegWriteEvts;
+    off_t file_pos = off_t(offset);
+retry:
+    ssize_t n_written = sendfile(task->m_Fd, file_fd, &file_pos, size);
+    if (n_written == -1) {
+        int x_errno = errno;
+        if (x_errno == EINTR)
+            goto retry;
+        if (x_errno == EAGAIN  ||  x_errno == EWOULDBLOCK) {
+            return 0;
+        }
+        if (x_errno == EINVAL  ||  x_errno == ENOSYS) {
+            LOG_WITH_ERRNO(Warning, "sendfile() is not supported, "
+                                    "disabling it", x_errno);
+            s_UseSendFile = false;
+            return size_t(-1);
+        }
+        LOG_WITH_ERRNO(Warning, "Error writing to socket", x_errno);
+        task->m_RegError = true;
+        n_written = 0;
+    }
+    task->m_WrittenBytes += n_written;
+    task->m_SockCanWrite = size_t(n_written) == size;
+
+    return size_t(n_written);
+}
+#endif
+
 static inline void
 s_CompactBuffer(char* buf, Uint2& size, Uint2& pos)
 {
@@ -1158,6 +1208,7 @@ CSrvSocketTask::CSrvSocketTask(void)
       m_Fd(-1),
       m_RdSize(0),
       m_RdPos(0),
+      m_RdLowWater(1),
       m_WrMemSize(kSockWriteBufSize),
       m_WrSize(0),
       m_WrPos(0),
@@ -1319,6 +1370,53 @@ CSrvSocketTask::Write(const void* buf, size_t size)
     }
 }
 
+size_t
+CSrvSocketTask::WriteFromFile(const void* buf, int file_fd, Uint8 offset,
+                              size_t size)
+{
+#ifdef NCBI_OS_LINUX
+    if (!s_UseSendFile  ||  file_fd == -1  ||  size < kSockMinWriteSize)
+        return Write(buf, size);
+
+    if (IsWriteDataPending()) {
+        // Whatever is in the write buffer (usually some header) goes first,
+        // and with MSG_MORE kernel can put it into one packet with the file
+        // data that follows.
+        s_CompactWrBuffer(this);
+        Uint2 n_written = Uint2(s_WriteToSocket(this, m_WrBuf, m_WrSize,
+                                                MSG_MORE));
+        m_WrPos += n_written;
+        if (IsWriteDataPending())
+            return 0;
+        s_CompactWrBuffer(this);
+    }
+    size_t n_written = s_SendFileToSocket(this, file_fd, offset, size);
+    if (n_written != size_t(-1))
+        return n_written;
+#endif
+    return Write(buf, size);
+}
+
+void
+CSrvSocketTask::SetReadLowWater(size_t size)
+{
+    Uint4 low_water = Uint4(min(size, size_t(kSockMaxReadLowWater)));
+    if (low_water == 0)
+        low_water = 1;
+    if (low_water == m_RdLowWater  ||  m_Fd == -1)
+        return;
+
+#ifdef NCBI_OS_LINUX
+    int value = int(low_water);
+    if (setsockopt(m_Fd, SOL_SOCKET, SO_RCVLOWAT, &value, sizeof(value)) != 0) {
+        LOG_WITH_ERRNO(Warning, "Cannot set socket's receive low water mark",
+                       errno);
+        return;
+    }
+#endif
+    m_RdLowWater = low_water;
+}
+
 void
 CSrvSocketTask::WriteData(const void* buf, size_t size)
 {
@@ -1459,6 +1557,7 @@ retry:
 
     m_ConnStartJfy = s_CurJiffies;
     m_Fd = sock;
+    m_RdLowWater = 1;
     s_CreateDiagRequest(this, GetLocalPort(), host, port);
     GetCurThread()->stat->SockOpenActive();
     AtomicAdd(s_TotalSockets, 1);
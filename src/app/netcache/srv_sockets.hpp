@@ -162,6 +162,13 @@ public:
     /// data into num and returns TRUE.
     template <typename NumType>
     bool ReadNumber(NumType* num);
+    /// Don't consider socket readable until at least the given amount of
+    /// data arrives in it (or EOF or error happens). This allows to read
+    /// big amounts of data (like large blobs) in large portions instead of
+    /// waking up on each network packet. Caller must be sure that the given
+    /// amount of data will come and must reset it back to 1 before reading
+    /// anything smaller.
+    void SetReadLowWater(size_t size);
 
     /// Write text into socket.
     /// The whole text message will be written, internal write buffer will be
@@ -184,6 +191,13 @@ public:
     /// amount of data written which can be 0 if socket is not writable at the
     /// moment.
     size_t Write(const void* buf, size_t size);
+    /// Same as Write() but for data that is also stored in the file file_fd
+    /// at the given offset. Data is sent directly from the file with
+    /// sendfile() whenever possible, so that it's not copied through user
+    /// space; buf is used if it's not possible (e.g. data is too small,
+    /// file_fd is -1 or sendfile() is disabled in configuration).
+    size_t WriteFromFile(const void* buf, int file_fd, Uint8 offset,
+                         size_t size);
     /// Flush all data saved in internal write buffers to socket.
     /// Method must be called from inside of ExecuteSlice() of this task and
     /// no other writing methods should be called until FlushIsDone() returns
@@ -287,6 +301,8 @@ public:
     /// [0, m_RdPos) was already read; data in [m_RdPos, m_RdSize) are queued
     /// for reading.
     Uint2 m_RdPos;
+    /// Current value of SO_RCVLOWAT option for the socket.
+    Uint4 m_RdLowWater;
     /// Size of memory allocated for write buffer. This size can grow in
     /// methods requiring exact writing like WriteData(), WriteText() etc.
     Uint2 m_WrMemSize;
@@ -319,6 +319,9 @@ private:
     State x_FinishSession(void);
 
     SNCDataCoord x_FindMetaCoord(SNCDataCoord coord, Uint1 max_map_depth);
+    /// Check if moves should pause till the next second to keep moving
+    /// rate under max_move_rate.
+    bool x_NeedThrottle(void);
 
 
     typedef vector<CSrvRef<SNCDBFileInfo> > TFilesList;
@@ -337,6 +340,8 @@ private:
     Uint4 m_CntProcessed;
     Uint4 m_CntMoved;
     Uint4 m_SizeMoved;
+    int m_RateTime;
+    Uint8 m_RateSize;
     bool m_Failed;
     bool m_MovingMeta;
     TFileRecsMap m_RecsMap;
@@ -88,6 +88,22 @@ private:
 
     void DeleteRandomBlobs(TTransactionLog* tlog, size_t bcount);
 
+    /// Read small blobs several times and re-write them.
+    /// With the RAM cache enabled on the server (ram_cache_size_limit)
+    /// the blobs are admitted to the cache and read from it, and new data
+    /// of re-written blobs is copied to the cache.
+    void StressTestHotBlobs(size_t blob_size, unsigned bcount);
+
+    /// Write large blobs in slices with pauses between them, so that the
+    /// server reads them in many parts and the last part is smaller than
+    /// a database chunk (kNCMaxBlobChunkSize), then read them back.
+    void StressTestChunkTail(void);
+
+    /// Send COPY_BATCH data (as a mirroring peer does) in slices with
+    /// pauses, so that the last piece is smaller than a database chunk,
+    /// and check that the server reads all of it and replies.
+    void StressTestBatchTail(void);
+
     /// Read BLOB according to the transaction log
     /// (all of them straight or randomly)
     void StressTestGet(const TTransactionLog& tlog,
@@ -326,6 +342,129 @@ void CTestNetCacheStress::DeleteRandomBlobs(TTransactionLog* tlog,
 }
 
 
+void CTestNetCacheStress::StressTestHotBlobs(size_t   blob_size,
+                                            unsigned bcount)
+{
+    TTransactionLog tlog;
+    StressTestPut(blob_size, bcount, &tlog);
+
+    // The first reads count accesses, then blobs come from the RAM cache
+    for (int i = 0; i < 4; ++i) {
+        StressTestGet(tlog, false /*random*/, tlog.size());
+    }
+
+    // Re-write the blobs with a different size, so a stale cached copy
+    // would fail the size check
+    size_t new_size = blob_size / 2 + 1;
+    unsigned char* buf = NULL;
+    try {
+        NON_CONST_ITERATE(TTransactionLog, ti, tlog) {
+            delete[] buf;
+            buf = AllocateTestBlob(new_size);
+            m_API.PutData(ti->key, buf, new_size);
+            ti->blob_size = new_size;
+            ti->time_stamp = GetFastLocalTime().AsString();
+        }
+    }
+    catch (exception& ex)
+    {
+        LOG_POST(Error << "BLOB re-write error: " << ex.what());
+    }
+    delete[] buf;
+
+    for (int i = 0; i < 2; ++i) {
+        StressTestGet(tlog, true /*random*/, tlog.size());
+    }
+    DeleteRandomBlobs(&tlog, tlog.size());
+}
+
+
+void CTestNetCacheStress::StressTestChunkTail(void)
+{
+    static const size_t kSizes[] = { 70000, 300 * 1024 + 5000,
+                                     1000 * 1024 + 100 };
+    static const size_t kSliceSize = 40 * 1024;
+
+    TTransactionLog tlog;
+    for (size_t i = 0; i < sizeof(kSizes) / sizeof(kSizes[0]); ++i) {
+        if (Int8(kSizes[i]) > s_MaxSize)
+            continue;
+        STransactionInfo ti;
+        ti.blob_size = kSizes[i];
+        ti.time_stamp = GetFastLocalTime().AsString();
+        unsigned char* buf = AllocateTestBlob(ti.blob_size);
+        try {
+            auto_ptr<IEmbeddedStreamWriter> writer(m_API.PutData(&ti.key));
+            for (size_t pos = 0; pos < ti.blob_size; pos += kSliceSize) {
+                size_t n_written;
+                writer->Write(buf + pos, min(kSliceSize, ti.blob_size - pos),
+                              &n_written);
+                writer->Flush();
+                SleepMilliSec(10);
+            }
+            writer->Close();
+            tlog.push_back(ti);
+        }
+        catch (exception& ex)
+        {
+            LOG_POST(Error << "BLOB write error: " << ti.blob_size << " "
+                           << ex.what());
+        }
+        delete[] buf;
+    }
+
+    StressTestGet(tlog, false /*random*/, tlog.size());
+    DeleteRandomBlobs(&tlog, tlog.size());
+}
+
+
+void CTestNetCacheStress::StressTestBatchTail(void)
+{
+    static const size_t kSizes[] = { 70000, 300 * 1024 + 5000 };
+    static const size_t kSliceSize = 40 * 1024;
+    static const STimeout kTimeout = { 20, 0 };
+
+    CNetServer server(*m_API.GetService().Iterate());
+    for (size_t i = 0; i < sizeof(kSizes) / sizeof(kSizes[0]); ++i) {
+        string size_str = NStr::NumericToString(kSizes[i]);
+        string reply;
+        try {
+            CSocket sock(server.GetHost(), server.GetPort(), &kTimeout);
+            sock.SetTimeout(eIO_ReadWrite, &kTimeout);
+            string cmd = "client=stress_test\r\nCOPY_BATCH 1 1 "
+                         + size_str + " " + size_str + "\r\n";
+            sock.Write(cmd.data(), cmd.size());
+            if (sock.ReadLine(reply) != eIO_Success
+                ||  !NStr::StartsWith(reply, "OK:"))
+            {
+                LOG_POST(Error << "COPY_BATCH rejected: " << reply);
+                continue;
+            }
+
+            // Only the signature is valid, the server is expected to
+            // report the embedded command as failed
+            vector<char> data(kSizes[i], 0);
+            Uint4 start_word = 0x01020304;
+            memcpy(&data[0], &start_word, sizeof(start_word));
+            for (size_t pos = 0; pos < data.size(); pos += kSliceSize) {
+                sock.Write(&data[pos], min(kSliceSize, data.size() - pos));
+                SleepMilliSec(10);
+            }
+            if (sock.ReadLine(reply) != eIO_Success
+                ||  !NStr::StartsWith(reply, "OK:CNT="))
+            {
+                LOG_POST(Error << "COPY_BATCH of " << size_str
+                               << " bytes failed: " << reply);
+            }
+        }
+        catch (exception& ex)
+        {
+            LOG_POST(Error << "COPY_BATCH error: " << ex.what());
+        }
+    }
+}
+
+
 unsigned char* CTestNetCacheStress::AllocateTestBlob(size_t blob_size) const
 {
     if (blob_size == 0) {
@@ -418,6 +557,11 @@ int CTestNetCacheStress::Run(void)
 
     StressTestGet(m_Log, true /*random*/, m_Log.size());
 
+    StressTestHotBlobs(size_t(min(s_MaxSize, Int8(32 * 1024))), 50);
+
+    StressTestChunkTail();
+    StressTestBatchTail();
+
     return 0;
 }
 
@@ -410,6 +410,13 @@ CJob::EJobFetchResult CJob::x_Fetch(CQueue* queue)
 
 CJob::EJobFetchResult  CJob::Fetch(CQueue *  queue, unsigned  id)
 {
+    CNSJobStore &   job_store = queue->m_QueueDbBlock->job_store;
+    if (job_store.IsEnabled()) {
+        if (job_store.Fetch(id, *this))
+            return eJF_Ok;
+        return eJF_NotFound;
+    }
+
     SJobDB &        job_db = queue->m_QueueDbBlock->job_db;
 
     job_db.id = id;
@@ -429,14 +436,39 @@ CJob::EJobFetchResult  CJob::Fetch(CQueue *  queue, unsigned  id)
 
 bool CJob::Flush(CQueue* queue)
 {
+    CNSJobStore &   job_store = queue->m_QueueDbBlock->job_store;
+
     if (m_Deleted) {
         queue->EraseJob(m_Id, m_Status);
+        // The journal must not resurrect the job after a crash
+        if (job_store.IsEnabled())
+            job_store.Erase(m_Id);
         return true;
     }
 
     if (m_Dirty == 0 && m_New == false)
         return true;
 
+    if (job_store.IsEnabled()) {
+        // The tokens are needed only to restore a new job from the journal;
+        // the identifiers are valid within this server instance only
+        string      aff_token;
+        string      group;
+        if (m_New) {
+            aff_token = queue->GetAffinityTokenByID(m_AffinityId);
+            group = queue->GetGroupTokenByID(m_GroupId);
+        }
+
+        NON_CONST_ITERATE(vector<CJobEvent>, it, m_Events) {
+            it->m_Dirty = false;
+        }
+        m_New = false;
+        m_Dirty = 0;
+
+        job_store.Put(*this, aff_token, group);
+        return true;
+    }
+
     SJobDB &        job_db      = queue->m_QueueDbBlock->job_db;
     SJobInfoDB &    job_info_db = queue->m_QueueDbBlock->job_info_db;
     SEventsDB &     events_db   = queue->m_QueueDbBlock->events_db;
@@ -352,6 +352,35 @@ CNSAffinityRegistry::GetJobsWithAffinities(const TNSBitVector &  affs) const
 }
 
 
+// Provides the first job of the affinity which is also in the candidates
+// vector. The affinity jobs are scanned in place so that neither the
+// affinity jobs vector is copied nor a temporary intersection is built.
+// It matters for batch job requests where the same affinity is probed
+// once per each job in a batch.
+unsigned int
+CNSAffinityRegistry::GetFirstJobWithAffinity(
+                                unsigned int          aff_id,
+                                const TNSBitVector &  candidates) const
+{
+    if (aff_id == 0)
+        return 0;
+
+    CMutexGuard                             guard(m_Lock);
+    map< unsigned int,
+         SNSJobsAffinity >::const_iterator  found = m_JobsAffinity.find(aff_id);
+
+    if (found == m_JobsAffinity.end())
+        return 0;
+
+    TNSBitVector::enumerator    en(found->second.m_Jobs.first());
+    for ( ; en.valid(); ++en) {
+        if (candidates.get_bit(*en))
+            return *en;
+    }
+    return 0;
+}
+
+
 TNSBitVector
 CNSAffinityRegistry::GetRegisteredAffinities(void) const
 {
@@ -177,6 +177,9 @@ class CNSAffinityRegistry
         unsigned int  ResolveAffinity(const string &  token);
         TNSBitVector  GetJobsWithAffinity(unsigned int  aff_id) const;
         TNSBitVector  GetJobsWithAffinities(const TNSBitVector &  affs) const;
+        unsigned int  GetFirstJobWithAffinity(
+                                unsigned int          aff_id,
+                                const TNSBitVector &  candidates) const;
         TNSBitVector  GetRegisteredAffinities(void) const;
         void  RemoveJobFromAffinity(unsigned int  job_id, unsigned int  aff_id);
         size_t  RemoveClientFromAffinities(unsigned int          client_id,
@@ -55,6 +55,10 @@ const string    kEndOfResponse = "\n";
 const string    kOKCompleteResponse = "OK:" + kEndOfResponse;
 const string    kErrNoJobFoundResponse = "ERR:eJobNotFound:" + kEndOfResponse;
 const string    kOKResponsePrefix = "OK:";
+const string    kOKEndResponse = "OK:END" + kEndOfResponse;
+
+// The max number of jobs in one GETB/PUTB request
+const unsigned int  kMaxJobBatchSize = 1000;
 
 
 
@@ -82,6 +86,14 @@ SNSProtoArgument s_BatchArgs[] = {
     { NULL }
 };
 
+SNSProtoArgument s_PutBatchArgs[] = {
+    { "job_key",         eNSPT_Id,  eNSPA_Required },
+    { "auth_token",      eNSPT_Id,  eNSPA_Required },
+    { "job_return_code", eNSPT_Id,  eNSPA_Required },
+    { "output",          eNSPT_Str, eNSPA_Required },
+    { NULL }
+};
+
 CNetScheduleHandler::SCommandMap CNetScheduleHandler::sm_CommandMap[] = {
 
     { "SHUTDOWN",      { &CNetScheduleHandler::x_ProcessShutdown,
@@ -431,6 +443,20 @@ CNetScheduleHandler::SCommandMap CNetScheduleHandler::sm_CommandMap[] = {
           { "sid",               eNSPT_Str, eNSPA_Optional, ""  },
           { "ncbi_phid",         eNSPT_Str, eNSPA_Optional, ""  },
           { "prioritized_aff",   eNSPT_Int, eNSPA_Optional, "0" } } },
+    { "GETB",          { &CNetScheduleHandler::x_ProcessGetJobBatch,
+                         eNS_Queue | eNS_Worker | eNS_Program },
+        { { "count",             eNSPT_Int, eNSPA_Required      },
+          { "wnode_aff",         eNSPT_Int, eNSPA_Required, "0" },
+          { "any_aff",           eNSPT_Int, eNSPA_Required, "0" },
+          { "exclusive_new_aff", eNSPT_Int, eNSPA_Optional, "0" },
+          { "aff",               eNSPT_Str, eNSPA_Optional, ""  },
+          { "port",              eNSPT_Int, eNSPA_Optional      },
+          { "timeout",           eNSPT_Int, eNSPA_Optional      },
+          { "group",             eNSPT_Str, eNSPA_Optional, ""  },
+          { "ip",                eNSPT_Str, eNSPA_Optional, ""  },
+          { "sid",               eNSPT_Str, eNSPA_Optional, ""  },
+          { "ncbi_phid",         eNSPT_Str, eNSPA_Optional, ""  },
+          { "prioritized_aff",   eNSPT_Int, eNSPA_Optional, "0" } } },
     { "PUT",           { &CNetScheduleHandler::x_ProcessPut,
                          eNS_Queue | eNS_Worker | eNS_Program },
         { { "job_key",           eNSPT_Id,  eNSPA_Required      },
@@ -448,6 +474,12 @@ CNetScheduleHandler::SCommandMap CNetScheduleHandler::sm_CommandMap[] = {
           { "ip",                eNSPT_Str, eNSPA_Optional, ""  },
           { "sid",               eNSPT_Str, eNSPA_Optional, ""  },
           { "ncbi_phid",         eNSPT_Str, eNSPA_Optional, ""  } } },
+    { "PUTB",          { &CNetScheduleHandler::x_ProcessPutBatch,
+                         eNS_Queue | eNS_Worker | eNS_Program },
+        { { "count",             eNSPT_Int, eNSPA_Required      },
+          { "ip",                eNSPT_Str, eNSPA_Optional, ""  },
+          { "sid",               eNSPT_Str, eNSPA_Optional, ""  },
+          { "ncbi_phid",         eNSPT_Str, eNSPA_Optional, ""  } } },
     { "RETURN",        { &CNetScheduleHandler::x_ProcessReturn,
                          eNS_Queue | eNS_Worker | eNS_Program },
         { { "job_key",           eNSPT_Id,  eNSPA_Required      },
@@ -608,6 +640,8 @@ CNetScheduleHandler::CNetScheduleHandler(CNetScheduleServer* server)
       m_BatchPos(0),
       m_BatchSubmPort(0),
       m_WithinBatchSubmit(false),
+      m_PutBatchSize(0),
+      m_PutBatchPos(0),
       m_SingleCmdParser(sm_CommandMap),
       m_BatchHeaderParser(sm_BatchHeaderMap),
       m_BatchEndParser(sm_BatchEndMap),
@@ -933,6 +967,11 @@ CNetScheduleHandler::x_PrepareWriteBuffer(const string &  msg,
 
 EIO_Status CNetScheduleHandler::x_WriteMessage(const string &  msg)
 {
+    // The reply confirms the job changes so they must reach the journal
+    // disk first. The sync is shared with the concurrently committing
+    // threads.
+    CNSJobStore::WaitForCommit();
+
     size_t  msg_size = msg.size();
     bool    has_eom = false;
 
@@ -1590,6 +1629,65 @@ void CNetScheduleHandler::x_ProcessMsgBatchSubmit(BUF buffer)
 }
 
 
+// Message processor for x_ProcessPutBatch
+void CNetScheduleHandler::x_ProcessMsgPutBatchJob(BUF buffer)
+{
+    // Expecting:
+    // job_key=... auth_token=... job_return_code=... output="..."
+    string          msg;
+    s_ReadBufToString(buffer, msg);
+
+    TNSProtoParams  params;
+    try {
+        m_BatchEndParser.ParseArguments(msg, s_PutBatchArgs, &params);
+    }
+    catch (const CNSProtoParserException &  ex) {
+        m_PutBatchResponse.clear();
+        m_ProcessMessage = &CNetScheduleHandler::x_ProcessMsgRequest;
+        x_OnCmdParserError(false, ex.GetMsg(), "");
+        return;
+    }
+
+    // The job related errors do not break the batch; they are reported
+    // for each job individually
+    string      job_response;
+    try {
+        m_CommandArguments.AssignValues(params, "PUTB", false, GetSocket(),
+                                        m_Server->GetCompoundIDPool());
+        CRef<CQueue>    queue_ref(GetQueue());
+        job_response = x_PutBatchJob(queue_ref.GetPointer());
+    }
+    catch (const CNetScheduleException &  ex) {
+        ERR_POST(Warning << "Cannot accept job "
+                         << m_CommandArguments.job_key
+                         << " results in a batch: " << ex.GetMsg());
+        job_response = "result=ERR&code=" +
+                       string(ex.GetErrCodeString()) +
+                       "&message=" + NStr::URLEncode(ex.GetMsg());
+    }
+    catch (const exception &  ex) {
+        ERR_POST("Error processing a batch put job "
+                 << m_CommandArguments.job_key << ": " << ex.what());
+        job_response = "result=ERR&code=eInternalError&message=" +
+                       NStr::URLEncode(ex.what());
+    }
+
+    m_PutBatchResponse += "OK:job_key=" + m_CommandArguments.job_key +
+                          "&" + job_response + kEndOfResponse;
+
+    if (++m_PutBatchPos < m_PutBatchSize)
+        return;
+
+    // All the results are reported at once so that the client pays for a
+    // single round trip and the journal commits are grouped
+    string      response;
+    response.swap(m_PutBatchResponse);
+    m_ProcessMessage = &CNetScheduleHandler::x_ProcessMsgRequest;
+    x_WriteMessage(response + kOKEndResponse);
+    x_PrintCmdRequestStop();
+}
+
+
 //////////////////////////////////////////////////////////////////////////
 // Process* methods for processing commands
 
@@ -2215,6 +2313,112 @@ void CNetScheduleHandler::x_ProcessGetJob(CQueue* q)
 }
 
 
+void CNetScheduleHandler::x_ProcessGetJobBatch(CQueue* q)
+{
+    x_CheckNonAnonymousClient("use GETB command");
+    x_CheckPortAndTimeout();
+    x_CheckGetParameters();
+
+    if (m_CommandArguments.count == 0 ||
+        m_CommandArguments.count > kMaxJobBatchSize)
+        NCBI_THROW(CNetScheduleException, eInvalidParameter,
+                   "The count parameter must be between 1 and " +
+                   NStr::NumericToString(kMaxJobBatchSize));
+
+    // Check if the queue is paused
+    CQueue::TPauseStatus    pause_status = q->GetPauseStatus();
+    if (pause_status != CQueue::eNoPause) {
+
+        if (m_CommandArguments.timeout != 0)
+            q->RegisterQueueResumeNotification(m_ClientId.GetAddress(),
+                                               m_CommandArguments.port,
+                                               true);
+
+        string      pause_status_str;
+
+        if (pause_status == CQueue::ePauseWithPullback)
+            pause_status_str = "pullback";
+        else
+            pause_status_str = "nopullback";
+
+        x_WriteMessage("OK:pause=" + pause_status_str + kEndOfResponse +
+                       kOKEndResponse);
+
+        if (x_NeedCmdLogging())
+            GetDiagContext().Extra().Print("job_key", "None")
+                                    .Print("reason",
+                                           "pause: " + pause_status_str);
+
+        x_PrintCmdRequestStop();
+        return;
+    }
+
+    list<string>    aff_list;
+    NStr::Split(m_CommandArguments.affinity_token,
+                "\t,", aff_list, NStr::fSplit_NoMergeDelims);
+    list<string>    group_list;
+    NStr::Split(m_CommandArguments.group,
+                "\t,", group_list, NStr::fSplit_NoMergeDelims);
+
+    vector<CJob>    jobs;
+    string          added_pref_aff;
+    x_ClearRollbackAction();
+    if (q->GetJobs(m_ClientId,
+                   m_CommandArguments.port,
+                   m_CommandArguments.timeout,
+                   CNSPreciseTime::Current(), &aff_list,
+                   m_CommandArguments.wnode_affinity,
+                   m_CommandArguments.any_affinity,
+                   m_CommandArguments.exclusive_new_aff,
+                   m_CommandArguments.prioritized_aff,
+                   &group_list,
+                   m_CommandArguments.count,
+                   jobs,
+                   m_RollbackAction,
+                   added_pref_aff) == false) {
+        // Preferred affinities were reset for the client, so no job
+        // and bad request
+        x_SetCmdRequestStatus(eStatus_BadRequest);
+        x_WriteMessage("ERR:ePrefAffExpired:" + kEndOfResponse);
+        x_PrintCmdRequestStop();
+        return;
+    }
+
+    string      response;
+    string      job_keys;
+    for (vector<CJob>::const_iterator  k = jobs.begin();
+         k != jobs.end(); ++k) {
+        response += "OK:" + x_GetJob2Response(q, *k) + kEndOfResponse;
+        if (!job_keys.empty())
+            job_keys += ",";
+        job_keys += q->MakeJobKey(k->GetId());
+    }
+
+    if (x_NeedCmdLogging()) {
+        if (jobs.empty())
+            GetDiagContext().Extra().Print("job_key", "None");
+        else
+            GetDiagContext().Extra().Print("job_keys", job_keys)
+                                    .Print("job_count", jobs.size());
+
+        if (!added_pref_aff.empty()) {
+            if (m_ClientIdentificationPrinted)
+                GetDiagContext().Extra()
+                    .Print("added_preferred_affinity", added_pref_aff);
+            else
+                GetDiagContext().Extra()
+                    .Print("client_node", m_ClientId.GetNode())
+                    .Print("client_session", m_ClientId.GetSession())
+                    .Print("added_preferred_affinity", added_pref_aff);
+        }
+    }
+
+    x_WriteMessage(response + kOKEndResponse);
+    x_ClearRollbackAction();
+    x_PrintCmdRequestStop();
+}
+
+
 void CNetScheduleHandler::x_ProcessCancelWaitGet(CQueue* q)
 {
     x_CheckNonAnonymousClient("cancel waiting after WGET");
@@ -2303,6 +2507,85 @@ void CNetScheduleHandler::x_ProcessPut(CQueue* q)
 }
 
 
+void CNetScheduleHandler::x_ProcessPutBatch(CQueue* q)
+{
+    x_CheckNonAnonymousClient("use PUTB command");
+
+    if (m_CommandArguments.count == 0 ||
+        m_CommandArguments.count > kMaxJobBatchSize)
+        NCBI_THROW(CNetScheduleException, eInvalidParameter,
+                   "The count parameter must be between 1 and " +
+                   NStr::NumericToString(kMaxJobBatchSize));
+
+    m_PutBatchSize = m_CommandArguments.count;
+    m_PutBatchPos = 0;
+    m_PutBatchResponse.clear();
+
+    x_WriteMessage("OK:Batch put ready" + kEndOfResponse);
+    m_ProcessMessage = &CNetScheduleHandler::x_ProcessMsgPutBatchJob;
+}
+
+
+// Puts the results of one job from a PUTB batch. Provides the job part of
+// the response line, i.e. everything after the job key.
+string CNetScheduleHandler::x_PutBatchJob(CQueue *  q)
+{
+    x_CheckAuthorizationToken();
+
+    if (!m_CommandArguments.queue_from_job_key.empty() &&
+        NStr::CompareNocase(m_QueueName,
+                            m_CommandArguments.queue_from_job_key) != 0)
+        NCBI_THROW(CNetScheduleException, eInvalidParameter,
+                   "The job belongs to the queue " +
+                   m_CommandArguments.queue_from_job_key);
+
+    CJob        job;
+    TJobStatus  old_status = q->PutResult(m_ClientId, CNSPreciseTime::Current(),
+                                          m_CommandArguments.job_id,
+                                          m_CommandArguments.job_key,
+                                          job,
+                                          m_CommandArguments.auth_token,
+                                          m_CommandArguments.job_return_code,
+                                          m_CommandArguments.output);
+    if (old_status == CNetScheduleAPI::ePending ||
+        old_status == CNetScheduleAPI::eRunning) {
+        x_LogCommandWithJob(job);
+        return "result=OK";
+    }
+    if (old_status == CNetScheduleAPI::eFailed) {
+        // Still accept the job results, but print a warning: CXX-3632
+        ERR_POST(Warning << "Accepting results for a job in the FAILED state.");
+        x_LogCommandWithJob(job);
+        return "result=OK";
+    }
+    if (old_status == CNetScheduleAPI::eDone) {
+        ERR_POST(Warning << "Cannot accept job "
+                         << m_CommandArguments.job_key
+                         << " results. The job has already been done.");
+        x_LogCommandWithJob(job);
+        return "result=WARNING&code=eJobAlreadyDone&message=Already%20done";
+    }
+    if (old_status == CNetScheduleAPI::eJobNotFound) {
+        ERR_POST(Warning << "Cannot accept job "
+                         << m_CommandArguments.job_key
+                         << " results. The job is unknown");
+        return "result=ERR&code=eJobNotFound&message=";
+    }
+
+    // Here: invalid job status, nothing will be done
+    ERR_POST(Warning << "Cannot accept job "
+                     << m_CommandArguments.job_key
+                     << " results; job is in "
+                     << CNetScheduleAPI::StatusToString(old_status)
+                     << " state");
+    x_LogCommandWithJob(job);
+    return "result=ERR&code=eInvalidJobStatus&message=" +
+           NStr::URLEncode("Cannot accept job results; job is in " +
+                           CNetScheduleAPI::StatusToString(old_status) +
+                           " state");
+}
+
+
 void CNetScheduleHandler::x_ProcessJobExchange(CQueue* q)
 {
     // The JXCG command is used only by old clients. All new client should use
@@ -4293,18 +4576,7 @@ CNetScheduleHandler::x_PrintGetJobResponse(const CQueue *  q,
     }
 
     if (cmdv2)
-        x_WriteMessage(
-                       "OK:job_key=" + job_key +
-                       "&input=" + NStr::URLEncode(job.GetInput()) +
-                       "&affinity=" +
-                       NStr::URLEncode(q->GetAffinityTokenByID(
-                                                        job.GetAffinityId())) +
-                       "&client_ip=" + NStr::URLEncode(job.GetClientIP()) +
-                       "&client_sid=" + NStr::URLEncode(job.GetClientSID()) +
-                       "&ncbi_phid=" + NStr::URLEncode(job.GetNCBIPHID()) +
-                       "&mask=" + NStr::NumericToString(job.GetMask()) +
-                       "&auth_token=" + job.GetAuthToken() +
-                       kEndOfResponse);
+        x_WriteMessage("OK:" + x_GetJob2Response(q, job) + kEndOfResponse);
     else
         x_WriteMessage(
                        "OK:" + job_key +
@@ -4319,6 +4591,23 @@ CNetScheduleHandler::x_PrintGetJobResponse(const CQueue *  q,
 }
 
 
+// Forms the GET2/GETB job description
+string
+CNetScheduleHandler::x_GetJob2Response(const CQueue *  q,
+                                       const CJob &    job) const
+{
+    return "job_key=" + q->MakeJobKey(job.GetId()) +
+           "&input=" + NStr::URLEncode(job.GetInput()) +
+           "&affinity=" +
+           NStr::URLEncode(q->GetAffinityTokenByID(job.GetAffinityId())) +
+           "&client_ip=" + NStr::URLEncode(job.GetClientIP()) +
+           "&client_sid=" + NStr::URLEncode(job.GetClientSID()) +
+           "&ncbi_phid=" + NStr::URLEncode(job.GetNCBIPHID()) +
+           "&mask=" + NStr::NumericToString(job.GetMask()) +
+           "&auth_token=" + job.GetAuthToken();
+}
+
+
 bool CNetScheduleHandler::x_CanBeWithoutQueue(FProcessor  processor) const
 {
     return // STATUS/STATUS2
@@ -123,6 +123,8 @@ private:
     void x_ProcessMsgBatchHeader(BUF buffer);
     void x_ProcessMsgBatchJob(BUF buffer);
     void x_ProcessMsgBatchSubmit(BUF buffer);
+    // Message processing for ProcessPutBatch
+    void x_ProcessMsgPutBatchJob(BUF buffer);
 
     void x_SetQuickAcknowledge(void);
     void x_SetCmdRequestStatus(unsigned int  status)
@@ -166,9 +168,11 @@ private:
     void x_ProcessCancel(CQueue*);
     void x_ProcessStatus(CQueue*);
     void x_ProcessGetJob(CQueue*);
+    void x_ProcessGetJobBatch(CQueue*);
     void x_ProcessCancelWaitGet(CQueue*);
     void x_ProcessCancelWaitRead(CQueue*);
     void x_ProcessPut(CQueue*);
+    void x_ProcessPutBatch(CQueue*);
     void x_ProcessJobExchange(CQueue*);
     void x_ProcessPutMessage(CQueue*);
     void x_ProcessGetMessage(CQueue*);
@@ -247,6 +251,8 @@ private:
     void x_PrintGetJobResponse(const CQueue * q,
                                const CJob &   job,
                                bool           add_security_token);
+    string x_GetJob2Response(const CQueue * q, const CJob &  job) const;
+    string x_PutBatchJob(CQueue *  q);
     bool x_CanBeWithoutQueue(FProcessor  processor) const;
     bool x_NeedToGeneratePHIDAndSID(FProcessor  processor) const;
     bool x_WorkerNodeCommand(void) const;
@@ -297,6 +303,11 @@ private:
     string                          m_BatchNCBIPHID;
     bool                            m_WithinBatchSubmit;
 
+    // Batch put data
+    unsigned                        m_PutBatchSize;
+    unsigned                        m_PutBatchPos;
+    string                          m_PutBatchResponse;
+
     // Parsers for incoming commands and their parser tables
     TProtoParser                    m_SingleCmdParser;
     static SCommandMap              sm_CommandMap[];
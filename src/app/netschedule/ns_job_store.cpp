@@ -0,0 +1,830 @@
+/*  $Id$
+ * ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ *
+ * File Description:
+ *   NetSchedule in-memory job store with a journal
+ *
+ */
+
+#include <ncbi_pch.hpp>
+
+#include <corelib/ncbifile.hpp>
+#include <corelib/ncbithr.hpp>
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+
+#include "ns_job_store.hpp"
+#include "ns_queue.hpp"
+
+
+BEGIN_NCBI_SCOPE
+
+
+// See the comment for kDumpMagic
+const Uint4     kJournalMagic(0xD1D1D1D1);
+const Uint4     kSnapshotMagic(0xD2D2D2D2);
+const size_t    kJournalBufferSize = 256 * 1024;
+const size_t    kSnapshotChunkSize = 1000;
+
+// Journal record types
+enum EJournalRecord {
+    eJournalJob    = 1,     // full job image: aff token, group, CJob::Dump()
+    eJournalErase  = 2,     // job id
+    eJournalCommit = 3      // end of a transaction
+};
+
+
+// The last transaction committed by the current thread in each store. The
+// reply to the client is sent only when the transactions are on the disk.
+// A thread may work with a few queues within one request so the stores are
+// waited for together in WaitForCommit(), when no lock is held.
+typedef map<CNSJobStore *, Uint8>   TPendingCommits;
+static CStaticTls<TPendingCommits>  s_PendingCommits;
+
+
+static void s_CleanupPendingCommits(TPendingCommits *  pending, void *)
+{
+    delete pending;
+}
+
+
+static void s_Write(FILE *  f, const void *  data, size_t  size)
+{
+    errno = 0;
+    if (size > 0 && fwrite(data, size, 1, f) != 1)
+        throw runtime_error("Journal write error: " + string(strerror(errno)));
+}
+
+
+static void s_WriteUint4(FILE *  f, Uint4  value)
+{
+    s_Write(f, &value, sizeof(value));
+}
+
+
+static void s_WriteString(FILE *  f, const string &  value)
+{
+    s_WriteUint4(f, Uint4(value.size()));
+    s_Write(f, value.data(), value.size());
+}
+
+
+static void s_WriteJob(FILE *  f, const CJob &  job,
+                       const string &  aff_token, const string &  group)
+{
+    s_WriteUint4(f, eJournalJob);
+    s_WriteString(f, aff_token);
+    s_WriteString(f, group);
+    job.Dump(f);
+}
+
+
+// Provides false at the clean end of file
+static bool s_ReadUint4(FILE *  f, Uint4 &  value)
+{
+    size_t      bytes = fread(&value, 1, sizeof(value), f);
+    if (bytes == sizeof(value))
+        return true;
+    if (bytes == 0 && feof(f))
+        return false;
+    throw runtime_error("incomplete record");
+}
+
+
+static void s_ReadString(FILE *  f, string &  value)
+{
+    Uint4       size;
+    if (!s_ReadUint4(f, size))
+        throw runtime_error("incomplete record");
+    if (size > kNetScheduleMaxOverflowSize)
+        throw runtime_error("invalid string size");
+
+    value.resize(size);
+    if (size > 0 && fread(&value[0], size, 1, f) != 1)
+        throw runtime_error("incomplete record");
+}
+
+
+static void s_ReadJob(FILE *  f, SNSRecoveredJob &  record,
+                      char *  input_buf, char *  output_buf)
+{
+    s_ReadString(f, record.m_AffToken);
+    s_ReadString(f, record.m_Group);
+    if (!record.m_Job.LoadFromDump(f, input_buf, output_buf))
+        throw runtime_error("incomplete record");
+}
+
+
+static void s_ApplyJob(TNSRecoveredJobs &  jobs,
+                       const SNSRecoveredJob &  record)
+{
+    unsigned int                job_id = record.m_Job.GetId();
+    TNSRecoveredJobs::iterator  found = jobs.find(job_id);
+
+    if (found == jobs.end()) {
+        jobs[job_id] = record;
+        return;
+    }
+
+    // The tokens are journaled when a job is created only
+    found->second.m_Job = record.m_Job;
+    if (!record.m_AffToken.empty())
+        found->second.m_AffToken = record.m_AffToken;
+    if (!record.m_Group.empty())
+        found->second.m_Group = record.m_Group;
+}
+
+
+static string s_JournalFileName(const string &  path,
+                                const string &  queue_name,
+                                unsigned int    generation)
+{
+    return path + queue_name + "." +
+           NStr::NumericToString(generation) + ".journal";
+}
+
+
+static string s_SnapshotFileName(const string &  path,
+                                 const string &  queue_name)
+{
+    return path + queue_name + ".snapshot";
+}
+
+
+// Provides the sorted generations of the queue journals
+static vector<unsigned int> s_GetGenerations(const string &  path,
+                                             const string &  queue_name)
+{
+    vector<unsigned int>    generations;
+    CDir                    journal_dir(path);
+
+    if (!journal_dir.Exists())
+        return generations;
+
+    CDir::TEntries          entries = journal_dir.GetEntries(
+                                            queue_name + ".*.journal",
+                                            CDir::fIgnoreRecursive);
+    for (CDir::TEntries::const_iterator  k = entries.begin();
+            k != entries.end(); ++k) {
+        string      name = (*k)->GetName();
+        string      middle = name.substr(queue_name.size() + 1,
+                                         name.size() - queue_name.size() - 1 -
+                                         strlen(".journal"));
+        unsigned int    generation = NStr::StringToUInt(
+                                            middle, NStr::fConvErr_NoThrow);
+        if (generation != 0)
+            generations.push_back(generation);
+    }
+    sort(generations.begin(), generations.end());
+    return generations;
+}
+
+
+static void s_ReplayJournal(const string &      file_name,
+                            TNSRecoveredJobs &  jobs,
+                            char *              input_buf,
+                            char *              output_buf)
+{
+    FILE *      f = fopen(file_name.c_str(), "rb");
+    if (f == NULL)
+        throw runtime_error("Cannot open journal file " + file_name);
+
+    // The records are applied when the transaction commit mark is read so
+    // a transaction interrupted by a crash is ignored
+    vector<SNSRecoveredJob>     pending_jobs;
+    vector<unsigned int>        pending_erase;
+    size_t                      transactions = 0;
+
+    try {
+        Uint4       value;
+        if (!s_ReadUint4(f, value) || value != kJournalMagic)
+            throw runtime_error("wrong header");
+
+        while (s_ReadUint4(f, value)) {
+            switch (value) {
+            case eJournalJob:
+                pending_jobs.push_back(SNSRecoveredJob());
+                s_ReadJob(f, pending_jobs.back(), input_buf, output_buf);
+                break;
+            case eJournalErase:
+                if (!s_ReadUint4(f, value))
+                    throw runtime_error("incomplete record");
+                pending_erase.push_back(value);
+                break;
+            case eJournalCommit:
+                for (size_t  k = 0; k < pending_erase.size(); ++k)
+                    jobs.erase(pending_erase[k]);
+                for (size_t  k = 0; k < pending_jobs.size(); ++k)
+                    s_ApplyJob(jobs, pending_jobs[k]);
+                pending_erase.clear();
+                pending_jobs.clear();
+                ++transactions;
+                break;
+            default:
+                throw runtime_error("unknown record type");
+            }
+        }
+    } catch (const exception &  ex) {
+        // The tail after the last complete transaction is a crash leftover
+        ERR_POST(Warning << "Journal " << file_name << " is truncated after "
+                         << transactions << " transaction(s): " << ex.what()
+                         << ". The rest of the journal is ignored.");
+    }
+
+    fclose(f);
+}
+
+
+
+CNSJobStore::CNSJobStore() :
+    m_TransDepth(0), m_Journal(NULL), m_Generation(0), m_JournalSize(0),
+    m_CommitSeq(0), m_SyncedSeq(0), m_Syncing(false),
+    m_LastSnapshot(time(0))
+{}
+
+
+CNSJobStore::~CNSJobStore()
+{
+    try {
+        Detach();
+    } catch (...) {}
+}
+
+
+void CNSJobStore::Init(const string &                 journal_path,
+                       const SNSJobStoreParameters &  params)
+{
+    m_Path = CDirEntry::AddTrailingPathSeparator(journal_path);
+    m_Params = params;
+}
+
+
+void CNSJobStore::Attach(const string &  queue_name)
+{
+    CFastMutexGuard     guard(m_Lock);
+    CFastMutexGuard     journal_guard(m_JournalLock);
+
+    x_CloseJournal();
+    x_Clear();
+    m_QueueName = queue_name;
+
+    // A new queue instance starts a new journal; the recovered jobs are
+    // written to it while the queue is loaded
+    x_RemoveFiles(0);
+    m_Generation = 1;
+    x_OpenJournal();
+    m_LastSnapshot = time(0);
+}
+
+
+void CNSJobStore::Detach(void)
+{
+    CFastMutexGuard     guard(m_Lock);
+    CFastMutexGuard     journal_guard(m_JournalLock);
+
+    x_CloseJournal();
+    x_Clear();
+}
+
+
+void CNSJobStore::Truncate(void)
+{
+    CFastMutexGuard     guard(m_Lock);
+    CFastMutexGuard     journal_guard(m_JournalLock);
+
+    x_CloseJournal();
+    x_Clear();
+    if (!m_QueueName.empty())
+        x_RemoveFiles(0);
+    m_QueueName.clear();
+}
+
+
+bool CNSJobStore::Fetch(unsigned int  job_id, CJob &  job) const
+{
+    CFastMutexGuard         guard(m_Lock);
+    TJobs::const_iterator   found = m_Jobs.find(job_id);
+
+    if (found == m_Jobs.end())
+        return false;
+    job = found->second;
+    return true;
+}
+
+
+void CNSJobStore::Put(const CJob &    job,
+                      const string &  aff_token,
+                      const string &  group)
+{
+    BeginTransaction();
+    try {
+        CFastMutexGuard     guard(m_Lock);
+        unsigned int        job_id = job.GetId();
+
+        x_Touch(job_id);
+        m_Jobs[job_id] = job;
+        if (!aff_token.empty() || !group.empty())
+            m_NewTokens[job_id] = make_pair(aff_token, group);
+    } catch (...) {
+        AbortTransaction();
+        throw;
+    }
+    CommitTransaction();
+}
+
+
+void CNSJobStore::Erase(unsigned int  job_id)
+{
+    BeginTransaction();
+    try {
+        CFastMutexGuard     guard(m_Lock);
+
+        x_Touch(job_id);
+        m_Jobs.erase(job_id);
+        m_NewTokens.erase(job_id);
+    } catch (...) {
+        AbortTransaction();
+        throw;
+    }
+    CommitTransaction();
+}
+
+
+size_t CNSJobStore::GetSize(void) const
+{
+    CFastMutexGuard     guard(m_Lock);
+    return m_Jobs.size();
+}
+
+
+void CNSJobStore::BeginTransaction(void)
+{
+    CFastMutexGuard     guard(m_Lock);
+    ++m_TransDepth;
+}
+
+
+void CNSJobStore::CommitTransaction(void)
+{
+    CFastMutexGuard     guard(m_Lock);
+
+    if (m_TransDepth == 0)
+        return;
+    if (--m_TransDepth > 0)
+        return;
+
+    try {
+        x_WriteTransaction();
+    } catch (...) {
+        // The journal does not have the transaction so the memory must
+        // not have it either
+        ++m_TransDepth;
+        guard.Release();
+        AbortTransaction();
+        throw;
+    }
+    m_Undo.clear();
+    m_NewTokens.clear();
+}
+
+
+void CNSJobStore::AbortTransaction(void)
+{
+    CFastMutexGuard     guard(m_Lock);
+
+    if (m_TransDepth == 0)
+        return;
+
+    // A nested transaction failure discards the whole transaction
+    m_TransDepth = 0;
+    for (TUndo::const_iterator  k = m_Undo.begin(); k != m_Undo.end(); ++k) {
+        if (k->second.m_Existed)
+            m_Jobs[k->first] = k->second.m_Job;
+        else
+            m_Jobs.erase(k->first);
+    }
+    m_Undo.clear();
+    m_NewTokens.clear();
+}
+
+
+void CNSJobStore::Sync(void)
+{
+    Uint8       seq;
+    {{
+        CFastMutexGuard     journal_guard(m_JournalLock);
+        seq = m_CommitSeq;
+    }}
+    x_WaitForSync(seq);
+}
+
+
+void CNSJobStore::SyncToDisk(void)
+{
+    CFastMutexGuard     journal_guard(m_JournalLock);
+
+    while (m_Syncing)
+        m_SyncDone.WaitForSignal(m_JournalLock);
+
+    if (m_Journal != NULL) {
+        if (fflush(m_Journal) != 0 || fdatasync(fileno(m_Journal)) != 0)
+            throw runtime_error("Journal sync error for queue " +
+                                m_QueueName + ": " + strerror(errno));
+    }
+
+    m_SyncedSeq = m_CommitSeq;
+    m_SyncDone.SignalAll();
+}
+
+
+bool CNSJobStore::IsSnapshotDue(void) const
+{
+    CFastMutexGuard     journal_guard(m_JournalLock);
+
+    if (m_QueueName.empty())
+        return false;
+    if (m_JournalSize >= m_Params.max_journal_size)
+        return true;
+    if (m_Params.snapshot_period == 0)
+        return false;
+    return m_JournalSize > sizeof(kJournalMagic) &&
+           time(0) - m_LastSnapshot >= time_t(m_Params.snapshot_period);
+}
+
+
+// The snapshot is fuzzy: the jobs are copied in chunks while the queue keeps
+// working. The journal is rotated first so any change made while the
+// snapshot is being written lands in the new journal generation and
+// overrides the snapshot at the time of the replay.
+void CNSJobStore::Snapshot(const CQueue &  queue)
+{
+    vector<unsigned int>    job_ids;
+    unsigned int            generation;
+    string                  queue_name;
+
+    {{
+        CFastMutexGuard     guard(m_Lock);
+        CFastMutexGuard     journal_guard(m_JournalLock);
+
+        if (m_QueueName.empty())
+            return;
+
+        x_CloseJournal();
+        ++m_Generation;
+        x_OpenJournal();
+
+        generation = m_Generation;
+        queue_name = m_QueueName;
+        m_LastSnapshot = time(0);
+
+        job_ids.reserve(m_Jobs.size());
+        for (TJobs::const_iterator  k = m_Jobs.begin();
+                k != m_Jobs.end(); ++k)
+            job_ids.push_back(k->first);
+        // The jobs created by the transaction in progress are written to
+        // the new journal generation when the transaction is committed
+    }}
+
+    string      file_name = s_SnapshotFileName(m_Path, queue_name);
+    string      tmp_file_name = file_name + ".tmp";
+    FILE *      f = fopen(tmp_file_name.c_str(), "wb");
+
+    if (f == NULL)
+        throw runtime_error("Cannot create journal snapshot file " +
+                            tmp_file_name);
+
+    try {
+        s_WriteUint4(f, kSnapshotMagic);
+        s_WriteUint4(f, generation);
+
+        vector<CJob>    buffer;
+        for (size_t  k = 0; k < job_ids.size(); ) {
+            buffer.clear();
+            {{
+                CFastMutexGuard     guard(m_Lock);
+                for (size_t  n = 0; k < job_ids.size() &&
+                                    n < kSnapshotChunkSize; ++k, ++n) {
+                    unsigned int    job_id = job_ids[k];
+
+                    // A job changed by a transaction in progress is taken
+                    // in its committed state
+                    TUndo::const_iterator   undo = m_Undo.find(job_id);
+                    if (undo != m_Undo.end()) {
+                        if (undo->second.m_Existed)
+                            buffer.push_back(undo->second.m_Job);
+                        continue;
+                    }
+
+                    TJobs::const_iterator   found = m_Jobs.find(job_id);
+                    if (found != m_Jobs.end())
+                        buffer.push_back(found->second);
+                }
+            }}
+
+            for (vector<CJob>::const_iterator  j = buffer.begin();
+                    j != buffer.end(); ++j)
+                s_WriteJob(f, *j,
+                           queue.GetAffinityTokenByID(j->GetAffinityId()),
+                           queue.GetGroupTokenByID(j->GetGroupId()));
+        }
+
+        if (fflush(f) != 0)
+            throw runtime_error("Journal snapshot flush error: " +
+                                string(strerror(errno)));
+        if (m_Params.sync && fsync(fileno(f)) != 0)
+            throw runtime_error("Journal snapshot sync error: " +
+                                string(strerror(errno)));
+    } catch (...) {
+        fclose(f);
+        CFile(tmp_file_name).Remove();
+        throw;
+    }
+    fclose(f);
+
+    if (!CFile(tmp_file_name).Rename(file_name, CFile::fRF_Overwrite))
+        throw runtime_error("Cannot rename journal snapshot file " +
+                            tmp_file_name);
+
+    // The older generations are covered by the snapshot
+    CFastMutexGuard     journal_guard(m_JournalLock);
+    if (m_QueueName == queue_name)
+        x_RemoveFiles(generation);
+}
+
+
+void CNSJobStore::WaitForCommit(void)
+{
+    TPendingCommits *   pending = s_PendingCommits.GetValue();
+    if (pending == NULL)
+        return;
+
+    for (TPendingCommits::const_iterator  k = pending->begin();
+            k != pending->end(); ++k)
+        k->first->x_WaitForSync(k->second);
+    pending->clear();
+}
+
+
+void CNSJobStore::Recover(const string &      journal_path,
+                          const string &      queue_name,
+                          TNSRecoveredJobs &  jobs)
+{
+    string              path = CDirEntry::AddTrailingPathSeparator(
+                                                            journal_path);
+    string              snapshot_name = s_SnapshotFileName(path, queue_name);
+    unsigned int        generation = 0;
+    AutoArray<char>     input_buf(new char[kNetScheduleMaxOverflowSize]);
+    AutoArray<char>     output_buf(new char[kNetScheduleMaxOverflowSize]);
+
+    if (CFile(snapshot_name).Exists()) {
+        FILE *      f = fopen(snapshot_name.c_str(), "rb");
+        if (f == NULL)
+            throw runtime_error("Cannot open journal snapshot file " +
+                                snapshot_name);
+
+        try {
+            Uint4       value;
+            if (!s_ReadUint4(f, value) || value != kSnapshotMagic ||
+                !s_ReadUint4(f, generation))
+                throw runtime_error("wrong header");
+
+            while (s_ReadUint4(f, value)) {
+                if (value != eJournalJob)
+                    throw runtime_error("unknown record type");
+
+                SNSRecoveredJob     record;
+                s_ReadJob(f, record, input_buf.get(), output_buf.get());
+                jobs[record.m_Job.GetId()] = record;
+            }
+        } catch (const exception &  ex) {
+            // The snapshot is renamed into place only when it is complete
+            fclose(f);
+            throw runtime_error("Error reading journal snapshot " +
+                                snapshot_name + ": " + ex.what());
+        }
+        fclose(f);
+    }
+
+    vector<unsigned int>    generations = s_GetGenerations(path, queue_name);
+    for (vector<unsigned int>::const_iterator  k = generations.begin();
+            k != generations.end(); ++k) {
+        if (*k < generation)
+            continue;
+        s_ReplayJournal(s_JournalFileName(path, queue_name, *k), jobs,
+                        input_buf.get(), output_buf.get());
+    }
+}
+
+
+// Must be called under m_Lock
+void CNSJobStore::x_Touch(unsigned int  job_id)
+{
+    if (m_Undo.find(job_id) != m_Undo.end())
+        return;
+
+    SUndoRecord &           undo = m_Undo[job_id];
+    TJobs::const_iterator   found = m_Jobs.find(job_id);
+
+    undo.m_Existed = (found != m_Jobs.end());
+    if (undo.m_Existed)
+        undo.m_Job = found->second;
+}
+
+
+// Must be called under m_Lock
+void CNSJobStore::x_WriteTransaction(void)
+{
+    if (m_Undo.empty())
+        return;
+
+    TPendingCommits *   pending = s_PendingCommits.GetValue();
+    if (pending == NULL) {
+        pending = new TPendingCommits;
+        s_PendingCommits.SetValue(pending, s_CleanupPendingCommits);
+    }
+
+    CFastMutexGuard     journal_guard(m_JournalLock);
+
+    // A failed journal file is never appended; the next generation is
+    // started instead
+    if (m_Journal == NULL) {
+        ++m_Generation;
+        x_OpenJournal();
+    }
+
+    try {
+        for (TUndo::const_iterator  k = m_Undo.begin();
+                k != m_Undo.end(); ++k) {
+            unsigned int            job_id = k->first;
+            TJobs::const_iterator   found = m_Jobs.find(job_id);
+
+            if (found != m_Jobs.end()) {
+                TTokens::const_iterator     tokens = m_NewTokens.find(job_id);
+                if (tokens == m_NewTokens.end())
+                    s_WriteJob(m_Journal, found->second,
+                               kEmptyStr, kEmptyStr);
+                else
+                    s_WriteJob(m_Journal, found->second,
+                               tokens->second.first, tokens->second.second);
+            } else if (k->second.m_Existed) {
+                s_WriteUint4(m_Journal, eJournalErase);
+                s_WriteUint4(m_Journal, job_id);
+            }
+        }
+        s_WriteUint4(m_Journal, eJournalCommit);
+    } catch (...) {
+        // A group commit leader may be in fdatasync() on this file so it
+        // is closed when the sync is over. The torn transaction has no
+        // commit mark and is skipped at the replay.
+        x_CloseJournal();
+        throw;
+    }
+
+    m_JournalSize = Uint8(ftello(m_Journal));
+    ++m_CommitSeq;
+    (*pending)[this] = m_CommitSeq;
+}
+
+
+// Group commit: the first waiting thread flushes everything written to the
+// journal so far and the others wait for it instead of syncing themselves.
+void CNSJobStore::x_WaitForSync(Uint8  seq)
+{
+    CFastMutexGuard     journal_guard(m_JournalLock);
+
+    while (m_SyncedSeq < seq) {
+        if (m_Syncing) {
+            m_SyncDone.WaitForSignal(m_JournalLock);
+            continue;
+        }
+
+        Uint8       target = m_CommitSeq;
+        int         fd = -1;
+
+        if (m_Journal != NULL) {
+            if (fflush(m_Journal) != 0)
+                ERR_POST("Journal flush error for queue " << m_QueueName <<
+                         ": " << strerror(errno));
+            fd = fileno(m_Journal);
+        }
+
+        m_Syncing = true;
+        journal_guard.Release();
+
+        if (fd != -1 && m_Params.sync && fdatasync(fd) != 0)
+            ERR_POST("Journal sync error for queue " << m_QueueName <<
+                     ": " << strerror(errno));
+
+        journal_guard.Guard(m_JournalLock);
+        m_Syncing = false;
+        if (target > m_SyncedSeq)
+            m_SyncedSeq = target;
+        m_SyncDone.SignalAll();
+    }
+}
+
+
+// Must be called under m_JournalLock
+void CNSJobStore::x_OpenJournal(void)
+{
+    string      file_name = x_JournalFileName(m_Generation);
+
+    m_Journal = fopen(file_name.c_str(), "wb");
+    if (m_Journal == NULL)
+        throw runtime_error("Cannot create journal file " + file_name +
+                            ": " + strerror(errno));
+
+    setvbuf(m_Journal, NULL, _IOFBF, kJournalBufferSize);
+    s_WriteUint4(m_Journal, kJournalMagic);
+    m_JournalSize = sizeof(kJournalMagic);
+}
+
+
+// Must be called under m_JournalLock. Everything committed is synced.
+void CNSJobStore::x_CloseJournal(void)
+{
+    while (m_Syncing)
+        m_SyncDone.WaitForSignal(m_JournalLock);
+
+    if (m_Journal != NULL) {
+        if (fflush(m_Journal) != 0 ||
+            (m_Params.sync && fdatasync(fileno(m_Journal)) != 0))
+            ERR_POST("Journal sync error for queue " << m_QueueName <<
+                     ": " << strerror(errno));
+        fclose(m_Journal);
+        m_Journal = NULL;
+    }
+
+    m_SyncedSeq = m_CommitSeq;
+    m_SyncDone.SignalAll();
+}
+
+
+// Must be called under both locks
+void CNSJobStore::x_Clear(void)
+{
+    m_Jobs.clear();
+    m_Undo.clear();
+    m_NewTokens.clear();
+    m_TransDepth = 0;
+}
+
+
+// Removes the journals older than the given generation. 0 means all the
+// queue files including the snapshot.
+void CNSJobStore::x_RemoveFiles(unsigned int  before_generation)
+{
+    vector<unsigned int>    generations = s_GetGenerations(m_Path,
+                                                           m_QueueName);
+    for (vector<unsigned int>::const_iterator  k = generations.begin();
+            k != generations.end(); ++k) {
+        if (before_generation != 0 && *k >= before_generation)
+            continue;
+        try {
+            CFile(x_JournalFileName(*k)).Remove();
+        } catch (...) {}
+    }
+
+    if (before_generation == 0) {
+        string      snapshot_name = s_SnapshotFileName(m_Path, m_QueueName);
+        try {
+            CFile(snapshot_name).Remove();
+            CFile(snapshot_name + ".tmp").Remove();
+        } catch (...) {}
+    }
+}
+
+
+string CNSJobStore::x_JournalFileName(unsigned int  generation) const
+{
+    return s_JournalFileName(m_Path, m_QueueName, generation);
+}
+
+
+END_NCBI_SCOPE
+
@@ -0,0 +1,185 @@
+#ifndef NETSCHEDULE_JOB_STORE__HPP
+#define NETSCHEDULE_JOB_STORE__HPP
+
+/*  $Id$
+ * ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ *
+ * File Description:
+ *   NetSchedule in-memory job store. The jobs are kept in memory and the
+ *   changes are persisted in an append-only journal which is periodically
+ *   compacted into a snapshot.
+ *
+ */
+
+
+#include <corelib/ncbistl.hpp>
+#include <corelib/ncbimtx.hpp>
+
+#include <stdio.h>
+#include <map>
+#include <string>
+
+#include "job.hpp"
+
+
+BEGIN_NCBI_SCOPE
+
+class CQueue;
+
+
+const string    kJournalSubdirName("journal");
+const string    kJournalRecoverSubdirName("journal.recover");
+
+
+// Job store settings; they come from the [bdb] section
+struct SNSJobStoreParameters
+{
+    bool        enabled;            // true => jobs are stored in memory
+    bool        sync;               // true => fdatasync() at commit
+    unsigned    snapshot_period;    // seconds, 0 => by size only
+    Uint8       max_journal_size;   // bytes before a snapshot is made
+
+    SNSJobStoreParameters() :
+        enabled(false), sync(true), snapshot_period(600),
+        max_journal_size(256 * 1024 * 1024)
+    {}
+};
+
+
+// A job restored from the journal together with the tokens it refers to.
+// The affinity and group identifiers are not stable between the server
+// instances so the tokens are journaled instead.
+struct SNSRecoveredJob
+{
+    CJob        m_Job;
+    string      m_AffToken;
+    string      m_Group;
+};
+typedef map<unsigned int, SNSRecoveredJob>  TNSRecoveredJobs;
+
+
+// In-memory job store with a group committed journal. It serves one queue
+// DB block so it lives as long as the server does.
+class CNSJobStore
+{
+    public:
+        CNSJobStore();
+        ~CNSJobStore();
+
+    public:
+        void Init(const string &                 journal_path,
+                  const SNSJobStoreParameters &  params);
+        bool IsEnabled(void) const
+        { return m_Params.enabled; }
+
+        void Attach(const string &  queue_name);
+        void Detach(void);
+        void Truncate(void);
+
+        bool Fetch(unsigned int  job_id, CJob &  job) const;
+        void Put(const CJob &    job,
+                 const string &  aff_token,
+                 const string &  group);
+        void Erase(unsigned int  job_id);
+        size_t GetSize(void) const;
+
+        // Transactions may be nested; the outermost commit writes the
+        // changed jobs to the journal
+        void BeginTransaction(void);
+        void CommitTransaction(void);
+        void AbortTransaction(void);
+
+        void Sync(void);
+        // Like Sync() but calls fdatasync() regardless of the sync
+        // parameter and throws if the journal cannot be written
+        void SyncToDisk(void);
+        bool IsSnapshotDue(void) const;
+        void Snapshot(const CQueue &  queue);
+
+        // Blocks until the transactions committed by the current thread are
+        // on the disk. Must be called before a reply is sent to a client.
+        static void WaitForCommit(void);
+
+        static void Recover(const string &      journal_path,
+                            const string &      queue_name,
+                            TNSRecoveredJobs &  jobs);
+
+    private:
+        struct SUndoRecord
+        {
+            bool    m_Existed;
+            CJob    m_Job;
+        };
+
+        typedef map<unsigned int, CJob>                 TJobs;
+        typedef map<unsigned int, SUndoRecord>          TUndo;
+        typedef map<unsigned int, pair<string, string> > TTokens;
+
+        SNSJobStoreParameters   m_Params;
+        string                  m_Path;
+        string                  m_QueueName;
+
+        // There is one transaction per store, not per thread. m_Undo,
+        // m_NewTokens and m_TransDepth are shared by everybody and m_Lock
+        // protects them for a single call only. It works because every
+        // transaction from BeginTransaction() to the commit or abort is
+        // made under the queue m_OperationLock (see CNSTransaction), so
+        // the transactions of different threads never interleave. The only
+        // exception is the queue loading which is single threaded.
+        TJobs                   m_Jobs;
+        TUndo                   m_Undo;         // jobs touched by the
+                                                // current transaction
+        TTokens                 m_NewTokens;    // tokens of the new jobs
+        unsigned int            m_TransDepth;
+        mutable CFastMutex      m_Lock;         // jobs and transaction
+
+        mutable CFastMutex      m_JournalLock;  // the members below
+        CConditionVariable      m_SyncDone;
+        FILE *                  m_Journal;
+        unsigned int            m_Generation;
+        Uint8                   m_JournalSize;
+        Uint8                   m_CommitSeq;
+        Uint8                   m_SyncedSeq;
+        bool                    m_Syncing;      // a group commit leader is
+                                                // in fdatasync()
+        time_t                  m_LastSnapshot;
+
+    private:
+        CNSJobStore(const CNSJobStore &);
+        CNSJobStore & operator=(const CNSJobStore &);
+
+        void x_Touch(unsigned int  job_id);
+        void x_WriteTransaction(void);
+        void x_WaitForSync(Uint8  seq);
+        void x_OpenJournal(void);
+        void x_CloseJournal(void);
+        void x_Clear(void);
+        void x_RemoveFiles(unsigned int  before_generation);
+        string x_JournalFileName(unsigned int  generation) const;
+};
+
+END_NCBI_SCOPE
+
+#endif /* NETSCHEDULE_JOB_STORE__HPP */
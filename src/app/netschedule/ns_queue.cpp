@@ -166,6 +166,8 @@ void CQueue::Attach(SQueueDbBlock* block)
 {
     x_Detach();
     m_QueueDbBlock = block;
+    if (m_QueueDbBlock->job_store.IsEnabled())
+        m_QueueDbBlock->job_store.Attach(m_QueueName);
 
     // Here we have a db, so we can read the counter value we should start from
     m_LastId = m_Server->GetJobsStartID(m_QueueName);
@@ -217,9 +219,13 @@ void CQueue::x_Detach(void)
     // CQueueDbBlockArray::Allocate.
 
     if (m_TruncateAtDetach && !m_Server->ShutdownRequested()) {
+        // The journal files are named after the queue so they are removed
+        // right away; a queue with the same name may be created any time
+        m_QueueDbBlock->job_store.Truncate();
         CRef<CStdRequest> request(new CTruncateRequest(m_QueueDbBlock));
         m_Executor.SubmitRequest(request);
     } else {
+        m_QueueDbBlock->job_store.Detach();
         m_QueueDbBlock->allocated = false;
     }
 
@@ -1011,6 +1017,86 @@ CQueue::GetJobOrWait(const CNSClientId &       client,
 }
 
 
+// Provides up to max_count jobs for one request. The first job is picked
+// exactly as GET2 does it (including registering a waiting listener if there
+// are no jobs). The following jobs are picked without waiting and the jobs
+// which share affinities with the jobs already in the batch are preferred so
+// that a worker node could reuse the data it fetched for the batch.
+bool
+CQueue::GetJobs(const CNSClientId &       client,
+                unsigned short            port,
+                unsigned int              timeout,
+                const CNSPreciseTime &    curr,
+                const list<string> *      aff_list,
+                bool                      wnode_affinity,
+                bool                      any_affinity,
+                bool                      exclusive_new_affinity,
+                bool                      prioritized_aff,
+                const list<string> *      group_list,
+                size_t                    max_count,
+                vector<CJob> &            new_jobs,
+                CNSRollbackInterface * &  rollback_action,
+                string &                  added_pref_aff)
+{
+    vector<unsigned int>    job_ids;
+    list<string>            batch_affs;
+    TNSBitVector            batch_aff_ids;
+
+    while (new_jobs.size() < max_count) {
+        CJob                    job;
+        CNSRollbackInterface *  job_rollback = NULL;
+        string                  job_added_pref_aff;
+
+        if (!batch_affs.empty())
+            GetJobOrWait(client, 0, 0, curr, &batch_affs,
+                         false, false, false, true, true, group_list,
+                         &job, job_rollback, job_added_pref_aff);
+
+        if (job.GetId() == 0) {
+            bool    first = new_jobs.empty();
+            bool    ok = GetJobOrWait(client,
+                                      first ? port : 0,
+                                      first ? timeout : 0,
+                                      curr, aff_list,
+                                      wnode_affinity, any_affinity,
+                                      exclusive_new_affinity,
+                                      prioritized_aff, true, group_list,
+                                      &job, job_rollback, job_added_pref_aff);
+            if (!ok && first)
+                return false;
+        }
+
+        // The individual rollbacks are replaced with the batch one below
+        delete job_rollback;
+        if (job.GetId() == 0)
+            break;
+
+        if (!job_added_pref_aff.empty()) {
+            if (!added_pref_aff.empty())
+                added_pref_aff += ",";
+            added_pref_aff += job_added_pref_aff;
+        }
+
+        // CXX-8843: the '-' affinity jobs have nothing in common
+        unsigned int    aff_id = job.GetAffinityId();
+        if (aff_id != 0 && !batch_aff_ids.get_bit(aff_id)) {
+            string      aff_token = m_AffinityRegistry.GetTokenByID(aff_id);
+            if (!aff_token.empty() && aff_token != k_NoAffinityToken) {
+                batch_aff_ids.set_bit(aff_id);
+                batch_affs.push_back(aff_token);
+            }
+        }
+
+        job_ids.push_back(job.GetId());
+        new_jobs.push_back(job);
+    }
+
+    if (!job_ids.empty())
+        rollback_action = new CNSBatchGetJobRollback(client, job_ids);
+    return true;
+}
+
+
 void  CQueue::CancelWaitGet(const CNSClientId &  client)
 {
     bool    result;
@@ -2828,11 +2914,10 @@ CQueue::x_FindVacantJob(const CNSClientId  &          client,
             // (respecting their order) which may be followed by any affinity
             for (vector<unsigned int>::const_iterator  k = aff_ids.begin();
                     k != aff_ids.end(); ++k) {
-                TNSBitVector    aff_jobs = m_AffinityRegistry.
-                                                    GetJobsWithAffinity(*k);
-                TNSBitVector    candidates = vacant_jobs & aff_jobs;
-                if (candidates.any())
-                    return x_SJobPick(*(candidates.first()), false, *k);
+                unsigned int    job_id = m_AffinityRegistry.
+                                    GetFirstJobWithAffinity(*k, vacant_jobs);
+                if (job_id != 0)
+                    return x_SJobPick(job_id, false, *k);
             }
             if (any_affinity) {
                 if (vacant_jobs.any()) {
@@ -3251,6 +3336,20 @@ string  CQueue::GetAffinityTokenByID(unsigned int  aff_id) const
 }
 
 
+string  CQueue::GetGroupTokenByID(unsigned int  group_id) const
+{
+    if (group_id == 0)
+        return kEmptyStr;
+
+    try {
+        return m_GroupRegistry.ResolveGroup(group_id);
+    } catch (...) {
+        // The group has been removed already
+        return kEmptyStr;
+    }
+}
+
+
 void CQueue::ClearWorkerNode(const CNSClientId &  client,
                              bool &               client_was_found,
                              string &             old_session,
@@ -3799,23 +3898,29 @@ unsigned int  CQueue::DeleteBatch(unsigned int  max_deleted)
                  ++en, ++n) {
                 unsigned int    job_id = *en;
 
-                try {
-                    m_QueueDbBlock->job_db.id = job_id;
-                    m_QueueDbBlock->job_db.Delete();
+                if (m_QueueDbBlock->job_store.IsEnabled()) {
+                    m_QueueDbBlock->job_store.Erase(job_id);
                     ++del_rec;
                     deleted_jobs.set_bit(job_id);
-                } catch (CBDB_ErrnoException& ex) {
-                    ERR_POST("BDB error " << ex.what());
-                }
+                } else {
+                    try {
+                        m_QueueDbBlock->job_db.id = job_id;
+                        m_QueueDbBlock->job_db.Delete();
+                        ++del_rec;
+                        deleted_jobs.set_bit(job_id);
+                    } catch (CBDB_ErrnoException& ex) {
+                        ERR_POST("BDB error " << ex.what());
+                    }
 
-                try {
-                    m_QueueDbBlock->job_info_db.id = job_id;
-                    m_QueueDbBlock->job_info_db.Delete();
-                } catch (CBDB_ErrnoException& ex) {
-                    ERR_POST("BDB error " << ex.what());
-                }
+                    try {
+                        m_QueueDbBlock->job_info_db.id = job_id;
+                        m_QueueDbBlock->job_info_db.Delete();
+                    } catch (CBDB_ErrnoException& ex) {
+                        ERR_POST("BDB error " << ex.what());
+                    }
 
-                x_DeleteJobEvents(job_id);
+                    x_DeleteJobEvents(job_id);
+                }
 
                 // The job might be the one which was given for reading
                 // so the garbage should be collected
@@ -3970,6 +4075,29 @@ unsigned int  CQueue::PurgeJobInfoCache(void)
 }
 
 
+// Compacts the job journal into a snapshot if it has grown enough or if it
+// is time to do so. Otherwise makes sure that the journal tail is on disk.
+void  CQueue::SnapshotJournal(void)
+{
+    CNSJobStore &   job_store = m_QueueDbBlock->job_store;
+    if (!job_store.IsEnabled())
+        return;
+
+    if (!job_store.IsSnapshotDue()) {
+        job_store.Sync();
+        return;
+    }
+
+    CStopWatch      sw(CStopWatch::eStart);
+    job_store.Snapshot(*this);
+    GetDiagContext().Extra()
+        .Print("_type", "journal_snapshot")
+        .Print("_queue", m_QueueName)
+        .Print("jobs", job_store.GetSize())
+        .Print("elapsed", sw.Elapsed());
+}
+
+
 void CQueue::x_DeleteJobEvents(unsigned int  job_id)
 {
     try {
@@ -4933,27 +5061,6 @@ unsigned int  CQueue::LoadFromDump(const string &  dump_dname)
             unsigned int    job_id = job.GetId();
             unsigned int    group_id = job.GetGroupId();
             unsigned int    aff_id = job.GetAffinityId();
-            TJobStatus      status = job.GetStatus();
-
-            {
-                CNSTransaction      transaction(this);
-                job.Flush(this);
-                transaction.Commit();
-            }
-
-            m_StatusTracker.SetExactStatusNoLock(job_id, status, true);
-
-            if ((status == CNetScheduleAPI::eRunning ||
-                 status == CNetScheduleAPI::eReading) &&
-                m_RunTimeLine) {
-                // Add object to the first available slot;
-                // it is going to be rescheduled or dropped
-                // in the background control thread
-                // We can use time line without lock here because
-                // the queue is still in single-use mode while
-                // being loaded.
-                m_RunTimeLine->AddObject(m_RunTimeLine->GetHead(), job_id);
-            }
 
             // Register the job for the affinity if so
             if (aff_id != 0)
@@ -4963,17 +5070,7 @@ unsigned int  CQueue::LoadFromDump(const string &  dump_dname)
             if (group_id != 0)
                 m_GroupRegistry.AddJobToGroup(group_id, job_id);
 
-            // Register the loaded job with the garbage collector
-            CNSPreciseTime  submit_time = job.GetSubmitTime();
-            CNSPreciseTime  expiration =
-                    GetJobExpirationTime(job.GetLastTouch(), status,
-                                         submit_time, job.GetTimeout(),
-                                         job.GetRunTimeout(),
-                                         job.GetReadTimeout(),
-                                         m_Timeout, m_RunTimeout, m_ReadTimeout,
-                                         m_PendingTimeout, kTimeZero);
-            m_GCRegistry.RegisterJob(job_id, job.GetSubmitTime(),
-                                     aff_id, group_id, expiration);
+            x_RegisterLoadedJob(job);
             ++recs;
         }
 
@@ -5005,6 +5102,100 @@ unsigned int  CQueue::LoadFromDump(const string &  dump_dname)
 }
 
 
+// Restores the jobs committed to the journal by the previous instance which
+// did not stop gracefully. The affinity and group identifiers are assigned
+// anew from the journaled tokens.
+unsigned int  CQueue::LoadFromJournal(const string &  journal_dname)
+{
+    unsigned int        recs = 0;
+    TNSRecoveredJobs    jobs;
+
+    if (!CDir(journal_dname).Exists())
+        return 0;
+
+    try {
+        CNSJobStore::Recover(journal_dname, m_QueueName, jobs);
+
+        for (TNSRecoveredJobs::iterator  k = jobs.begin();
+                k != jobs.end(); ++k) {
+            CJob &          job = k->second.m_Job;
+            unsigned int    job_id = k->first;
+            const string &  aff_token = k->second.m_AffToken;
+            const string &  group = k->second.m_Group;
+
+            job.SetAffinityId(0);
+            if (!aff_token.empty())
+                job.SetAffinityId(m_AffinityRegistry.ResolveAffinityToken(
+                                            aff_token, job_id, 0, eUndefined));
+            job.SetGroupId(0);
+            if (!group.empty())
+                job.SetGroupId(m_GroupRegistry.AddJob(group, job_id));
+
+            x_RegisterLoadedJob(job);
+            ++recs;
+        }
+
+        // The caller removes the recovered journal, so the jobs must be on
+        // the disk in the new one even if the journal is not synced at
+        // every commit
+        CNSJobStore &   job_store = m_QueueDbBlock->job_store;
+        if (recs > 0 && job_store.IsEnabled())
+            job_store.SyncToDisk();
+    } catch (const exception &  ex) {
+        x_ClearQueue();
+        throw runtime_error("Error loading queue " + m_QueueName +
+                            " from its journal: " + string(ex.what()));
+    } catch (...) {
+        x_ClearQueue();
+        throw runtime_error("Unknown error loading queue " + m_QueueName +
+                            " from its journal");
+    }
+    return recs;
+}
+
+
+// Flushes a job loaded at startup and registers it with the queue
+// structures. The affinity and group registries are updated by the caller.
+void CQueue::x_RegisterLoadedJob(CJob &  job)
+{
+    unsigned int    job_id = job.GetId();
+    TJobStatus      status = job.GetStatus();
+
+    {
+        CNSTransaction      transaction(this);
+        job.Flush(this);
+        transaction.Commit();
+    }
+
+    m_StatusTracker.SetExactStatusNoLock(job_id, status, true);
+
+    if ((status == CNetScheduleAPI::eRunning ||
+         status == CNetScheduleAPI::eReading) &&
+        m_RunTimeLine) {
+        // Add object to the first available slot;
+        // it is going to be rescheduled or dropped
+        // in the background control thread
+        // We can use time line without lock here because
+        // the queue is still in single-use mode while
+        // being loaded.
+        m_RunTimeLine->AddObject(m_RunTimeLine->GetHead(), job_id);
+    }
+
+    // Register the loaded job with the garbage collector
+    CNSPreciseTime  submit_time = job.GetSubmitTime();
+    CNSPreciseTime  expiration =
+            GetJobExpirationTime(job.GetLastTouch(), status,
+                                 submit_time, job.GetTimeout(),
+                                 job.GetRunTimeout(),
+                                 job.GetReadTimeout(),
+                                 m_Timeout, m_RunTimeout, m_ReadTimeout,
+                                 m_PendingTimeout, kTimeZero);
+    m_GCRegistry.RegisterJob(job_id, job.GetSubmitTime(),
+                             job.GetAffinityId(), job.GetGroupId(),
+                             expiration);
+}
+
+
 // The member does not grab the operational lock.
 // The member is used at the time of loading jobs from dump and at that time
 // there is no concurrent access.
@@ -5028,6 +5219,11 @@ void CQueue::x_ClearQueue(void)
     for ( ; en.valid(); ++en) {
         unsigned int        job_id = *en;
         try {
+            if (m_QueueDbBlock->job_store.IsEnabled()) {
+                m_QueueDbBlock->job_store.Erase(job_id);
+                continue;
+            }
+
             CNSTransaction      transaction(this);
 
             m_QueueDbBlock->job_db.id = job_id;
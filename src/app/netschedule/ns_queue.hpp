@@ -210,6 +210,21 @@ public:
                       CNSRollbackInterface * &  rollback_action,
                       string &                  added_pref_aff);
 
+    bool GetJobs(const CNSClientId &       client,
+                 unsigned short            port,
+                 unsigned int              timeout,
+                 const CNSPreciseTime &    curr,
+                 const list<string> *      aff_list,
+                 bool                      wnode_affinity,
+                 bool                      any_affinity,
+                 bool                      exclusive_new_affinity,
+                 bool                      prioritized_aff,
+                 const list<string> *      group_list,
+                 size_t                    max_count,
+                 vector<CJob> &            new_jobs,
+                 CNSRollbackInterface * &  rollback_action,
+                 string &                  added_pref_aff);
+
     void CancelWaitGet(const CNSClientId &  client);
     void CancelWaitRead(const CNSClientId &  client);
 
@@ -365,6 +380,7 @@ public:
                        string                 warning);
 
     string  GetAffinityTokenByID(unsigned int  aff_id) const;
+    string  GetGroupTokenByID(unsigned int  group_id) const;
 
     void ClearWorkerNode(const CNSClientId &  client,
                          bool &               client_was_found,
@@ -412,6 +428,7 @@ public:
     void          PurgeBlacklistedJobs(void);
     void          PurgeClientRegistry(const CNSPreciseTime &  current_time);
     unsigned int  PurgeJobInfoCache(void);
+    void          SnapshotJournal(void);
 
     CBDB_FileCursor& GetEventsCursor();
 
@@ -479,6 +496,7 @@ public:
     void Dump(const string &  dump_dir_name);
     void RemoveDump(const string &  dump_dir_name);
     unsigned int LoadFromDump(const string &  dump_dir_name);
+    unsigned int LoadFromJournal(const string &  journal_dir_name);
     bool ShouldPerfLogTransitions(void) const
     { return m_ShouldPerfLogTransitions; }
     void UpdatePerfLoggingSettings(const string &  qclass);
@@ -611,6 +629,7 @@ private:
                           bool                  group_may_change);
 
     string x_GetJobsDumpFileName(const string &  dump_dname) const;
+    void x_RegisterLoadedJob(CJob &  job);
     void x_ClearQueue(void);
 
 private:
@@ -818,7 +837,9 @@ inline bool CQueue::IsProgramAllowed(const string &  program_name) const
 }
 
 
-// Application specific defaults provider for DB transaction
+// Application specific defaults provider for DB transaction.
+// If the queue jobs are kept in memory then the job store transaction is used
+// and the BDB tables are not involved.
 class CNSTransaction : public CBDB_Transaction
 {
 public:
@@ -826,8 +847,15 @@ public:
                    int                   what_tables = eAllTables,
                    ETransSync            tsync = eEnvDefault,
                    EKeepFileAssociation  assoc = eNoAssociation)
-        : CBDB_Transaction(queue->GetEnv(), tsync, assoc)
+        : CBDB_Transaction(queue->GetEnv(), tsync, assoc),
+          m_JobStore(NULL)
     {
+        if (queue->m_QueueDbBlock->job_store.IsEnabled()) {
+            m_JobStore = &queue->m_QueueDbBlock->job_store;
+            m_JobStore->BeginTransaction();
+            return;
+        }
+
         if (what_tables & eJobTable)
             queue->m_QueueDbBlock->job_db.SetTransaction(this);
 
@@ -837,6 +865,31 @@ public:
         if (what_tables & eJobEventsTable)
             queue->m_QueueDbBlock->events_db.SetTransaction(this);
     }
+
+    ~CNSTransaction()
+    {
+        // Not committed => aborted
+        if (m_JobStore != NULL) {
+            try {
+                m_JobStore->AbortTransaction();
+            } catch (...) {}
+        }
+    }
+
+    virtual void Commit()
+    {
+        if (m_JobStore == NULL) {
+            CBDB_Transaction::Commit();
+            return;
+        }
+
+        CNSJobStore *   job_store = m_JobStore;
+        m_JobStore = NULL;
+        job_store->CommitTransaction();
+    }
+
+private:
+    CNSJobStore *   m_JobStore;
 };
 
 
@@ -41,11 +41,14 @@ BEGIN_NCBI_SCOPE
 //////////////////////////////////////////////////////////////////////////
 // SQueueDbBlock
 
-void SQueueDbBlock::Open(CBDB_Env& env, const string& path, int pos_)
+void SQueueDbBlock::Open(CBDB_Env& env, const string& path, int pos_,
+                         const SNSJobStoreParameters& store_params)
 {
     pos       = pos_;
     allocated = false;
 
+    job_store.Init(path + kJournalSubdirName, store_params);
+
     string      prefix = "jsq_" + NStr::NumericToString(pos);
 
     try {
@@ -104,13 +107,14 @@ CQueueDbBlockArray::~CQueueDbBlockArray()
 
 
 void CQueueDbBlockArray::Init(CBDB_Env& env, const string& path,
-                             unsigned count)
+                             unsigned count,
+                             const SNSJobStoreParameters& store_params)
 {
     m_Count = count;
     m_Array = new SQueueDbBlock[m_Count];
 
     for (unsigned n = 0; n < m_Count; ++n) {
-        m_Array[n].Open(env, path, n);
+        m_Array[n].Open(env, path, n, store_params);
     }
 }
 
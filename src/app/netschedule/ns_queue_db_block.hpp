@@ -37,6 +37,7 @@
 #include <corelib/ncbiobj.hpp>
 
 #include "ns_db.hpp"
+#include "ns_job_store.hpp"
 
 
 BEGIN_NCBI_SCOPE
@@ -48,7 +49,8 @@ BEGIN_NCBI_SCOPE
 // This block represent a set of db files to serve one queue.
 struct SQueueDbBlock
 {
-    void Open(CBDB_Env& env, const std::string& path, int pos);
+    void Open(CBDB_Env& env, const std::string& path, int pos,
+              const SNSJobStoreParameters& store_params);
     void Close();
     void Truncate();
 
@@ -57,6 +59,8 @@ struct SQueueDbBlock
     SJobDB                  job_db;
     SJobInfoDB              job_info_db;
     SEventsDB               events_db;
+    CNSJobStore             job_store; // Used instead of the tables above
+                                       // if the journal is enabled
 };
 
 
@@ -66,7 +70,8 @@ public:
     CQueueDbBlockArray();
     ~CQueueDbBlockArray();
 
-    void Init(CBDB_Env &  env, const string &  path, unsigned int  count);
+    void Init(CBDB_Env &  env, const string &  path, unsigned int  count,
+              const SNSJobStoreParameters &  store_params);
 
     void Close();
 
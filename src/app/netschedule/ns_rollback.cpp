@@ -109,6 +109,32 @@ void CNSGetJobRollback::Rollback(CQueue *  queue)
 }
 
 
+void CNSBatchGetJobRollback::Rollback(CQueue *  queue)
+{
+    ERR_POST(Warning << "Rolling back job batch request due to "
+                        "a network error while reporting the job keys.");
+
+    // Each job is returned individually so that a failure for one of them
+    // does not leave the rest of the batch running
+    for (vector<unsigned int>::const_iterator  k = m_JobIds.begin();
+         k != m_JobIds.end(); ++k) {
+        try {
+            string  warning;    // used for auth tokens only, so
+                                // not analyzed here
+            CJob        job;    // Not used here
+
+            queue->ReturnJob(m_Client, *k, queue->MakeJobKey(*k),
+                             job, "", warning, CQueue::eRollback);
+        } catch (const exception &  ex) {
+            ERR_POST("Error while rolling back requested job batch: "
+                     << ex.what());
+        } catch (...) {
+            ERR_POST("Unknown error while rolling back requested job batch");
+        }
+    }
+}
+
+
 void CNSReadJobRollback::Rollback(CQueue *  queue)
 {
     ERR_POST(Warning << "Rolling back reading job request due to "
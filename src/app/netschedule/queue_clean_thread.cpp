@@ -114,6 +114,7 @@ void CJobQueueCleanerThread::x_DoJob(void)
         m_QueueDB.PurgeBlacklistedJobs();
         m_QueueDB.PurgeClientRegistry();
         m_QueueDB.PurgeJobInfoCache();
+        m_QueueDB.SnapshotJournals();
     }
     catch (CBDB_ErrnoException &  ex) {
         if (ex.IsNoMem()) {
@@ -102,6 +102,12 @@ bool SNSDBEnvironmentParams::Read(const IRegistry& reg, const string& sname)
     direct_db         = GetBoolNoErr("direct_db", false);
     direct_log        = GetBoolNoErr("direct_log", false);
     private_env       = GetBoolNoErr("private_env", false);
+
+    job_store.enabled = GetBoolNoErr("job_journal", false);
+    job_store.sync    = GetBoolNoErr("journal_sync", true);
+    job_store.snapshot_period  = GetUIntNoErr("journal_snapshot_period", 600);
+    job_store.max_journal_size = GetSizeNoErr("journal_max_size",
+                                              256 * 1024 * 1024);
     return true;
 }
 
@@ -116,6 +122,8 @@ CQueueDataBase::CQueueDataBase(CNetScheduleServer *            server,
 : m_Host(server->GetBackgroundHost()),
   m_Executor(server->GetRequestExecutor()),
   m_Env(NULL),
+  m_JobStoreParams(params.job_store),
+  m_RecoverFromJournal(false),
   m_StopPurge(false),
   m_FreeStatusMemCnt(0),
   m_LastFreeMem(time(0)),
@@ -127,6 +135,8 @@ CQueueDataBase::CQueueDataBase(CNetScheduleServer *            server,
     m_DataPath = CDirEntry::AddTrailingPathSeparator(params.db_path);
     m_DumpPath = CDirEntry::AddTrailingPathSeparator(m_DataPath +
                                                      kDumpSubdirName);
+    m_JournalPath = CDirEntry::AddTrailingPathSeparator(m_DataPath +
+                                                        kJournalSubdirName);
 
     // First, load the previous session start job IDs if file existed
     m_Server->LoadJobsStartIDs();
@@ -160,6 +170,25 @@ void  CQueueDataBase::x_Open(const SNSDBEnvironmentParams &  params,
     if (!data_dir.Exists())
         data_dir.Create();
 
+    // The previous instance journal is moved aside so that the queues start
+    // new journals while the old one is replayed. If the previous recovery
+    // has not completed then its source is used again.
+    string  recover_path = CDirEntry::AddTrailingPathSeparator(
+                                m_DataPath + kJournalRecoverSubdirName);
+    if (m_RecoverFromJournal) {
+        if (!CDir(recover_path).Exists() &&
+            !CDir(m_JournalPath).Rename(recover_path)) {
+            ERR_POST("Cannot move the journal directory to " << recover_path
+                     << ". The jobs are not recovered.");
+            m_RecoverFromJournal = false;
+        }
+    } else {
+        CDir(recover_path).Remove();
+    }
+    CDir(m_JournalPath).Remove();
+    if (m_JobStoreParams.enabled)
+        CDir(m_JournalPath).Create();
+
     // The initialization must be done before the queues are created but after
     // the directory is possibly re-created
     m_Server->InitNodeID(m_DataPath);
@@ -205,7 +234,8 @@ void  CQueueDataBase::x_Open(const SNSDBEnvironmentParams &  params,
     }
 
     // Allocate SQueueDbBlock's here, open/create corresponding databases
-    m_QueueDbBlockArray.Init(*m_Env, m_DataPath, queues_limit);
+    m_QueueDbBlockArray.Init(*m_Env, m_DataPath, queues_limit,
+                             m_JobStoreParams);
 
     try {
         // Here: we can start restoring what was saved. The first step is
@@ -285,6 +315,37 @@ void  CQueueDataBase::x_Open(const SNSDBEnvironmentParams &  params,
                 ++queue_load_error_count;
             }
         }
+
+        // The jobs committed by the previous instance which did not stop
+        // gracefully
+        size_t      journal_load_error_count = 0;
+        for (TQueueInfo::iterator  k = m_Queues.begin();
+                m_RecoverFromJournal && k != m_Queues.end(); ++k) {
+            try {
+                unsigned int   records =
+                            k->second.second->LoadFromJournal(recover_path);
+                GetDiagContext().Extra()
+                    .Print("_type", "startup")
+                    .Print("_queue", k->first)
+                    .Print("info", "load_from_journal")
+                    .Print("records", records);
+            } catch (const exception &  ex) {
+                ERR_POST(ex.what());
+                last_queue_load_error = ex.what();
+                ++queue_load_error_count;
+                ++journal_load_error_count;
+            } catch (...) {
+                last_queue_load_error = "Unknown error loading queue " +
+                                        k->first + " from journal";
+                ERR_POST(last_queue_load_error);
+                ++queue_load_error_count;
+                ++journal_load_error_count;
+            }
+        }
+
+        // The recovered jobs are synced to the new journals now
+        if (m_RecoverFromJournal && journal_load_error_count == 0)
+            CDir(recover_path).Remove();
     } catch (const exception &  ex) {
         ERR_POST(ex.what());
         last_queue_load_error = ex.what();
@@ -2051,6 +2112,28 @@ void CQueueDataBase::PurgeJobInfoCache(void)
 }
 
 
+void CQueueDataBase::SnapshotJournals(void)
+{
+    if (!m_JobStoreParams.enabled)
+        return;
+
+    for (unsigned int  index = 0; ; ++index) {
+        CRef<CQueue>  queue = x_GetQueueAt(index);
+        if (queue.IsNull())
+            break;
+        try {
+            queue->SnapshotJournal();
+        } catch (const exception &  ex) {
+            // The journal keeps growing; the next attempt may succeed
+            ERR_POST("Error making the journal snapshot for queue " <<
+                     queue->GetQueueName() << ": " << ex.what());
+        }
+        if (x_CheckStopPurge())
+            break;
+    }
+}
+
+
 // Safely provides a queue at the given index
 CRef<CQueue>  CQueueDataBase::x_GetQueueAt(unsigned int  index)
 {
@@ -2481,6 +2564,22 @@ void CQueueDataBase::x_RemoveBDBFiles(void)
 bool CQueueDataBase::x_CheckOpenPreconditions(bool  reinit)
 {
     if (x_DoesCrashFlagFileExist()) {
+        // The jobs can be restored from the journal unless there is a dump
+        // which is authoritative
+        if (!reinit && m_JobStoreParams.enabled &&
+            !CDir(m_DumpPath).Exists() &&
+            (CDir(m_JournalPath).Exists() ||
+             CDir(m_DataPath + kJournalRecoverSubdirName).Exists())) {
+            ERR_POST("The server did not stop gracefully last time. "
+                     "The jobs are recovered from the journal in "
+                     << m_DataPath);
+            m_Server->RegisterAlert(eStartAfterCrash, "The server did not "
+                                    "stop gracefully last time. The jobs "
+                                    "have been recovered from the journal");
+            m_RecoverFromJournal = true;
+            return false;
+        }
+
         ERR_POST("Reinitialization due to the server "
                  "did not stop gracefully last time. "
                  << m_DataPath << " removed.");
@@ -86,6 +86,9 @@ struct SNSDBEnvironmentParams
     bool      direct_log;
     bool      private_env;
 
+    // In-memory job store with a journal instead of the BDB tables
+    SNSJobStoreParameters   job_store;
+
     bool Read(const IRegistry& reg, const string& sname);
 };
 
@@ -138,6 +141,7 @@ public:
     void PurgeBlacklistedJobs(void);
     void PurgeClientRegistry(void);
     void PurgeJobInfoCache(void);
+    void SnapshotJournals(void);
 
     // Notify all listeners
     void NotifyListeners(void);
@@ -214,6 +218,9 @@ private:
     CBDB_Env *           m_Env;
     string               m_DataPath;
     string               m_DumpPath;
+    string               m_JournalPath;
+    SNSJobStoreParameters m_JobStoreParams;
+    bool                 m_RecoverFromJournal;  // Crash recovery is possible
 
     mutable CFastMutex   m_ConfigureLock;
 
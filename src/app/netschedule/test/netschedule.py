@@ -88,6 +88,9 @@ class NetSchedule:
     def getPort( self ):
         return self.__port
 
+    def getDBPath( self ):
+        return self.__dbPath
+
     @staticmethod
     def __getUsername():
         " Provides the current user name "
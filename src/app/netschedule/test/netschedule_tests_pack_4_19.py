@@ -12,7 +12,9 @@ from netschedule_tests_pack import TestBase
 from netschedule_tests_pack_4_10 import execAny
 
 from cgi import parse_qs
+import os
 import socket
+import struct
 import time
 
 
@@ -1103,3 +1105,232 @@ class Scenario1904( TestBase ):
         return True
 
 
+class Scenario2000( TestBase ):
+    " Scenario 2000 "
+
+    def __init__( self, netschedule ):
+        TestBase.__init__( self, netschedule )
+        return
+
+    @staticmethod
+    def getScenario():
+        " Provides the scenario "
+        return "SUBMIT 4 jobs with affinities a, b, a, b, " \
+               "GETB count=2 -> both a jobs, GETB count=5 -> both b jobs"
+
+    def execute( self ):
+        " Should return True if the execution completed successfully "
+        self.fromScratch()
+        jobID1 = self.ns.submitJob( 'TEST', 'bla', 'a' )
+        jobID2 = self.ns.submitJob( 'TEST', 'bla', 'b' )
+        jobID3 = self.ns.submitJob( 'TEST', 'bla', 'a' )
+        jobID4 = self.ns.submitJob( 'TEST', 'bla', 'b' )
+
+        self.ns.connect( 10 )
+        self.ns.directLogin( 'TEST',
+                             'netschedule_admin client_node=n1 '
+                             'client_session=s1' )
+        self.ns.directSendCmd( 'GETB count=2 wnode_aff=0 any_aff=1' )
+        reply = self.ns.directReadMultiReply()
+        if reply[ 0 ] != True:
+            self.ns.disconnect()
+            raise Exception( "GETB error: " + str( reply[ 1 ] ) )
+        keys = [ parse_qs( line, True, True )[ 'job_key' ][ 0 ]
+                 for line in reply[ 1 ] ]
+        if keys != [ jobID1, jobID3 ]:
+            self.ns.disconnect()
+            raise Exception( "Expected the affinity a jobs, got: " +
+                             str( keys ) )
+
+        self.ns.directSendCmd( 'GETB count=5 wnode_aff=0 any_aff=1' )
+        reply = self.ns.directReadMultiReply()
+        self.ns.disconnect()
+        if reply[ 0 ] != True:
+            raise Exception( "GETB error: " + str( reply[ 1 ] ) )
+        keys = [ parse_qs( line, True, True )[ 'job_key' ][ 0 ]
+                 for line in reply[ 1 ] ]
+        if keys != [ jobID2, jobID4 ]:
+            raise Exception( "Expected the affinity b jobs, got: " +
+                             str( keys ) )
+        return True
+
+
+class Scenario2001( TestBase ):
+    " Scenario 2001 "
+
+    def __init__( self, netschedule ):
+        TestBase.__init__( self, netschedule )
+        return
+
+    @staticmethod
+    def getScenario():
+        " Provides the scenario "
+        return "SUBMIT 2 jobs, GETB count=2, PUTB count=2 -> both done, " \
+               "PUTB count=1 for a done job -> eJobAlreadyDone"
+
+    def execute( self ):
+        " Should return True if the execution completed successfully "
+        self.fromScratch()
+        jobID1 = self.ns.submitJob( 'TEST', 'bla' )
+        jobID2 = self.ns.submitJob( 'TEST', 'bla' )
+
+        self.ns.connect( 10 )
+        self.ns.directLogin( 'TEST',
+                             'netschedule_admin client_node=n1 '
+                             'client_session=s1' )
+        self.ns.directSendCmd( 'GETB count=2 wnode_aff=0 any_aff=1' )
+        reply = self.ns.directReadMultiReply()
+        if reply[ 0 ] != True or len( reply[ 1 ] ) != 2:
+            self.ns.disconnect()
+            raise Exception( "GETB error: " + str( reply[ 1 ] ) )
+        jobs = [ parse_qs( line, True, True ) for line in reply[ 1 ] ]
+
+        self.ns.directSendCmd( 'PUTB count=2' )
+        reply = self.ns.directReadSingleReply()
+        if reply[ 0 ] != True or reply[ 1 ] != "Batch put ready":
+            self.ns.disconnect()
+            raise Exception( "PUTB error: " + str( reply[ 1 ] ) )
+        for job in jobs:
+            self.ns.directSendCmd( 'job_key=' + job[ 'job_key' ][ 0 ] +
+                                   ' auth_token=' + job[ 'auth_token' ][ 0 ] +
+                                   ' job_return_code=0 output="out"' )
+        reply = self.ns.directReadMultiReply()
+        if reply[ 0 ] != True or len( reply[ 1 ] ) != 2:
+            self.ns.disconnect()
+            raise Exception( "PUTB error: " + str( reply[ 1 ] ) )
+        for line in reply[ 1 ]:
+            if parse_qs( line, True, True )[ 'result' ][ 0 ] != 'OK':
+                self.ns.disconnect()
+                raise Exception( "Unexpected PUTB result: " + line )
+
+        for jobID in [ jobID1, jobID2 ]:
+            status = self.ns.getFastJobStatus( 'TEST', jobID )
+            if status != "Done":
+                self.ns.disconnect()
+                raise Exception( "Unexpected job state: " + status )
+
+        self.ns.directSendCmd( 'PUTB count=1' )
+        self.ns.directReadSingleReply()
+        self.ns.directSendCmd( 'job_key=' + jobs[ 0 ][ 'job_key' ][ 0 ] +
+                               ' auth_token=' + jobs[ 0 ][ 'auth_token' ][ 0 ] +
+                               ' job_return_code=0 output="out"' )
+        reply = self.ns.directReadMultiReply()
+        self.ns.disconnect()
+        if reply[ 0 ] != True or len( reply[ 1 ] ) != 1:
+            raise Exception( "PUTB error: " + str( reply[ 1 ] ) )
+        values = parse_qs( reply[ 1 ][ 0 ], True, True )
+        if values[ 'result' ][ 0 ] != 'WARNING' or \
+           values[ 'code' ][ 0 ] != 'eJobAlreadyDone':
+            raise Exception( "Expected eJobAlreadyDone, got: " +
+                             reply[ 1 ][ 0 ] )
+        return True
+
+
+class Scenario2100( TestBase ):
+    " Scenario 2100 "
+
+    def __init__( self, netschedule ):
+        TestBase.__init__( self, netschedule )
+        return
+
+    @staticmethod
+    def getScenario():
+        " Provides the scenario "
+        return "Config with the job journal, SUBMIT 3 jobs, GET one, " \
+               "CANCEL one, kill -9 NS, start NS, kill -9 NS right " \
+               "after the recovery, start NS -> the job states are restored"
+
+    def execute( self ):
+        " Should return True if the execution completed successfully "
+        self.fromScratch( 1300 )
+        jobID1 = self.ns.submitJob( 'TEST', 'bla' )
+        jobID2 = self.ns.submitJob( 'TEST', 'bla' )
+        jobID3 = self.ns.submitJob( 'TEST', 'bla' )
+
+        j = self.ns.getJob( 'TEST' )
+        if j[ 0 ] != jobID1:
+            raise Exception( "Unexpected job for execution: " + j[ 0 ] )
+        self.ns.cancelJob( 'TEST', jobID2 )
+
+        # The second crash hits the jobs which are only in the journal
+        # written while recovering from the first one
+        for attempt in range( 2 ):
+            self.ns.kill( "SIGKILL" )
+            time.sleep( 1 )
+            self.ns.start()
+            time.sleep( 1 )
+            if not self.ns.isRunning():
+                raise Exception( "Cannot start netschedule after kill -9" )
+
+        expected = [ ( jobID1, "Running" ), ( jobID2, "Canceled" ),
+                     ( jobID3, "Pending" ) ]
+        for jobID, expectedStatus in expected:
+            status = self.ns.getFastJobStatus( 'TEST', jobID )
+            if status != expectedStatus:
+                raise Exception( "Unexpected state of job " + jobID +
+                                 " after recovery: " + status +
+                                 ". Expected: " + expectedStatus )
+        return True
+
+
+class Scenario2101( TestBase ):
+    " Scenario 2101 "
+
+    def __init__( self, netschedule ):
+        TestBase.__init__( self, netschedule )
+        return
+
+    @staticmethod
+    def getScenario():
+        " Provides the scenario "
+        return "Config with the job journal, SUBMIT 2 jobs, kill -9 NS, " \
+               "append a torn record to the journal, start NS, kill -9 NS " \
+               "right after the recovery, start NS -> both jobs are " \
+               "restored, a new job gets a new ID"
+
+    def execute( self ):
+        " Should return True if the execution completed successfully "
+        self.fromScratch( 1300 )
+        jobID1 = self.ns.submitJob( 'TEST', 'bla' )
+        jobID2 = self.ns.submitJob( 'TEST', 'bla' )
+
+        self.ns.kill( "SIGKILL" )
+        time.sleep( 1 )
+
+        # Simulate a crash in the middle of a transaction: a job record
+        # type followed by a truncated string length
+        journalDir = self.ns.getDBPath() + os.path.sep + "journal"
+        journals = [ name for name in os.listdir( journalDir )
+                     if name.startswith( "TEST." ) and
+                        name.endswith( ".journal" ) ]
+        if not journals:
+            raise Exception( "No journal found in " + journalDir )
+        journals.sort( key = lambda name: int( name.split( '.' )[ 1 ] ) )
+        journal = open( journalDir + os.path.sep + journals[ -1 ], "ab" )
+        journal.write( struct.pack( "=I", 1 ) + "\x05\x00" )
+        journal.close()
+
+        self.ns.start()
+        time.sleep( 1 )
+        if not self.ns.isRunning():
+            raise Exception( "Cannot start netschedule after kill -9" )
+
+        # The recovered journal is removed at this point
+        self.ns.kill( "SIGKILL" )
+        time.sleep( 1 )
+        self.ns.start()
+        time.sleep( 1 )
+        if not self.ns.isRunning():
+            raise Exception( "Cannot start netschedule after the second "
+                             "kill -9" )
+
+        for jobID in [ jobID1, jobID2 ]:
+            status = self.ns.getFastJobStatus( 'TEST', jobID )
+            if status != "Pending":
+                raise Exception( "Unexpected state of job " + jobID +
+                                 " after recovery: " + status )
+
+        jobID3 = self.ns.submitJob( 'TEST', 'bla' )
+        if jobID3 in [ jobID1, jobID2 ]:
+            raise Exception( "A recovered job ID is reused: " + jobID3 )
+        return True
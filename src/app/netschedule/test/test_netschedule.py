@@ -776,6 +776,12 @@ def main():
               pack_4_19.Scenario1902( netschedule ),
               pack_4_19.Scenario1903( netschedule ),
               pack_4_19.Scenario1904( netschedule ),
+
+              pack_4_19.Scenario2000( netschedule ),
+              pack_4_19.Scenario2001( netschedule ),
+
+              pack_4_19.Scenario2100( netschedule ),
+              pack_4_19.Scenario2101( netschedule ),
             ]
 
     # Calculate the start test index
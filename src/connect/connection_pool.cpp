@@ -35,6 +35,16 @@
 #include <connect/error_codes.hpp>
 #include "connection_pool.hpp"
 
+#ifdef NCBI_OS_LINUX
+#  include <sys/epoll.h>
+#  include <sys/eventfd.h>
+#  include <unistd.h>
+#  include <errno.h>
+#  ifndef EPOLLRDHUP
+#    define EPOLLRDHUP 0x2000
+#  endif
+#endif
+
 
 #define NCBI_USE_ERRCODE_X   Connect_ThrServer
 
@@ -56,13 +66,95 @@ std::string g_ServerConnTypeToString(enum EServerConnType  conn_type)
 }
 
 
+// Alarm times seen during a poll cycle
+struct CServer_ConnectionPool::SAlarmScan
+{
+    SAlarmScan(vector<IServer_ConnectionBase*>& requests)
+        : timer_requests(requests),
+          min_alarm_time(NULL),
+          alarm_time_defined(false),
+          current_time(CTime::eEmpty)
+    {}
+
+    void Add(TConnBase* conn_base, const CTime* alarm_time);
+
+    vector<IServer_ConnectionBase*>& timer_requests;
+    const CTime*                     min_alarm_time;
+    bool                             alarm_time_defined;
+    CTime                            current_time;
+};
+
+
+void CServer_ConnectionPool::SAlarmScan::Add(TConnBase*   conn_base,
+                                             const CTime* alarm_time)
+{
+    if (!alarm_time_defined) {
+        alarm_time_defined = true;
+        current_time = GetFastLocalTime();
+        min_alarm_time = *alarm_time > current_time? alarm_time: NULL;
+        timer_requests.clear();
+        timer_requests.push_back(conn_base);
+    } else if (min_alarm_time == NULL) {
+        if (*alarm_time <= current_time)
+            timer_requests.push_back(conn_base);
+    } else if (*alarm_time <= *min_alarm_time) {
+        if (*alarm_time != *min_alarm_time) {
+            min_alarm_time = *alarm_time > current_time? alarm_time
+                                                       : NULL;
+            timer_requests.clear();
+        }
+        timer_requests.push_back(conn_base);
+    }
+}
+
+
 CServer_ConnectionPool::CServer_ConnectionPool(unsigned max_connections) :
-    m_MaxConnections(max_connections), m_ListeningStarted(false)
+    m_MaxConnections(max_connections),
+    m_EpollFD(-1), m_WakeUpFD(-1), m_Rescan(true), m_RescanCycle(false),
+    m_ListeningStarted(false)
 {}
 
 CServer_ConnectionPool::~CServer_ConnectionPool()
 {
     Erase();
+#ifdef NCBI_OS_LINUX
+    if (m_EpollFD != -1)
+        close(m_EpollFD);
+    if (m_WakeUpFD != -1)
+        close(m_WakeUpFD);
+#endif
+}
+
+bool CServer_ConnectionPool::UseEpoll(void)
+{
+#ifdef NCBI_OS_LINUX
+    if (m_EpollFD != -1)
+        return true;
+    int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd == -1)
+        return false;
+    int wakeup_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeup_fd == -1) {
+        close(epoll_fd);
+        return false;
+    }
+    struct epoll_event evt;
+    evt.events = EPOLLIN;
+    evt.data.ptr = NULL;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wakeup_fd, &evt) != 0) {
+        close(wakeup_fd);
+        close(epoll_fd);
+        return false;
+    }
+
+    CMutexGuard guard(m_Mutex);
+    m_EpollFD = epoll_fd;
+    m_WakeUpFD = wakeup_fd;
+    m_Rescan = true;
+    return true;
+#else
+    return false;
+#endif
 }
 
 void CServer_ConnectionPool::Erase(void)
@@ -112,6 +204,10 @@ bool CServer_ConnectionPool::Add(TConnBase* conn, EServerConnType type)
         if (m_Data.find(conn) != m_Data.end())
             abort();
         m_Data.insert(conn);
+        if (type == eInactiveSocket)
+            m_Returned.push_back(conn);
+        else if (type == eListener)
+            m_Rescan = true;
     }}
 
     if (type == eListener)
@@ -121,7 +217,7 @@ bool CServer_ConnectionPool::Add(TConnBase* conn, EServerConnType type)
             // (e.g. in CServer::Run())
             conn->Activate();
 
-    PingControlConnection();
+    x_WakeUp();
     return true;
 }
 
@@ -129,6 +225,14 @@ void CServer_ConnectionPool::Remove(TConnBase* conn)
 {
     CMutexGuard guard(m_Mutex);
     m_Data.erase(conn);
+    if (m_EpollFD != -1) {
+        m_Returned.erase(remove(m_Returned.begin(), m_Returned.end(), conn),
+                         m_Returned.end());
+        m_Deferred.erase(conn);
+        m_Alarms.erase(conn);
+        if (conn->polled)
+            x_Disarm(conn, true);
+    }
 }
 
 
@@ -195,12 +299,40 @@ void CServer_ConnectionPool::SetConnType(TConnBase* conn, EServerConnType type)
 
     // Signal poll cycle to re-read poll vector by sending
     // byte to control socket
-    if (type == eInactiveSocket)
-        PingControlConnection();
+    if (type == eInactiveSocket) {
+        if (m_EpollFD != -1) {
+            CMutexGuard guard(m_Mutex);
+            m_Returned.push_back(conn);
+        }
+        x_WakeUp();
+    }
 }
 
 void CServer_ConnectionPool::PingControlConnection(void)
 {
+    if (m_EpollFD != -1) {
+        // Events to poll for or readiness to process might have changed
+        // for any connection
+        CMutexGuard guard(m_Mutex);
+        m_Rescan = true;
+    }
+    x_WakeUp();
+}
+
+void CServer_ConnectionPool::x_WakeUp(void)
+{
+#ifdef NCBI_OS_LINUX
+    if (m_EpollFD != -1) {
+        Uint8 one = 1;
+        if (write(m_WakeUpFD, &one, sizeof(one)) != sizeof(one)
+            &&  errno != EAGAIN) {
+            ERR_POST_X(4, Warning
+                       << "PingControlConnection: failed to write eventfd: "
+                       << strerror(errno));
+        }
+        return;
+    }
+#endif
     EIO_Status status = m_ControlTrigger.Set();
     if (status != eIO_Success) {
         ERR_POST_X(4, Warning
@@ -244,105 +376,58 @@ bool CServer_ConnectionPool::GetPollAndTimerVec(
     to_close_conns.clear();
     to_delete_conns.clear();
 
-    const CTime *   alarm_time = NULL;
-    const CTime *   min_alarm_time = NULL;
-    bool            alarm_time_defined = false;
-    CTime           current_time(CTime::eEmpty);
+    SAlarmScan      alarms(timer_requests);
 
     CMutexGuard     guard(m_Mutex);
 
     // Control trigger goes here as well
     polls.push_back(CSocketAPI::SPoll(&m_ControlTrigger, eIO_Read));
 
-    ERASE_ITERATE(TData, it, m_Data) {
-        // Check that socket is not processing packet - safeguards against
-        // out-of-order packet processing by effectively pulling socket from
-        // poll vector until it is done with previous packet. See comments in
-        // server.cpp: CServer_Connection::CreateRequest() and
-        // CServerConnectionRequest::Process()
-        TConnBase* conn_base = *it;
-        conn_base->type_lock.Lock();
-        EServerConnType conn_type = conn_base->type;
-
-        // There might be a request to delete a listener
-        if (conn_type == eListener) {
-            CServer_Listener *  listener = dynamic_cast<CServer_Listener *>(
-                                                                    conn_base);
-            if (listener) {
-                unsigned short  port = listener->GetPort();
-
-                vector<unsigned short>::iterator    port_it = 
-                        std::find(m_ListenerPortsToStop.begin(),
-                                  m_ListenerPortsToStop.end(), port);
-                if (port_it != m_ListenerPortsToStop.end()) {
-                    conn_base->type_lock.Unlock();
-                    m_ListenerPortsToStop.erase(port_it);
-                    delete conn_base;
-                    m_Data.erase(it);
-                    continue;
-                }
-            }
-        }
-
-
-        if (conn_type == eClosedSocket
-            ||  (conn_type == eInactiveSocket  &&  !conn_base->IsOpen()))
-        {
-            // If it's not eClosedSocket then This connection was closed
-            // by the client earlier in CServer::Run after Poll returned
-            // eIO_Close which was converted into eServIO_ClientClose.
-            // Then during OnSocketEvent(eServIO_ClientClose) it was marked
-            // as closed. Here we just clean it up from the connection pool.
-            to_delete_conns.push_back(conn_base);
-            m_Data.erase(it);
+    m_RescanCycle = false;
+    if (m_EpollFD == -1  ||  m_Rescan  ||  now >= m_NextSweep) {
+        // Look at every connection.  With epoll this is done on request
+        // and once a second to find expired connections; registered
+        // connections are re-armed only on request.
+        if (m_EpollFD != -1) {
+            m_RescanCycle = m_Rescan;
+            m_Rescan = false;
+            m_NextSweep = now;
+            m_NextSweep.AddSecond(1);
+            m_Returned.clear();
+            m_Deferred.clear();
+            m_Alarms.clear();
         }
-        else if (conn_type == eInactiveSocket  &&  conn_base->expiration <= now)
-        {
-            to_close_conns.push_back(conn_base);
-            m_Data.erase(it);
+        ERASE_ITERATE(TData, it, m_Data) {
+            if (!x_ProcessConn(*it, now, m_EpollFD == -1  ||  m_RescanCycle,
+                               polls, alarms, revived_conns,
+                               to_close_conns, to_delete_conns))
+                m_Data.erase(it);
         }
-        else if ((conn_type == eInactiveSocket  ||  conn_type == eListener)
-                 &&  conn_base->IsOpen())
-        {
-            CPollable* pollable = dynamic_cast<CPollable*>(conn_base);
-            _ASSERT(pollable);
-            polls.push_back(CSocketAPI::SPoll(pollable,
-                            conn_base->GetEventsToPollFor(&alarm_time)));
-            if (alarm_time != NULL) {
-                if (!alarm_time_defined) {
-                    alarm_time_defined = true;
-                    current_time = GetFastLocalTime();
-                    min_alarm_time = *alarm_time > current_time? alarm_time: NULL;
-                    timer_requests.clear();
-                    timer_requests.push_back(conn_base);
-                } else if (min_alarm_time == NULL) {
-                    if (*alarm_time <= current_time)
-                        timer_requests.push_back(conn_base);
-                } else if (*alarm_time <= *min_alarm_time) {
-                    if (*alarm_time != *min_alarm_time) {
-                        min_alarm_time = *alarm_time > current_time? alarm_time
-                                                                   : NULL;
-                        timer_requests.clear();
-                    }
-                    timer_requests.push_back(conn_base);
-                }
-                alarm_time = NULL;
-            }
-        }
-        else if (conn_type == eDeferredSocket  &&  conn_base->IsReadyToProcess())
-        {
-            conn_base->type = eActiveSocket;
-            revived_conns.push_back(conn_base);
+    }
+    else {
+        // Only connections which were returned to the pool, deferred
+        // ones and ones with alarms need attention
+        TData   conns(m_Deferred);
+        conns.insert(m_Alarms.begin(), m_Alarms.end());
+        conns.insert(m_Returned.begin(), m_Returned.end());
+        m_Returned.clear();
+        m_Deferred.clear();
+        m_Alarms.clear();
+        ITERATE(TData, it, conns) {
+            if (!x_ProcessConn(*it, now, false,
+                               polls, alarms, revived_conns,
+                               to_close_conns, to_delete_conns))
+                m_Data.erase(*it);
         }
-        conn_base->type_lock.Unlock();
     }
     guard.Release();
 
-    if (alarm_time_defined) {
+    if (alarms.alarm_time_defined) {
+        const CTime* min_alarm_time = alarms.min_alarm_time;
         if (min_alarm_time == NULL)
             timer_timeout->usec = timer_timeout->sec = 0;
         else {
-            CTimeSpan span(min_alarm_time->DiffTimeSpan(current_time));
+            CTimeSpan span(min_alarm_time->DiffTimeSpan(alarms.current_time));
             if (span.GetCompleteSeconds() < 0 ||
                 span.GetNanoSecondsAfterSecond() < 0)
             {
@@ -358,6 +443,310 @@ bool CServer_ConnectionPool::GetPollAndTimerVec(
     return false;
 }
 
+bool CServer_ConnectionPool::x_ProcessConn(
+                             TConnBase*                       conn_base,
+                             const CTime&                     now,
+                             bool                             rearm,
+                             vector<CSocketAPI::SPoll>&       polls,
+                             SAlarmScan&                      alarms,
+                             vector<IServer_ConnectionBase*>& revived_conns,
+                             vector<IServer_ConnectionBase*>& to_close_conns,
+                             vector<IServer_ConnectionBase*>& to_delete_conns)
+{
+    // Check that socket is not processing packet - safeguards against
+    // out-of-order packet processing by effectively pulling socket from
+    // poll vector until it is done with previous packet. See comments in
+    // server.cpp: CServer_Connection::CreateRequest() and
+    // CServerConnectionRequest::Process()
+    conn_base->type_lock.Lock();
+    EServerConnType conn_type = conn_base->type;
+
+    // There might be a request to delete a listener
+    if (conn_type == eListener) {
+        CServer_Listener *  listener = dynamic_cast<CServer_Listener *>(
+                                                                conn_base);
+        if (listener) {
+            unsigned short  port = listener->GetPort();
+
+            vector<unsigned short>::iterator    port_it = 
+                    std::find(m_ListenerPortsToStop.begin(),
+                              m_ListenerPortsToStop.end(), port);
+            if (port_it != m_ListenerPortsToStop.end()) {
+                conn_base->type_lock.Unlock();
+                m_ListenerPortsToStop.erase(port_it);
+                if (conn_base->polled)
+                    x_Disarm(conn_base, true);
+                delete conn_base;
+                return false;
+            }
+        }
+    }
+
+
+    if (conn_type == eClosedSocket
+        ||  (conn_type == eInactiveSocket  &&  !conn_base->IsOpen()))
+    {
+        // If it's not eClosedSocket then This connection was closed
+        // by the client earlier in CServer::Run after Poll returned
+        // eIO_Close which was converted into eServIO_ClientClose.
+        // Then during OnSocketEvent(eServIO_ClientClose) it was marked
+        // as closed. Here we just clean it up from the connection pool.
+        if (conn_base->polled)
+            x_Disarm(conn_base, true);
+        conn_base->type_lock.Unlock();
+        to_delete_conns.push_back(conn_base);
+        return false;
+    }
+    else if (conn_type == eInactiveSocket  &&  conn_base->expiration <= now)
+    {
+        if (conn_base->polled)
+            x_Disarm(conn_base, true);
+        conn_base->type_lock.Unlock();
+        to_close_conns.push_back(conn_base);
+        return false;
+    }
+    else if ((conn_type == eInactiveSocket  ||  conn_type == eListener)
+             &&  conn_base->IsOpen())
+    {
+        const CTime* alarm_time = NULL;
+        EIO_Event    events = conn_base->GetEventsToPollFor(&alarm_time);
+        if (rearm  ||  !conn_base->polled) {
+            CPollable* pollable = dynamic_cast<CPollable*>(conn_base);
+            _ASSERT(pollable);
+            polls.push_back(CSocketAPI::SPoll(pollable, events));
+            conn_base->polled = m_EpollFD != -1;
+        }
+        if (alarm_time != NULL) {
+            alarms.Add(conn_base, alarm_time);
+            if (m_EpollFD != -1)
+                m_Alarms.insert(conn_base);
+        }
+    }
+    else if (conn_type == eDeferredSocket)
+    {
+        if (conn_base->IsReadyToProcess()) {
+            conn_base->type = eActiveSocket;
+            revived_conns.push_back(conn_base);
+        }
+        else if (m_EpollFD != -1)
+            m_Deferred.insert(conn_base);
+    }
+    conn_base->type_lock.Unlock();
+    return true;
+}
+
+
+EIO_Status CServer_ConnectionPool::Poll(vector<CSocketAPI::SPoll>& polls,
+                                        const STimeout*            timeout,
+                                        size_t*                    count)
+{
+    if (m_EpollFD != -1)
+        return x_EpollPoll(polls, timeout, count);
+    return CSocketAPI::Poll(polls, timeout, count);
+}
+
+
+#ifdef NCBI_OS_LINUX
+
+// Check sockets which are not registered with epoll yet, or are being
+// re-armed, directly (CSocket may have data buffered already, which
+// epoll would not report).  Register the ones which are not ready and
+// remove them from the vector.  Returns the number of ready ones.
+size_t CServer_ConnectionPool::x_CheckCandidates(
+                                        vector<CSocketAPI::SPoll>& polls,
+                                        bool                       disarm_ready)
+{
+    static const STimeout kZeroTimeout = { 0, 0 };
+
+    if (polls.size() <= 1)
+        return 0;
+
+    // polls[0] is the control trigger, which is never set with epoll
+    size_t n_ready = 0;
+    EIO_Status status = CSocketAPI::Poll(polls, &kZeroTimeout, &n_ready);
+    if (status != eIO_Success  &&  status != eIO_Timeout) {
+        // Let epoll report the state of all of them
+        for (size_t i = 0;  i < polls.size();  ++i)
+            polls[i].m_REvent = eIO_Open;
+    }
+
+    n_ready = 0;
+    size_t kept = 1;
+    for (size_t i = 1;  i < polls.size();  ++i) {
+        TConnBase* conn_base =
+            dynamic_cast<TConnBase*>(polls[i].m_Pollable);
+        _ASSERT(conn_base);
+        bool is_listener = conn_base->type == eListener;
+        if (polls[i].m_REvent == eIO_Open  ||  is_listener)
+            x_Arm(conn_base, polls[i].m_Event);
+        else if (disarm_ready)
+            x_Disarm(conn_base, false);
+        if (polls[i].m_REvent != eIO_Open) {
+            polls[kept++] = polls[i];
+            ++n_ready;
+        }
+    }
+    polls.resize(kept);
+    return n_ready;
+}
+
+
+void CServer_ConnectionPool::x_Arm(TConnBase* conn, EIO_Event events)
+{
+    CPollable* pollable = dynamic_cast<CPollable*>(conn);
+    int        fd;
+    if (pollable->GetOSHandle(&fd, sizeof(fd)) != eIO_Success) {
+        // Let the next rescan look at it
+        conn->polled = false;
+        return;
+    }
+
+    struct epoll_event evt;
+    if (conn->type == eListener) {
+        // Listeners stay registered, accepting is done by this thread
+        evt.events = EPOLLIN;
+    }
+    else {
+        // Connections are handed over to a worker thread on the first
+        // event and re-armed when they are returned to the pool
+        evt.events = EPOLLET | EPOLLONESHOT;
+        if (events & eIO_Read)
+            evt.events |= EPOLLIN | EPOLLRDHUP;
+        if (events & eIO_Write)
+            evt.events |= EPOLLOUT;
+    }
+    evt.data.ptr = conn;
+    if (epoll_ctl(m_EpollFD, EPOLL_CTL_MOD, fd, &evt) != 0) {
+        if (errno != ENOENT
+            ||  epoll_ctl(m_EpollFD, EPOLL_CTL_ADD, fd, &evt) != 0) {
+            ERR_POST_X(12, "Cannot register socket with epoll: "
+                       << strerror(errno));
+            conn->polled = false;
+        }
+    }
+}
+
+
+void CServer_ConnectionPool::x_Disarm(TConnBase* conn, bool remove)
+{
+    CPollable* pollable = dynamic_cast<CPollable*>(conn);
+    int        fd;
+    conn->polled = false;
+    // A closed socket is removed from epoll by the kernel
+    if (pollable->GetOSHandle(&fd, sizeof(fd)) != eIO_Success)
+        return;
+    struct epoll_event evt;
+    evt.events = 0;
+    evt.data.ptr = conn;
+    epoll_ctl(m_EpollFD, remove ? EPOLL_CTL_DEL : EPOLL_CTL_MOD, fd, &evt);
+}
+
+
+EIO_Status CServer_ConnectionPool::x_EpollPoll(
+                                        vector<CSocketAPI::SPoll>& polls,
+                                        const STimeout*            timeout,
+                                        size_t*                    count)
+{
+    // Connections just returned to the pool are checked first; if one
+    // of them is ready, epoll is still polled, but without waiting, so
+    // that listeners and other sockets are not starved by busy clients
+    size_t n_ready = x_CheckCandidates(polls, m_RescanCycle);
+    polls[0].m_REvent = eIO_Open;
+
+    int wait_ms = -1;
+    if (n_ready > 0)
+        wait_ms = 0;
+    else if (timeout != kInfiniteTimeout  &&  timeout != kDefaultTimeout)
+        wait_ms = int(timeout->sec * 1000 + (timeout->usec + 999) / 1000);
+
+    static const int kMaxEvents = 256;
+    struct epoll_event events[kMaxEvents];
+    int n = epoll_wait(m_EpollFD, events, kMaxEvents, wait_ms);
+    if (n < 0) {
+        if (errno == EINTR) {
+            // Treat as a wake up
+            polls[0].m_REvent = eIO_Read;
+            ++n_ready;
+        }
+        else if (n_ready == 0)
+            return eIO_Unknown;
+        *count = n_ready;
+        return eIO_Success;
+    }
+
+    // Sockets reported by epoll are checked separately from the ready
+    // candidates, which stay in the beginning of polls
+    vector<CSocketAPI::SPoll> epolled(1, polls[0]);
+    bool woken_up = false;
+    for (int i = 0;  i < n;  ++i) {
+        TConnBase* conn_base = static_cast<TConnBase*>(events[i].data.ptr);
+        if (conn_base == NULL) {
+            Uint8 value;
+            while (read(m_WakeUpFD, &value, sizeof(value)) > 0)
+                ;
+            woken_up = true;
+            continue;
+        }
+        // The connection might have been taken by a timer or closed
+        // since it was registered
+        conn_base->type_lock.Lock();
+        EServerConnType conn_type = conn_base->type;
+        conn_base->type_lock.Unlock();
+        if (conn_type != eInactiveSocket  &&  conn_type != eListener)
+            continue;
+        CPollable* pollable = dynamic_cast<CPollable*>(conn_base);
+        _ASSERT(pollable);
+        // A ready candidate may be armed already, it must not be handed
+        // over twice
+        bool is_candidate = false;
+        for (size_t j = 1;  j < polls.size()  &&  !is_candidate;  ++j)
+            is_candidate = polls[j].m_Pollable == pollable;
+        if (is_candidate)
+            continue;
+        const CTime* alarm_time = NULL;
+        epolled.push_back(CSocketAPI::SPoll(pollable,
+                          conn_base->GetEventsToPollFor(&alarm_time)));
+    }
+
+    // Translate the readiness into the events CSocketAPI::Poll() would
+    // report (e.g. eIO_Close); spurious ones are re-armed
+    n_ready += x_CheckCandidates(epolled, false);
+    polls.insert(polls.end(), epolled.begin() + 1, epolled.end());
+    if (woken_up) {
+        polls[0].m_REvent = eIO_Read;
+        ++n_ready;
+    }
+    *count = n_ready;
+    return eIO_Success;
+}
+
+#else
+
+size_t CServer_ConnectionPool::x_CheckCandidates(vector<CSocketAPI::SPoll>&,
+                                                 bool)
+{
+    return 0;
+}
+
+void CServer_ConnectionPool::x_Arm(TConnBase*, EIO_Event)
+{
+}
+
+void CServer_ConnectionPool::x_Disarm(TConnBase* conn, bool)
+{
+    conn->polled = false;
+}
+
+EIO_Status CServer_ConnectionPool::x_EpollPoll(vector<CSocketAPI::SPoll>&,
+                                               const STimeout*,
+                                               size_t*)
+{
+    return eIO_NotSupported;
+}
+
+#endif  /* NCBI_OS_LINUX */
+
+
 void CServer_ConnectionPool::SetAllActive(const vector<CSocketAPI::SPoll>& polls)
 {
     ITERATE(vector<CSocketAPI::SPoll>, it, polls) {
@@ -372,8 +761,11 @@ void CServer_ConnectionPool::SetAllActive(const vector<CSocketAPI::SPoll>& polls
                         dynamic_cast<IServer_ConnectionBase*>(it->m_Pollable);
 
         conn_base->type_lock.Lock();
-        if (conn_base->type == eInactiveSocket)
+        if (conn_base->type == eInactiveSocket) {
             conn_base->type = eActiveSocket;
+            // epoll: one-shot registration has fired already
+            conn_base->polled = false;
+        }
         else if (conn_base->type != eListener)
             abort();
         conn_base->type_lock.Unlock();
@@ -388,6 +780,8 @@ void CServer_ConnectionPool::SetAllActive(const vector<IServer_ConnectionBase*>&
         if (conn_base->type != eInactiveSocket)
             abort();
         conn_base->type = eActiveSocket;
+        if (conn_base->polled)
+            x_Disarm(conn_base, false);
         conn_base->type_lock.Unlock();
     }
 }
@@ -400,6 +794,7 @@ void CServer_ConnectionPool::StartListening(void)
         (*it)->Activate();
     }
     m_ListeningStarted = true;
+    m_Rescan = true;
 }
 
 
@@ -409,6 +804,7 @@ void CServer_ConnectionPool::StopListening(void)
     ITERATE (TData, it, m_Data) {
         (*it)->Passivate();
     }
+    m_Rescan = true;
 }
 
 
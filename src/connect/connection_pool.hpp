@@ -85,6 +85,20 @@ public:
                             vector<IServer_ConnectionBase*>& to_close_conns,
                             vector<IServer_ConnectionBase*>& to_delete_conns);
 
+    /// Wait for events on the poll vector made by GetPollAndTimerVec().
+    /// Without epoll this is CSocketAPI::Poll(), with epoll only the
+    /// connections which became ready are left in the vector.
+    EIO_Status Poll(vector<CSocketAPI::SPoll>& polls,
+                    const STimeout*            timeout,
+                    size_t*                    count);
+
+    /// Switch to persistent epoll registrations (before the poll cycle
+    /// starts).  Connections are registered once and re-armed only when
+    /// returned to the pool, so a poll cycle costs O(active connections).
+    /// @return
+    ///  false if epoll is not available
+    bool UseEpoll(void);
+
     void StartListening(void);
     void StopListening(void);
 
@@ -94,7 +108,25 @@ public:
     vector<unsigned short>  GetListenerPorts(void);
 
 private:
+    struct SAlarmScan;
+
     void x_UpdateExpiration(TConnBase* conn);
+    void x_WakeUp(void);
+    bool x_ProcessConn(TConnBase*                       conn_base,
+                       const CTime&                     now,
+                       bool                             rearm,
+                       vector<CSocketAPI::SPoll>&       polls,
+                       SAlarmScan&                      alarms,
+                       vector<IServer_ConnectionBase*>& revived_conns,
+                       vector<IServer_ConnectionBase*>& to_close_conns,
+                       vector<IServer_ConnectionBase*>& to_delete_conns);
+    EIO_Status x_EpollPoll(vector<CSocketAPI::SPoll>& polls,
+                           const STimeout*            timeout,
+                           size_t*                    count);
+    size_t x_CheckCandidates(vector<CSocketAPI::SPoll>& polls,
+                             bool                       disarm_ready);
+    void x_Arm(TConnBase* conn, EIO_Event events);
+    void x_Disarm(TConnBase* conn, bool remove);
 
 
     typedef set<TConnBase*> TData;
@@ -104,6 +136,18 @@ private:
     unsigned int        m_MaxConnections;
     mutable CTrigger    m_ControlTrigger;
 
+    // epoll backend (m_EpollFD is -1 when not used).  The sets below
+    // are the only connections looked at in a poll cycle, all of them
+    // are protected with m_Mutex.
+    int                 m_EpollFD;
+    int                 m_WakeUpFD;     ///< eventfd interrupting epoll_wait
+    bool                m_Rescan;       ///< look at all connections
+    bool                m_RescanCycle;  ///< current cycle is a rescan
+    CTime               m_NextSweep;    ///< time to look for expired ones
+    vector<TConnBase*>  m_Returned;     ///< returned to the pool
+    TData               m_Deferred;     ///< waiting for IsReadyToProcess()
+    TData               m_Alarms;       ///< with alarm time set
+
 private:
     // A list of ports on which the listeners should be stopped.
     // A storage for the ports is needed because the listener deletion could
@@ -121,21 +121,106 @@ int Server_CheckLineMessage(BUF* buffer, const void *data, size_t size,
 }
 
 
+CBlockingQueue_ForServer::CBlockingQueue_ForServer(unsigned int work_queues)
+{
+    m_WorkQueued.Set(0);
+    m_WaitingThreads.Set(0);
+    m_NextWorkQueue.Set(0);
+    m_NextThreadQueue.Set(0);
+    m_WorkQueues.reserve(work_queues);
+    for (unsigned int i = 0;  i < work_queues;  ++i) {
+        m_WorkQueues.push_back(AutoPtr<SWorkQueue>(new SWorkQueue));
+    }
+}
+
+unsigned int
+CBlockingQueue_ForServer::AssignWorkQueue(void)
+{
+    if (m_WorkQueues.empty())
+        return 0;
+    return (unsigned int)
+        ((m_NextThreadQueue.Add(1) - 1) % m_WorkQueues.size());
+}
+
 CBlockingQueue_ForServer::TItemHandle
 CBlockingQueue_ForServer::Put(const TRequest& data)
 {
+    TItemHandle handle(new CQueueItem(data));
+    if ( !m_WorkQueues.empty() ) {
+        SWorkQueue& q = *m_WorkQueues[
+            (m_NextWorkQueue.Add(1) - 1) % m_WorkQueues.size()];
+        // Pairs with GetHandle():  the sleeping thread first counts itself
+        // as waiting and then checks m_WorkQueued, so one of the two sides
+        // always sees the other and no wakeup can be lost.  The item is
+        // counted before it is published, so that a worker cannot pop it
+        // and decrement the counter below zero.
+        {{
+            CFastMutexGuard q_guard(q.mutex);
+            m_WorkQueued.Add(1);
+            q.queue.push_back(handle);
+            q.size = q.queue.size();
+        }}
+        if (m_WaitingThreads.Get() != 0) {
+            CMutexGuard guard(m_Mutex);
+            m_GetCond.SignalSome();
+        }
+        return handle;
+    }
+
     CMutexGuard guard(m_Mutex);
     if (m_Queue.empty()) {
         m_GetCond.SignalAll();
     }
-    TItemHandle handle(new CQueueItem(data));
     m_Queue.push_back(handle);
     return handle;
 }
 
 CBlockingQueue_ForServer::TItemHandle
-CBlockingQueue_ForServer::GetHandle(void)
+CBlockingQueue_ForServer::x_PopWorkItem(unsigned int own_queue)
 {
+    size_t n = m_WorkQueues.size();
+    for (size_t i = 0;  i < n;  ++i) {
+        SWorkQueue& q = *m_WorkQueues[(own_queue + i) % n];
+        if (q.size == 0)
+            continue;
+        CFastMutexGuard q_guard(q.mutex);
+        if (q.queue.empty())
+            continue;
+        TItemHandle handle;
+        // The owner keeps the arrival order, thieves take from the other
+        // end to stay out of its way
+        if (i == 0) {
+            handle = q.queue.front();
+            q.queue.pop_front();
+        } else {
+            handle = q.queue.back();
+            q.queue.pop_back();
+        }
+        q.size = q.queue.size();
+        q_guard.Release();
+        m_WorkQueued.Add(-1);
+        return handle;
+    }
+    return TItemHandle();
+}
+
+CBlockingQueue_ForServer::TItemHandle
+CBlockingQueue_ForServer::GetHandle(unsigned int own_queue)
+{
+    if ( !m_WorkQueues.empty() ) {
+        TItemHandle handle;
+        while ((handle = x_PopWorkItem(own_queue)).Empty()) {
+            CMutexGuard guard(m_Mutex);
+            m_WaitingThreads.Add(1);
+            while (m_WorkQueued.Get() == 0) {
+                m_GetCond.WaitForSignal(m_Mutex);
+            }
+            m_WaitingThreads.Add(-1);
+        }
+        handle->x_SetStatus(CQueueItemBase::eActive);
+        return handle;
+    }
+
     CMutexGuard guard(m_Mutex);
 
     while (m_Queue.empty()) {
@@ -184,7 +269,7 @@ CThreadInPool_ForServer::x_UnregisterThread(void)
 void
 CThreadInPool_ForServer::x_HandleOneRequest(bool catch_all)
 {
-    TItemHandle handle(m_Pool->GetHandle());
+    TItemHandle handle(m_Pool->GetHandle(m_WorkQueue));
     if (catch_all) {
         try {
             ProcessRequest(handle);
@@ -237,8 +322,10 @@ CThreadInPool_ForServer::ProcessRequest(TItemHandle handle)
 
 
 CPoolOfThreads_ForServer::CPoolOfThreads_ForServer(unsigned int max_threads,
-                                                   const string& thr_suffix)
+                                                   const string& thr_suffix,
+                                                   bool work_stealing)
     : m_MaxThreads(max_threads),
+      m_Queue(work_stealing ? max_threads : 0),
       m_ThrSuffix(thr_suffix),
       m_KilledAll(false)
 {
@@ -277,9 +364,9 @@ CPoolOfThreads_ForServer::AcceptRequest(const TRequest& req)
 }
 
 CPoolOfThreads_ForServer::TItemHandle
-CPoolOfThreads_ForServer::GetHandle(void)
+CPoolOfThreads_ForServer::GetHandle(unsigned int own_queue)
 {
-    return m_Queue.GetHandle();
+    return m_Queue.GetHandle(own_queue);
 }
 
 
@@ -658,6 +745,11 @@ void CServer::x_DoRun(void)
 {
     m_ThreadPool->Spawn(m_Parameters->max_threads);
 
+    if (m_Parameters->use_epoll  &&  !m_ConnectionPool->UseEpoll()) {
+        ERR_POST_X(11, Warning << "epoll is not available, "
+                   "falling back to polling all connections");
+    }
+
     Init();
 
     vector<CSocketAPI::SPoll> polls;
@@ -708,7 +800,7 @@ void CServer::x_DoRun(void)
             timeout = &timer_timeout;
         }
 
-        EIO_Status status = CSocketAPI::Poll(polls, timeout, &count);
+        EIO_Status status = m_ConnectionPool->Poll(polls, timeout, &count);
 
         if (status != eIO_Success  &&  status != eIO_Timeout) {
             int x_errno = errno;
@@ -774,7 +866,8 @@ void CServer::Run(void)
     StartListening(); // detect unavailable ports ASAP
 
     m_ThreadPool = new CPoolOfThreads_ForServer(m_Parameters->max_threads,
-                                                m_ThreadSuffix);
+                                                m_ThreadSuffix,
+                                                m_Parameters->work_stealing);
     if (s_ServerCatchExceptions->Get()) {
         try {
             x_DoRun();
@@ -857,7 +950,9 @@ SServer_Parameters::SServer_Parameters() :
     idle_timeout(&k_DefaultIdleTimeout),
     init_threads(5),
     max_threads(10),
-    spawn_threshold(1)
+    spawn_threshold(1),
+    use_epoll(false),
+    work_stealing(false)
 {
 }
 
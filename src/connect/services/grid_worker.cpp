@@ -330,6 +330,7 @@ SGridWorkerNodeImpl::SGridWorkerNodeImpl(CNcbiApplication& app,
     m_MaxThreads(1),
     m_NSTimeout(DEFAULT_NS_TIMEOUT),
     m_CommitJobInterval(COMMIT_JOB_INTERVAL_DEFAULT),
+    m_JobBatchSize(1),
     m_CheckStatusPeriod(2),
     m_ExclusiveJobSemaphore(1, 1),
     m_IsProcessingExclusiveJob(false),
@@ -575,6 +576,11 @@ int SGridWorkerNodeImpl::Run(
     if (m_CommitJobInterval == 0)
         m_CommitJobInterval = 1;
 
+    m_JobBatchSize = reg.GetInt(kServerSec, "job_batch_size",
+            1, 0, IRegistry::eErrPost);
+    if (m_JobBatchSize == 0)
+        m_JobBatchSize = 1;
+
     m_CheckStatusPeriod = reg.GetInt(kServerSec,
             "check_status_period", 2, 0, IRegistry::eErrPost);
     if (m_CheckStatusPeriod == 0)
@@ -206,6 +206,7 @@ struct SGridWorkerNodeImpl : public CObject
     unsigned int                 m_NSTimeout;
     mutable CFastMutex           m_JobProcessorMutex;
     unsigned                     m_CommitJobInterval;
+    unsigned                     m_JobBatchSize;
     unsigned                     m_CheckStatusPeriod;
     CSemaphore                   m_ExclusiveJobSemaphore;
     bool                         m_IsProcessingExclusiveJob;
@@ -272,6 +273,12 @@ struct SGridWorkerNodeImpl : public CObject
             return erased;
         }
 
+        size_t Count()
+        {
+            TFastMutexGuard lock(m_Mutex);
+            return m_Ids.size();
+        }
+
     private:
         CFastMutex m_Mutex;
         unordered_set<string> m_Ids;
@@ -333,6 +340,7 @@ private:
         CImpl(SGridWorkerNodeImpl* worker_node) :
             m_API(worker_node->m_NetScheduleAPI),
             m_Timeout(worker_node->m_NSTimeout),
+            m_LastAnyAffinity(false),
             m_WorkerNode(worker_node)
         {
         }
@@ -354,6 +362,12 @@ private:
         CNetScheduleAPI m_API;
         const unsigned m_Timeout;
 
+        // The job request criteria of the last received job; the
+        // additional jobs of a batch are requested with the same ones.
+        CNetServer m_LastServer;
+        string m_LastPrioAffList;
+        bool m_LastAnyAffinity;
+
     private:
         SGridWorkerNodeImpl* m_WorkerNode;
 
@@ -361,10 +375,13 @@ private:
     };
 
     bool x_GetNextJob(CNetScheduleJob& job);
+    void x_PrefetchJobs();
+    void x_ReturnPrefetchedJobs();
 
     SGridWorkerNodeImpl* m_WorkerNode;
     CImpl m_Impl;
     CNetScheduleGetJobImpl<CImpl> m_Timeline;
+    deque<CNetScheduleJob> m_PrefetchedJobs;
     const string m_ThreadName;
 };
 
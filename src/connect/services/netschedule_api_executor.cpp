@@ -246,6 +246,37 @@ bool CGetJobCmdExecutor::Consider(CNetServer server)
     return m_Executor->ExecGET(server, m_GetCmd, m_Job);
 }
 
+class CGetJobsCmdExecutor : public INetServerFinder
+{
+public:
+    CGetJobsCmdExecutor(const string& get_cmd, vector<CNetScheduleJob>& jobs,
+            size_t max_count, SNetScheduleExecutorImpl* executor) :
+        m_GetCmd(get_cmd), m_Jobs(jobs), m_MaxCount(max_count),
+        m_Executor(executor)
+    {
+    }
+
+    virtual bool Consider(CNetServer server);
+
+private:
+    const string& m_GetCmd;
+    vector<CNetScheduleJob>& m_Jobs;
+    size_t m_MaxCount;
+    SNetScheduleExecutorImpl* m_Executor;
+};
+
+bool CGetJobsCmdExecutor::Consider(CNetServer server)
+{
+    // GETB accepts the same job selection criteria as GET2.
+    string cmd("GETB count=");
+    cmd += NStr::NumericToString(m_MaxCount - m_Jobs.size());
+    cmd.append(m_GetCmd, sizeof("GET2") - 1, NPOS);
+
+    m_Executor->ExecGETB(server, cmd, m_Jobs);
+
+    return m_Jobs.size() >= m_MaxCount;
+}
+
 const CNetScheduleAPI::SServerParams& CNetScheduleExecutor::GetServerParams()
 {
     return m_Impl->m_API->GetServerParams();
@@ -316,15 +347,14 @@ string SNetScheduleExecutorImpl::MkSETAFFCmd()
     return cmd;
 }
 
-bool SNetScheduleExecutorImpl::ExecGET(SNetServerImpl* server,
-        const string& get_cmd, CNetScheduleJob& job)
+void SNetScheduleExecutorImpl::x_ExecGETCmd(SNetServerImpl* server,
+        const string& get_cmd, bool multiline_output,
+        CNetServer::SExecResult& exec_result)
 {
     CNetScheduleGETCmdListener get_cmd_listener(this);
 
-    CNetServer::SExecResult exec_result;
-
     try {
-        server->ConnectAndExec(get_cmd, false,
+        server->ConnectAndExec(get_cmd, multiline_output,
                 exec_result, NULL, &get_cmd_listener);
     }
     catch (CNetScheduleException& e) {
@@ -341,9 +371,17 @@ bool SNetScheduleExecutorImpl::ExecGET(SNetServerImpl* server,
             listener->SetAffinitiesSynced(server, true);
         }
 
-        server->ConnectAndExec(get_cmd, false,
+        server->ConnectAndExec(get_cmd, multiline_output,
                 exec_result, NULL, &get_cmd_listener);
     }
+}
+
+bool SNetScheduleExecutorImpl::ExecGET(SNetServerImpl* server,
+        const string& get_cmd, CNetScheduleJob& job)
+{
+    CNetServer::SExecResult exec_result;
+
+    x_ExecGETCmd(server, get_cmd, false, exec_result);
 
     if (!g_ParseGetJobResponse(job, exec_result.response))
         return false;
@@ -358,6 +396,34 @@ bool SNetScheduleExecutorImpl::ExecGET(SNetServerImpl* server,
     return true;
 }
 
+void SNetScheduleExecutorImpl::ExecGETB(SNetServerImpl* server,
+        const string& get_cmd, vector<CNetScheduleJob>& jobs)
+{
+    CNetServer::SExecResult exec_result;
+
+    x_ExecGETCmd(server, get_cmd, true, exec_result);
+
+    CNetServerMultilineCmdOutput output(exec_result);
+    string line;
+
+    while (output.ReadLine(line)) {
+        CNetScheduleJob job;
+
+        // Lines without a job (e.g. the queue pause status) are skipped.
+        if (!g_ParseGetJobResponse(job, line))
+            continue;
+
+        // Remember the server that issued this job.
+        job.server = server;
+
+        // If a new preferred affinity is given by the server,
+        // register it with the rest of servers.
+        ClaimNewPreferredAffinity(server, job.affinity);
+
+        jobs.push_back(job);
+    }
+}
+
 bool SNetScheduleExecutorImpl::x_GetJobWithAffinityLadder(
         SNetServerImpl* server, const CDeadline& timeout, 
         const string& prio_aff_list, bool any_affinity, CNetScheduleJob& job)
@@ -380,6 +446,27 @@ bool SNetScheduleExecutorImpl::x_GetJobWithAffinityLadder(
     return ExecGET(server, cmd, job);
 }
 
+void SNetScheduleExecutorImpl::x_GetJobsWithAffinityLadder(
+        SNetServerImpl* server, const string& prio_aff_list,
+        bool any_affinity, size_t max_count, vector<CNetScheduleJob>& jobs)
+{
+    const auto affinity_preference = any_affinity ? m_AffinityPreference :
+        CNetScheduleExecutor::eExplicitAffinitiesOnly;
+
+    string cmd("GETB count=" + NStr::NumericToString(max_count));
+    cmd.append(s_GET2(affinity_preference), sizeof("GET2") - 1, NPOS);
+    const bool have_affinities = !prio_aff_list.empty();
+
+    if (have_affinities) cmd += " aff=" + prio_aff_list;
+
+    m_NotificationHandler.CmdAppendTimeoutGroupAndClientInfo(cmd,
+            NULL, m_JobGroup);
+
+    if (have_affinities) cmd += " prioritized_aff=1";
+
+    ExecGETB(server, cmd, jobs);
+}
+
 bool CNetScheduleExecutor::GetJob(CNetScheduleJob& job,
         const string& affinity_list,
         CDeadline* deadline)
@@ -441,6 +528,28 @@ bool CNetScheduleExecutor::GetJob(CNetScheduleJob& job,
     }
 }
 
+size_t CNetScheduleExecutor::GetJobs(vector<CNetScheduleJob>& jobs,
+        size_t max_count, const string& affinity_list)
+{
+    const size_t initial_count = jobs.size();
+
+    if (max_count == 0)
+        return 0;
+
+    string cmd(CNetScheduleNotificationHandler::MkBaseGETCmd(
+            m_Impl->m_AffinityPreference, affinity_list));
+    m_Impl->m_NotificationHandler.CmdAppendTimeoutGroupAndClientInfo(
+            cmd, NULL, m_Impl->m_JobGroup);
+
+    CGetJobsCmdExecutor get_cmd_executor(cmd, jobs,
+            initial_count + max_count, m_Impl);
+
+    m_Impl->m_API->m_Service.FindServer(&get_cmd_executor,
+            CNetService::eIncludePenalized);
+
+    return jobs.size() - initial_count;
+}
+
 string s_GET2(CNetScheduleExecutor::EJobAffinityPreference affinity_preference)
 {
     switch (affinity_preference) {
@@ -571,12 +680,10 @@ void SNetScheduleExecutorImpl::ExecWithOrWithoutRetry(
     }
 }
 
-void CNetScheduleExecutor::PutResult(const CNetScheduleJob& job)
+static void s_AppendPutResultArgs(string& cmd, const CNetScheduleJob& job)
 {
-    s_CheckOutputSize(job.output,
-        m_Impl->m_API->GetServerParams().max_output_size);
-
-    string cmd("PUT2 job_key=" + job.job_id);
+    cmd.append("job_key=");
+    cmd.append(job.job_id);
 
     limits::Check<limits::SAuthToken>(job.auth_token);
     cmd.append(" auth_token=");
@@ -588,12 +695,118 @@ void CNetScheduleExecutor::PutResult(const CNetScheduleJob& job)
     cmd.append(" output=\"");
     cmd.append(NStr::PrintableString(job.output));
     cmd.push_back('\"');
+}
+
+void CNetScheduleExecutor::PutResult(const CNetScheduleJob& job)
+{
+    s_CheckOutputSize(job.output,
+        m_Impl->m_API->GetServerParams().max_output_size);
+
+    string cmd("PUT2 ");
+    s_AppendPutResultArgs(cmd, job);
 
     g_AppendClientIPSessionIDHitID(cmd);
 
     m_Impl->ExecWithOrWithoutRetry(job, cmd);
 }
 
+size_t CNetScheduleExecutor::PutResults(const vector<CNetScheduleJob>& jobs,
+        vector<string>* errors)
+{
+    // Must not exceed the server limit for one PUTB command.
+    const size_t kMaxBatchSize = 1000;
+
+    const size_t max_output_size =
+        m_Impl->m_API->GetServerParams().max_output_size;
+
+    ITERATE(vector<CNetScheduleJob>, it, jobs) {
+        s_CheckOutputSize(it->output, max_output_size);
+    }
+
+    if (errors != NULL) {
+        errors->clear();
+        errors->resize(jobs.size());
+    }
+
+    // The results go to the servers that issued the jobs.
+    typedef map<string, pair<CNetServer, vector<size_t> > > TServerJobs;
+    TServerJobs server_jobs;
+
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        CNetServer server(m_Impl->m_API->GetServer(jobs[i]));
+        pair<CNetServer, vector<size_t> >& server_batch =
+            server_jobs[server.GetServerAddress()];
+        server_batch.first = server;
+        server_batch.second.push_back(i);
+    }
+
+    size_t accepted = 0;
+    string cmd;
+    string line;
+
+    NON_CONST_ITERATE(TServerJobs, server_batch, server_jobs) {
+        const vector<size_t>& indices = server_batch->second.second;
+
+        for (size_t start = 0; start < indices.size(); ) {
+            size_t batch_size = min(indices.size() - start, kMaxBatchSize);
+
+            cmd = "PUTB count=";
+            cmd.append(NStr::NumericToString(batch_size));
+            g_AppendClientIPSessionIDHitID(cmd);
+
+            CNetServer::SExecResult exec_result;
+            server_batch->second.first->ConnectAndExec(cmd, false,
+                    exec_result);
+
+            // A connection left in the middle of the reply must not go
+            // back to the pool
+            try {
+                for (size_t i = start; i < start + batch_size; ++i) {
+                    cmd.erase();
+                    s_AppendPutResultArgs(cmd, jobs[indices[i]]);
+                    exec_result.conn->WriteLine(cmd);
+                }
+
+                // One line per job in the order of the request, then END.
+                for (size_t i = start; ; ++i) {
+                    exec_result.conn->ReadCmdOutputLine(line, true);
+                    if (line == "END")
+                        break;
+                    if (i >= start + batch_size) {
+                        NCBI_THROW(CNetServiceException, eProtocolError,
+                                "Invalid server response to PUTB: " + line);
+                    }
+
+                    CUrlArgs result(line);
+                    const string& status = result.GetValue("result");
+
+                    if (status != "ERR") {
+                        ++accepted;
+                        continue;
+                    }
+
+                    string error(result.GetValue("code") + ": " +
+                            result.GetValue("message"));
+
+                    ERR_POST(Warning << "Job " << jobs[indices[i]].job_id <<
+                            " results were not accepted: " << error);
+
+                    if (errors != NULL)
+                        (*errors)[indices[i]] = error;
+                }
+            }
+            catch (...) {
+                exec_result.conn->Abort();
+                throw;
+            }
+
+            start += batch_size;
+        }
+    }
+
+    return accepted;
+}
+
 void CNetScheduleExecutor::PutProgressMsg(const CNetScheduleJob& job)
 {
     if (job.progress_msg.length() >= kNetScheduleMaxDBDataSize) {
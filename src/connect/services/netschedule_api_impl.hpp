@@ -505,11 +505,20 @@ struct SNetScheduleExecutorImpl : public CObject
     string MkSETAFFCmd();
     bool ExecGET(SNetServerImpl* server,
             const string& get_cmd, CNetScheduleJob& job);
+    void ExecGETB(SNetServerImpl* server,
+            const string& get_cmd, vector<CNetScheduleJob>& jobs);
+    void x_ExecGETCmd(SNetServerImpl* server, const string& get_cmd,
+            bool multiline_output, CNetServer::SExecResult& exec_result);
     bool x_GetJobWithAffinityLadder(SNetServerImpl* server,
             const CDeadline& timeout,
             const string& prio_aff_list,
             bool any_affinity,
             CNetScheduleJob& job);
+    void x_GetJobsWithAffinityLadder(SNetServerImpl* server,
+            const string& prio_aff_list,
+            bool any_affinity,
+            size_t max_count,
+            vector<CNetScheduleJob>& jobs);
 
     void ExecWithOrWithoutRetry(const CNetScheduleJob& job, const string& cmd);
     void ReturnJob(const CNetScheduleJob& job, bool blacklist = true);
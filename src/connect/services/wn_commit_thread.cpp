@@ -135,7 +135,36 @@ void* CJobCommitterThread::Main()
             m_Timeline.pop_front();
         }
 
+        // The number of jobs to commit one by one after a failed batch.
+        size_t single_commits = 0;
+
         while (!m_ImmediateActions.empty()) {
+            // Results of the jobs that are done are put in batches
+            // to save round trips to the server.
+            size_t batch_size = single_commits > 0 ? 0 :
+                    x_GetDoneJobBatchSize();
+
+            if (batch_size > 1) {
+                vector<TEntry> batch(m_ImmediateActions.begin(),
+                        m_ImmediateActions.begin() + batch_size);
+
+                // The same as below: the job contexts stay in
+                // m_ImmediateActions while they are being committed.
+                if (x_CommitJobBatch(batch)) {
+                    m_JobContextPool.insert(m_JobContextPool.end(),
+                            batch.begin(), batch.end());
+                    m_ImmediateActions.erase(m_ImmediateActions.begin(),
+                            m_ImmediateActions.begin() + batch_size);
+                    continue;
+                }
+                // Otherwise, commit the jobs one by one so
+                // that each of them is retried individually.
+                single_commits = batch_size;
+            }
+
+            if (single_commits > 0)
+                --single_commits;
+
             TEntry& entry = m_ImmediateActions.front();
 
             // Do not remove the job context from m_ImmediateActions
@@ -155,6 +184,63 @@ void* CJobCommitterThread::Main()
     return NULL;
 }
 
+size_t CJobCommitterThread::x_GetDoneJobBatchSize() const
+{
+    const size_t max_batch_size = m_WorkerNode->m_JobBatchSize;
+    size_t batch_size = 0;
+
+    // Only the jobs committed for the first time are batched;
+    // the retries keep their own schedule.
+    ITERATE(TCommitJobTimeline, it, m_ImmediateActions) {
+        if (batch_size >= max_batch_size ||
+                (*it)->m_JobCommitStatus != CWorkerNodeJobContext::eCS_Done ||
+                !(*it)->m_FirstCommitAttempt)
+            break;
+        ++batch_size;
+    }
+
+    return batch_size;
+}
+
+bool CJobCommitterThread::x_CommitJobBatch(vector<TEntry>& batch)
+{
+    TFastMutexUnlockGuard mutext_unlock(m_TimelineMutex);
+
+    vector<CNetScheduleJob> jobs;
+    vector<string> errors;
+
+    jobs.reserve(batch.size());
+    ITERATE(vector<TEntry>, it, batch) {
+        jobs.push_back((*it)->m_Job);
+    }
+
+    try {
+        m_WorkerNode->m_NSExecutor.PutResults(jobs, &errors);
+    }
+    catch (exception& e) {
+        ERR_POST_X(63, "Error while committing a batch of " <<
+                batch.size() << " jobs: " << e.what() <<
+                "; will commit them one by one.");
+        return false;
+    }
+
+    for (size_t i = 0; i < batch.size(); ++i) {
+        SWorkerNodeJobContextImpl* job_context = batch[i];
+        CRequestContextSwitcher request_state_guard(
+                job_context->m_RequestContext);
+
+        if (!errors[i].empty()) {
+            ERR_POST_X(65, "Could not commit " <<
+                    job_context->m_Job.job_id << ": " << errors[i]);
+        }
+
+        m_WorkerNode->m_JobsInProgress.Remove(job_context->m_Job.job_id);
+        job_context->x_PrintRequestStop();
+    }
+
+    return true;
+}
+
 bool CJobCommitterThread::x_CommitJob(SWorkerNodeJobContextImpl* job_context)
 {
     TFastMutexUnlockGuard mutext_unlock(m_TimelineMutex);
@@ -93,6 +93,8 @@ private:
 
     bool WaitForTimeout();
     bool x_CommitJob(SWorkerNodeJobContextImpl* job_context);
+    size_t x_GetDoneJobBatchSize() const;
+    bool x_CommitJobBatch(vector<TEntry>& batch);
 
     void WakeUp()
     {
@@ -624,6 +624,8 @@ void* CMainLoopThread::Main()
         try_count = 0;
     }
 
+    x_ReturnPrefetchedJobs();
+
     return NULL;
 }
 
@@ -707,8 +709,15 @@ bool CMainLoopThread::CImpl::CheckEntry(
         CNetScheduleAPI::EJobStatus* /*job_status*/)
 {
     CNetServer server(m_API.GetService()->GetServer(entry.server_address));
-    return m_WorkerNode->m_NSExecutor->x_GetJobWithAffinityLadder(server,
-            m_Timeout, prio_aff_list, any_affinity, job);
+
+    if (!m_WorkerNode->m_NSExecutor->x_GetJobWithAffinityLadder(server,
+            m_Timeout, prio_aff_list, any_affinity, job))
+        return false;
+
+    m_LastServer = server;
+    m_LastPrioAffList = prio_aff_list;
+    m_LastAnyAffinity = any_affinity;
+    return true;
 }
 
 void CMainLoopThread::CImpl::ReturnJob(CNetScheduleJob& job)
@@ -718,16 +727,27 @@ void CMainLoopThread::CImpl::ReturnJob(CNetScheduleJob& job)
 
 bool CMainLoopThread::x_GetNextJob(CNetScheduleJob& job)
 {
-    if (!m_WorkerNode->x_AreMastersBusy()) {
-        SleepSec(m_WorkerNode->m_NSTimeout);
-        return false;
-    }
+    if (!m_PrefetchedJobs.empty()) {
+        if (!m_WorkerNode->WaitForExclusiveJobToFinish())
+            return false;
 
-    if (!m_WorkerNode->WaitForExclusiveJobToFinish())
-        return false;
+        job = m_PrefetchedJobs.front();
+        m_PrefetchedJobs.pop_front();
+    } else {
+        if (!m_WorkerNode->x_AreMastersBusy()) {
+            SleepSec(m_WorkerNode->m_NSTimeout);
+            return false;
+        }
 
-    if (m_Timeline.GetJob(CTimeout::eInfinite, job, NULL) != CNetScheduleGetJob::eJob) {
-        return false;
+        if (!m_WorkerNode->WaitForExclusiveJobToFinish())
+            return false;
+
+        if (m_Timeline.GetJob(CTimeout::eInfinite, job, NULL) !=
+                CNetScheduleGetJob::eJob) {
+            return false;
+        }
+
+        x_PrefetchJobs();
     }
 
     // Already executing this job, so do nothing
@@ -752,6 +772,51 @@ bool CMainLoopThread::x_GetNextJob(CNetScheduleJob& job)
     return true;
 }
 
+// Requests more jobs from the server that has just provided one, so that
+// a batch of short jobs costs a single round trip. No more jobs than
+// there are idle threads are requested; the rest stay in the queue for
+// the other worker nodes.
+void CMainLoopThread::x_PrefetchJobs()
+{
+    if (m_WorkerNode->m_JobBatchSize <= 1 || !m_Impl.m_LastServer)
+        return;
+
+    size_t busy_threads = m_WorkerNode->m_JobsInProgress.Count() + 1;
+
+    if (busy_threads >= m_WorkerNode->m_MaxThreads)
+        return;
+
+    size_t max_count = min<size_t>(m_WorkerNode->m_JobBatchSize - 1,
+            m_WorkerNode->m_MaxThreads - busy_threads);
+
+    vector<CNetScheduleJob> jobs;
+
+    try {
+        m_WorkerNode->m_NSExecutor->x_GetJobsWithAffinityLadder(
+                m_Impl.m_LastServer, m_Impl.m_LastPrioAffList,
+                m_Impl.m_LastAnyAffinity, max_count, jobs);
+    }
+    catch (exception& e) {
+        // The job already received is not affected.
+        ERR_POST_X(67, "Could not get a job batch: " << e.what());
+    }
+
+    m_PrefetchedJobs.insert(m_PrefetchedJobs.end(), jobs.begin(), jobs.end());
+}
+
+void CMainLoopThread::x_ReturnPrefetchedJobs()
+{
+    for (; !m_PrefetchedJobs.empty(); m_PrefetchedJobs.pop_front()) {
+        try {
+            m_WorkerNode->m_NSExecutor.ReturnJob(m_PrefetchedJobs.front());
+        }
+        catch (exception& e) {
+            ERR_POST_X(68, "Could not return job " <<
+                    m_PrefetchedJobs.front().job_id << ": " << e.what());
+        }
+    }
+}
+
 size_t CGridWorkerNode::GetServerOutputSize()
 {
     return m_Impl->m_QueueEmbeddedOutputSize;
@@ -348,6 +348,9 @@ void CServerTestApp::Init(void)
                             "Maximum delay in milliseconds",
                             CArgDescriptions::eInteger, "1000");
 
+    arg_desc->AddFlag("epoll", "Use epoll based poll cycle (Linux only)");
+    arg_desc->AddFlag("stealing", "Use per-thread request queues");
+
     SetupArgDescriptions(arg_desc.release());
 }
 
@@ -396,6 +399,8 @@ int CServerTestApp::Run(void)
     params.init_threads = args["srvthreads"].AsInteger();
     params.max_threads = args["maxsrvthreads"].AsInteger();
     params.accept_timeout = &kAcceptTimeout;
+    params.use_epoll = args["epoll"];
+    params.work_stealing = args["stealing"];
 
     int max_number_of_clients = args["requests"].AsInteger();
 
@@ -0,0 +1,289 @@
+/* $Id$
+ * ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ *
+ * File Description:
+ *   CServer poll cycle scaling benchmark: request latency on a few busy
+ *   connections while many other connections stay idle.
+ *
+ */
+
+#include <ncbi_pch.hpp>
+#include <corelib/ncbiapp.hpp>
+#include <corelib/ncbithr.hpp>
+#include <corelib/ncbitime.hpp>
+#include <connect/ncbi_util.h>
+#include <connect/ncbi_socket.hpp>
+#include <connect/server.hpp>
+
+#include "test_assert.h"  // This header must go last
+
+
+BEGIN_NCBI_SCOPE
+
+
+/// Server which stops when the client is done
+class CScalingServer : public CServer
+{
+public:
+    CScalingServer(void) : m_ShutdownRequested(false) { }
+
+    virtual bool ShutdownRequested(void) { return m_ShutdownRequested; }
+    void RequestShutdown(void) { m_ShutdownRequested = true; }
+
+private:
+    volatile bool m_ShutdownRequested;
+};
+
+
+/// Echo every line back
+class CEchoHandler : public IServer_LineMessageHandler
+{
+public:
+    virtual void OnOpen(void) { }
+    virtual void OnWrite(void) { }
+    virtual void OnMessage(BUF buf);
+};
+
+void CEchoHandler::OnMessage(BUF buf)
+{
+    char   data[256];
+    size_t msg_size = BUF_Read(buf, data, sizeof(data) - 1);
+    data[msg_size++] = '\n';
+    GetSocket().Write(data, msg_size);
+}
+
+
+/// Client side: opens the idle connections, then measures round trips
+/// on the busy ones
+class CClientThread : public CThread
+{
+public:
+    CClientThread(CScalingServer& server, unsigned short port,
+                  int idle, int busy, int requests)
+        : m_Server(server), m_Port(port),
+          m_Idle(idle), m_Busy(busy), m_Requests(requests),
+          m_Ok(false), m_SetupTime(0.0), m_RunTime(0.0)
+    {
+    }
+
+    bool   IsOk(void)         const { return m_Ok; }
+    double GetSetupTime(void) const { return m_SetupTime; }
+    double GetRunTime(void)   const { return m_RunTime; }
+
+protected:
+    virtual void* Main(void);
+
+private:
+    bool x_RoundTrip(CSocket& sock, const string& msg);
+
+    CScalingServer& m_Server;
+    unsigned short  m_Port;
+    int             m_Idle;
+    int             m_Busy;
+    int             m_Requests;
+    bool            m_Ok;
+    double          m_SetupTime;
+    double          m_RunTime;
+};
+
+
+bool CClientThread::x_RoundTrip(CSocket& sock, const string& msg)
+{
+    string reply;
+    return sock.Write(msg.data(), msg.size()) == eIO_Success
+        &&  sock.ReadLine(reply) == eIO_Success
+        &&  reply.size() + 1 == msg.size();
+}
+
+
+void* CClientThread::Main(void)
+{
+    static const STimeout kTimeout = { 30, 0 };
+
+    vector< AutoPtr<CSocket> > socks;
+    int total = m_Idle + m_Busy;
+    socks.reserve(total);
+
+    // One round trip per connection makes sure it is accepted and
+    // registered by the server before the measurement starts
+    CStopWatch sw(CStopWatch::eStart);
+    for (int i = 0;  i < total;  ++i) {
+        AutoPtr<CSocket> sock(new CSocket("127.0.0.1", m_Port, &kTimeout));
+        sock->SetTimeout(eIO_ReadWrite, &kTimeout);
+        if (!x_RoundTrip(*sock, "hello\n")) {
+            ERR_POST("Connection " << i << " failed");
+            m_Server.RequestShutdown();
+            return NULL;
+        }
+        socks.push_back(sock);
+    }
+    m_SetupTime = sw.Restart();
+
+    bool ok = true;
+    for (int i = 0;  ok  &&  i < m_Requests;  ++i)
+        ok = x_RoundTrip(*socks[m_Idle + i % m_Busy], "request\n");
+    m_RunTime = sw.Elapsed();
+
+    // The idle ones must still be served
+    for (int i = 0;  ok  &&  i < m_Idle;  i += 1 + m_Idle / 10)
+        ok = x_RoundTrip(*socks[i], "bye\n");
+
+    m_Ok = ok;
+    m_Server.RequestShutdown();
+    return NULL;
+}
+
+
+/// CServerScalingApp --
+///
+/// Main application class pulling everything together.
+class CServerScalingApp : public CNcbiApplication
+{
+public:
+    virtual void Init(void);
+    virtual int  Run (void);
+    virtual void Exit(void);
+};
+
+
+void CServerScalingApp::Init(void)
+{
+    CORE_SetLOCK(MT_LOCK_cxx2c());
+    CORE_SetLOG(LOG_cxx2c());
+
+    auto_ptr<CArgDescriptions> arg_desc(new CArgDescriptions);
+
+    arg_desc->SetUsageContext(GetArguments().GetProgramBasename(),
+                              "CServer idle connections scaling benchmark");
+
+    arg_desc->AddDefaultKey("idle", "N",
+                            "Number of idle connections",
+                            CArgDescriptions::eInteger, "1000");
+
+    arg_desc->AddDefaultKey("busy", "N",
+                            "Number of connections making requests",
+                            CArgDescriptions::eInteger, "1");
+
+    arg_desc->AddDefaultKey("requests", "N",
+                            "Number of requests to make",
+                            CArgDescriptions::eInteger, "10000");
+
+    arg_desc->AddDefaultKey("srvthreads", "N",
+                            "Number of server threads",
+                            CArgDescriptions::eInteger, "4");
+
+    arg_desc->SetConstraint("idle", new CArgAllow_Integers(0, 1000000));
+    arg_desc->SetConstraint("busy", new CArgAllow_Integers(1, 1000));
+    arg_desc->SetConstraint("requests", new CArgAllow_Integers(1, 100000000));
+    arg_desc->SetConstraint("srvthreads", new CArgAllow_Integers(1, 999));
+
+    arg_desc->AddFlag("epoll", "Use epoll based poll cycle (Linux only)");
+    arg_desc->AddFlag("stealing", "Use per-thread request queues");
+
+    SetupArgDescriptions(arg_desc.release());
+}
+
+
+void CServerScalingApp::Exit(void)
+{
+    CORE_SetLOG(0);
+    CORE_SetLOCK(0);
+}
+
+
+// Check for shutdown request every second
+static STimeout kAcceptTimeout = { 1, 0 };
+
+int CServerScalingApp::Run(void)
+{
+    const CArgs& args = GetArgs();
+
+    unsigned short port = 4096;
+
+    {
+        CListeningSocket listener;
+
+        while (++port & 0xFFFF) {
+            if (listener.Listen(port, 5, fSOCK_BindAny | fSOCK_LogOff)
+                == eIO_Success)
+                break;
+        }
+        if (port == 0) {
+            ERR_POST("CServer test: unable to find a free port to listen on");
+            return 2;
+        }
+    }
+
+    int idle = args["idle"].AsInteger();
+    int busy = args["busy"].AsInteger();
+
+    SServer_Parameters params;
+    params.init_threads    = args["srvthreads"].AsInteger();
+    params.max_threads     = params.init_threads;
+    params.max_connections = idle + busy + 10;
+    params.accept_timeout  = &kAcceptTimeout;
+    params.use_epoll       = args["epoll"];
+    params.work_stealing   = args["stealing"];
+
+    CScalingServer server;
+    server.SetParameters(params);
+    server.AddListener(
+        new CServer_ConnectionFactory<CEchoHandler>(), port);
+    server.StartListening();
+
+    CRef<CClientThread> client(new CClientThread(server, port, idle, busy,
+                                                 args["requests"].AsInteger()));
+    client->Run();
+
+    server.Run();
+    client->Join();
+
+    if (!client->IsOk()) {
+        ERR_POST("Benchmark failed");
+        return 1;
+    }
+
+    int requests = args["requests"].AsInteger();
+    NcbiCout << (params.use_epoll ? "epoll" : "poll")
+             << ": idle=" << idle << " busy=" << busy
+             << " setup=" << client->GetSetupTime() << "s"
+             << " requests=" << requests
+             << " time=" << client->GetRunTime() << "s"
+             << " (" << client->GetRunTime() * 1e6 / requests
+             << " us/request)" << NcbiEndl;
+    return 0;
+}
+
+
+END_NCBI_SCOPE
+
+
+USING_NCBI_SCOPE;
+
+
+int main(int argc, const char* argv[])
+{
+    return CServerScalingApp().AppMain(argc, argv);
+}
@@ -2620,7 +2620,7 @@ bool CAnnot_Collector::x_SearchTSE2(const CTSE_Handle&    tseh,
     bool found = false;
 
     tse.UpdateAnnotIndex(id);
-    CTSE_Info::TAnnotLockReadGuard guard(tse.GetAnnotLock());
+    CTSE_Info::TAnnotLockReadGuard guard(tse);
 
     //CStopWatch sw(CStopWatch::eStart);
 
@@ -2881,7 +2881,7 @@ void CAnnot_Collector::x_SearchRange(const CTSE_Handle&    tseh,
             tse.UpdateAnnotIndex(id);
 
             // Acquire the lock again:
-            guard.Guard(tse.GetAnnotLock());
+            guard.Guard(tse);
 
             // Reget range map pointer as it may change:
             objs = tse.x_GetIdObjects(annot_name, id);
@@ -238,7 +238,7 @@ void CSeq_annot_Finder::x_Find(const CSeq_entry_Info& entry,
     CHandleRange::TRange overlap_range = r0.begin()->second.GetOverlappingRange();
     
     m_TSE.UpdateAnnotIndex(idh);
-    CTSE_Info::TAnnotLockReadGuard guard(m_TSE.GetAnnotLock());
+    CTSE_Info::TAnnotLockReadGuard guard(m_TSE);
 
     const SIdAnnotObjs* objs = NULL;
     if (name.IsNamed()) 
@@ -268,7 +268,7 @@ void CSeq_annot_Finder::x_Find(const CSeq_entry_Info& entry,
                     if ( chunk.NotLoaded() ) {
                         guard.Release();
                         chunk.Load();
-                        guard.Guard(m_TSE.GetAnnotLock());
+                        guard.Guard(m_TSE);
                         run_again = true;
                     }
                     continue;
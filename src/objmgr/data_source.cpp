@@ -822,7 +822,7 @@ void CDataSource::x_AddTSEBioseqAnnots(TTSE_LockMatchSet& ret,
         tse.x_GetRecords(*id_it, false);
     }
     UpdateAnnotIndex(tse);
-    CTSE_Info::TAnnotLockReadGuard guard(tse.GetAnnotLock());
+    CTSE_Info::TAnnotLockReadGuard guard(tse);
     ITERATE ( CBioseq_Info::TId, id_it, bioseq.GetId() ) {
         x_AddTSEAnnots(ret, *id_it, tse_lock);
     }
@@ -842,7 +842,7 @@ void CDataSource::x_AddTSEOrphanAnnots(TTSE_LockMatchSet& ret,
         tse.x_GetRecords(*id_it, false);
     }
     UpdateAnnotIndex(tse);
-    CTSE_Info::TAnnotLockReadGuard guard(tse.GetAnnotLock());
+    CTSE_Info::TAnnotLockReadGuard guard(tse);
     ITERATE ( TSeq_idSet, id_it, ids ) {
         x_AddTSEAnnots(ret, *id_it, tse_lock);
     }
@@ -527,30 +527,7 @@ void CSeqVector_CI::x_FillCache(TSeqPos start, TSeqPos count)
             return;
         }
         
-        TCoding dataCoding = data.Which();
-        TCoding cacheCoding = x_GetCoding(m_Coding, dataCoding);
         bool reverse = m_Seg.GetRefMinusStrand();
-
-        bool randomize = false;
-        if ( cacheCoding != dataCoding &&
-             cacheCoding == CSeq_data::e_Ncbi2na &&
-             m_Randomizer) {
-            cacheCoding = CSeq_data::e_Ncbi4na;
-            randomize = true;
-        }
-
-        const char* table = 0;
-        if ( cacheCoding != dataCoding || reverse ||
-             m_CaseConversion != eCaseConversion_none ) {
-            table = sx_GetConvertTable(dataCoding, cacheCoding,
-                                       reverse, m_CaseConversion);
-            if ( !table && cacheCoding != dataCoding ) {
-                NCBI_THROW_FMT(CSeqVectorException, eCodingError,
-                               "Incompatible sequence codings: "<<
-                               dataCoding<<" -> "<<cacheCoding);
-            }
-        }
-
         TSeqPos dataPos;
         if ( reverse ) {
             // Revert segment offset
@@ -562,63 +539,11 @@ void CSeqVector_CI::x_FillCache(TSeqPos start, TSeqPos count)
                 (start - m_Seg.GetPosition());
         }
 
-        switch ( dataCoding ) {
-        case CSeq_data::e_Iupacna:
-            copy_8bit_any(m_Cache, count, data.GetIupacna().Get(), dataPos,
-                          table, reverse);
-            break;
-        case CSeq_data::e_Iupacaa:
-            copy_8bit_any(m_Cache, count, data.GetIupacaa().Get(), dataPos,
-                          table, reverse);
-            break;
-        case CSeq_data::e_Ncbi2na:
-            copy_2bit_any(m_Cache, count, data.GetNcbi2na().Get(), dataPos,
-                            table, reverse);
-            break;
-        case CSeq_data::e_Ncbi4na:
-            copy_4bit_any(m_Cache, count, data.GetNcbi4na().Get(), dataPos,
-                          table, reverse);
-            break;
-        case CSeq_data::e_Ncbi8na:
-            copy_8bit_any(m_Cache, count, data.GetNcbi8na().Get(), dataPos,
-                          table, reverse);
-            break;
-        case CSeq_data::e_Ncbipna:
-            NCBI_THROW(CSeqVectorException, eCodingError,
-                       "Ncbipna conversion not implemented");
-        case CSeq_data::e_Ncbi8aa:
-            copy_8bit_any(m_Cache, count, data.GetNcbi8aa().Get(), dataPos,
-                          table, reverse);
-            break;
-        case CSeq_data::e_Ncbieaa:
-            copy_8bit_any(m_Cache, count, data.GetNcbieaa().Get(), dataPos,
-                          table, reverse);
-            break;
-        case CSeq_data::e_Ncbipaa:
-            NCBI_THROW(CSeqVectorException, eCodingError,
-                       "Ncbipaa conversion not implemented");
-        case CSeq_data::e_Ncbistdaa:
-            copy_8bit_any(m_Cache, count, data.GetNcbistdaa().Get(), dataPos,
-                          table, reverse);
-            break;
-        default:
-            NCBI_THROW_FMT(CSeqVectorException, eCodingError,
-                           "Invalid data coding: "<<dataCoding);
-        }
-        if ( randomize ) {
-            m_Randomizer->RandomizeData(m_Cache, count, start);
-        }
+        x_DecodeData(m_Cache, start, count, data, dataPos, reverse);
         break;
     }
     case CSeqMap::eSeqGap:
-        if (m_Coding == CSeq_data::e_Ncbi2na  &&  m_Randomizer) {
-            fill_n(m_Cache, count,
-                   sx_GetGapChar(CSeq_data::e_Ncbi4na, eCaseConversion_none));
-            m_Randomizer->RandomizeData(m_Cache, count, start);
-        }
-        else {
-            fill_n(m_Cache, count, GetGapChar());
-        }
+        x_DecodeGap(m_Cache, start, count);
         break;
     default:
         NCBI_THROW_FMT(CSeqVectorException, eDataError,
@@ -628,6 +553,95 @@ void CSeqVector_CI::x_FillCache(TSeqPos start, TSeqPos count)
 }
 
 
+void CSeqVector_CI::x_DecodeData(char* dst, TSeqPos start, TSeqPos count,
+                                 const CSeq_data& data, TSeqPos dataPos,
+                                 bool reverse)
+{
+    TCoding dataCoding = data.Which();
+    TCoding cacheCoding = x_GetCoding(m_Coding, dataCoding);
+
+    bool randomize = false;
+    if ( cacheCoding != dataCoding &&
+         cacheCoding == CSeq_data::e_Ncbi2na &&
+         m_Randomizer) {
+        cacheCoding = CSeq_data::e_Ncbi4na;
+        randomize = true;
+    }
+
+    const char* table = 0;
+    if ( cacheCoding != dataCoding || reverse ||
+         m_CaseConversion != eCaseConversion_none ) {
+        table = sx_GetConvertTable(dataCoding, cacheCoding,
+                                   reverse, m_CaseConversion);
+        if ( !table && cacheCoding != dataCoding ) {
+            NCBI_THROW_FMT(CSeqVectorException, eCodingError,
+                           "Incompatible sequence codings: "<<
+                           dataCoding<<" -> "<<cacheCoding);
+        }
+    }
+
+    switch ( dataCoding ) {
+    case CSeq_data::e_Iupacna:
+        copy_8bit_any(dst, count, data.GetIupacna().Get(), dataPos,
+                      table, reverse);
+        break;
+    case CSeq_data::e_Iupacaa:
+        copy_8bit_any(dst, count, data.GetIupacaa().Get(), dataPos,
+                      table, reverse);
+        break;
+    case CSeq_data::e_Ncbi2na:
+        copy_2bit_any(dst, count, data.GetNcbi2na().Get(), dataPos,
+                      table, reverse);
+        break;
+    case CSeq_data::e_Ncbi4na:
+        copy_4bit_any(dst, count, data.GetNcbi4na().Get(), dataPos,
+                      table, reverse);
+        break;
+    case CSeq_data::e_Ncbi8na:
+        copy_8bit_any(dst, count, data.GetNcbi8na().Get(), dataPos,
+                      table, reverse);
+        break;
+    case CSeq_data::e_Ncbipna:
+        NCBI_THROW(CSeqVectorException, eCodingError,
+                   "Ncbipna conversion not implemented");
+    case CSeq_data::e_Ncbi8aa:
+        copy_8bit_any(dst, count, data.GetNcbi8aa().Get(), dataPos,
+                      table, reverse);
+        break;
+    case CSeq_data::e_Ncbieaa:
+        copy_8bit_any(dst, count, data.GetNcbieaa().Get(), dataPos,
+                      table, reverse);
+        break;
+    case CSeq_data::e_Ncbipaa:
+        NCBI_THROW(CSeqVectorException, eCodingError,
+                   "Ncbipaa conversion not implemented");
+    case CSeq_data::e_Ncbistdaa:
+        copy_8bit_any(dst, count, data.GetNcbistdaa().Get(), dataPos,
+                      table, reverse);
+        break;
+    default:
+        NCBI_THROW_FMT(CSeqVectorException, eCodingError,
+                       "Invalid data coding: "<<dataCoding);
+    }
+    if ( randomize ) {
+        m_Randomizer->RandomizeData(dst, count, start);
+    }
+}
+
+
+void CSeqVector_CI::x_DecodeGap(char* dst, TSeqPos start, TSeqPos count)
+{
+    if (m_Coding == CSeq_data::e_Ncbi2na  &&  m_Randomizer) {
+        fill_n(dst, count,
+               sx_GetGapChar(CSeq_data::e_Ncbi4na, eCaseConversion_none));
+        m_Randomizer->RandomizeData(dst, count, start);
+    }
+    else {
+        fill_n(dst, count, GetGapChar());
+    }
+}
+
+
 void CSeqVector_CI::x_SetPos(TSeqPos pos)
 {
     TSeqPos size = x_GetSize();
@@ -734,6 +748,14 @@ void CSeqVector_CI::GetSeqData(string& buffer, TSeqPos count)
                        <<pos<<"-"<<pos+count);
     }
     
+    if ( count > kCacheSize ) {
+        // long range - decode it at once bypassing the cache
+        buffer.resize(count);
+        GetSeqData(pos, pos+count, &buffer[0]);
+        SetPos(pos+count);
+        return;
+    }
+
     buffer.reserve(count);
     while ( count ) {
         TCache_I cache = m_Cache;
@@ -754,6 +776,99 @@ void CSeqVector_CI::GetSeqData(string& buffer, TSeqPos count)
 }
 
 
+namespace {
+    // Resolved part of a segment within the range decoded by GetSeqData()
+    struct SDecodeSegment
+    {
+        TSeqPos                 m_Pos;
+        TSeqPos                 m_Length;
+        // null for gaps
+        CConstRef<CSeq_data>    m_Data;
+        TSeqPos                 m_DataPos;
+        bool                    m_Reverse;
+    };
+}
+
+
+void CSeqVector_CI::GetSeqData(TSeqPos start, TSeqPos stop, char* buffer)
+{
+    TSeqPos size = x_GetSize();
+    if ( start > stop || stop > size ) {
+        NCBI_THROW_FMT(CSeqVectorException, eOutOfRange,
+                       "CSeqVector_CI::GetSeqData: "
+                       "range out of sequence: "
+                       <<start<<"-"<<stop<<">"<<size);
+    }
+    if ( start == stop ) {
+        return;
+    }
+    if ( m_TSE && !CanGetRange(start, stop) ) {
+        NCBI_THROW_FMT(CSeqVectorException, eDataError,
+                       "CSeqVector_CI::GetSeqData: "
+                       "cannot get seq-data in range: "
+                       <<start<<"-"<<stop);
+    }
+
+    // collect segments of the range before decoding anything
+    vector<SDecodeSegment> segs;
+    SSeqMapSelector sel(CSeqMap::fDefaultFlags, kMax_UInt);
+    sel.SetStrand(m_Strand).SetLinkUsedTSE(m_TSE).SetLinkUsedTSE(m_UsedTSEs);
+    for ( CSeqMap_CI seg(m_SeqMap, m_Scope.GetScopeOrNull(), sel, start);
+          seg && seg.GetPosition() < stop; ++seg ) {
+        TSeqPos seg_start = max(start, seg.GetPosition());
+        TSeqPos seg_end = min(stop, seg.GetEndPosition());
+        if ( seg_start >= seg_end ) {
+            // skip 0 length segments
+            continue;
+        }
+        SDecodeSegment info;
+        info.m_Pos = seg_start;
+        info.m_Length = seg_end - seg_start;
+        info.m_DataPos = 0;
+        info.m_Reverse = false;
+        switch ( seg.GetType() ) {
+        case CSeqMap::eSeqData:
+            info.m_Data = &seg.GetRefData();
+            info.m_Reverse = seg.GetRefMinusStrand();
+            if ( info.m_Reverse ) {
+                // Revert segment offset
+                info.m_DataPos = seg.GetRefEndPosition() -
+                    (seg_start - seg.GetPosition()) - info.m_Length;
+            }
+            else {
+                info.m_DataPos = seg.GetRefPosition() +
+                    (seg_start - seg.GetPosition());
+            }
+            break;
+        case CSeqMap::eSeqGap:
+            break;
+        default:
+            NCBI_THROW_FMT(CSeqVectorException, eDataError,
+                           "Invalid segment type: "<<seg.GetType());
+        }
+        segs.push_back(info);
+    }
+    if ( segs.empty() || segs.front().m_Pos != start ||
+         segs.back().m_Pos + segs.back().m_Length != stop ) {
+        NCBI_THROW_FMT(CSeqVectorException, eDataError,
+                       "CSeqVector_CI: cannot locate segments in range "
+                       <<start<<"-"<<stop);
+    }
+
+    ITERATE ( vector<SDecodeSegment>, it, segs ) {
+        char* dst = buffer + (it->m_Pos - start);
+        if ( it->m_Data ) {
+            x_DecodeData(dst, it->m_Pos, it->m_Length,
+                         *it->m_Data, it->m_DataPos, it->m_Reverse);
+        }
+        else {
+            // whole gap at once
+            x_DecodeGap(dst, it->m_Pos, it->m_Length);
+        }
+    }
+}
+
+
 void CSeqVector_CI::x_NextCacheSeg()
 {
     _ASSERT(m_SeqMap);
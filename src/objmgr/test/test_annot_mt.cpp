@@ -0,0 +1,255 @@
+/*  $Id$
+* ===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+* File Description:
+*   Scaling of annotation iteration over a shared scope in MT mode
+*
+* ===========================================================================
+*/
+#define NCBI_TEST_APPLICATION
+#include <ncbi_pch.hpp>
+#include <corelib/ncbistd.hpp>
+#include <corelib/ncbiapp.hpp>
+#include <corelib/ncbiargs.hpp>
+#include <corelib/ncbitime.hpp>
+#include <corelib/ncbithr.hpp>
+#include <corelib/test_mt.hpp>
+#include <util/random_gen.hpp>
+
+#include <objects/seqloc/Seq_id.hpp>
+#include <objects/seqloc/Seq_interval.hpp>
+#include <objects/seqloc/Seq_loc.hpp>
+#include <objects/seqset/Seq_entry.hpp>
+#include <objects/seq/Bioseq.hpp>
+#include <objects/seq/Seq_inst.hpp>
+#include <objects/seq/Seq_annot.hpp>
+#include <objects/seqfeat/Seq_feat.hpp>
+#include <objmgr/object_manager.hpp>
+#include <objmgr/scope.hpp>
+#include <objmgr/bioseq_handle.hpp>
+#include <objmgr/feat_ci.hpp>
+#include <objmgr/impl/tse_info.hpp>
+#include <objmgr/impl/handle_range_map.hpp>
+
+#include <common/test_assert.h>  /* This header must go last */
+
+
+BEGIN_NCBI_SCOPE
+using namespace objects;
+
+
+/////////////////////////////////////////////////////////////////////////////
+//
+//  Test application
+//
+//  All threads resolve the same Bioseq and iterate its features in random
+//  ranges through one shared scope.  Compare the reported throughput for
+//  different -threads values to see how annotation search scales.
+//
+
+class CTestAnnotMT : public CThreadedApp
+{
+protected:
+    virtual bool Thread_Run(int idx);
+    virtual bool TestApp_Init(void);
+    virtual bool TestApp_Exit(void);
+    virtual bool TestApp_Args(CArgDescriptions& args);
+
+    // number of features expected in the range [from, to]
+    size_t x_ExpectedCount(TSeqPos from, TSeqPos to) const;
+
+    CRef<CScope>      m_Scope;
+    CSeq_id_Handle    m_Id;
+    TSeqPos           m_Length;
+    TSeqPos           m_Step;
+    TSeqPos           m_FeatLength;
+    TSeqPos           m_Window;
+    int               m_Iterations;
+
+    CFastMutex        m_StatMutex;
+    Uint8             m_TotalFeatures;
+    double            m_TotalTime;
+    CStopWatch        m_Timer;
+};
+
+
+/////////////////////////////////////////////////////////////////////////////
+
+
+size_t CTestAnnotMT::x_ExpectedCount(TSeqPos from, TSeqPos to) const
+{
+    // feature i occupies [i*m_Step, i*m_Step+m_FeatLength-1]
+    TSeqPos count = (m_Length - m_FeatLength) / m_Step + 1;
+    TSeqPos last = min(to / m_Step, count - 1);
+    TSeqPos first = from < m_FeatLength ?
+        0 : (from - m_FeatLength) / m_Step + 1;
+    return first > last ? 0 : last - first + 1;
+}
+
+
+bool CTestAnnotMT::Thread_Run(int idx)
+{
+    CRandom r(idx+1);
+    SAnnotSelector sel(CSeqFeatData::e_Region);
+
+    CStopWatch sw(CStopWatch::eStart);
+    Uint8 features = 0;
+    for ( int t = 0; t < m_Iterations; ++t ) {
+        CBioseq_Handle bh = m_Scope->GetBioseqHandle(m_Id);
+        _ASSERT(bh);
+        TSeqPos from = r.GetRand(0, m_Length - m_Window);
+        TSeqPos to = from + m_Window - 1;
+        size_t count = 0;
+        for ( CFeat_CI it(bh, CRange<TSeqPos>(from, to), sel); it; ++it ) {
+            ++count;
+        }
+        if ( count != x_ExpectedCount(from, to) ) {
+            ERR_POST("Thread "<<idx<<": "<<count<<" features in "<<
+                     from<<".."<<to<<", expected "<<
+                     x_ExpectedCount(from, to));
+            return false;
+        }
+        features += count;
+        if ( t % 16 == 0 ) {
+            // W-after-R on the annot index while other threads read it
+            const CTSE_Info& tse = bh.GetTSE_Handle().x_GetTSE_Info();
+            CTSE_Info::TAnnotLockReadGuard guard(tse);
+            CTSE_Info::TAnnotLockWriteGuard guard2(tse.GetAnnotLock());
+        }
+    }
+    double time = sw.Elapsed();
+
+    CFastMutexGuard guard(m_StatMutex);
+    m_TotalFeatures += features;
+    m_TotalTime += time;
+    return true;
+}
+
+
+bool CTestAnnotMT::TestApp_Init(void)
+{
+    const CArgs& args = GetArgs();
+    size_t feat_count = args["features"].AsInteger();
+    m_Step = 10;
+    m_FeatLength = 50;
+    m_Length = TSeqPos((feat_count - 1) * m_Step + m_FeatLength);
+    m_Window = min(TSeqPos(args["window"].AsInteger()), m_Length);
+    m_Iterations = args["iterations"].AsInteger();
+    m_TotalFeatures = 0;
+    m_TotalTime = 0;
+
+    CRef<CSeq_id> id(new CSeq_id("lcl|annot_mt"));
+    m_Id = CSeq_id_Handle::GetHandle(*id);
+
+    CRef<CSeq_entry> entry(new CSeq_entry);
+    CBioseq& seq = entry->SetSeq();
+    seq.SetId().push_back(id);
+    seq.SetInst().SetRepr(CSeq_inst::eRepr_virtual);
+    seq.SetInst().SetMol(CSeq_inst::eMol_dna);
+    seq.SetInst().SetLength(m_Length);
+    CRef<CSeq_annot> annot(new CSeq_annot);
+    for ( size_t i = 0; i < feat_count; ++i ) {
+        CRef<CSeq_feat> feat(new CSeq_feat);
+        feat->SetData().SetRegion("region "+NStr::SizetToString(i));
+        CSeq_interval& interval = feat->SetLocation().SetInt();
+        interval.SetId(*id);
+        interval.SetFrom(TSeqPos(i * m_Step));
+        interval.SetTo(TSeqPos(i * m_Step + m_FeatLength - 1));
+        annot->SetData().SetFtable().push_back(feat);
+    }
+    seq.SetAnnot().push_back(annot);
+
+    m_Scope = new CScope(*CObjectManager::GetInstance());
+    m_Scope->AddTopLevelSeqEntry(*entry);
+    // build annotation index before the threads start
+    _VERIFY(CFeat_CI(m_Scope->GetBioseqHandle(m_Id)).GetSize() == feat_count);
+
+    // The annot index of a loaded TSE is locked for reading in shared mode,
+    // but it is still taken for writing by threads that already hold it for
+    // reading, e.g. on index update during a search.
+    // Such W-after-R must not deadlock.
+    {{
+        CBioseq_Handle bh = m_Scope->GetBioseqHandle(m_Id);
+        const CTSE_Info& tse = bh.GetTSE_Handle().x_GetTSE_Info();
+        CTSE_Info::TAnnotLockReadGuard guard(tse);
+        {{
+            CTSE_Info::TAnnotLockWriteGuard guard2(tse.GetAnnotLock());
+        }}
+        tse.GetMasterSeqSegments();
+        _VERIFY(CFeat_CI(bh).GetSize() == feat_count);
+    }}
+
+    NcbiCout << "Iterating " << feat_count << " features in " <<
+        s_NumThreads << " threads..." << NcbiEndl;
+    m_Timer.Start();
+    return true;
+}
+
+
+bool CTestAnnotMT::TestApp_Exit(void)
+{
+    double elapsed = m_Timer.Elapsed();
+    Uint8 queries = Uint8(m_Iterations) * s_NumThreads;
+    NcbiCout << "Features found: " << m_TotalFeatures << NcbiEndl;
+    NcbiCout << "Wall time: " << elapsed << " s, " <<
+        queries/elapsed << " queries/s" << NcbiEndl;
+    if ( m_TotalTime > 0 ) {
+        NcbiCout << "Thread time: " << m_TotalTime << " s, " <<
+            queries/m_TotalTime << " queries/s per thread" << NcbiEndl;
+    }
+    NcbiCout << " Passed" << NcbiEndl << NcbiEndl;
+    return true;
+}
+
+
+bool CTestAnnotMT::TestApp_Args(CArgDescriptions& args)
+{
+    args.AddDefaultKey("features", "Features",
+                       "number of features on the test sequence",
+                       CArgDescriptions::eInteger, "10000");
+    args.SetConstraint("features",
+                       new CArgAllow_Integers(1, kMax_Int/10));
+    args.AddDefaultKey("window", "Window",
+                       "length of each queried range",
+                       CArgDescriptions::eInteger, "1000");
+    args.SetConstraint("window", new CArgAllow_Integers(1, kMax_Int));
+    args.AddDefaultKey("iterations", "Iterations",
+                       "number of queries made by each thread",
+                       CArgDescriptions::eInteger, "2000");
+    return true;
+}
+
+END_NCBI_SCOPE
+
+
+/////////////////////////////////////////////////////////////////////////////
+//  MAIN
+
+USING_NCBI_SCOPE;
+
+int main(int argc, const char* argv[])
+{
+    return CTestAnnotMT().AppMain(argc, argv);
+}
@@ -1089,6 +1089,11 @@ void CTestHelper::ProcessBioseq(CScope& scope, CSeq_id& id,
         _ASSERT(sout[vit.GetPos()] == *vit);
         vit.GetSeqData(0, seq_vect.size(), sout);
         _ASSERT(NStr::PrintableString(sout) == seq_str);
+        if ( seq_vect.size() ) {
+            vector<char> buf(seq_vect.size());
+            vit.GetSeqData(0, seq_vect.size(), &buf[0]);
+            _ASSERT(string(buf.begin(), buf.end()) == sout);
+        }
         sout = "";
         seq_vect.SetCoding(CBioseq_Handle::eCoding_NotSet);
     }}
@@ -505,7 +505,7 @@ CTSE_Info::x_GetSNP_Info(const CConstRef<CSeq_annot>& annot)
 
 bool CTSE_Info::HasAnnot(const CAnnotName& name) const
 {
-    TAnnotLockReadGuard guard(GetAnnotLock());
+    TAnnotLockReadGuard guard(*this);
     return m_NamedAnnotObjs.find(name) != m_NamedAnnotObjs.end();
 }
 
@@ -681,7 +681,7 @@ void CTSE_Info::GetAnnotIds(TSeqIds& ids) const
 {
     UpdateAnnotIndex();
     {{
-        TAnnotLockReadGuard guard(GetAnnotLock());
+        TAnnotLockReadGuard guard(*this);
         ITERATE ( TNamedAnnotObjs, it, m_NamedAnnotObjs ) {
             ITERATE ( TAnnotObjs, it2, it->second ) {
                 ids.push_back(it2->first);
@@ -1366,6 +1366,12 @@ CTSE_Split_Info& CTSE_Info::GetSplitInfo(void)
 }
 
 
+bool CTSE_Info::x_IsFullyLoaded(void) const
+{
+    return !m_Split || m_Split->x_AllChunksLoaded();
+}
+
+
 bool CTSE_Info::x_NeedsDelayedMainChunk(void) const
 {
     return m_Split && m_Split->x_NeedsDelayedMainChunk();
@@ -1992,6 +1998,167 @@ CTSE_SetObjectInfo::~CTSE_SetObjectInfo(void)
 }
 
 
+CTSEAnnotLock::CTSEAnnotLock(void)
+    : m_Owner(0),
+      m_WriteDepth(0)
+{
+}
+
+
+CTSEAnnotLock::~CTSEAnnotLock(void)
+{
+}
+
+
+void CTSEAnnotLock::WriteLock(void)
+{
+    TThreadSystemID self = GetCurrentThreadSystemID();
+    bool recursive = false;
+    int suspended = 0;
+    {{
+        CFastMutexGuard guard(m_StateMutex);
+        if ( x_IsWriter(self) ) {
+            ++m_WriteDepth;
+            recursive = true;
+        }
+        else {
+            // CRWLock does not allow W-after-R, so the read locks of this
+            // thread are released and restored with the write lock release
+            NON_CONST_ITERATE ( TReaders, it, m_Readers ) {
+                if ( it->first == self ) {
+                    suspended = it->second;
+                    m_Suspended.push_back(*it);
+                    m_Readers.erase(it);
+                    break;
+                }
+            }
+        }
+    }}
+    if ( recursive ) {
+        m_Lock.WriteLock();
+        return;
+    }
+    for ( int i = 0; i < suspended; ++i ) {
+        m_Lock.Unlock();
+    }
+    m_Lock.WriteLock();
+    CFastMutexGuard guard(m_StateMutex);
+    m_Owner = self;
+    m_WriteDepth = 1;
+}
+
+
+void CTSEAnnotLock::Unlock(void)
+{
+    TThreadSystemID self = GetCurrentThreadSystemID();
+    bool released = false;
+    int suspended = 0;
+    {{
+        CFastMutexGuard guard(m_StateMutex);
+        _ASSERT(x_IsWriter(self));
+        if ( --m_WriteDepth == 0 ) {
+            m_Owner = 0;
+            released = true;
+            NON_CONST_ITERATE ( TReaders, it, m_Suspended ) {
+                if ( it->first == self ) {
+                    suspended = it->second;
+                    m_Suspended.erase(it);
+                    break;
+                }
+            }
+        }
+    }}
+    m_Lock.Unlock();
+    if ( released  &&  suspended ) {
+        for ( int i = 0; i < suspended; ++i ) {
+            m_Lock.ReadLock();
+        }
+        CFastMutexGuard guard(m_StateMutex);
+        m_Readers.push_back(TReaders::value_type(self, suspended));
+    }
+}
+
+
+void CTSEAnnotLock::ReadLock(void)
+{
+    TThreadSystemID self = GetCurrentThreadSystemID();
+    bool recursive = false;
+    {{
+        CFastMutexGuard guard(m_StateMutex);
+        if ( x_IsWriter(self) ) {
+            // R-after-W is a recursive write lock in CRWLock
+            ++m_WriteDepth;
+            recursive = true;
+        }
+    }}
+    m_Lock.ReadLock();
+    if ( recursive ) {
+        return;
+    }
+    CFastMutexGuard guard(m_StateMutex);
+    NON_CONST_ITERATE ( TReaders, it, m_Readers ) {
+        if ( it->first == self ) {
+            ++it->second;
+            return;
+        }
+    }
+    m_Readers.push_back(TReaders::value_type(self, 1));
+}
+
+
+void CTSEAnnotLock::ReadUnlock(void)
+{
+    TThreadSystemID self = GetCurrentThreadSystemID();
+    {{
+        CFastMutexGuard guard(m_StateMutex);
+        if ( x_IsWriter(self) ) {
+            _ASSERT(m_WriteDepth > 1);
+            --m_WriteDepth;
+        }
+        else {
+            NON_CONST_ITERATE ( TReaders, it, m_Readers ) {
+                if ( it->first == self ) {
+                    if ( --it->second == 0 ) {
+                        m_Readers.erase(it);
+                    }
+                    break;
+                }
+            }
+        }
+    }}
+    m_Lock.Unlock();
+}
+
+
+void CTSEAnnotLockReadGuard::Guard(const CTSE_Info& tse)
+{
+    Release();
+    CTSE_Info::TAnnotLock& lock = tse.GetAnnotLock();
+    m_Shared = tse.x_IsFullyLoaded();
+    if ( m_Shared ) {
+        lock.ReadLock();
+    }
+    else {
+        // chunk loading from this thread will need write lock
+        lock.WriteLock();
+    }
+    m_Lock = &lock;
+}
+
+
+void CTSEAnnotLockReadGuard::Release(void)
+{
+    if ( m_Lock ) {
+        if ( m_Shared ) {
+            m_Lock->ReadUnlock();
+        }
+        else {
+            m_Lock->Unlock();
+        }
+        m_Lock = 0;
+    }
+}
+
 
 END_SCOPE(objects)
 END_NCBI_SCOPE
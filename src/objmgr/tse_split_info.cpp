@@ -63,6 +63,7 @@ CTSE_Split_Info::CTSE_Split_Info(void)
       m_BlobVersion(-1),
       m_SplitVersion(-1),
       m_BioseqChunkId(-1),
+      m_AllChunksLoaded(false),
       m_SeqIdToChunksSorted(false),
       m_ContainsBioseqs(false)
 {
@@ -74,6 +75,7 @@ CTSE_Split_Info::CTSE_Split_Info(TBlobId blob_id, TBlobVersion blob_ver)
       m_BlobVersion(blob_ver),
       m_SplitVersion(-1),
       m_BioseqChunkId(-1),
+      m_AllChunksLoaded(false),
       m_SeqIdToChunksSorted(false),
       m_ContainsBioseqs(false)
 {
@@ -183,6 +185,22 @@ bool CTSE_Split_Info::x_HasDelayedMainChunk(void) const
 }
 
 
+bool CTSE_Split_Info::x_AllChunksLoaded(void) const
+{
+    if ( !m_AllChunksLoaded ) {
+        CMutexGuard guard(m_SeqIdToChunksMutex);
+        ITERATE ( TChunks, it, m_Chunks ) {
+            if ( it->second->NotLoaded() ) {
+                return false;
+            }
+        }
+        // chunks are never unloaded, so the result can be remembered
+        m_AllChunksLoaded = true;
+    }
+    return true;
+}
+
+
 bool CTSE_Split_Info::x_NeedsDelayedMainChunk(void) const
 {
     TChunks::const_iterator iter = m_Chunks.end(), begin = m_Chunks.begin();
@@ -210,6 +228,7 @@ void CTSE_Split_Info::AddChunk(CTSE_Chunk_Info& chunk_info)
     _ASSERT(m_Chunks.empty() || chunk_info.GetChunkId() != kMax_Int);
     bool need_update = x_HasDelayedMainChunk();
     m_Chunks[chunk_info.GetChunkId()].Reset(&chunk_info);
+    m_AllChunksLoaded = false;
     chunk_info.x_SplitAttach(*this);
     if ( need_update ) {
         chunk_info.x_EnableAnnotIndex();
@@ -677,6 +677,32 @@ void CSeqDB::ResetInternalChunkBookmark()
     m_Impl->ResetInternalChunkBookmark();
 }
 
+void CSeqDB::GetOidRanges(int num_ranges, vector<TOidRange> & ranges) const
+{
+    m_Impl->Verify();
+    m_Impl->GetOidRanges(num_ranges, ranges);
+    m_Impl->Verify();
+}
+
+int CSeqDB::GetSequenceBatch(int              begin,
+                             int              end,
+                             TSequenceBatch & batch,
+                             bool             get_deflines) const
+{
+    m_Impl->Verify();
+    int rv = m_Impl->GetSequenceBatch(begin, end, batch, get_deflines);
+    m_Impl->Verify();
+
+    return rv;
+}
+
+void CSeqDB::PrefetchSequences(const vector<TOID> & oids) const
+{
+    m_Impl->Verify();
+    m_Impl->PrefetchSequences(oids);
+    m_Impl->Verify();
+}
+
 const string & CSeqDB::GetDBNameList() const
 {
     return m_Impl->GetDBNameList();
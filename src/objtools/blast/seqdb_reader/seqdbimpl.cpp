@@ -400,6 +400,183 @@ void CSeqDBImpl::ResetInternalChunkBookmark()
     m_NextChunkOID = 0;
 }
 
+void CSeqDBImpl::GetOidRanges(int                         num_ranges,
+                              vector<CSeqDB::TOidRange> & ranges)
+{
+    CHECK_MARKER();
+
+    if (num_ranges < 1) {
+        NCBI_THROW(CSeqDBException,
+                   eArgErr,
+                   "Number of OID ranges must be positive.");
+    }
+
+    ranges.clear();
+
+    int oid_begin = m_RestrictBegin;
+    int oid_end   = m_RestrictEnd;
+
+    if (oid_begin >= oid_end) {
+        return;
+    }
+
+    // Residue offsets are only known for the database as a whole, so
+    // a restricted iteration range is split by OID count instead.
+
+    bool by_residue = (oid_begin == 0 &&
+                       oid_end   == m_NumOIDs &&
+                       m_VolumeLength > 0);
+
+    int prev = oid_begin;
+
+    for(int i = 1; i < num_ranges && prev < oid_end; i++) {
+        int split = 0;
+
+        if (by_residue) {
+            Uint8 residue = (m_VolumeLength / num_ranges) * i;
+            split = GetOidAtOffset(prev, residue);
+        } else {
+            split = oid_begin + int((Int8(oid_end - oid_begin) * i) /
+                                    num_ranges);
+        }
+
+        if (split > prev && split < oid_end) {
+            ranges.push_back(CSeqDB::TOidRange(prev, split));
+            prev = split;
+        }
+    }
+
+    ranges.push_back(CSeqDB::TOidRange(prev, oid_end));
+}
+
+int CSeqDBImpl::GetSequenceBatch(int                      begin,
+                                 int                      end,
+                                 CSeqDB::TSequenceBatch & batch,
+                                 bool                     get_deflines)
+{
+    CHECK_MARKER();
+
+    batch.clear();
+
+    // Volume and volume OID for each returned sequence.
+    typedef pair<const CSeqDBVol *, int> TVolOid;
+    vector<TVolOid> vol_oids;
+
+    // Resolve the included OIDs to volumes and make sure all files
+    // needed for the batch are open; this is the only part of the
+    // batch that modifies shared state.
+
+    bool filtered = false;
+
+    {{
+        CSeqDBLockHold locked(m_Atlas);
+        m_Atlas.Lock(locked);
+
+        const CSeqDBVol * prev_vol = NULL;
+        int oid = begin;
+
+        while (x_CheckOrFindOID(oid, locked) && oid < end) {
+            int vol_oid = 0;
+            const CSeqDBVol * vol = m_VolSet.FindVol(oid, vol_oid);
+
+            if (! vol) {
+                NCBI_THROW(CSeqDBException, eArgErr, CSeqDB::kOidNotFound);
+            }
+
+            if (vol != prev_vol) {
+                vol->OpenSeqFile(locked);
+
+                if (get_deflines) {
+                    vol->OpenHdrFile(locked);
+                    filtered = filtered || vol->HasHeaderFilter();
+                }
+                prev_vol = vol;
+            }
+
+            CSeqDB::SBatchSequence entry;
+            entry.oid    = oid;
+            entry.data   = NULL;
+            entry.length = 0;
+
+            batch.push_back(entry);
+            vol_oids.push_back(TVolOid(vol, vol_oid));
+            oid++;
+        }
+    }}
+
+    // The sequence data and unfiltered headers are read directly from
+    // the memory mapped volume files, without the atlas lock.
+
+    CSeqDBLockHold unused(m_Atlas);
+
+    for(size_t i = 0; i < batch.size(); i++) {
+        CSeqDB::SBatchSequence & entry = batch[i];
+        const CSeqDBVol * vol = vol_oids[i].first;
+        int vol_oid = vol_oids[i].second;
+
+        entry.length = vol->GetSequence(vol_oid, & entry.data, unused);
+
+        if (get_deflines && ! filtered) {
+            entry.deflines = vol->GetUnfilteredHeader(vol_oid);
+        }
+    }
+
+    // Filtered headers go through the volume's defline cache, which is
+    // shared, so they are fetched under the lock.
+
+    if (get_deflines && filtered) {
+        CSeqDBLockHold locked(m_Atlas);
+        m_Atlas.Lock(locked);
+
+        for(size_t i = 0; i < batch.size(); i++) {
+            batch[i].deflines =
+                vol_oids[i].first->GetFilteredHeader(vol_oids[i].second,
+                                                     locked);
+        }
+    }
+
+    return (int) batch.size();
+}
+
+void CSeqDBImpl::PrefetchSequences(const vector<int> & oids)
+{
+    CHECK_MARKER();
+
+    vector<int> sorted_oids(oids);
+    sort(sorted_oids.begin(), sorted_oids.end());
+    sorted_oids.erase(unique(sorted_oids.begin(), sorted_oids.end()),
+                      sorted_oids.end());
+
+    CSeqDBLockHold locked(m_Atlas);
+    m_Atlas.Lock(locked);
+
+    // Walk each volume once, in file order.
+
+    const CSeqDBVol * vol = NULL;
+    vector<int> vol_oids;
+
+    ITERATE(vector<int>, oid, sorted_oids) {
+        int vol_oid = 0;
+        const CSeqDBVol * oid_vol = m_VolSet.FindVol(*oid, vol_oid);
+
+        if (! oid_vol) {
+            continue;
+        }
+        if (oid_vol != vol) {
+            if (vol) {
+                vol->PrefetchData(vol_oids, locked);
+            }
+            vol = oid_vol;
+            vol_oids.clear();
+        }
+        vol_oids.push_back(vol_oid);
+    }
+
+    if (vol) {
+        vol->PrefetchData(vol_oids, locked);
+    }
+}
+
 int CSeqDBImpl::GetSeqLength(int oid) const
 {
     CHECK_MARKER();
@@ -600,6 +600,44 @@ public:
     /// Restart chunk iteration at the beginning of the database.
     void ResetInternalChunkBookmark();
 
+    /// Split the iteration range into disjoint OID ranges.
+    ///
+    /// The ranges are balanced by residue count when the whole
+    /// database is iterated, and by OID count otherwise.
+    ///
+    /// @param num_ranges
+    ///   Maximum number of ranges to produce. [in]
+    /// @param ranges
+    ///   The OID ranges. [out]
+    void GetOidRanges(int num_ranges, vector<CSeqDB::TOidRange> & ranges);
+
+    /// Get all included sequences in a range of OIDs.
+    ///
+    /// The atlas lock is held only while the OIDs are resolved to
+    /// volumes; sequence data and unfiltered headers are then read
+    /// from the memory mapped files without it.
+    ///
+    /// @param begin
+    ///   The first OID to consider. [in]
+    /// @param end
+    ///   The OID after the last OID to consider. [in]
+    /// @param batch
+    ///   The sequences found. [out]
+    /// @param get_deflines
+    ///   Specify true to deserialize the deflines. [in]
+    /// @return
+    ///   The number of sequences returned.
+    int GetSequenceBatch(int                      begin,
+                         int                      end,
+                         CSeqDB::TSequenceBatch & batch,
+                         bool                     get_deflines);
+
+    /// Advise the OS that data for a set of sequences will be needed.
+    ///
+    /// @param oids
+    ///   The OIDs that will be fetched, in any order. [in]
+    void PrefetchSequences(const vector<int> & oids);
+
     /// Get list of database names.
     ///
     /// This returns the database name list used at construction.
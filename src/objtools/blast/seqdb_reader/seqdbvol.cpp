@@ -114,6 +114,11 @@ CSeqDBVol::OpenSeqFile(CSeqDBLockHold & locked) const{
     if (!m_SeqFileOpened) x_OpenSeqFile();
 }
 
+void
+CSeqDBVol::OpenHdrFile(CSeqDBLockHold & locked) const{
+    if (!m_HdrFileOpened) x_OpenHdrFile();
+}
+
 void
 CSeqDBVol::x_OpenSeqFile(void) const {
     //m_Atlas.Lock(locked);
@@ -1925,6 +1930,94 @@ CSeqDBVol::x_GetHdrAsn1Binary(int oid) const
     return CTempString(asn_region, hdr_end - hdr_start);
 }
 
+/// Add a file region to a list of regions, merging it with the last
+/// region if the two are within a page of each other.
+///
+/// @param regions List of [start, end) regions. [in|out]
+/// @param start Start offset of the new region. [in]
+/// @param end End offset of the new region. [in]
+/// @param page Page size used to decide whether regions merge. [in]
+static void
+s_SeqDBAddRegion(vector< pair<CSeqDBAtlas::TIndx, CSeqDBAtlas::TIndx> > & regions,
+                 CSeqDBAtlas::TIndx start,
+                 CSeqDBAtlas::TIndx end,
+                 CSeqDBAtlas::TIndx page)
+{
+    if (start >= end) {
+        return;
+    }
+    if (regions.empty() || start > regions.back().second + page) {
+        regions.push_back(make_pair(start, end));
+    } else if (end > regions.back().second) {
+        regions.back().second = end;
+    }
+}
+
+/// Request read-ahead for a region of a memory mapped file.
+///
+/// madvise() needs a page aligned address, so the region is extended
+/// back to the start of its first page.
+///
+/// @param data Start of the region. [in]
+/// @param length Length of the region in bytes. [in]
+/// @param page Virtual memory page size. [in]
+static void
+s_SeqDBWillNeed(const char * data, size_t length, size_t page)
+{
+    size_t skew = ((size_t) data) % page;
+    CMemoryFile_Base::MemMapAdviseAddr((void *) (data - skew),
+                                       length + skew,
+                                       CMemoryFile_Base::eMMA_WillNeed);
+}
+
+void
+CSeqDBVol::PrefetchData(const vector<int> & oids,
+                        CSeqDBLockHold    & locked) const
+{
+    if (oids.empty()) {
+        return;
+    }
+
+    if (!m_SeqFileOpened) x_OpenSeqFile();
+    if (!m_HdrFileOpened) x_OpenHdrFile();
+
+    if (m_Seq.Empty() || m_Hdr.Empty()) {
+        return;
+    }
+
+    static const size_t kPage = (size_t) GetVirtualMemoryPageSize();
+
+    typedef vector< pair<TIndx, TIndx> > TRegions;
+    TRegions seq_regions, hdr_regions;
+
+    ITERATE(vector<int>, oid, oids) {
+        if (*oid < 0 || *oid >= m_Idx->GetNumOIDs()) {
+            continue;
+        }
+
+        // The sequence data of the next OID starts after this OID's
+        // ambiguity data, so this range covers both.
+
+        TIndx seq_start = 0, seq_end = 0;
+        m_Idx->GetSeqStart(*oid,     seq_start);
+        m_Idx->GetSeqStart(*oid + 1, seq_end);
+        s_SeqDBAddRegion(seq_regions, seq_start, seq_end, kPage);
+
+        TIndx hdr_start = 0, hdr_end = 0;
+        m_Idx->GetHdrStartEnd(*oid, hdr_start, hdr_end);
+        s_SeqDBAddRegion(hdr_regions, hdr_start, hdr_end, kPage);
+    }
+
+    ITERATE(TRegions, region, seq_regions) {
+        s_SeqDBWillNeed(m_Seq->GetFileDataPtr(region->first),
+                        size_t(region->second - region->first), kPage);
+    }
+    ITERATE(TRegions, region, hdr_regions) {
+        s_SeqDBWillNeed(m_Hdr->GetFileDataPtr(region->first),
+                        size_t(region->second - region->first), kPage);
+    }
+}
+
 void
 CSeqDBVol::x_GetFilteredBinaryHeader(int                    oid,
                                      vector<char>         & hdr_data ) const
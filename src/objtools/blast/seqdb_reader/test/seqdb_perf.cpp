@@ -105,6 +105,12 @@ private:
     /// Processes all requests except printing the BLAST database information
     /// @return 0 on success; 1 if some sequences were not retrieved
     int x_ScanDatabase();
+
+    /// Scans the database by splitting it into one OID range per thread
+    /// and fetching each range with CSeqDB::GetSequenceBatch, using a
+    /// single CSeqDB object shared by all threads
+    /// @return 0 on success
+    int x_ScanDatabaseInBatches();
 };
 
 void
@@ -178,6 +184,53 @@ CSeqDBPerfApp::x_ScanDatabase()
     return 0;
 }
 
+int
+CSeqDBPerfApp::x_ScanDatabaseInBatches()
+{
+    // Number of OIDs fetched per call to GetSequenceBatch
+    static const int kBatchSize = 4096;
+    const bool kGetDeflines = GetArgs()["batch_deflines"];
+
+    CStopWatch sw;
+    sw.Start();
+    Uint8 num_letters = m_BlastDb->GetTotalLength();
+    CRef<CSeqDBExpert> db = m_DbHandles.front();
+    vector<CSeqDB::TOidRange> ranges;
+    db->GetOidRanges((int)m_DbHandles.size(), ranges);
+    LOG_POST(Info << "Will go over " << ranges.size() << " OID ranges");
+
+    #pragma omp parallel for default(none) num_threads(ranges.size()) \
+                             shared(ranges, db) if(ranges.size() > 1) \
+                             schedule(static, 1)
+    for (size_t r = 0; r < ranges.size(); r++) {
+        int thread_id = 0;
+#ifdef _OPENMP
+        thread_id = omp_get_thread_num();
+#endif
+        CSeqDB::TSequenceBatch batch;
+        for (int begin = ranges[r].first; begin < ranges[r].second;
+             begin += kBatchSize) {
+            int end = min(begin + kBatchSize, ranges[r].second);
+            db->GetSequenceBatch(begin, end, batch, kGetDeflines);
+            ITERATE(CSeqDB::TSequenceBatch, seq, batch) {
+                int seqlen = m_DbIsProtein ? seq->length : seq->length / 4;
+                for (int i = 0; i < seqlen; i++) {
+                    char base = seq->data[i];
+                    (void)base;    // pacify compiler warnings
+                }
+            }
+        }
+        x_UpdateMemoryUsage(thread_id);
+    }
+
+    sw.Stop();
+    Uint8 bases = static_cast<Uint8>(num_letters / sw.Elapsed());
+    cout << "Scanning rate: "
+         << NStr::NumericToString(bases, NStr::fWithCommas)
+         << " bases/second" << endl;
+    return 0;
+}
+
 void
 CSeqDBPerfApp::x_InitApplicationData()
 {
@@ -286,6 +339,11 @@ void CSeqDBPerfApp::Init()
                       "Do a full database scan of compressed sequence data", true);
     arg_desc->AddFlag("get_metadata",
                       "Retrieve BLAST database metadata", true);
+    arg_desc->AddFlag("scan_batches",
+                      "Do a full database scan of compressed sequence data "
+                      "in OID ranges, sharing one database handle", true);
+    arg_desc->AddFlag("batch_deflines",
+                      "Also retrieve deflines when scanning in batches", true);
 
     arg_desc->SetDependency("scan_compressed", CArgDescriptions::eExcludes,
                             "scan_uncompressed");
@@ -293,6 +351,12 @@ void CSeqDBPerfApp::Init()
                             "get_metadata");
     arg_desc->SetDependency("scan_uncompressed", CArgDescriptions::eExcludes,
                             "get_metadata");
+    arg_desc->SetDependency("scan_batches", CArgDescriptions::eExcludes,
+                            "scan_uncompressed");
+    arg_desc->SetDependency("scan_batches", CArgDescriptions::eExcludes,
+                            "get_metadata");
+    arg_desc->SetDependency("batch_deflines", CArgDescriptions::eRequires,
+                            "scan_batches");
 
     arg_desc->AddDefaultKey("num_threads", "number",
                             "Number of threads to use (requires OpenMP)",
@@ -316,6 +380,8 @@ int CSeqDBPerfApp::Run(void)
         x_InitApplicationData();
         if (GetArgs()["get_metadata"]) {
             status = x_PrintBlastDatabaseInformation();
+        } else if (GetArgs()["scan_batches"]) {
+            status = x_ScanDatabaseInBatches();
         } else {
             status = x_ScanDatabase();
         }
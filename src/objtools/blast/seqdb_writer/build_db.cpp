@@ -37,6 +37,7 @@
 
 #include <objtools/blast/seqdb_reader/seqdbexpert.hpp>
 #include <objtools/blast/seqdb_writer/writedb.hpp>
+#include <objtools/blast/seqdb_writer/writedb_general.hpp>
 #include <objtools/readers/fasta.hpp>
 
 // Object Manager
@@ -464,10 +465,12 @@ CBuildDatabase::x_AddMasksForSeqId(const list< CRef<CSeq_id> >& ids)
 
 bool CBuildDatabase::x_EditAndAddBioseq(CConstRef<objects::CBioseq>   bs,
                                         objects::CSeqVector         * sv,
-                                        bool						  add_pig)
+                                        bool						  add_pig,
+                                        CRef<CBlast_def_line_set>     headers)
 {
-    CRef<CBlast_def_line_set> headers =
-        CWriteDB::ExtractBioseqDeflines(*bs, m_ParseIDs, m_LongIDs);
+    if (headers.Empty()) {
+        headers = CWriteDB::ExtractBioseqDeflines(*bs, m_ParseIDs, m_LongIDs);
+    }
 
     x_EditHeaders(headers);
 
@@ -778,13 +781,29 @@ CConstRef<CBioseq> CFastaBioseqSource::GetNext()
     return rv;
 }
 
-bool CBuildDatabase::AddSequences(IBioseqSource & src, bool add_pig)
-{
-    bool found = false;
+/// A sequence read from an IBioseqSource.
+///
+/// When several threads are used, the deflines are extracted and the
+/// sequence data is converted before the sequence reaches the thread
+/// that writes the database; any exception thrown while doing so is
+/// kept here and rethrown when the sequence would have been added.
+struct CBuildDatabase::SSourceBioseq {
+    /// The sequence.
+    CConstRef<CBioseq> m_Bioseq;
 
-    CStopWatch sw(CStopWatch::eStart);
-    int count = 0;
+    /// The first Seq-id of the sequence, for log messages.
+    string m_Id;
+
+    /// Deflines extracted from the sequence, if already done.
+    CRef<CBlast_def_line_set> m_Headers;
+
+    /// Error found while preparing the sequence.
+    std::exception_ptr m_Error;
+};
 
+bool CBuildDatabase::x_ReadSourceBioseq(IBioseqSource & src,
+                                        SSourceBioseq & entry)
+{
     CConstRef<CBioseq> bs = src.GetNext();
 
     while(bs.NotEmpty()) {
@@ -815,32 +834,149 @@ bool CBuildDatabase::AddSequences(IBioseqSource & src, bool add_pig)
             }
         }
 
-        if(bs->IsAa() != m_IsProtein ){
-                    bs = src.GetNext();
-                    continue;
-       }
-
-        if ((bs->GetLength() == 0) || (!x_EditAndAddBioseq(bs, NULL, add_pig))){
-            m_LogFile << "Ignoring sequence '" << bioseq_id
-                      << "' as it has no sequence data" << endl;
-            bs = src.GetNext();
-            continue;
+        if (bs->IsAa() == m_IsProtein) {
+            entry.m_Bioseq = bs;
+            entry.m_Id.swap(bioseq_id);
+            entry.m_Headers.Reset();
+            entry.m_Error = std::exception_ptr();
+            return true;
         }
 
-        if (m_Verbose) {
-            m_LogFile << "Adding bioseq from fasta; first id is: '" << bioseq_id
-                << "'" << endl;
-        }
+        bs = src.GetNext();
+    }
+
+    return false;
+}
 
-        // No linkouts or memberships here (yet).
+void CBuildDatabase::x_ReadSourceBatch(IBioseqSource         & src,
+                                       vector<SSourceBioseq> & batch,
+                                       size_t                  max_count)
+{
+    SSourceBioseq entry;
 
-        found = true;
+    while (batch.size() < max_count && x_ReadSourceBioseq(src, entry)) {
+        batch.push_back(entry);
+    }
+}
 
-        count++;
+bool CBuildDatabase::x_AddSourceBioseq(SSourceBioseq & entry, bool add_pig)
+{
+    if (entry.m_Error) {
+        std::rethrow_exception(entry.m_Error);
+    }
 
-        if (debug_mode > 5) m_LogFile << "-- FASTA: Found sequence." << endl;
+    if ((entry.m_Bioseq->GetLength() == 0) ||
+        (! x_EditAndAddBioseq(entry.m_Bioseq, NULL, add_pig,
+                              entry.m_Headers))) {
+        m_LogFile << "Ignoring sequence '" << entry.m_Id
+                  << "' as it has no sequence data" << endl;
+        return false;
+    }
 
-        bs = src.GetNext();
+    if (m_Verbose) {
+        m_LogFile << "Adding bioseq from fasta; first id is: '" << entry.m_Id
+            << "'" << endl;
+    }
+
+    // No linkouts or memberships here (yet).
+
+    if (debug_mode > 5) m_LogFile << "-- FASTA: Found sequence." << endl;
+
+    return true;
+}
+
+void CBuildDatabase::x_PrepareSourceBatch(vector<SSourceBioseq> & batch)
+{
+    const size_t num_tasks = min(batch.size(), (size_t) m_NumThreads);
+    const bool parse_ids = m_ParseIDs;
+    const bool long_ids = m_LongIDs;
+    vector<TWriteDB_Task> tasks;
+
+    for (size_t t = 0; t < num_tasks; t++) {
+        tasks.push_back([&batch, t, num_tasks, parse_ids, long_ids]() {
+            for (size_t i = t; i < batch.size(); i += num_tasks) {
+                SSourceBioseq & entry = batch[i];
+
+                try {
+                    if (entry.m_Bioseq->GetLength() == 0) {
+                        continue;
+                    }
+                    entry.m_Headers =
+                        CWriteDB::ExtractBioseqDeflines(*entry.m_Bioseq,
+                                                        parse_ids,
+                                                        long_ids);
+                    entry.m_Bioseq = s_FixBioseqDeltas(entry.m_Bioseq);
+                }
+                catch (...) {
+                    entry.m_Error = std::current_exception();
+                }
+            }
+        });
+    }
+
+    WriteDB_RunTasks(tasks, m_NumThreads);
+}
+
+bool CBuildDatabase::AddSequences(IBioseqSource & src, bool add_pig)
+{
+    CStopWatch sw(CStopWatch::eStart);
+    int count = 0;
+
+    if (m_NumThreads > 1) {
+        // Sequences are handled in batches.  While one batch is added
+        // to the database (which must be done in input order), the
+        // next one is read from the source; it is then prepared for
+        // the database by all threads.  If reading fails, the
+        // sequences read before the failure are still added.
+
+        const size_t kBatchSize = 256 * m_NumThreads;
+        vector<SSourceBioseq> current, next;
+        std::exception_ptr read_error;
+
+        auto read_next = [&](vector<SSourceBioseq> & batch) {
+            try {
+                x_ReadSourceBatch(src, batch, kBatchSize);
+            }
+            catch (...) {
+                read_error = std::current_exception();
+            }
+        };
+
+        read_next(current);
+
+        while (! current.empty()) {
+            x_PrepareSourceBatch(current);
+
+            vector<TWriteDB_Task> tasks;
+
+            if (! read_error) {
+                tasks.push_back([&]() { read_next(next); });
+            }
+            tasks.push_back([&]() {
+                NON_CONST_ITERATE(vector<SSourceBioseq>, entry, current) {
+                    if (x_AddSourceBioseq(*entry, add_pig)) {
+                        count++;
+                    }
+                }
+            });
+
+            WriteDB_RunTasks(tasks, 2);
+
+            current.swap(next);
+            next.clear();
+        }
+
+        if (read_error) {
+            std::rethrow_exception(read_error);
+        }
+    } else {
+        SSourceBioseq entry;
+
+        while (x_ReadSourceBioseq(src, entry)) {
+            if (x_AddSourceBioseq(entry, add_pig)) {
+                count++;
+            }
+        }
     }
 
     if (count) {
@@ -850,7 +986,7 @@ bool CBuildDatabase::AddSequences(IBioseqSource & src, bool add_pig)
                   << count << " sequences in " << t << " seconds." << endl;
     }
 
-    return found;
+    return count > 0;
 }
 
 bool CBuildDatabase::AddSequences(IRawSequenceSource & src)
@@ -1041,6 +1177,7 @@ CBuildDatabase::CBuildDatabase(const string         & dbname,
       m_Verbose      (false),
       m_ParseIDs     (((indexing & CWriteDB::eFullIndex) != 0 ? true : false)),
       m_LongIDs      (long_seqids),
+      m_NumThreads   (1),
       m_FoundMatchingMasks(false)
 {
     s_CreateDirectories(dbname);
@@ -1093,6 +1230,7 @@ CBuildDatabase::CBuildDatabase(const string & dbname,
       m_Verbose      (false),
       m_ParseIDs     (parse_seqids),
       m_LongIDs      (long_seqids),
+      m_NumThreads   (1),
       m_FoundMatchingMasks(false)
 {
     s_CreateDirectories(dbname);
@@ -1514,6 +1652,12 @@ void CBuildDatabase::SetMaxFileSize(Uint8 max_file_size)
     m_OutputDb->SetMaxFileSize(max_file_size);
 }
 
+void CBuildDatabase::SetNumThreads(int num_threads)
+{
+    m_NumThreads = max(num_threads, 1);
+    m_OutputDb->SetNumThreads(m_NumThreads);
+}
+
 int
 CBuildDatabase::RegisterMaskingAlgorithm(EBlast_filter_program program,
                                          const string        & options,
@@ -3279,6 +3279,99 @@ typedef CSeqDBSqlite::SAccOid SAccOid;
 typedef CSeqDBSqlite::TOid TOid;
 
 
+// Build a protein database from FASTA with the given number of threads.
+
+static void s_BuildFromFasta(const string & fasta,
+                             const string & dbname,
+                             int            num_threads)
+{
+    CNcbiIstrstream istr(fasta.data(), fasta.size());
+    ostringstream log;
+    CBuildDatabase db(dbname, "Temporary unit test db", true,
+                      CWriteDB::eFullIndex, false, &log);
+
+    db.SetNumThreads(num_threads);
+    db.StartBuild();
+    db.AddFasta(istr);
+    db.EndBuild();
+}
+
+BOOST_AUTO_TEST_CASE(MultiThreadedBuildIsIdentical)
+{
+    // Enough sequences to span several input batches, with deflines
+    // that go to the GI, accession and string ISAM indices.  The
+    // volume shares the threads between its four ISAM indices, so 12
+    // threads give each index sort 3 threads, and the GI table is big
+    // enough (64K entries per chunk) to be sorted in 3 chunks.
+
+    const int kNumSeqs = 200000;
+    const int kNumThreads = 12;
+
+    CNcbiOstrstream oss;
+    for (int i = 0; i < kNumSeqs; i++) {
+        oss << ">gi|" << (100000 + i * 7) << "|ref|XP_" << (900000 - i)
+            << ".1| protein " << i << endl;
+        for (int j = 0; j < 10 + i % 20; j++) {
+            oss << "ACDEFGHIKLMNPQRSTVWY"[(i * 31 + j * 17) % 20];
+        }
+        oss << endl;
+    }
+    const string fasta = CNcbiOstrstreamToString(oss);
+
+    const string db1 = "data/mt_build_1", dbn = "data/mt_build_n";
+    const char * exts[] = { "phr", "psq", "pog", "pni", "pnd",
+                            "psi", "psd", "pin" };
+
+    for (const char * ext : exts) {
+        CFileDeleteAtExit::Add(db1 + "." + ext);
+        CFileDeleteAtExit::Add(dbn + "." + ext);
+    }
+
+    s_BuildFromFasta(fasta, db1, 1);
+    s_BuildFromFasta(fasta, dbn, kNumThreads);
+
+    // The index file (.pin) holds the build time, so it is only
+    // compared through CSeqDB.
+
+    for (const char * ext : exts) {
+        if (string(ext) == "pin") {
+            continue;
+        }
+        CNcbiIfstream f1((db1 + "." + ext).c_str(), IOS_BASE::binary);
+        CNcbiIfstream fn((dbn + "." + ext).c_str(), IOS_BASE::binary);
+        BOOST_REQUIRE(f1 && fn);
+
+        CNcbiOstrstream d1, dn;
+        NcbiStreamCopy(d1, f1);
+        NcbiStreamCopy(dn, fn);
+        const string data1 = CNcbiOstrstreamToString(d1);
+        const string datan = CNcbiOstrstreamToString(dn);
+        BOOST_REQUIRE_MESSAGE(data1 == datan,
+                              string("Files differ: ") + ext);
+    }
+
+    CSeqDB seqdb1(db1, CSeqDB::eProtein), seqdbn(dbn, CSeqDB::eProtein);
+    BOOST_REQUIRE_EQUAL(seqdb1.GetNumOIDs(), kNumSeqs);
+    BOOST_REQUIRE_EQUAL(seqdbn.GetNumOIDs(), kNumSeqs);
+    BOOST_REQUIRE_EQUAL(seqdb1.GetTotalLength(), seqdbn.GetTotalLength());
+
+    vector<int> oids;
+    seqdbn.AccessionToOids("XP_900000.1", oids);
+    BOOST_REQUIRE_EQUAL(oids.size(), 1U);
+    BOOST_REQUIRE_EQUAL(oids.front(), 0);
+
+    oids.clear();
+    seqdbn.AccessionToOids("XP_" + NStr::IntToString(900001 - kNumSeqs)
+                           + ".1", oids);
+    BOOST_REQUIRE_EQUAL(oids.size(), 1U);
+    BOOST_REQUIRE_EQUAL(oids.front(), kNumSeqs - 1);
+
+    int oid = -1;
+    BOOST_REQUIRE(seqdbn.GiToOid(GI_FROM(int, 100000 + (kNumSeqs / 2) * 7),
+                                 oid));
+    BOOST_REQUIRE_EQUAL(oid, kNumSeqs / 2);
+}
+
 BOOST_AUTO_TEST_CASE(CreateSqliteDB)
 {
     // Initialize SQLite library.
@@ -117,6 +117,11 @@ void CWriteDB::SetMaxVolumeLetters(Uint8 sz)
     m_Impl->SetMaxVolumeLetters(sz);
 }
 
+void CWriteDB::SetNumThreads(int num_threads)
+{
+    m_Impl->SetNumThreads(num_threads);
+}
+
 CRef<CBlast_def_line_set>
 CWriteDB::ExtractBioseqDeflines(const CBioseq & bs, bool parse_ids,
                                 bool long_ids)
@@ -31,17 +31,147 @@
 /// Implementation for general purpose utilities for WriteDB.
 #include <ncbi_pch.hpp>
 #include <objtools/blast/seqdb_writer/writedb_general.hpp>
+#include <corelib/ncbithr.hpp>
+#include <exception>
 
 BEGIN_NCBI_SCOPE
 
 /// Use standard C++ definitions.
 USING_SCOPE(std);
 
-void CWriteDB_PackedSemiTree::Sort()
+void CWriteDB_PackedSemiTree::Sort(int num_threads)
 {
+    if (num_threads <= 1) {
+        NON_CONST_ITERATE(TPackedMap, iter, m_Packed) {
+            iter->second->Sort();
+        }
+        return;
+    }
+    
+    // Buckets are independent, so they can be sorted concurrently;
+    // the result is the same in either case.
+    
+    vector<TWriteDB_Task> tasks;
+    tasks.reserve(m_Packed.size());
+    
     NON_CONST_ITERATE(TPackedMap, iter, m_Packed) {
-        iter->second->Sort();
+        TPacked * packed = iter->second.GetPointer();
+        tasks.push_back([packed]() { packed->Sort(); });
+    }
+    
+    WriteDB_RunTasks(tasks, num_threads);
+}
+
+/// Shared state of the threads started by WriteDB_RunTasks.
+class CWriteDB_TaskQueue {
+public:
+    /// Constructor.
+    /// @param tasks The tasks to run. [in]
+    CWriteDB_TaskQueue(const vector<TWriteDB_Task> & tasks)
+        : m_Tasks(tasks), m_Next(0)
+    {
+    }
+    
+    /// Run tasks until none are left or one of them has failed.
+    void RunTasks()
+    {
+        size_t index = 0;
+        
+        while(x_NextTask(index)) {
+            try {
+                m_Tasks[index]();
+            }
+            catch(...) {
+                CFastMutexGuard guard(m_Lock);
+                
+                if (! m_Error) {
+                    m_Error = std::current_exception();
+                }
+            }
+        }
+    }
+    
+    /// Rethrow the first exception thrown by a task, if any.
+    void CheckError()
+    {
+        if (m_Error) {
+            std::rethrow_exception(m_Error);
+        }
+    }
+    
+private:
+    /// Claim the next task to run.
+    /// @param index The index of the claimed task. [out]
+    /// @return False if there is nothing more to do.
+    bool x_NextTask(size_t & index)
+    {
+        CFastMutexGuard guard(m_Lock);
+        
+        if (m_Error || m_Next >= m_Tasks.size()) {
+            return false;
+        }
+        index = m_Next++;
+        return true;
     }
+    
+    /// The tasks to run.
+    const vector<TWriteDB_Task> & m_Tasks;
+    
+    /// Protects m_Next and m_Error.
+    CFastMutex m_Lock;
+    
+    /// Index of the next task to start.
+    size_t m_Next;
+    
+    /// First exception thrown by a task.
+    std::exception_ptr m_Error;
+};
+
+/// Thread running tasks for WriteDB_RunTasks.
+class CWriteDB_TaskThread : public CThread {
+public:
+    /// Constructor.
+    /// @param queue Source of tasks to run. [in]
+    CWriteDB_TaskThread(CWriteDB_TaskQueue & queue)
+        : m_Queue(queue)
+    {
+    }
+    
+protected:
+    /// Run tasks from the queue.
+    virtual void * Main()
+    {
+        m_Queue.RunTasks();
+        return NULL;
+    }
+    
+private:
+    /// Source of tasks to run.
+    CWriteDB_TaskQueue & m_Queue;
+};
+
+void WriteDB_RunTasks(const vector<TWriteDB_Task> & tasks, int num_threads)
+{
+    size_t nthreads = min((size_t) max(num_threads, 1), tasks.size());
+    CWriteDB_TaskQueue queue(tasks);
+    
+    vector< CRef<CWriteDB_TaskThread> > threads;
+    
+    // The calling thread is one of the workers.
+    
+    for(size_t i = 1; i < nthreads; i++) {
+        threads.push_back(CRef<CWriteDB_TaskThread>
+                          (new CWriteDB_TaskThread(queue)));
+        threads.back()->Run();
+    }
+    
+    queue.RunTasks();
+    
+    NON_CONST_ITERATE(vector< CRef<CWriteDB_TaskThread> >, iter, threads) {
+        (**iter).Join();
+    }
+    
+    queue.CheckError();
 }
 
 void CWriteDB_PackedSemiTree::Clear()
@@ -64,6 +64,7 @@ CWriteDB_Impl::CWriteDB_Impl(const string & dbname,
       m_Title            (title),
       m_MaxFileSize      (0),
       m_MaxVolumeLetters (0),
+      m_NumThreads       (1),
       m_Indices          (indices),
       m_Closed           (false),
       m_MaskDataColumn   (-1),
@@ -1049,6 +1050,7 @@ void CWriteDB_Impl::x_Publish()
                                                m_MaxVolumeLetters,
                                                m_Indices));
 
+            m_Volume->SetNumThreads(m_NumThreads);
             m_VolumeList.push_back(m_Volume);
 
 #if ((!defined(NCBI_COMPILER_WORKSHOP) || (NCBI_COMPILER_VERSION  > 550)) && \
@@ -1420,6 +1422,15 @@ void CWriteDB_Impl::SetMaxVolumeLetters(Uint8 sz)
     m_MaxVolumeLetters = sz;
 }
 
+void CWriteDB_Impl::SetNumThreads(int num_threads)
+{
+    m_NumThreads = max(num_threads, 1);
+
+    if (m_Volume.NotEmpty()) {
+        m_Volume->SetNumThreads(m_NumThreads);
+    }
+}
+
 CRef<CBlast_def_line_set>
 CWriteDB_Impl::ExtractBioseqDeflines(const CBioseq & bs, bool parse_ids,
                                      bool long_seqids)
@@ -203,6 +203,10 @@ public:
     /// @param sz Maximum sequence letters per volume.
     void SetMaxVolumeLetters(Uint8 sz);
 
+    /// Set the number of threads used to build the volume indices.
+    /// @param num_threads Maximum number of threads to use.
+    void SetNumThreads(int num_threads);
+
     /// Extract deflines from a CBioseq.
     ///
     /// Given a CBioseq, this method extracts and returns header info
@@ -368,6 +372,7 @@ private:
     string        m_Date;             ///< Time stamp (for all volumes.)
     Uint8         m_MaxFileSize;      ///< Maximum size of any file.
     Uint8         m_MaxVolumeLetters; ///< Max letters per volume.
+    int           m_NumThreads;       ///< Threads used to build indices.
     EIndexType    m_Indices;          ///< Indexing mode.
     bool          m_Closed;           ///< True if database has been closed.
     string        m_MaskedLetters;    ///< Masked protein letters (IUPAC).
@@ -150,6 +150,11 @@ void CWriteDB_Isam::Close()
     m_DFile->Close();
 }
 
+void CWriteDB_Isam::SetNumThreads(int num_threads)
+{
+    m_IFile->SetNumThreads(num_threads);
+}
+
 void CWriteDB_Isam::RenameSingle()
 {
     m_IFile->RenameSingle();
@@ -174,7 +179,8 @@ CWriteDB_IsamIndex::CWriteDB_IsamIndex(EWriteDBIsamType        itype,
       m_DataFileSize (0),
       m_UseInt8      (false),
       m_DataFile     (datafile),
-      m_Oid          (-1)
+      m_Oid          (-1),
+      m_NumThreads   (1)
 {
     // This is the one case where I don't worry about file size; if
     // the data file can hold the relevant data, the index file can
@@ -295,7 +301,7 @@ void CWriteDB_IsamIndex::x_FlushStringIndex()
     int output_count = 0;
     int index = 0;
 
-    m_StringSort.Sort();
+    m_StringSort.Sort(m_NumThreads);
 
     CWriteDB_PackedSemiTree::Iterator iter = m_StringSort.Begin();
     CWriteDB_PackedSemiTree::Iterator end_iter = m_StringSort.End();
@@ -378,7 +384,7 @@ void CWriteDB_IsamIndex::x_FlushNumericIndex()
 
     int row_index = 0;
 
-    sort(m_NumberTable.begin(), m_NumberTable.end());
+    WriteDB_ParallelSort(m_NumberTable, m_NumThreads);
 
     int count = (int) m_NumberTable.size();
 
@@ -55,7 +55,8 @@ CWriteDB_Volume::CWriteDB_Volume(const string & dbname,
       m_Index       (index),
       m_Indices     (indices),
       m_OID         (0),
-      m_Open        (true)
+      m_Open        (true),
+      m_NumThreads  (1)
 {
     m_VolName = CWriteDB_File::MakeShortName(m_DbName, m_Index);
 
@@ -311,20 +312,45 @@ void CWriteDB_Volume::Close()
         m_Seq->Close();
 
         if (m_Indices != CWriteDB::eNoIndex) {
+            // The indices are written to separate files, so they can
+            // be sorted and flushed concurrently.  The accession
+            // index is usually the largest, so it is started first.
+
+            vector<TWriteDB_Task> tasks;
+            CWriteDB_Isam * acc = m_AccIsam.GetPointer();
+            CWriteDB_Isam * gi = m_GiIsam.GetPointer();
+            CWriteDB_GiIndex * gi_index = m_GiIndex.GetPointer();
+
+            tasks.push_back([acc]() { acc->Close(); });
+            tasks.push_back([gi]() { gi->Close(); });
+
             if (m_Protein) {
-                m_PigIsam->Close();
+                CWriteDB_Isam * pig = m_PigIsam.GetPointer();
+                tasks.push_back([pig]() { pig->Close(); });
             }
-            m_GiIsam->Close();
-            m_AccIsam->Close();
-            m_GiIndex->Close();
+
+            tasks.push_back([gi_index]() { gi_index->Close(); });
 
             if (m_TraceIsam.NotEmpty()) {
-                m_TraceIsam->Close();
+                CWriteDB_Isam * trace = m_TraceIsam.GetPointer();
+                tasks.push_back([trace]() { trace->Close(); });
             }
 
             if (m_HashIsam.NotEmpty()) {
-                m_HashIsam->Close();
+                CWriteDB_Isam * hash = m_HashIsam.GetPointer();
+                tasks.push_back([hash]() { hash->Close(); });
+            }
+
+            // Each index is sorted with threads of its own, so the
+            // budget is divided between the indices and the sorts.
+            int num_tasks = min(m_NumThreads, (int) tasks.size());
+            
+            if (num_tasks < 1) {
+                num_tasks = 1;
             }
+            
+            x_SetIsamThreads(max(1, m_NumThreads / num_tasks));
+            WriteDB_RunTasks(tasks, num_tasks);
             m_IdSet.clear();
         }
     }
@@ -337,6 +363,30 @@ void CWriteDB_Volume::Close()
 #endif
 }
 
+void CWriteDB_Volume::SetNumThreads(int num_threads)
+{
+    m_NumThreads = num_threads;
+}
+
+void CWriteDB_Volume::x_SetIsamThreads(int num_threads)
+{
+    if (m_Indices != CWriteDB::eNoIndex) {
+        if (m_Protein) {
+            m_PigIsam->SetNumThreads(num_threads);
+        }
+        m_GiIsam->SetNumThreads(num_threads);
+        m_AccIsam->SetNumThreads(num_threads);
+
+        if (m_TraceIsam.NotEmpty()) {
+            m_TraceIsam->SetNumThreads(num_threads);
+        }
+
+        if (m_HashIsam.NotEmpty()) {
+            m_HashIsam->SetNumThreads(num_threads);
+        }
+    }
+}
+
 void CWriteDB_Volume::RenameSingle()
 {
     _ASSERT(! m_Open);
@@ -204,6 +204,16 @@ public:
     /// @param files The filenames will be appended to this vector.
     void ListFiles(vector<string> & files) const;
 
+    /// Set the number of threads used to build the ISAM indices.
+    ///
+    /// When the volume is closed, the ISAM indices are sorted and
+    /// written concurrently, and the threads are shared between the
+    /// indices and the sorts within each index.  The files produced
+    /// do not depend on the number of threads.
+    ///
+    /// @param num_threads Maximum number of threads to use. [in]
+    void SetNumThreads(int num_threads);
+
 #if ((!defined(NCBI_COMPILER_WORKSHOP) || (NCBI_COMPILER_VERSION  > 550)) && \
      (!defined(NCBI_COMPILER_MIPSPRO)) )
     /// Type used for database column meta-data.
@@ -253,6 +263,7 @@ private:
 
     int  m_OID;  ///< Next assigned OID.
     bool m_Open; ///< True if user can still append sequences.
+    int  m_NumThreads; ///< Threads used to build the ISAM indices.
 
     // Components
 
@@ -278,6 +289,10 @@ private:
 
     // Functions
 
+    /// Set the number of threads used to sort each ISAM index.
+    /// @param num_threads Maximum number of threads per index. [in]
+    void x_SetIsamThreads(int num_threads);
+
     /// Compute base-length of compressed nucleotide sequence.
     ///
     /// Nucleotide sequences stored on disk are packed 4 bases to a byte,
@@ -1284,7 +1284,7 @@ bool CCacheReader::LoadChunk(CReaderRequestResult& result,
                     CConn_MemoryStream data;
                     {{
                         CRStream stream(str.GetReader());
-                        data << stream.rdbuf();
+                        NcbiStreamCopyThrow(data, stream);
                     }}
                     conn.Release();
 
@@ -1310,11 +1310,8 @@ bool CCacheReader::LoadChunk(CReaderRequestResult& result,
                 else {
                     // current blob version is valid
                     result.SetAndSaveBlobVersion(blob_id, version);
-                    {{
-                        CRStream stream(str.GetReader());
-                        x_ProcessBlob(result, blob_id, chunk_id, stream);
-                    }}
-                    conn.Release();
+                    x_ProcessBlob(result, blob_id, chunk_id,
+                                  str.GetReader(), conn);
                     return true;
                 }
             } while ( false );
@@ -1366,9 +1363,7 @@ bool CCacheReader::LoadChunk(CReaderRequestResult& result,
         return false;
     }
 
-    CRStream stream(buffer.GetReader());
-    x_ProcessBlob(result, blob_id, chunk_id, stream);
-    conn.Release();
+    x_ProcessBlob(result, blob_id, chunk_id, buffer.GetReader(), conn);
     return true;
 }
 
@@ -1396,6 +1391,33 @@ void CCacheReader::x_ProcessBlob(CReaderRequestResult& result,
 }
 
 
+void CCacheReader::x_ProcessBlob(CReaderRequestResult& result,
+                                 const TBlobId& blob_id,
+                                 TChunkId chunk_id,
+                                 IReader* reader,
+                                 CConn& conn)
+{
+    if ( result.IsBulkLoad() ) {
+        // read the blob to allow next ICache command of other threads
+        // while the blob is parsed
+        CConn_MemoryStream data;
+        {{
+            CRStream stream(reader);
+            NcbiStreamCopyThrow(data, stream);
+        }}
+        conn.Release();
+        x_ProcessBlob(result, blob_id, chunk_id, data);
+    }
+    else {
+        {{
+            CRStream stream(reader);
+            x_ProcessBlob(result, blob_id, chunk_id, stream);
+        }}
+        conn.Release();
+    }
+}
+
+
 struct SPluginParams
 {
     typedef SCacheInfo::TParams TParams;
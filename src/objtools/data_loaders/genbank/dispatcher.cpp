@@ -648,6 +648,56 @@ namespace {
         TLock m_Lock;
     };
 
+    class CCommandLoadSeq_idBlob_idsSet : public CReadDispatcherCommand
+    {
+    public:
+        typedef CReadDispatcher::TIds TIds;
+        CCommandLoadSeq_idBlob_idsSet(CReaderRequestResult& result,
+                                      const TIds& seq_ids)
+            : CReadDispatcherCommand(result)
+            {
+                ITERATE(TIds, id, seq_ids) {
+                    if ( !CReadDispatcher::CannotProcess(*id) ) {
+                        m_Ids.push_back(*id);
+                    }
+                }
+            }
+
+        bool IsDone(void)
+            {
+                CReaderRequestResult& result = GetResult();
+                ITERATE(TIds, id, m_Ids) {
+                    CLoadLockBlobIds lock(result, *id, 0);
+                    if ( !s_Blob_idsLoaded(lock, result, *id) ) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+        bool Execute(CReader& reader)
+            {
+                return reader.LoadSeq_idBlob_idsSet(GetResult(), m_Ids);
+            }
+        string GetErrMsg(void) const
+            {
+                return "LoadSeq_idBlob_idsSet(" +
+                    NStr::SizetToString(m_Ids.size()) + " ids): "
+                    "data not found";
+            }
+        CGBRequestStatistics::EStatType GetStatistics(void) const
+            {
+                return CGBRequestStatistics::eStat_Seq_idBlob_ids;
+            }
+        string GetStatisticsDescription(void) const
+            {
+                return "blob-ids(" +
+                    NStr::SizetToString(m_Ids.size()) + " ids)";
+            }
+        
+    private:
+        TIds m_Ids;
+    };
+
     template<class CLoadLock>
     bool sx_IsLoaded(size_t i,
                      CReaderRequestResult& result,
@@ -1749,6 +1799,14 @@ void CReadDispatcher::LoadSeq_idBlob_ids(CReaderRequestResult& result,
 }
 
 
+void CReadDispatcher::LoadSeq_idBlob_idsSet(CReaderRequestResult& result,
+                                            const TIds& seq_ids)
+{
+    CCommandLoadSeq_idBlob_idsSet command(result, seq_ids);
+    Process(command);
+}
+
+
 void CReadDispatcher::LoadBlobState(CReaderRequestResult& result,
                                     const TBlobId& blob_id)
 {
@@ -65,6 +65,8 @@
 #include <corelib/plugin_manager_impl.hpp>
 #include <corelib/plugin_manager_store.hpp>
 
+#include <util/thread_pool.hpp>
+
 #include <algorithm>
 
 
@@ -535,6 +537,22 @@ void CGBDataLoader::x_CreateDriver(const CGBLoaderParams& params)
             }
         }
     }
+    m_BulkLoadThreads = 0;
+    if ( gb_params ) {
+        string param =
+            GetParam(gb_params, NCBI_GBLOADER_PARAM_BULK_LOAD_THREADS);
+        if ( !param.empty() ) {
+            try {
+                m_BulkLoadThreads = NStr::StringToUInt(param);
+            }
+            catch ( CException& exc ) {
+                NCBI_RETHROW_FMT(exc, CLoaderException, eBadConfig,
+                                 "Bad value of parameter "
+                                 NCBI_GBLOADER_PARAM_BULK_LOAD_THREADS
+                                 ": \""<<param<<"\"");
+            }
+        }
+    }
     
     m_Dispatcher = new CReadDispatcher;
     m_InfoManager = new CGBInfoManager(queue_size);
@@ -1675,6 +1693,150 @@ void CGBDataLoader::GetChunks(const TChunkSet& chunks)
 }
 
 
+namespace {
+    class CGBBulkLoadTask : public CThreadPool_Task
+    {
+    public:
+        typedef CReadDispatcher::TIds TIds;
+        typedef vector<CTSE_LoadLock> TLocks;
+
+        CGBBulkLoadTask(CGBDataLoader* loader,
+                        CReadDispatcher& dispatcher,
+                        TIds& ids)
+            : m_Loader(loader), m_Dispatcher(dispatcher), m_Done(0, 1)
+            {
+                m_Ids.swap(ids);
+            }
+
+        virtual EStatus Execute(void);
+
+        // wait until the blobs are loaded, or the task is canceled
+        void Wait(void) { m_Done.Wait(); }
+
+        // locks of loaded blobs, they keep the blobs in the data source
+        // until the requesting thread gets its own locks
+        TLocks& GetLocks(void) { return m_Locks; }
+
+    protected:
+        virtual void OnStatusChange(EStatus /*old*/)
+            {
+                if ( IsFinished() ) {
+                    m_Done.Post();
+                }
+            }
+
+    private:
+        CGBDataLoader*   m_Loader;
+        CReadDispatcher& m_Dispatcher;
+        CSemaphore       m_Done;
+        TIds             m_Ids;
+        TLocks           m_Locks;
+    };
+
+
+    CThreadPool_Task::EStatus CGBBulkLoadTask::Execute(void)
+    {
+        try {
+            // request results are not MT-safe, each thread needs its own
+            CGBReaderRequestResult result(m_Loader, CSeq_id_Handle());
+            result.SetBulkLoad();
+            m_Dispatcher.LoadBlobSet(result, m_Ids);
+            ITERATE ( TIds, id, m_Ids ) {
+                CLoadLockBlobIds blob_ids_lock(result, *id, 0);
+                CFixedBlob_ids blob_ids = blob_ids_lock.GetBlob_ids();
+                ITERATE ( CFixedBlob_ids, it, blob_ids ) {
+                    if ( it->Matches(fBlobHasCore, 0) ) {
+                        CTSE_LoadLock lock =
+                            result.GetTSE_LoadLockIfLoaded(*it->GetBlob_id());
+                        if ( lock ) {
+                            m_Locks.push_back(lock);
+                        }
+                    }
+                }
+            }
+        }
+        catch ( exception& /*ignored*/ ) {
+            // the blobs will be loaded again by the requesting thread,
+            // which will report the error
+            return eFailed;
+        }
+        return eCompleted;
+    }
+}
+
+
+void CGBDataLoader::x_LoadBlobSetParallel(CGBReaderRequestResult& result,
+                                          const TIds& ids,
+                                          vector<CTSE_LoadLock>& locks)
+{
+    // resolve all Seq-ids in one batch
+    m_Dispatcher->LoadSeq_idBlob_idsSet(result, ids);
+
+    // Distribute Seq-ids with unloaded blobs between groups, so that
+    // every blob is requested by one group only. Each group is loaded
+    // by one LoadBlobSet() command, which lets readers coalesce requests.
+    size_t group_count = m_BulkLoadThreads;
+    vector<CReadDispatcher::TIds> groups(group_count);
+    vector<size_t> group_sizes(group_count);
+    set<CBlob_id> requested;
+    ITERATE ( TIds, id, ids ) {
+        CLoadLockBlobIds blob_ids_lock(result, *id, 0);
+        if ( !blob_ids_lock.IsLoaded() ) {
+            continue;
+        }
+        CFixedBlob_ids blob_ids = blob_ids_lock.GetBlob_ids();
+        size_t new_blobs = 0;
+        ITERATE ( CFixedBlob_ids, it, blob_ids ) {
+            const CBlob_id& blob_id = *it->GetBlob_id();
+            if ( !it->Matches(fBlobHasCore, 0) ||
+                 requested.count(blob_id) ) {
+                continue;
+            }
+            if ( result.GetTSE_LoadLockIfLoaded(blob_id) ) {
+                continue;
+            }
+            requested.insert(blob_id);
+            ++new_blobs;
+        }
+        if ( !new_blobs ) {
+            continue;
+        }
+        size_t group = min_element(group_sizes.begin(), group_sizes.end()) -
+            group_sizes.begin();
+        groups[group].push_back(*id);
+        group_sizes[group] += new_blobs;
+    }
+    if ( requested.size() < 2 ) {
+        // nothing to parallelize
+        return;
+    }
+
+    {{
+        CFastMutexGuard guard(m_BulkLoadPoolMutex);
+        if ( !m_BulkLoadPool ) {
+            m_BulkLoadPool.reset(new CThreadPool(2*m_BulkLoadThreads,
+                                                 m_BulkLoadThreads,
+                                                 m_BulkLoadThreads));
+        }
+    }}
+    vector< CRef<CGBBulkLoadTask> > tasks;
+    NON_CONST_ITERATE ( vector<CReadDispatcher::TIds>, it, groups ) {
+        if ( it->empty() ) {
+            continue;
+        }
+        CRef<CGBBulkLoadTask> task(new CGBBulkLoadTask(this, *m_Dispatcher,
+                                                       *it));
+        m_BulkLoadPool->AddTask(task.GetPointer());
+        tasks.push_back(task);
+    }
+    NON_CONST_ITERATE ( vector< CRef<CGBBulkLoadTask> >, it, tasks ) {
+        (*it)->Wait();
+        CGBBulkLoadTask::TLocks& task_locks = (*it)->GetLocks();
+        locks.insert(locks.end(), task_locks.begin(), task_locks.end());
+    }
+}
+
+
 void CGBDataLoader::GetBlobs(TTSE_LockSets& tse_sets)
 {
     CGBReaderRequestResult result(this, CSeq_id_Handle());
@@ -1687,6 +1849,11 @@ void CGBDataLoader::GetBlobs(TTSE_LockSets& tse_sets)
         }
         ids.push_back(id);
     }
+    vector<CTSE_LoadLock> loaded;
+    if ( m_BulkLoadThreads > 1 && ids.size() > 1 ) {
+        x_LoadBlobSetParallel(result, ids, loaded);
+    }
+    // load the rest, if any, and report errors
     m_Dispatcher->LoadBlobSet(result, ids);
 
     NON_CONST_ITERATE(TTSE_LockSets, tse_set, tse_sets) {
@@ -969,6 +969,21 @@ bool CReader::LoadBlobSet(CReaderRequestResult& result,
 }
 
 
+bool CReader::LoadSeq_idBlob_idsSet(CReaderRequestResult& result,
+                                    const TSeqIds& seq_ids)
+{
+    bool ret = false;
+    ITERATE(TSeqIds, id, seq_ids) {
+        CLoadLockBlobIds ids(result, *id, 0);
+        if ( ids.IsLoaded() ) {
+            continue;
+        }
+        ret |= LoadSeq_idBlob_ids(result, *id, 0);
+    }
+    return ret;
+}
+
+
 void CReader::SetAndSaveNoBlob(CReaderRequestResult& result,
                                const TBlobId& blob_id,
                                TChunkId chunk_id,
@@ -1445,8 +1445,8 @@ bool CId2ReaderBase::LoadChunks(CReaderRequestResult& result,
 }
 
 
-bool CId2ReaderBase::x_LoadSeq_idBlob_idsSet(CReaderRequestResult& result,
-                                             const TSeqIds& seq_ids)
+bool CId2ReaderBase::LoadSeq_idBlob_idsSet(CReaderRequestResult& result,
+                                           const TSeqIds& seq_ids)
 {
     size_t max_request_size = GetMaxChunksRequestSize();
     if ( SeparateChunksRequests(max_request_size) ) {
@@ -1490,7 +1490,7 @@ bool CId2ReaderBase::LoadBlobSet(CReaderRequestResult& result,
     bool loaded_blob_ids = false;
     size_t processed_requests = 0;
     if ( m_AvoidRequest & fAvoidRequest_nested_get_blob_info ) {
-        if ( !x_LoadSeq_idBlob_idsSet(result, seq_ids) ) {
+        if ( !LoadSeq_idBlob_idsSet(result, seq_ids) ) {
             return false;
         }
         loaded_blob_ids = true;
@@ -1501,7 +1501,7 @@ bool CId2ReaderBase::LoadBlobSet(CReaderRequestResult& result,
     ITERATE(TSeqIds, id, seq_ids) {
         if ( !loaded_blob_ids &&
              (m_AvoidRequest & fAvoidRequest_nested_get_blob_info) ) {
-            if ( !x_LoadSeq_idBlob_idsSet(result, seq_ids) ) {
+            if ( !LoadSeq_idBlob_idsSet(result, seq_ids) ) {
                 return false;
             }
             loaded_blob_ids = true;
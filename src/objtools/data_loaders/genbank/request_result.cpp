@@ -755,7 +755,8 @@ CReaderRequestResult::CReaderRequestResult(const CSeq_id_Handle& requested_id,
       m_RecursiveTime(0),
       m_AllocatedConnection(0),
       m_RetryDelay(0),
-      m_StartTime(sx_GetCurrentTime())
+      m_StartTime(sx_GetCurrentTime()),
+      m_BulkLoad(false)
 {
 }
 
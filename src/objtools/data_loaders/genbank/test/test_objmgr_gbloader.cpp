@@ -34,6 +34,7 @@
 
 #include <ncbi_pch.hpp>
 #include <corelib/ncbiapp.hpp>
+#include <corelib/ncbi_config.hpp>
 
 #include <objects/seq/Bioseq.hpp>
 #include <objects/seqloc/Seq_id.hpp>
@@ -50,6 +51,7 @@
 #include <connect/ncbi_util.h>
 
 #include <objtools/data_loaders/genbank/gbloader.hpp>
+#include <objtools/data_loaders/genbank/gbloader_params.h>
 #include <objtools/data_loaders/genbank/seqref.hpp>
 #include <objtools/data_loaders/genbank/readers.hpp>
 #include <dbapi/driver/drivers.hpp>
@@ -80,6 +82,9 @@ public:
     virtual bool TestApp_Args(CArgDescriptions& args);
     virtual int Run( void);
 
+    // compare bulk load on loader threads with serial bulk load
+    void TestBulkLoad(CObjectManager& om);
+
     bool m_Verbose;
 };
 
@@ -212,12 +217,80 @@ int CTestApplication::Run()
         }
     }
 
+    // the bulk test registers its own loaders
+    pLoader.Reset();
+    pOm->RevokeDataLoader(CGBDataLoader::GetLoaderNameFromArgs());
+    TestBulkLoad(*pOm);
+
     NcbiCout << "=================================================="<<NcbiEndl;
     NcbiCout << "Test completed (" << (time(0)-start) << " sec ) " << NcbiEndl;
     return 0;
 }
 
 
+// Load sequences in one bulk request with 'threads' loader threads,
+// return their top-level Seq-entries as ASN.1 text.
+static vector<string> s_LoadBulk(CObjectManager& om,
+                                 const CScope::TIds& ids,
+                                 unsigned int threads)
+{
+    // new loader starts with empty caches
+    auto_ptr<CGBDataLoader::TParamTree> params
+        (CConfig::ConvertRegToTree(CNcbiApplication::Instance()->GetConfig()));
+    CGBDataLoader::SetParam(CGBDataLoader::GetLoaderParams(params.get()),
+                            NCBI_GBLOADER_PARAM_BULK_LOAD_THREADS,
+                            NStr::UIntToString(threads));
+    CGBDataLoader::TRegisterLoaderInfo info =
+        CGBDataLoader::RegisterInObjectManager(om, *params,
+                                               CObjectManager::eNonDefault);
+    assert(info.IsCreated());
+    CRef<CGBDataLoader> loader(info.GetLoader());
+
+    vector<string> entries;
+    {{
+        CScope scope(om);
+        scope.AddDataLoader(loader->GetName());
+        CScope::TBioseqHandles handles = scope.GetBioseqHandles(ids);
+        ITERATE ( CScope::TBioseqHandles, it, handles ) {
+            CNcbiOstrstream out;
+            if ( *it ) {
+                out << MSerial_AsnText
+                    << *it->GetTopLevelEntry().GetCompleteSeq_entry();
+            }
+            entries.push_back(CNcbiOstrstreamToString(out));
+        }
+    }}
+    loader.Reset();
+    om.RevokeDataLoader(CGBDataLoader::GetLoaderNameFromArgs());
+    return entries;
+}
+
+
+void CTestApplication::TestBulkLoad(CObjectManager& om)
+{
+    CScope::TIds ids;
+    for ( TIntId gi = 18565540;  gi < 18565650; gi++ ) {
+        ids.push_back(CSeq_id_Handle::GetGiHandle(GI_FROM(TIntId, gi)));
+    }
+    vector<string> serial = s_LoadBulk(om, ids, 0);
+    vector<string> parallel = s_LoadBulk(om, ids, 4);
+    assert(serial.size() == ids.size());
+    assert(parallel.size() == ids.size());
+    for ( size_t i = 0; i < ids.size(); ++i ) {
+        if ( serial[i].empty() ) {
+            ERR_POST(Fatal << ids[i] << ":: not found in bulk request");
+        }
+        if ( parallel[i] != serial[i] ) {
+            ERR_POST(Fatal << ids[i] << ":: "
+                     "different data from parallel bulk request");
+        }
+    }
+    if ( m_Verbose ) {
+        LOG_POST("Bulk load: " << ids.size() << " sequences OK");
+    }
+}
+
+
 END_NCBI_SCOPE
 
 
@@ -215,6 +215,19 @@ CGff2Reader::ReadSeqAnnot(
             return pAnnot;
         }
         xReportProgress(pEC);
+        if (m_iFlags & fStreaming) {
+            if (line == "###") {
+                // all forward references resolved: annot is complete
+                if (mCurrentFeatureCount) {
+                    break;
+                }
+                continue;
+            }
+            if (xIsNewSequence(line)) {
+                xUngetLine(lr);
+                break;
+            }
+        }
         if ( xParseStructuredComment(line) ) {
             continue;
         }
@@ -255,6 +268,9 @@ CGff2Reader::ReadSeqAnnot(
     }
 
     xPostProcessAnnot(pAnnot, pEC);
+    if (m_iFlags & fStreaming) {
+        xClearFeatureMaps();
+    }
     return pAnnot;
 }
 
@@ -485,7 +501,7 @@ CGff2Reader::xParseFeature(
     }
 
     //make sure we are interested:
-    string ftype = pRecord->Type();
+    const string& ftype = pRecord->Type();
     if (xIsIgnoredFeatureType(ftype)) {
         return true;
     }
@@ -2245,11 +2261,39 @@ bool CGff2Reader::xReadInit()
     return true;
 }
 
+//  ============================================================================
+void CGff2Reader::xClearFeatureMaps()
+//  ============================================================================
+{
+    m_MapIdToFeature.clear();
+}
+
+//  ============================================================================
+bool CGff2Reader::xIsNewSequence(
+    const string& line)
+//  ============================================================================
+{
+    if (line.empty()  ||  line[0] == '#'  ||
+            xIsTrackLine(line)  ||  xIsBrowserLine(line)) {
+        return false;
+    }
+    CTempString seqId = CTempString(line).substr(0, line.find_first_of(" \t"));
+    if (!mCurrentFeatureCount) {
+        mCurrentSeqId.assign(seqId.data(), seqId.size());
+        return false;
+    }
+    return (seqId != mCurrentSeqId);
+}
+
 //  ============================================================================
 bool CGff2Reader::IsAlignmentData(
     const string& line)
 //  ============================================================================
 {
+    //  cheap test first, this is called several times for every line:
+    if (NStr::Find(line, "match") == NPOS) {
+        return false;
+    }
     vector<CTempStringEx> columns;
     CGff2Record::TokenizeGFF(columns, line);
     if (columns.size() < 9) {
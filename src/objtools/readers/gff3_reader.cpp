@@ -698,6 +698,15 @@ bool CGff3Reader::xReadInit()
     return true;
 }
 
+//  ----------------------------------------------------------------------------
+void CGff3Reader::xClearFeatureMaps()
+//  ----------------------------------------------------------------------------
+{
+    CGff2Reader::xClearFeatureMaps();
+    mCdsParentMap.clear();
+    mMrnaLocs.clear();
+}
+
 //  ----------------------------------------------------------------------------
 bool CGff3Reader::xIsIgnoredFeatureType(
     const string& featureType)
@@ -211,6 +211,16 @@ CGtfReader::~CGtfReader()
 {
 }
 
+//  ----------------------------------------------------------------------------
+void CGtfReader::xClearFeatureMaps()
+//  ----------------------------------------------------------------------------
+{
+    CGff2Reader::xClearFeatureMaps();
+    m_GeneMap.clear();
+    m_CdsMap.clear();
+    m_MrnaMap.clear();
+}
+
 //  ---------------------------------------------------------------------------                       
 void
 CGtfReader::ReadSeqAnnots(
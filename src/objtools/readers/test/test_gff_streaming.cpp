@@ -0,0 +1,149 @@
+/*  $Id$
+ * ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ *
+ * File Description:
+ *     Throughput and memory benchmark for the GFF3/GTF readers, with and
+ *     without CGff2Reader::fStreaming.
+ */
+
+#include <ncbi_pch.hpp>
+#include <corelib/ncbiapp.hpp>
+#include <corelib/ncbiargs.hpp>
+#include <corelib/ncbifile.hpp>
+#include <corelib/ncbitime.hpp>
+#include <corelib/ncbi_system.hpp>
+
+#include <util/line_reader.hpp>
+
+#include <objects/seq/Seq_annot.hpp>
+#include <objtools/readers/message_listener.hpp>
+#include <objtools/readers/gff3_reader.hpp>
+#include <objtools/readers/gtf_reader.hpp>
+
+USING_NCBI_SCOPE;
+USING_SCOPE(objects);
+
+//  ----------------------------------------------------------------------------
+class CGffStreamingTestApp : public CNcbiApplication
+//  ----------------------------------------------------------------------------
+{
+public:
+    virtual void Init(void);
+    virtual int  Run(void);
+
+private:
+    static size_t x_ResidentMemory(void);
+};
+
+//  ----------------------------------------------------------------------------
+void CGffStreamingTestApp::Init(void)
+//  ----------------------------------------------------------------------------
+{
+    auto_ptr<CArgDescriptions> arg_desc(new CArgDescriptions);
+    arg_desc->SetUsageContext(GetArguments().GetProgramBasename(),
+        "Measure GFF3/GTF reader throughput and peak memory");
+
+    arg_desc->AddDefaultKey("i", "InputFile", "GFF3 or GTF input",
+        CArgDescriptions::eInputFile, "-");
+    arg_desc->AddDefaultKey("format", "Format", "Input format",
+        CArgDescriptions::eString, "gff3");
+    arg_desc->SetConstraint("format", &(*new CArgAllow_Strings, "gff3", "gtf"));
+    arg_desc->AddFlag("streaming",
+        "Read with fStreaming, one annot per sequence");
+    arg_desc->AddFlag("keep",
+        "Keep all annots in memory, as ReadSeqAnnots() does");
+
+    SetupArgDescriptions(arg_desc.release());
+}
+
+//  ----------------------------------------------------------------------------
+int CGffStreamingTestApp::Run(void)
+//  ----------------------------------------------------------------------------
+{
+    const CArgs& args = GetArgs();
+
+    int flags = 0;
+    if (args["streaming"]) {
+        flags |= CGff2Reader::fStreaming;
+    }
+    auto_ptr<CGff2Reader> pReader;
+    if (args["format"].AsString() == "gtf") {
+        pReader.reset(new CGtfReader(flags));
+    }
+    else {
+        pReader.reset(new CGff3Reader(flags));
+    }
+
+    CMessageListenerLenient errors;
+    CStreamLineReader lr(args["i"].AsInputFile());
+    CGff2Reader::TAnnots kept;
+    size_t annots = 0;
+    size_t features = 0;
+    size_t peak = x_ResidentMemory();
+
+    CStopWatch sw(CStopWatch::eStart);
+    CRef<CSeq_annot> pAnnot = pReader->ReadSeqAnnot(lr, &errors);
+    while (pAnnot) {
+        ++annots;
+        if (pAnnot->IsFtable()) {
+            features += pAnnot->GetData().GetFtable().size();
+        }
+        if (args["keep"]) {
+            kept.push_back(pAnnot);
+        }
+        peak = max(peak, x_ResidentMemory());
+        pAnnot = pReader->ReadSeqAnnot(lr, &errors);
+    }
+    double seconds = sw.Elapsed();
+    peak = max(peak, x_ResidentMemory());
+
+    unsigned int lines = lr.GetLineNumber();
+    cout << "lines:      " << lines << endl
+         << "annots:     " << annots << endl
+         << "features:   " << features << endl
+         << "errors:     " << errors.Count() << endl
+         << "seconds:    " << seconds << endl
+         << "lines/sec:  " << (seconds > 0 ? lines / seconds : 0.0) << endl
+         << "peak RSS:   " << peak / (1024*1024) << " MB" << endl;
+    return 0;
+}
+
+//  ----------------------------------------------------------------------------
+size_t CGffStreamingTestApp::x_ResidentMemory(void)
+//  ----------------------------------------------------------------------------
+{
+    size_t total = 0, resident = 0, shared = 0;
+    if (!GetMemoryUsage(&total, &resident, &shared)) {
+        return 0;
+    }
+    return resident;
+}
+
+//  ----------------------------------------------------------------------------
+int main(int argc, const char* argv[])
+//  ----------------------------------------------------------------------------
+{
+    return CGffStreamingTestApp().AppMain(argc, argv);
+}
@@ -38,6 +38,8 @@
 #include <corelib/ncbiapp.hpp>
 #include <corelib/ncbifile.hpp>
 
+#include <util/line_reader.hpp>
+#include <objects/seq/Seq_annot.hpp>
 #include <objtools/readers/gff3_reader.hpp>
 #include "error_logger.hpp"
 
@@ -325,3 +327,45 @@ BOOST_AUTO_TEST_CASE(RunTests)
         BOOST_CHECK_NO_THROW(sRunTest(sName, testInfo, args["keep-diffs"]));
     }
 }
+
+static size_t sCountFeatures(const CSeq_annot& annot)
+{
+    return annot.IsFtable() ? annot.GetData().GetFtable().size() : 0;
+}
+
+BOOST_AUTO_TEST_CASE(StreamingMode)
+{
+    const string input(
+        "##gff-version 3\n"
+        "chr1\tRefSeq\tgene\t100\t200\t.\t+\t.\tID=gene1\n"
+        "chr1\tRefSeq\tgene\t300\t400\t.\t+\t.\tID=gene2\n"
+        "chr1\tRefSeq\tgene\t500\t600\t.\t-\t.\tID=gene3\n"
+        "chr2\tRefSeq\tgene\t100\t200\t.\t+\t.\tID=gene4\n"
+        "###\n"
+        "chr2\tRefSeq\tgene\t300\t400\t.\t+\t.\tID=gene5\n");
+
+    // default: everything in a single annot
+    {
+        CGff3Reader reader(0);
+        CNcbiIstrstream istr(input.data(), input.size());
+        CStreamLineReader lr(istr);
+        CRef<CSeq_annot> pAnnot = reader.ReadSeqAnnot(lr);
+        BOOST_REQUIRE(pAnnot);
+        BOOST_CHECK_EQUAL(sCountFeatures(*pAnnot), 5u);
+        BOOST_CHECK(!reader.ReadSeqAnnot(lr));
+    }
+
+    // streaming: split at sequence change and at "###"
+    {
+        CGff3Reader reader(CGff2Reader::fStreaming);
+        CNcbiIstrstream istr(input.data(), input.size());
+        CStreamLineReader lr(istr);
+        size_t expected[] = { 3, 1, 1 };
+        for (size_t i = 0;  i < sizeof(expected)/sizeof(expected[0]);  ++i) {
+            CRef<CSeq_annot> pAnnot = reader.ReadSeqAnnot(lr);
+            BOOST_REQUIRE(pAnnot);
+            BOOST_CHECK_EQUAL(sCountFeatures(*pAnnot), expected[i]);
+        }
+        BOOST_CHECK(!reader.ReadSeqAnnot(lr));
+    }
+}
@@ -38,6 +38,12 @@
 #include <corelib/ncbiapp.hpp>
 #include <corelib/ncbifile.hpp>
 
+#include <util/line_reader.hpp>
+#include <objects/seq/Seq_annot.hpp>
+#include <objects/seqfeat/Seq_feat.hpp>
+#include <objects/general/User_object.hpp>
+#include <objects/general/User_field.hpp>
+
 #include <objtools/readers/vcf_reader.hpp>
 #include "error_logger.hpp"
 
@@ -189,16 +195,18 @@ void sUpdateAll(CDir& test_cases_dir) {
     }
 }
 
-void sRunTest(const string &sTestName, const STestInfo & testInfo, bool keep)
+void sRunTest(const string &sTestName, const STestInfo & testInfo, bool keep,
+    unsigned int threads)
 {
     cerr << "Testing " << testInfo.mInFile.GetName() << " against " <<
         testInfo.mOutFile.GetName() << " and " <<
-        testInfo.mErrorFile.GetName() << endl;
+        testInfo.mErrorFile.GetName() << " (threads: " << threads << ")" << endl;
 
     string logName = CDirEntry::GetTmpName();
     CErrorLogger logger(logName);
 
     READERCLASS reader(0);
+    reader.SetThreads(threads);
     CNcbiIfstream ifstr(testInfo.mInFile.GetPath().c_str());
 
     typedef list<CRef<CSeq_annot> > ANNOTS;
@@ -319,6 +327,136 @@ BOOST_AUTO_TEST_CASE(RunTests)
         
         cout << "Running test: " << sName << endl;
 
-        BOOST_CHECK_NO_THROW(sRunTest(sName, testInfo, args["keep-diffs"]));
+        BOOST_CHECK_NO_THROW(sRunTest(sName, testInfo, args["keep-diffs"], 1));
+        // threaded parsing must give exactly the same results
+        BOOST_CHECK_NO_THROW(sRunTest(sName, testInfo, args["keep-diffs"], 4));
     }
 }
+
+BOOST_AUTO_TEST_CASE(FormatFields)
+{
+    const string input(
+        "##fileformat=VCFv4.1\n"
+        "#CHROM\tPOS\tID\tREF\tALT\tQUAL\tFILTER\tINFO\tFORMAT\tS1\tS2\tS3\n"
+        "1\t100\trs1\tA\tG\t.\t.\t.\tGT:DP:GQ\t0|1:12:30\t1|1\t0/0::7\n");
+
+    CVcfReader reader(0);
+    vector<string> fields;
+    fields.push_back("GQ");
+    fields.push_back("GT");
+    fields.push_back("XX");
+    reader.SetFormatFields(fields);
+
+    CNcbiIstrstream istr(input.data(), input.size());
+    CStreamLineReader lr(istr);
+    CRef<CSeq_annot> pAnnot = reader.ReadSeqAnnot(lr);
+    BOOST_REQUIRE(pAnnot  &&  pAnnot->IsFtable());
+    BOOST_REQUIRE_EQUAL(pAnnot->GetData().GetFtable().size(), 1u);
+    const CUser_object& ext = pAnnot->GetData().GetFtable().front()->GetExt();
+
+    // only the requested fields present in the record, in requested order
+    const vector<string>& format = ext.GetField("format").GetData().GetStrs();
+    BOOST_REQUIRE_EQUAL(format.size(), 2u);
+    BOOST_CHECK_EQUAL(format[0], "GQ");
+    BOOST_CHECK_EQUAL(format[1], "GT");
+
+    // one value per sample, "." where a sample lacks the field
+    const CUser_field& columns = ext.GetField("genotype-columns");
+    const vector<string>& gq = columns.GetField("GQ").GetData().GetStrs();
+    BOOST_REQUIRE_EQUAL(gq.size(), 3u);
+    BOOST_CHECK_EQUAL(gq[0], "30");
+    BOOST_CHECK_EQUAL(gq[1], ".");
+    BOOST_CHECK_EQUAL(gq[2], "7");
+    const vector<string>& gt = columns.GetField("GT").GetData().GetStrs();
+    BOOST_REQUIRE_EQUAL(gt.size(), 3u);
+    BOOST_CHECK_EQUAL(gt[0], "0|1");
+    BOOST_CHECK_EQUAL(gt[1], "1|1");
+    BOOST_CHECK_EQUAL(gt[2], "0/0");
+    BOOST_CHECK(!ext.HasField("genotype-data"));
+}
+
+//  ----------------------------------------------------------------------------
+string sMakeLargeVcf(
+    size_t dataLines,
+    size_t badLine = 0)
+//  ----------------------------------------------------------------------------
+{
+    // enough data lines for many parser batches, with some of them bad
+    //  enough to produce messages:
+    CNcbiOstrstream ostr;
+    ostr << "##fileformat=VCFv4.1\n"
+         << "#CHROM\tPOS\tID\tREF\tALT\tQUAL\tFILTER\tINFO\tFORMAT\tS1\tS2\n";
+    for (size_t u = 0; u < dataLines; ++u) {
+        if (u % 997 == 500) {
+            ostr << "1\tgarbage\n";
+            continue;
+        }
+        ostr << (u % 2 ? "1" : "2") << "\t" << (100 + 10*u) << "\trs" << u
+             << "\tA\t" << (u % 3 ? "G" : "G,T") << "\t" << (u % 50) << "\t"
+             << (u % 7 ? "PASS" : "q10") << "\t"
+             << (u == badLine ? "WGT=oops" : "DP=10") << "\tGT:DP\t0|1:"
+             << u << "\t1|1:" << (u % 11) << "\n";
+    }
+    return CNcbiOstrstreamToString(ostr);
+}
+
+//  ----------------------------------------------------------------------------
+void sReadLargeVcf(
+    const string& input,
+    unsigned int threads,
+    string& output,
+    string& messages)
+//  ----------------------------------------------------------------------------
+{
+    CVcfReader reader(0);
+    reader.SetThreads(threads);
+    CMessageListenerLenient listener;
+    CNcbiIstrstream istr(input.data(), input.size());
+
+    list<CRef<CSeq_annot> > annots;
+    reader.ReadSeqAnnots(annots, istr, &listener);
+
+    CNcbiOstrstream ostr;
+    ITERATE(list<CRef<CSeq_annot> >, it, annots) {
+        ostr << MSerial_AsnText << **it;
+    }
+    output = CNcbiOstrstreamToString(ostr);
+
+    messages.clear();
+    for (size_t u = 0; u < listener.Count(); ++u) {
+        const ILineError& error = listener.GetError(u);
+        messages += NStr::UIntToString(error.Line()) + ": " +
+            error.Message() + "\n";
+    }
+}
+
+BOOST_AUTO_TEST_CASE(ThreadedBatches)
+{
+    // 10 times the batch size, so several batches are parsed at the same
+    //  time and the merge order matters
+    const string input = sMakeLargeVcf(10000);
+
+    string output1, messages1;
+    sReadLargeVcf(input, 1, output1, messages1);
+    BOOST_REQUIRE(!messages1.empty());
+
+    const unsigned int threads[] = { 2, 4, 7 };
+    for (size_t u = 0; u < sizeof(threads)/sizeof(threads[0]); ++u) {
+        string output, messages;
+        sReadLargeVcf(input, threads[u], output, messages);
+        BOOST_CHECK_MESSAGE(output == output1,
+            "features differ with " << threads[u] << " threads");
+        BOOST_CHECK_EQUAL(messages, messages1);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(ThreadedException)
+{
+    // an exception in a data line leaves the reader the same way no
+    //  matter which thread parsed it
+    const string input = sMakeLargeVcf(10000, 6543);
+
+    string output, messages;
+    BOOST_CHECK_THROW(sReadLargeVcf(input, 1, output, messages), CException);
+    BOOST_CHECK_THROW(sReadLargeVcf(input, 4, output, messages), CException);
+}
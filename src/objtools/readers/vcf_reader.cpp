@@ -37,9 +37,11 @@
 #include <corelib/ncbiutil.hpp>
 #include <corelib/ncbiexpt.hpp>
 #include <corelib/stream_utils.hpp>
+#include <corelib/ncbi_system.hpp>
 
 #include <util/static_map.hpp>
 #include <util/line_reader.hpp>
+#include <util/thread_pool.hpp>
 
 #include <serial/iterator.hpp>
 #include <serial/objistrasn.hpp>
@@ -106,6 +108,7 @@ public:
     vector<string> m_FormatKeys;
 //    vector< vector<string> > m_GenotypeData;
     GTDATA m_GenotypeData;
+    vector<CTempString> m_Samples; // unparsed sample columns, in m_strLine
     enum SetType_t {
         ST_ALL_SNV,
         ST_ALL_DEL,
@@ -115,6 +118,90 @@ public:
     } m_SetType;
 };
 
+//  ============================================================================
+class CVcfParseTask : public CThreadPool_Task
+//  ============================================================================
+{
+public:
+    CVcfParseTask(
+        CVcfReader* pParser ) :
+        m_pParser(pParser),
+        m_pAnnot(new CSeq_annot),
+        m_Done(0, 1),
+        m_uSize(0),
+        m_uDataCount(0),
+        m_uExceptionLine(0)
+    {
+        m_pAnnot->SetData().SetFtable();
+    };
+
+    void AddLine(
+        const string& line,
+        unsigned int lineNumber )
+    {
+        m_Lines.push_back(line);
+        m_LineNumbers.push_back(lineNumber);
+        m_uSize += line.size();
+    };
+
+    bool IsFull() const
+    {
+        return (m_Lines.size() >= kMaxLines  ||  m_uSize >= kMaxSize);
+    };
+
+    virtual EStatus Execute()
+    {
+        try {
+            m_uDataCount = m_pParser->xProcessDataBatch(
+                m_Lines, m_LineNumbers, m_pAnnot, &m_Errors);
+        }
+        catch (...) {
+            // rethrown by the reader when the batch is merged, so it
+            //  leaves ReadSeqAnnot() just like in single threaded parsing:
+            m_pException = std::current_exception();
+            m_uExceptionLine = m_pParser->m_uLineNumber;
+        }
+        // release the input as soon as possible
+        vector<string>().swap(m_Lines);
+        return eCompleted;
+    };
+
+    void Wait() { m_Done.Wait(); };
+    bool TryWait() { return m_Done.TryWait(); };
+
+    CRef<CSeq_annot> GetAnnot() { return m_pAnnot; };
+    CMessageListenerLenient& GetErrors() { return m_Errors; };
+    unsigned int GetDataCount() const { return m_uDataCount; };
+    bool HasException() const { return bool(m_pException); };
+    unsigned int GetExceptionLine() const { return m_uExceptionLine; };
+    void RethrowException() { std::rethrow_exception(m_pException); };
+
+protected:
+    virtual void OnStatusChange(EStatus)
+    {
+        if (IsFinished()) {
+            m_Done.Post();
+        }
+    };
+
+private:
+    // a batch is full at this many lines, or fewer if the lines are long
+    //  (many samples):
+    static const size_t kMaxLines = 1000;
+    static const size_t kMaxSize = 4*1024*1024;
+
+    AutoPtr<CVcfReader> m_pParser;
+    vector<string> m_Lines;
+    vector<unsigned int> m_LineNumbers;
+    CRef<CSeq_annot> m_pAnnot;
+    CMessageListenerLenient m_Errors;
+    CSemaphore m_Done;
+    size_t m_uSize;
+    unsigned int m_uDataCount;
+    std::exception_ptr m_pException;
+    unsigned int m_uExceptionLine;
+};
+
 //  ----------------------------------------------------------------------------
 ESpecType SpecType( 
     const string& spectype )
@@ -170,7 +257,10 @@ ESpecNumber SpecNumber(
 CVcfReader::CVcfReader(
     int flags ):
     CReaderBase(flags),
-    m_MetaHandled(false)
+    m_MetaHandled(false),
+    m_FormatColumnar(false),
+    m_Threads(1),
+    m_pThreadPool(0)
 //  ----------------------------------------------------------------------------
 {
 }
@@ -180,6 +270,30 @@ CVcfReader::CVcfReader(
 CVcfReader::~CVcfReader()
 //  ----------------------------------------------------------------------------
 {
+    xDiscardBatches();
+    delete m_pThreadPool;
+}
+
+//  ----------------------------------------------------------------------------
+void
+CVcfReader::SetThreads(
+    unsigned int threads )
+//  ----------------------------------------------------------------------------
+{
+    m_Threads = (threads ? threads : GetCpuCount());
+    if (m_Threads == 0) {
+        m_Threads = 1;
+    }
+}
+
+//  ----------------------------------------------------------------------------
+void
+CVcfReader::SetFormatFields(
+    const vector<string>& fields )
+//  ----------------------------------------------------------------------------
+{
+    m_FormatColumnar = true;
+    m_FormatFields = fields;
 }
 
 //  ----------------------------------------------------------------------------                
@@ -190,6 +304,7 @@ CVcfReader::ReadSeqAnnot(
 //  ----------------------------------------------------------------------------                
 {
     xProgressInit(lr);
+    xDiscardBatches(); // left over if the last call threw
     if (lr.AtEOF()) {
         return CRef<CSeq_annot>();
     }
@@ -210,10 +325,18 @@ CVcfReader::ReadSeqAnnot(
                 0,
                 "Reader stopped by user.",
                 ILineError::eProblem_ProgressInfo));
+            xDiscardBatches();
             ProcessError(*pErr, pEC);
             return CRef<CSeq_annot>();
         }
         xReportProgress(pEC);
+        if (m_Threads > 1  &&  xIsDataLine(line)) {
+            dataCount += xBatchDataLine(line, annot, pEC);
+            continue;
+        }
+        // anything else may change the parsing context, and its messages
+        //  must come after those of the preceding data lines:
+        dataCount += xFlushBatches(annot, pEC);
         if (xIsTrackLine(line)  &&  dataCount) {
             xUngetLine(lr);
             break;
@@ -243,11 +366,185 @@ CVcfReader::ReadSeqAnnot(
             ILineError::eProblem_GeneralParsingError) );
         ProcessWarning(*pErr, pEC);
     }
+    xFlushBatches(annot, pEC);
     xAssignTrackData(annot);
     xAssignVcfMeta(annot, pEC);
     return annot;
 }
 
+//  ----------------------------------------------------------------------------
+bool
+CVcfReader::xIsDataLine(
+    const string& line)
+//  ----------------------------------------------------------------------------
+{
+    return !NStr::StartsWith(line, "#")  &&
+        !NStr::StartsWith(line, "browser")  &&
+        !xIsTrackLine(line);
+}
+
+//  ----------------------------------------------------------------------------
+CVcfReader*
+CVcfReader::xCreateBatchParser() const
+//  ----------------------------------------------------------------------------
+{
+    CVcfReader* pParser = new CVcfReader(m_iFlags);
+    pParser->m_InfoSpecs = m_InfoSpecs;
+    pParser->m_FormatSpecs = m_FormatSpecs;
+    pParser->m_FilterSpecs = m_FilterSpecs;
+    pParser->m_GenotypeHeaders = m_GenotypeHeaders;
+    pParser->m_FormatColumnar = m_FormatColumnar;
+    pParser->m_FormatFields = m_FormatFields;
+    return pParser;
+}
+
+//  ----------------------------------------------------------------------------
+unsigned int
+CVcfReader::xBatchDataLine(
+    const string& line,
+    CRef<CSeq_annot> pAnnot,
+    ILineErrorListener* pEC)
+//  ----------------------------------------------------------------------------
+{
+    //
+    //  Every batch gets a parser of its own, with a copy of the header
+    //  information, so the threads share nothing with this reader:
+    //
+    if (!m_pBatch) {
+        m_pBatch.Reset(new CVcfParseTask(xCreateBatchParser()));
+    }
+    m_pBatch->AddLine(line, m_uLineNumber);
+    if (!m_pBatch->IsFull()) {
+        return 0;
+    }
+    // keep all threads busy while the oldest batch is merged
+    unsigned int dataCount = xCollectBatches(2*m_Threads - 1, pAnnot, pEC);
+    xSubmitBatch();
+    return dataCount;
+}
+
+//  ----------------------------------------------------------------------------
+void
+CVcfReader::xSubmitBatch()
+//  ----------------------------------------------------------------------------
+{
+    if (!m_pThreadPool) {
+        m_pThreadPool = new CThreadPool(2*m_Threads, m_Threads, m_Threads);
+    }
+    m_pThreadPool->AddTask(m_pBatch.GetPointer());
+    m_PendingBatches.push_back(m_pBatch);
+    m_pBatch.Reset();
+}
+
+//  ----------------------------------------------------------------------------
+unsigned int
+CVcfReader::xProcessDataBatch(
+    const vector<string>& lines,
+    const vector<unsigned int>& lineNumbers,
+    CRef<CSeq_annot> pAnnot,
+    ILineErrorListener* pEC)
+//  ----------------------------------------------------------------------------
+{
+    //
+    //  Runs on a parser thread, on a parser made by xCreateBatchParser().
+    //  pEC is a private lenient listener, so the messages are kept for the
+    //  reader. Anything thrown stops the batch at the current line.
+    //
+    unsigned int dataCount = 0;
+    for (size_t u = 0; u < lines.size(); ++u) {
+        m_uLineNumber = lineNumbers[u];
+        if (xProcessDataLine(lines[u], pAnnot, pEC)) {
+            ++dataCount;
+            continue;
+        }
+        AutoPtr<CObjReaderLineException> pErr(
+            CObjReaderLineException::Create(
+            eDiag_Warning,
+            0,
+            "CVcfReader::ReadSeqAnnot: Unrecognized line or record type.",
+            ILineError::eProblem_GeneralParsingError) );
+        ProcessWarning(*pErr, pEC);
+    }
+    return dataCount;
+}
+
+//  ----------------------------------------------------------------------------
+unsigned int
+CVcfReader::xCollectBatches(
+    size_t maxPending,
+    CRef<CSeq_annot> pAnnot,
+    ILineErrorListener* pEC)
+//  ----------------------------------------------------------------------------
+{
+    unsigned int dataCount = 0;
+    while (!m_PendingBatches.empty()) {
+        CRef<CVcfParseTask> pBatch = m_PendingBatches.front();
+        if (m_PendingBatches.size() > maxPending) {
+            pBatch->Wait();
+        }
+        else if (!pBatch->TryWait()) {
+            break;
+        }
+        m_PendingBatches.pop_front();
+
+        //  pass the batch messages on as if they came from this reader:
+        unsigned int currentLine = m_uLineNumber;
+        CMessageListenerLenient& errors = pBatch->GetErrors();
+        for (size_t u = 0; u < errors.Count(); ++u) {
+            // the batch parsers only report CObjReaderLineException's
+            const ILineError& error = errors.GetError(u);
+            AutoPtr<CObjReaderLineException> pErr(
+                static_cast<CObjReaderLineException*>(error.Clone()));
+            m_uLineNumber = error.Line();
+            if (pErr->Severity() <= eDiag_Warning) {
+                ProcessWarning(*pErr, pEC);
+            }
+            else {
+                ProcessError(*pErr, pEC);
+            }
+        }
+        if (pBatch->HasException()) {
+            // the batches after this one are dropped by xDiscardBatches()
+            m_uLineNumber = pBatch->GetExceptionLine();
+            pBatch->RethrowException();
+        }
+        m_uLineNumber = currentLine;
+
+        pAnnot->SetData().SetFtable().splice(
+            pAnnot->SetData().SetFtable().end(),
+            pBatch->GetAnnot()->SetData().SetFtable());
+        dataCount += pBatch->GetDataCount();
+    }
+    return dataCount;
+}
+
+//  ----------------------------------------------------------------------------
+unsigned int
+CVcfReader::xFlushBatches(
+    CRef<CSeq_annot> pAnnot,
+    ILineErrorListener* pEC)
+//  ----------------------------------------------------------------------------
+{
+    if (m_pBatch) {
+        xSubmitBatch();
+    }
+    return xCollectBatches(0, pAnnot, pEC);
+}
+
+//  ----------------------------------------------------------------------------
+void
+CVcfReader::xDiscardBatches()
+//  ----------------------------------------------------------------------------
+{
+    // batches cannot be taken back from the threads, so wait for them
+    m_pBatch.Reset();
+    while (!m_PendingBatches.empty()) {
+        m_PendingBatches.front()->RequestToCancel();
+        m_PendingBatches.front()->Wait();
+        m_PendingBatches.pop_front();
+    }
+}
+
 //  ----------------------------------------------------------------------------                
 CRef< CSerialObject >
 CVcfReader::ReadObject(
@@ -834,14 +1131,17 @@ CVcfReader::xParseData(
     ILineErrorListener* pEC)
 //  ----------------------------------------------------------------------------
 {
-    vector<string> columns;
-    NStr::Split( line, "\t", columns, NStr::eMergeDelims );
+    //
+    //  The columns are views into data.m_strLine. With many samples, most of
+    //  the line is genotype data, which is left alone until xProcessFormat().
+    //
+    data.m_strLine = line;
+    vector<CTempString> columns;
+    NStr::Split( data.m_strLine, "\t", columns, NStr::eMergeDelims );
     if ( columns.size() < 8 ) {
         return false;
     }
     try {
-        data.m_strLine = line;
-
         data.m_strChrom = columns[0];
         data.m_iPos = NStr::StringToInt( columns[1] );
         NStr::Split( columns[2], ";", data.m_Ids, NStr::eNoMergeDelims );
@@ -869,12 +1169,7 @@ CVcfReader::xParseData(
         }
         if ( columns.size() > 8 ) {
             NStr::Split( columns[8], ":", data.m_FormatKeys, NStr::eMergeDelims );
-
-            for ( size_t u=9; u < columns.size(); ++u ) {
-                vector<string> values;
-                NStr::Split( columns[u], ":", values, NStr::eMergeDelims );
-                data.m_GenotypeData[ m_GenotypeHeaders[u-9] ] = values;
-            }
+            data.m_Samples.assign( columns.begin() + 9, columns.end() );
         }
     }
     catch ( ... ) {
@@ -1215,6 +1510,15 @@ CVcfReader::xProcessFormat(
     if (data.m_FormatKeys.empty()) {
         return true;
     }
+    if (m_FormatColumnar) {
+        return xProcessFormatColumns(data, pFeature);
+    }
+
+    for ( size_t u=0; u < data.m_Samples.size(); ++u ) {
+        vector<string> values;
+        NStr::Split( data.m_Samples[u], ":", values, NStr::eMergeDelims );
+        data.m_GenotypeData[ m_GenotypeHeaders[u] ] = values;
+    }
 
     CSeq_feat::TExt& ext = pFeature->SetExt();
     ext.AddField("format", data.m_FormatKeys);
@@ -1230,6 +1534,72 @@ CVcfReader::xProcessFormat(
     return true;
 }
 
+//  ----------------------------------------------------------------------------
+static CTempString
+s_GetSampleField(
+    const CTempString& sample,
+    size_t index )
+//  ----------------------------------------------------------------------------
+{
+    size_t start = 0;
+    for ( ; index > 0; --index) {
+        start = sample.find(':', start);
+        if (start == NPOS) {
+            return ".";
+        }
+        ++start;
+    }
+    size_t end = sample.find(':', start);
+    if (end == NPOS) {
+        end = sample.size();
+    }
+    if (start == end) {
+        return ".";
+    }
+    return sample.substr(start, end - start);
+}
+
+//  ----------------------------------------------------------------------------
+bool
+CVcfReader::xProcessFormatColumns(
+    CVcfData& data,
+    CRef<CSeq_feat> pFeature )
+//  ----------------------------------------------------------------------------
+{
+    //
+    //  Only the requested fields are looked at, one field for all samples at
+    //  a time. Fields are located by their position in the FORMAT column,
+    //  so the sample columns are not split up.
+    //
+    vector<string> keys;
+    CRef<CUser_field> pGenotypeColumns( new CUser_field );
+    pGenotypeColumns->SetLabel().SetStr("genotype-columns");
+
+    for ( vector<string>::const_iterator cit = m_FormatFields.begin();
+            cit != m_FormatFields.end(); ++cit) {
+        vector<string>::const_iterator keyIt = find(
+            data.m_FormatKeys.begin(), data.m_FormatKeys.end(), *cit);
+        if (keyIt == data.m_FormatKeys.end()) {
+            continue;
+        }
+        size_t index = keyIt - data.m_FormatKeys.begin();
+        vector<string> values;
+        values.reserve(data.m_Samples.size());
+        for ( size_t u=0; u < data.m_Samples.size(); ++u ) {
+            values.push_back(s_GetSampleField(data.m_Samples[u], index));
+        }
+        pGenotypeColumns->AddField(*cit, values);
+        keys.push_back(*cit);
+    }
+    if (keys.empty()) {
+        return true;
+    }
+    CSeq_feat::TExt& ext = pFeature->SetExt();
+    ext.AddField("format", keys);
+    ext.SetData().push_back(pGenotypeColumns);
+    return true;
+}
+
 //  ----------------------------------------------------------------------------
 bool
 CVcfReader::xAssignVariationIds(
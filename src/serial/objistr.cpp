@@ -33,6 +33,7 @@
 
 #include <ncbi_pch.hpp>
 #include <corelib/ncbistd.hpp>
+#include <corelib/ncbifile.hpp>
 #include <corelib/ncbi_safe_static.hpp>
 #include <corelib/ncbiutil.hpp>
 #include <corelib/ncbimtx.hpp>
@@ -194,6 +195,14 @@ CObjectIStream* CObjectIStream::Open(ESerialDataFormat format,
                                      const string& fileName,
                                      TSerialOpenFlags openFlags)
 {
+    if ( (openFlags & eSerial_UseMemoryMap) &&
+         !((openFlags & eSerial_StdWhenEmpty) && fileName.empty()) &&
+         !((openFlags & eSerial_StdWhenDash) && fileName == "-") &&
+         !((openFlags & eSerial_StdWhenStd) && fileName == "stdin") ) {
+        AutoPtr<CObjectIStream> stream(Create(format));
+        stream->OpenFromMemoryFile(fileName);
+        return stream.release();
+    }
     CRef<CByteSource> src = GetSource(format, fileName, openFlags);
     return Create(format, *src);
 }
@@ -483,6 +492,28 @@ void CObjectIStream::OpenFromBuffer(const char* buffer, size_t size)
     m_Fail = 0;
 }
 
+void CObjectIStream::OpenFromMemoryFile(const string& fileName)
+{
+    Int8 length = CFile(fileName).GetLength();
+    if ( length < 0 ) {
+        NCBI_THROW(CSerialException,eNotOpen,
+                   "cannot open file: " + fileName);
+    }
+    AutoPtr<CMemoryFile> mem_file;
+    const char* data = "";
+    size_t size = 0;
+    if ( length > 0 ) {
+        // empty files cannot be mapped
+        mem_file.reset(new CMemoryFile(fileName));
+        size = mem_file->GetSize();
+        data = static_cast<const char*>(mem_file->Map(0, size));
+        mem_file->MemMapAdvise(CMemoryFile::eMMA_Sequential);
+    }
+    // OpenFromBuffer() calls Close(), which releases the previous mapping
+    OpenFromBuffer(data, size);
+    m_MemoryFile = mem_file;
+}
+
 void CObjectIStream::Open(CByteSource& source)
 {
     CRef<CByteSourceReader> reader = source.Open();
@@ -516,6 +547,7 @@ void CObjectIStream::Close(void)
 {
     if (m_Fail != fNotOpen) {
         m_Input.Close();
+        m_MemoryFile.reset();
         if ( m_Objects )
             m_Objects->Clear();
         ClearStack();
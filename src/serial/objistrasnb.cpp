@@ -727,6 +727,12 @@ namespace {
         REPLACE_BAD_CHARS_METHOD(it, fix_method);
     }
 
+    bool HaveBadVisibleChars(const char* ptr, size_t count)
+    {
+        FIND_BAD_CHAR(ptr);
+        return true;
+    }
+
     inline
     bool FixVisibleChars(char* ptr, size_t count, EFixNonPrint fix_method)
     {
@@ -784,6 +790,43 @@ void CObjectIStreamAsnBinary::ReadString(string& s, EStringType type)
                     type == eStringTypeVisible? x_FixCharsMethod(): eFNP_Allow);
 }
 
+CTempString CObjectIStreamAsnBinary::x_ReadBytesView(size_t length)
+{
+    if ( m_Input.IsMemoryBuffer() ) {
+        // the whole input is in memory -> point directly into it
+        const char* data = m_Input.GetCurrentPos();
+        SkipBytes(length);
+        return CTempString(data, length);
+    }
+    ReadBytes(m_ViewBuffer, length);
+    return m_ViewBuffer;
+}
+
+CTempString CObjectIStreamAsnBinary::ReadStringView(EStringType type)
+{
+    ExpectStringTag(type);
+    CTempString value = x_ReadBytesView(ReadLength());
+    EndOfTag();
+    EFixNonPrint fix_method =
+        type == eStringTypeVisible? x_FixCharsMethod(): eFNP_Allow;
+    if ( fix_method != eFNP_Allow &&
+         HaveBadVisibleChars(value.data(), value.size()) ) {
+        string fixed(value.data(), value.size());
+        FixVisibleChars(fixed, fix_method);
+        m_ViewBuffer.swap(fixed);
+        value = m_ViewBuffer;
+    }
+    return value;
+}
+
+CTempString CObjectIStreamAsnBinary::ReadOctetStringView(void)
+{
+    ExpectSysTag(eOctetString);
+    CTempString value = x_ReadBytesView(ReadLength());
+    EndOfTag();
+    return value;
+}
+
 
 void CObjectIStreamAsnBinary::ReadStringStore(string& s)
 {
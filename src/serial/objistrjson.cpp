@@ -36,10 +36,87 @@
 
 #include <serial/objistrjson.hpp>
 
+// SSE2 is present on every x86-64 CPU, so no run time check is needed
+#if defined(__SSE2__)  &&  defined(__GNUC__)
+#  define JSON_SSE2 1
+#  include <emmintrin.h>
+#endif
+
 #define NCBI_USE_ERRCODE_X   Serial_OStream
 
 BEGIN_NCBI_SCOPE
 
+
+// Length of the run of chars at the beginning of [pos, end), which
+// can be copied into a string value as is: anything but quote,
+// backslash, control chars and, unless copy_8bit is set, non-ASCII chars.
+static inline
+size_t s_ScanStringChars(const char* pos, const char* end, bool copy_8bit)
+{
+    const char* start = pos;
+#ifdef JSON_SSE2
+    const __m128i quote = _mm_set1_epi8('\"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i max_control = _mm_set1_epi8(0x1F);
+    const __m128i min_plain = _mm_set1_epi8(0x20);
+    while ( end - pos >= 16 ) {
+        __m128i v = _mm_loadu_si128((const __m128i*)pos);
+        __m128i special = _mm_or_si128(_mm_cmpeq_epi8(v, quote),
+                                       _mm_cmpeq_epi8(v, backslash));
+        if ( copy_8bit ) {
+            // unsigned v <= 0x1F
+            special = _mm_or_si128(special,
+                _mm_cmpeq_epi8(_mm_min_epu8(v, max_control), v));
+        }
+        else {
+            // signed v < 0x20 is either control or non-ASCII char
+            special = _mm_or_si128(special, _mm_cmplt_epi8(v, min_plain));
+        }
+        unsigned mask = _mm_movemask_epi8(special);
+        if ( mask ) {
+            return pos - start + __builtin_ctz(mask);
+        }
+        pos += 16;
+    }
+#endif
+    for ( ; pos < end; ++pos ) {
+        unsigned char c = *pos;
+        if ( c == '\"' || c == '\\' || c < 0x20 ||
+             (c >= 0x80 && !copy_8bit) ) {
+            break;
+        }
+    }
+    return pos - start;
+}
+
+// Char which ends an unquoted value (number, true, false, null)
+static inline
+bool s_IsDataEnd(char c)
+{
+    switch ( c ) {
+    case ',': case ']': case '}': case ' ': case '\r': case '\n': case '\0':
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Length of the run of chars at the beginning of [pos, end), which
+// belong to an unquoted value and need no decoding.
+static inline
+size_t s_ScanDataChars(const char* pos, const char* end)
+{
+    const char* start = pos;
+    for ( ; pos < end; ++pos ) {
+        char c = *pos;
+        if ( s_IsDataEnd(c) || c == '\\' || (unsigned char)c >= 0x80 ) {
+            break;
+        }
+    }
+    return pos - start;
+}
+
+
 CObjectIStream* CObjectIStream::CreateObjectIStreamJson()
 {
     return new CObjectIStreamJson();
@@ -296,7 +373,24 @@ string CObjectIStreamJson::x_ReadString(EStringType type)
     m_ExpectValue = false;
     Expect('\"',true);
     string str;
+    EEncoding enc_out( type == eStringTypeUTF8 ? eEncoding_UTF8 : m_StringEncoding);
+    bool copy_8bit = enc_out == eEncoding_UTF8 || enc_out == eEncoding_Unknown;
     for (;;) {
+        if ( m_Utf8Buf.empty() ) {
+            // copy chars, which need no decoding, directly from the buffer
+            size_t avail = m_Input.PeekAvailable();
+            const char* pos = m_Input.GetCurrentPos();
+            size_t count = s_ScanStringChars(pos, pos + avail, copy_8bit);
+            str.append(pos, count);
+            if ( count < avail && pos[count] == '\"' ) {
+                m_Input.SkipChars(count + 1);
+                break;
+            }
+            if ( count ) {
+                m_Input.SkipChars(count);
+                continue;
+            }
+        }
         bool encoded = false;
         char c = ReadEncodedChar(type, encoded);
         if (!encoded) {
@@ -321,6 +415,19 @@ string CObjectIStreamJson::x_ReadData(EStringType type /*= eStringTypeVisible*/)
     SkipWhiteSpace();
     string str;
     for (;;) {
+        if ( m_Utf8Buf.empty() ) {
+            size_t avail = m_Input.PeekAvailable();
+            const char* pos = m_Input.GetCurrentPos();
+            size_t count = s_ScanDataChars(pos, pos + avail);
+            str.append(pos, count);
+            m_Input.SkipChars(count);
+            if ( count < avail && s_IsDataEnd(pos[count]) ) {
+                break;
+            }
+            if ( count ) {
+                continue;
+            }
+        }
         bool encoded = false;
         char c = ReadEncodedChar(type, encoded);
         if (!encoded && strchr(",]} \r\n", c)) {
@@ -351,6 +458,16 @@ void  CObjectIStreamJson::x_SkipData(void)
     m_ExpectValue = false;
     char to = GetChar(true);
     for (;;) {
+        if ( m_Utf8Buf.empty() ) {
+            size_t count = m_Input.PeekAvailable();
+            const char* pos = m_Input.GetCurrentPos();
+            count = to == '\"' ? s_ScanStringChars(pos, pos + count, true)
+                               : s_ScanDataChars(pos, pos + count);
+            if ( count ) {
+                m_Input.SkipChars(count);
+                continue;
+            }
+        }
         bool encoded = false;
         char c = ReadEncodedChar(eStringTypeUTF8, encoded);
         if (!encoded) {
@@ -32,6 +32,10 @@
 
 #include <ncbi_pch.hpp>
 #include "test_serial.hpp"
+#include <serial/objistrasnb.hpp>
+#ifndef HAVE_NCBI_C
+# include <serial/test/Query_History.hpp>
+#endif
 
 #ifndef HAVE_NCBI_C
 
@@ -103,6 +107,89 @@ BOOST_AUTO_TEST_CASE(s_TestAsnSerialization)
         BOOST_CHECK( CFile( bin_in).Compare( bin_out) );
     }
 }
+
+BOOST_AUTO_TEST_CASE(s_TestMemoryMappedInput)
+{
+    string bin_in("webenv.bin"), str_out("memmap.bino");
+    {
+        CRef<CWeb_Env> env(new CWeb_Env), env_mapped(new CWeb_Env);
+        {
+            // read ASN binary from a stream
+            auto_ptr<CObjectIStream> in(
+                CObjectIStream::Open(bin_in,eSerial_AsnBinary));
+            *in >> *env;
+        }
+        {
+            // read ASN binary in place from the memory mapped file
+            auto_ptr<CObjectIStream> in(
+                CObjectIStream::Open(eSerial_AsnBinary, bin_in,
+                                     eSerial_UseMemoryMap));
+            *in >> *env_mapped;
+            BOOST_CHECK( in->EndOfData() );
+        }
+        BOOST_CHECK( SerialEquals<CWeb_Env>(*env, *env_mapped) );
+    }
+    {
+        const string value("memory mapped value");
+        {
+            auto_ptr<CObjectOStream> out(
+                CObjectOStream::Open(str_out,eSerial_AsnBinary));
+            out->WriteStd(value);
+            out->WriteStd(value);
+        }
+        // views refer to the mapped data and stay valid until Close()
+        auto_ptr<CObjectIStream> in(
+            CObjectIStream::Open(eSerial_AsnBinary, str_out,
+                                 eSerial_UseMemoryMap));
+        CObjectIStreamAsnBinary& asnb_in =
+            dynamic_cast<CObjectIStreamAsnBinary&>(*in);
+        CTempString view1 = asnb_in.ReadStringView();
+        CTempString view2 = asnb_in.ReadStringView();
+        BOOST_CHECK_EQUAL( string(view1), value );
+        BOOST_CHECK_EQUAL( string(view2), value );
+        BOOST_CHECK( view1.data() != view2.data() );
+        BOOST_CHECK( in->EndOfData() );
+    }
+}
+
+#if defined(NCBI_THREADS)
+BOOST_AUTO_TEST_CASE(s_TestContainerAsyncIterator)
+{
+    CRef<CWeb_Env> env(new CWeb_Env);
+    {
+        auto_ptr<CObjectIStream> in(
+            CObjectIStream::Open("webenv.bin",eSerial_AsnBinary));
+        *in >> *env;
+    }
+    BOOST_REQUIRE( env->IsSetQueries() );
+    const CWeb_Env::TQueries& queries = env->GetQueries();
+
+    const pair<string, ESerialDataFormat> inputs[] = {
+        make_pair("webenv.bin", eSerial_AsnBinary),
+        make_pair("webenv.ent", eSerial_AsnText)
+    };
+    for (const auto& input : inputs) {
+        auto_ptr<CObjectIStream> in(
+            CObjectIStream::Open(input.first, input.second));
+        // one element per parsing task
+        CObjectIStreamContainerAsyncIterator<CWeb_Env, CQuery_History> it(
+            *in, "queries", eNoOwnership,
+            CObjectIStreamAsyncIterator<>::CParams().MinRawBufferSize(1));
+        CWeb_Env::TQueries::const_iterator expected = queries.begin();
+        for (CQuery_History& query : it) {
+            BOOST_REQUIRE( expected != queries.end() );
+            BOOST_CHECK( SerialEquals<CQuery_History>(**expected, query) );
+            ++expected;
+        }
+        BOOST_CHECK( expected == queries.end() );
+        // the rest of the top-level object is read as usual
+        const CWeb_Env& root = it.GetRoot();
+        BOOST_CHECK( !root.IsSetQueries() || root.GetQueries().empty() );
+        BOOST_CHECK_EQUAL( root.IsSetArguments(), env->IsSetArguments() );
+        BOOST_CHECK_EQUAL( root.IsSetDb_Env(), env->IsSetDb_Env() );
+    }
+}
+#endif
 #endif
 
 /////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,622 @@
+/*  $Id$
+ * ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ *
+ * File Description:  BGZF (blocked gzip) format support
+ *
+ * NOTE: The BGZF format is described in the SAM/BAM format specification:
+ *       https://samtools.github.io/hts-specs/SAMv1.pdf
+ */
+
+#include <ncbi_pch.hpp>
+#include <util/compress/bgzf.hpp>
+#include <util/error_codes.hpp>
+#include <zlib.h>
+#include <algorithm>
+
+
+#define NCBI_USE_ERRCODE_X   Util_Compress
+
+BEGIN_NCBI_SCOPE
+
+
+// Get compression stream pointer
+#define STREAM ((z_stream*)m_Stream)
+
+
+// Maximum size of uncompressed data in a block. It is a bit less than
+// 64KB, so even incompressible data fit into a 64KB compressed block.
+const size_t kMaxDataSize   = 0xff00;
+// Maximum size of a compressed block
+const size_t kMaxBlockSize  = 0x10000;
+// Block header: gzip header with "BC" extra subfield holding BSIZE
+const size_t kHeaderSize    = 18;
+// Block footer: CRC32 and ISIZE
+const size_t kFooterSize    = 8;
+
+// Empty block written at the end of file
+const unsigned char kEOFBlock[28] = {
+    0x1f, 0x8b, 0x08, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff,
+    0x06, 0x00, 0x42, 0x43, 0x02, 0x00, 0x1b, 0x00, 0x03, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+
+
+static void s_StoreUI8(char* buf, Uint8 value)
+{
+    for (int i = 0;  i < 8;  ++i) {
+        buf[i] = char(value & 0xff);
+        value >>= 8;
+    }
+}
+
+static Uint8 s_GetUI8(const char* buf)
+{
+    Uint8 value = 0;
+    for (int i = 7;  i >= 0;  --i) {
+        value = (value << 8) | (unsigned char)buf[i];
+    }
+    return value;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// CBGZFIndex
+//
+
+void CBGZFIndex::AddBlock(TPosition raw_pos, TPosition data_pos)
+{
+    SBlock block;
+    block.raw_pos  = raw_pos;
+    block.data_pos = data_pos;
+    m_Blocks.push_back(block);
+}
+
+
+CBGZFIndex::SBlock CBGZFIndex::FindBlock(TPosition data_pos) const
+{
+    // Last block starting at or before 'data_pos'
+    size_t lo = 0, hi = m_Blocks.size();
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (m_Blocks[mid].data_pos <= data_pos) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if ( !lo ) {
+        SBlock block;
+        block.raw_pos  = 0;
+        block.data_pos = 0;
+        return block;
+    }
+    return m_Blocks[lo - 1];
+}
+
+
+CBGZFIndex::TVirtualPos CBGZFIndex::GetVirtualPos(TPosition data_pos) const
+{
+    SBlock block = FindBlock(data_pos);
+    return (block.raw_pos << 16) | (data_pos - block.data_pos);
+}
+
+
+CBGZFIndex::TPosition CBGZFIndex::GetDataPos(TVirtualPos virtual_pos) const
+{
+    TPosition raw_pos = virtual_pos >> 16;
+    TPosition offset  = virtual_pos & 0xffff;
+    if ( m_Blocks.empty()  &&  !raw_pos ) {
+        return offset;
+    }
+    size_t lo = 0, hi = m_Blocks.size();
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (m_Blocks[mid].raw_pos < raw_pos) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if ( lo == m_Blocks.size()  ||  m_Blocks[lo].raw_pos != raw_pos ) {
+        NCBI_THROW(CCompressionException, eCompression,
+                   "CBGZFIndex::GetDataPos(): no block at position " +
+                   NStr::UInt8ToString(raw_pos));
+    }
+    return m_Blocks[lo].data_pos + offset;
+}
+
+
+void CBGZFIndex::Write(CNcbiOstream& os) const
+{
+    char buf[16];
+    // The first block always starts at zero and is not stored
+    size_t first = (!m_Blocks.empty()  &&  !m_Blocks[0].raw_pos) ? 1 : 0;
+    s_StoreUI8(buf, m_Blocks.size() - first);
+    os.write(buf, 8);
+    for (size_t i = first;  i < m_Blocks.size();  ++i) {
+        s_StoreUI8(buf,     m_Blocks[i].raw_pos);
+        s_StoreUI8(buf + 8, m_Blocks[i].data_pos);
+        os.write(buf, 16);
+    }
+    if ( !os ) {
+        NCBI_THROW(CCompressionException, eCompression,
+                   "CBGZFIndex::Write(): cannot write index");
+    }
+}
+
+
+void CBGZFIndex::Read(CNcbiIstream& is)
+{
+    char buf[16];
+    m_Blocks.clear();
+    if ( !is.read(buf, 8) ) {
+        NCBI_THROW(CCompressionException, eCompression,
+                   "CBGZFIndex::Read(): cannot read index");
+    }
+    Uint8 n = s_GetUI8(buf);
+    AddBlock(0, 0);
+    for (Uint8 i = 0;  i < n;  ++i) {
+        if ( !is.read(buf, 16) ) {
+            NCBI_THROW(CCompressionException, eCompression,
+                       "CBGZFIndex::Read(): index is truncated");
+        }
+        AddBlock(s_GetUI8(buf), s_GetUI8(buf + 8));
+    }
+}
+
+
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// CBGZFCompressor
+//
+
+CBGZFCompressor::CBGZFCompressor(ELevel level, TZipFlags flags)
+    : CZipCompression(level),
+      m_OutputPos(0), m_RawPos(0), m_DataPos(0), m_Finished(false)
+{
+    SetFlags(flags);
+}
+
+
+CBGZFCompressor::~CBGZFCompressor()
+{
+}
+
+
+CCompressionProcessor::EStatus CBGZFCompressor::Init(void)
+{
+    if ( IsBusy() ) {
+        // Abnormal previous session termination
+        End();
+    }
+    // Initialize members
+    Reset();
+    SetBusy();
+
+    m_Block.erase();
+    m_Output.erase();
+    m_OutputPos = 0;
+    m_RawPos    = 0;
+    m_DataPos   = 0;
+    m_Finished  = false;
+    m_Index.Clear();
+
+    // Initialize the compressor stream structure.
+    // Each block is a raw deflate stream with gzip header/footer added.
+    memset(STREAM, 0, sizeof(z_stream));
+    int errcode = deflateInit2_(STREAM, GetLevel(), Z_DEFLATED,
+                                -MAX_WBITS, m_MemLevel, m_Strategy,
+                                ZLIB_VERSION, (int)sizeof(z_stream));
+    SetError(errcode, zError(errcode));
+    if ( errcode == Z_OK ) {
+        return eStatus_Success;
+    }
+    ERR_COMPRESS(97, FormatErrorMessage("CBGZFCompressor::Init", GetProcessedSize()));
+    return eStatus_Error;
+}
+
+
+CCompressionProcessor::EStatus CBGZFCompressor::Process(
+                      const char* in_buf,  size_t  in_len,
+                      char*       out_buf, size_t  out_size,
+                      /* out */            size_t* in_avail,
+                      /* out */            size_t* out_avail)
+{
+    *in_avail  = in_len;
+    *out_avail = x_CopyOutput(out_buf, out_size);
+
+    while ( *in_avail ) {
+        if ( m_OutputPos < m_Output.size() ) {
+            // The output buffer is full, let the caller write it out
+            break;
+        }
+        size_t n = min(*in_avail, kMaxDataSize - m_Block.size());
+        m_Block.append(in_buf + in_len - *in_avail, n);
+        *in_avail -= n;
+        IncreaseProcessedSize((unsigned long)n);
+
+        if ( m_Block.size() == kMaxDataSize ) {
+            if ( !x_CompressBlock() ) {
+                return eStatus_Error;
+            }
+            *out_avail += x_CopyOutput(out_buf + *out_avail,
+                                       out_size - *out_avail);
+        }
+    }
+    return eStatus_Success;
+}
+
+
+CCompressionProcessor::EStatus CBGZFCompressor::Flush(
+                      char* out_buf, size_t  out_size,
+                      /* out */      size_t* out_avail)
+{
+    if ( !x_CompressBlock() ) {
+        return eStatus_Error;
+    }
+    *out_avail = x_CopyOutput(out_buf, out_size);
+    if ( m_OutputPos < m_Output.size() ) {
+        return eStatus_Overflow;
+    }
+    return eStatus_Success;
+}
+
+
+CCompressionProcessor::EStatus CBGZFCompressor::Finish(
+                      char* out_buf, size_t  out_size,
+                      /* out */      size_t* out_avail)
+{
+    *out_avail = 0;
+
+    // The end-of-file block is written even for empty data, like "bgzip"
+    // does, so the output is always a valid BGZF file
+    if ( !m_Finished ) {
+        if ( !x_CompressBlock() ) {
+            return eStatus_Error;
+        }
+        m_Output.append((const char*)kEOFBlock, sizeof(kEOFBlock));
+        m_Index.AddBlock(m_RawPos, m_DataPos);
+        m_RawPos  += sizeof(kEOFBlock);
+        m_Finished = true;
+    }
+    *out_avail = x_CopyOutput(out_buf, out_size);
+    if ( m_OutputPos < m_Output.size() ) {
+        return eStatus_Overflow;
+    }
+    return eStatus_EndOfData;
+}
+
+
+CCompressionProcessor::EStatus CBGZFCompressor::End(int abandon)
+{
+    int errcode = deflateEnd(STREAM);
+    SetBusy(false);
+    if ( abandon ) {
+        // Ignore result of deflateEnd(), because it can return an error code
+        // for empty data
+        return eStatus_Success;
+    }
+    SetError(errcode, zError(errcode));
+    if ( errcode == Z_OK ) {
+        return eStatus_Success;
+    }
+    ERR_COMPRESS(98, FormatErrorMessage("CBGZFCompressor::End", GetProcessedSize()));
+    return eStatus_Error;
+}
+
+
+bool CBGZFCompressor::x_CompressBlock(void)
+{
+    if ( m_Block.empty() ) {
+        return true;
+    }
+    if ( m_OutputPos == m_Output.size() ) {
+        m_Output.erase();
+        m_OutputPos = 0;
+    }
+    size_t start = m_Output.size();
+    m_Output.resize(start + kMaxBlockSize);
+    unsigned char* block = (unsigned char*)&m_Output[start];
+
+    int errcode = deflateReset(STREAM);
+    if ( errcode == Z_OK ) {
+        STREAM->next_in   = (unsigned char*)const_cast<char*>(m_Block.data());
+        STREAM->avail_in  = (unsigned int)m_Block.size();
+        STREAM->next_out  = block + kHeaderSize;
+        STREAM->avail_out = (unsigned int)(kMaxBlockSize - kHeaderSize
+                                                         - kFooterSize);
+        errcode = deflate(STREAM, Z_FINISH);
+        if ( errcode == Z_STREAM_END ) {
+            errcode = Z_OK;
+        } else if ( errcode == Z_OK ) {
+            // Should never happen, data always fit into the block
+            errcode = Z_BUF_ERROR;
+        }
+    }
+    SetError(errcode, zError(errcode));
+    if ( errcode != Z_OK ) {
+        m_Output.resize(start);
+        ERR_COMPRESS(99, FormatErrorMessage("CBGZFCompressor::x_CompressBlock",
+                                            GetProcessedSize()));
+        return false;
+    }
+    size_t block_size = kHeaderSize + STREAM->total_out + kFooterSize;
+
+    // Header
+    memset(block, 0, kHeaderSize);
+    block[0]  = 0x1f;        // gzip magic
+    block[1]  = 0x8b;
+    block[2]  = Z_DEFLATED;  // CM
+    block[3]  = 0x04;        // FLG: FEXTRA
+    block[9]  = 0xff;        // OS: unknown
+    block[10] = 6;           // XLEN
+    block[12] = 'B';         // BGZF subfield
+    block[13] = 'C';
+    block[14] = 2;           // SLEN
+    CCompressionUtil::StoreUI2(block + 16, (unsigned long)(block_size - 1));
+
+    // Footer
+    unsigned long crc = crc32(0L, (unsigned char*)m_Block.data(),
+                              (unsigned int)m_Block.size());
+    unsigned char* footer = block + block_size - kFooterSize;
+    CCompressionUtil::StoreUI4(footer, crc);
+    CCompressionUtil::StoreUI4(footer + 4, (unsigned long)m_Block.size());
+
+    m_Output.resize(start + block_size);
+    m_Index.AddBlock(m_RawPos, m_DataPos);
+    m_RawPos  += block_size;
+    m_DataPos += m_Block.size();
+    m_Block.erase();
+    return true;
+}
+
+
+size_t CBGZFCompressor::x_CopyOutput(char* out_buf, size_t out_size)
+{
+    size_t n = min(m_Output.size() - m_OutputPos, out_size);
+    if ( n ) {
+        memcpy(out_buf, m_Output.data() + m_OutputPos, n);
+        m_OutputPos += n;
+        IncreaseOutputSize((unsigned long)n);
+    }
+    if ( m_OutputPos == m_Output.size() ) {
+        m_Output.erase();
+        m_OutputPos = 0;
+    }
+    return n;
+}
+
+
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// CBGZFReader
+//
+
+CBGZFReader::CBGZFReader(CNcbiIstream& is, const CBGZFIndex* index)
+    : m_Stream(is), m_RawPos(0), m_DataPos(0), m_RawSize(0),
+      m_HaveBlock(false)
+{
+    if ( index ) {
+        m_Index = *index;
+    } else {
+        x_BuildIndex();
+    }
+}
+
+
+CBGZFReader::~CBGZFReader()
+{
+}
+
+
+size_t CBGZFReader::Read(TPosition pos, void* buf, size_t count)
+{
+    // Position to the block containing 'pos', use cached block if possible
+    if ( !m_HaveBlock  ||  pos < m_DataPos ||
+         pos >= m_DataPos + m_Data.size() ) {
+        CBGZFIndex::SBlock block = m_Index.FindBlock(pos);
+        if ( !m_HaveBlock  ||  m_RawPos != block.raw_pos ) {
+            if ( !x_ReadBlock(block.raw_pos, block.data_pos) ) {
+                return 0;
+            }
+        }
+    }
+    char*  dst  = (char*)buf;
+    size_t done = 0;
+    while ( done < count ) {
+        TPosition end = m_DataPos + m_Data.size();
+        if ( pos >= end ) {
+            // Go to the next block
+            if ( !x_ReadBlock(m_RawPos + m_RawSize, end) ) {
+                break;
+            }
+            continue;
+        }
+        size_t offset = size_t(pos - m_DataPos);
+        size_t n = min(count - done, m_Data.size() - offset);
+        memcpy(dst + done, m_Data.data() + offset, n);
+        done += n;
+        pos  += n;
+    }
+    return done;
+}
+
+
+string CBGZFReader::ReadRange(TPosition from, TPosition to)
+{
+    string result;
+    if ( to <= from ) {
+        return result;
+    }
+    result.resize(size_t(to - from));
+    result.resize(Read(from, &result[0], result.size()));
+    return result;
+}
+
+
+size_t CBGZFReader::ReadVirtual(TVirtualPos pos, void* buf, size_t count)
+{
+    return Read(m_Index.GetDataPos(pos), buf, count);
+}
+
+
+size_t CBGZFReader::x_ReadHeader(TPosition raw_pos, size_t* header_size)
+{
+    unsigned char header[12];
+    m_Stream.clear();
+    if ( !m_Stream.seekg(NcbiInt8ToStreampos(raw_pos)) ) {
+        NCBI_THROW(CCompressionException, eCompression,
+                   "CBGZFReader: cannot seek to " +
+                   NStr::UInt8ToString(raw_pos));
+    }
+    m_Stream.read((char*)header, sizeof(header));
+    if ( m_Stream.gcount() == 0 ) {
+        // End of data
+        return 0;
+    }
+    string where = "CBGZFReader: block at " + NStr::UInt8ToString(raw_pos);
+    if ( m_Stream.gcount() != sizeof(header)  ||
+         header[0] != 0x1f  ||  header[1] != 0x8b  ||
+         header[2] != Z_DEFLATED  ||  (header[3] & 0x04) == 0 ) {
+        NCBI_THROW(CCompressionException, eCompression,
+                   where + ": bad gzip header");
+    }
+    // Find BSIZE in the extra field subfields
+    size_t xlen = CCompressionUtil::GetUI2(header + 10);
+    string extra(xlen, '\0');
+    if ( !xlen  ||  !m_Stream.read(&extra[0], xlen) ) {
+        NCBI_THROW(CCompressionException, eCompression,
+                   where + ": bad gzip extra field");
+    }
+    size_t block_size = 0;
+    for (size_t i = 0;  i + 4 <= xlen;  ) {
+        size_t slen = CCompressionUtil::GetUI2(extra.data() + i + 2);
+        if ( extra[i] == 'B'  &&  extra[i+1] == 'C'  &&  slen == 2  &&
+             i + 6 <= xlen ) {
+            block_size = CCompressionUtil::GetUI2(extra.data() + i + 4) + 1;
+            break;
+        }
+        i += 4 + slen;
+    }
+    *header_size = sizeof(header) + xlen;
+    if ( block_size <= *header_size + kFooterSize ) {
+        NCBI_THROW(CCompressionException, eCompression,
+                   where + ": not a BGZF block");
+    }
+    return block_size;
+}
+
+
+bool CBGZFReader::x_ReadBlock(TPosition raw_pos, TPosition data_pos)
+{
+    m_HaveBlock = false;
+    size_t header_size = 0;
+    size_t block_size  = x_ReadHeader(raw_pos, &header_size);
+    if ( !block_size ) {
+        return false;
+    }
+    string where = "CBGZFReader: block at " + NStr::UInt8ToString(raw_pos);
+
+    // Read compressed data and footer
+    size_t size = block_size - header_size;
+    m_RawBlock.resize(size);
+    if ( !m_Stream.read(&m_RawBlock[0], size) ) {
+        NCBI_THROW(CCompressionException, eCompression,
+                   where + ": block is truncated");
+    }
+    const char* footer = m_RawBlock.data() + size - kFooterSize;
+    Uint4 crc       = CCompressionUtil::GetUI4(footer);
+    Uint4 data_size = CCompressionUtil::GetUI4(footer + 4);
+    if ( data_size > kMaxBlockSize ) {
+        NCBI_THROW(CCompressionException, eCompression,
+                   where + ": bad uncompressed size");
+    }
+
+    // Decompress
+    m_Data.resize(data_size);
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    int errcode = inflateInit2(&stream, -MAX_WBITS);
+    if ( errcode == Z_OK ) {
+        char dummy;
+        stream.next_in   = (unsigned char*)const_cast<char*>(m_RawBlock.data());
+        stream.avail_in  = (unsigned int)(size - kFooterSize);
+        stream.next_out  = (unsigned char*)(data_size ? &m_Data[0] : &dummy);
+        stream.avail_out = data_size ? data_size : 1;
+        errcode = inflate(&stream, Z_FINISH);
+        if ( errcode == Z_STREAM_END  &&  stream.total_out == data_size ) {
+            errcode = Z_OK;
+        } else if ( errcode == Z_OK  ||  errcode == Z_STREAM_END ) {
+            errcode = Z_DATA_ERROR;
+        }
+        inflateEnd(&stream);
+    }
+    if ( errcode != Z_OK ) {
+        NCBI_THROW(CCompressionException, eCompression,
+                   where + ": " + zError(errcode));
+    }
+    if ( crc32(0L, (unsigned char*)m_Data.data(), data_size) != crc ) {
+        NCBI_THROW(CCompressionException, eCompression,
+                   where + ": CRC32 mismatch");
+    }
+    m_RawPos    = raw_pos;
+    m_DataPos   = data_pos;
+    m_RawSize   = block_size;
+    m_HaveBlock = true;
+    return true;
+}
+
+
+void CBGZFReader::x_BuildIndex(void)
+{
+    TPosition raw_pos  = 0;
+    TPosition data_pos = 0;
+    for (;;) {
+        size_t header_size = 0;
+        size_t block_size  = x_ReadHeader(raw_pos, &header_size);
+        if ( !block_size ) {
+            break;
+        }
+        // Get ISIZE from the block footer
+        char isize[4];
+        m_Stream.seekg(NcbiInt8ToStreampos(raw_pos + block_size - 4));
+        if ( !m_Stream.read(isize, sizeof(isize)) ) {
+            NCBI_THROW(CCompressionException, eCompression,
+                       "CBGZFReader: block at " +
+                       NStr::UInt8ToString(raw_pos) + " is truncated");
+        }
+        Uint4 data_size = CCompressionUtil::GetUI4(isize);
+        m_Index.AddBlock(raw_pos, data_pos);
+        raw_pos  += block_size;
+        data_pos += data_size;
+    }
+    m_Stream.clear();
+}
+
+
+END_NCBI_SCOPE
@@ -638,7 +638,8 @@ CCompressionProcessor::EStatus CBZip2Compressor::End(int abandon)
 
 CBZip2Decompressor::CBZip2Decompressor(int verbosity, int small_decompress,
                                        TBZip2Flags flags)
-    : CBZip2Compression(eLevel_Default, verbosity, 0, small_decompress)
+    : CBZip2Compression(eLevel_Default, verbosity, 0, small_decompress),
+      m_StreamEnd(false)
 {
     SetFlags(flags);
 }
@@ -654,6 +655,7 @@ CCompressionProcessor::EStatus CBZip2Decompressor::Init(void)
     // Initialize members
     Reset();
     SetBusy();
+    m_StreamEnd = false;
     // Initialize the decompressor stream structure
     memset(STREAM, 0, sizeof(bz_stream));
     // Create a compressor stream
@@ -721,9 +723,25 @@ CCompressionProcessor::EStatus CBZip2Decompressor::Process(
 
             switch (errcode) {
             case BZ_OK:
+                if ( in_len > *in_avail ) {
+                    m_StreamEnd = false;
+                }
                 return eStatus_Success;
             case BZ_STREAM_END:
-                return eStatus_EndOfData;
+                if ( !F_ISSET(fAllowConcatenatedStreams) ) {
+                    return eStatus_EndOfData;
+                }
+                // Restart decompressor for the next stream, if any
+                BZ2_bzDecompressEnd(STREAM);
+                memset(STREAM, 0, sizeof(bz_stream));
+                errcode = BZ2_bzDecompressInit(STREAM, m_Verbosity,
+                                               m_SmallDecompress);
+                SetError(errcode, GetBZip2ErrorDescription(errcode));
+                if ( errcode == BZ_OK ) {
+                    m_StreamEnd = true;
+                    return eStatus_Success;
+                }
+                break;
             }
             ERR_COMPRESS(32, FormatErrorMessage("CBZip2Decompressor::Process"));
             return eStatus_Error;
@@ -773,6 +791,10 @@ CCompressionProcessor::EStatus CBZip2Decompressor::Finish(
         default:
             ;
     }
+    if ( m_StreamEnd ) {
+        // No more concatenated streams
+        return eStatus_EndOfData;
+    }
     return eStatus_Success;
 }
 
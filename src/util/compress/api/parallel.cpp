@@ -0,0 +1,351 @@
+/*  $Id$
+ * ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ *
+ * File Description:  Multi-threaded block compression
+ *
+ */
+
+#include <ncbi_pch.hpp>
+#include <corelib/ncbi_system.hpp>
+#include <util/compress/parallel.hpp>
+#include <util/compress/zlib.hpp>
+#include <util/compress/bzip2.hpp>
+#include <util/thread_pool.hpp>
+#include <util/error_codes.hpp>
+
+
+#define NCBI_USE_ERRCODE_X   Util_Compress
+
+BEGIN_NCBI_SCOPE
+
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// CParallelCompressionTask -- compress one block
+//
+
+class CParallelCompressionTask : public CThreadPool_Task
+{
+public:
+    /// Take ownership of the block data (swap it out of 'data').
+    CParallelCompressionTask(CParallelCompressor::EMethod method,
+                             ICompression::ELevel         level,
+                             ICompression::TFlags         flags,
+                             string&                      data)
+        : m_Method(method), m_Level(level), m_Flags(flags),
+          m_Done(0, 1), m_ErrCode(0)
+    {
+        m_Data.swap(data);
+    }
+
+    virtual EStatus Execute(void);
+
+    /// Wait until the block is compressed, or the task is canceled.
+    void Wait(void)    { m_Done.Wait(); }
+    bool TryWait(void) { return m_Done.TryWait(); }
+
+    bool IsOkay(void) const             { return m_ErrCode == 0; }
+    int  GetErrorCode(void) const       { return m_ErrCode; }
+    const string& GetErrorDescription(void) const { return m_ErrMsg; }
+    const string& GetOutput(void) const { return m_Output; }
+
+protected:
+    virtual void OnStatusChange(EStatus /*old*/)
+    {
+        if ( IsFinished() ) {
+            m_Done.Post();
+        }
+    }
+
+private:
+    CParallelCompressor::EMethod m_Method;
+    ICompression::ELevel         m_Level;
+    ICompression::TFlags         m_Flags;
+    CSemaphore                   m_Done;
+    string                       m_Data;     ///< Uncompressed block.
+    string                       m_Output;   ///< Compressed block.
+    int                          m_ErrCode;
+    string                       m_ErrMsg;
+};
+
+
+CThreadPool_Task::EStatus CParallelCompressionTask::Execute(void)
+{
+    try {
+        auto_ptr<CCompression> cmp;
+        if ( m_Method == CParallelCompressor::eGZipFile ) {
+            cmp.reset(new CZipCompression(m_Level));
+            cmp->SetFlags(m_Flags | CZipCompression::fWriteGZipFormat);
+        } else {
+            cmp.reset(new CBZip2Compression(m_Level));
+            cmp->SetFlags(m_Flags);
+        }
+        // Enough for both algorithms, including incompressible data
+        // and the gzip header/footer
+        m_Output.resize(m_Data.size() + m_Data.size() / 100 + 1024);
+        size_t n = 0;
+        if ( !cmp->CompressBuffer(m_Data.data(), m_Data.size(),
+                                  &m_Output[0], m_Output.size(), &n) ) {
+            m_ErrCode = cmp->GetErrorCode() ? cmp->GetErrorCode() : -1;
+            m_ErrMsg  = cmp->GetErrorDescription();
+            m_Output.clear();
+            return eFailed;
+        }
+        m_Output.resize(n);
+    }
+    catch (exception& e) {
+        m_ErrCode = -1;
+        m_ErrMsg  = e.what();
+        m_Output.clear();
+        return eFailed;
+    }
+    // Release memory as soon as possible
+    string().swap(m_Data);
+    return eCompleted;
+}
+
+
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// CParallelCompressor
+//
+
+CParallelCompressor::CParallelCompressor(
+        EMethod              method,
+        ICompression::ELevel level,
+        ICompression::TFlags flags,
+        unsigned int         threads,
+        size_t               block_size)
+    : m_Method(method), m_Level(level), m_Flags(flags),
+      m_Threads(threads ? threads : GetCpuCount()),
+      m_BlockSize(block_size ? block_size
+                             : kParallelCompressionDefaultBlockSize),
+      m_Pool(0), m_OutputPos(0), m_HaveData(false)
+{
+    if ( !m_Threads ) {
+        m_Threads = 1;
+    }
+    // Keep all threads busy while the oldest block is written out
+    m_MaxPending = 2 * m_Threads;
+}
+
+
+CParallelCompressor::~CParallelCompressor()
+{
+    try {
+        if ( IsBusy() ) {
+            // Abnormal session termination
+            End(1);
+        }
+        delete m_Pool;
+    }
+    COMPRESS_HANDLE_EXCEPTIONS(95, "CParallelCompressor::~CParallelCompressor");
+}
+
+
+CCompressionProcessor::EStatus CParallelCompressor::Init(void)
+{
+    // Initialize members
+    Reset();
+    SetBusy();
+    m_Block.clear();
+    m_Pending.clear();
+    m_Output.clear();
+    m_OutputPos = 0;
+    m_HaveData  = false;
+
+    if ( !m_Pool ) {
+        m_Pool = new CThreadPool((unsigned int)m_MaxPending,
+                                 m_Threads, m_Threads);
+    }
+    return eStatus_Success;
+}
+
+
+CCompressionProcessor::EStatus CParallelCompressor::Process(
+                      const char* in_buf,  size_t  in_len,
+                      char*       out_buf, size_t  out_size,
+                      /* out */            size_t* in_avail,
+                      /* out */            size_t* out_avail)
+{
+    *in_avail  = in_len;
+    *out_avail = 0;
+
+    // Write out already compressed blocks first
+    if ( !x_CollectBlocks(m_MaxPending) ) {
+        return eStatus_Error;
+    }
+    *out_avail = x_CopyOutput(out_buf, out_size);
+    if ( in_len ) {
+        m_HaveData = true;
+    }
+
+    while ( *in_avail ) {
+        if ( m_OutputPos < m_Output.size() ) {
+            // The output buffer is full, let the caller write it out
+            break;
+        }
+        if ( m_Block.capacity() < m_BlockSize ) {
+            m_Block.reserve(m_BlockSize);
+        }
+        size_t n = min(*in_avail, m_BlockSize - m_Block.size());
+        m_Block.append(in_buf + in_len - *in_avail, n);
+        *in_avail -= n;
+        IncreaseProcessedSize((unsigned long)n);
+
+        if ( m_Block.size() == m_BlockSize ) {
+            // Wait for the oldest block if too many are in progress
+            if ( !x_CollectBlocks(m_MaxPending - 1) ) {
+                return eStatus_Error;
+            }
+            x_SubmitBlock();
+            *out_avail += x_CopyOutput(out_buf + *out_avail,
+                                       out_size - *out_avail);
+        }
+    }
+    return eStatus_Success;
+}
+
+
+CCompressionProcessor::EStatus CParallelCompressor::Flush(
+                      char*       out_buf, size_t  out_size,
+                      /* out */            size_t* out_avail)
+{
+    return x_Drain(out_buf, out_size, out_avail);
+}
+
+
+CCompressionProcessor::EStatus CParallelCompressor::Finish(
+                      char*       out_buf, size_t  out_size,
+                      /* out */            size_t* out_avail)
+{
+    // Write header/footer for empty input, if requested
+    if ( !m_HaveData ) {
+        bool allow_empty = (m_Method == eGZipFile) ?
+            (m_Flags & CZipCompression::fAllowEmptyData) != 0 :
+            (m_Flags & CBZip2Compression::fAllowEmptyData) != 0;
+        if ( allow_empty ) {
+            m_HaveData = true;
+            x_SubmitBlock();
+        }
+    }
+    EStatus status = x_Drain(out_buf, out_size, out_avail);
+    if ( status == eStatus_Success ) {
+        return eStatus_EndOfData;
+    }
+    return status;
+}
+
+
+CCompressionProcessor::EStatus CParallelCompressor::End(int abandon)
+{
+    // Blocks cannot be taken back from the threads, so wait for them
+    while ( !m_Pending.empty() ) {
+        if ( abandon ) {
+            m_Pending.front()->RequestToCancel();
+        }
+        m_Pending.front()->Wait();
+        m_Pending.pop_front();
+    }
+    m_Block.clear();
+    m_Output.clear();
+    m_OutputPos = 0;
+    SetBusy(false);
+    return eStatus_Success;
+}
+
+
+void CParallelCompressor::x_SubmitBlock(void)
+{
+    TTask task(new CParallelCompressionTask(m_Method, m_Level, m_Flags,
+                                            m_Block));
+    m_Pool->AddTask(task.GetPointer());
+    m_Pending.push_back(task);
+}
+
+
+bool CParallelCompressor::x_CollectBlocks(size_t max_pending)
+{
+    while ( !m_Pending.empty() ) {
+        TTask task = m_Pending.front();
+        if ( m_Pending.size() > max_pending ) {
+            task->Wait();
+        } else if ( !task->TryWait() ) {
+            break;
+        }
+        m_Pending.pop_front();
+        if ( !task->IsOkay() ) {
+            ERR_COMPRESS(96, "CParallelCompressor: block compression failed: "
+                         << task->GetErrorDescription()
+                         << " (errcode = " << task->GetErrorCode() << ")");
+            return false;
+        }
+        if ( m_OutputPos == m_Output.size() ) {
+            m_Output.clear();
+            m_OutputPos = 0;
+        }
+        m_Output.append(task->GetOutput());
+    }
+    return true;
+}
+
+
+size_t CParallelCompressor::x_CopyOutput(char* out_buf, size_t out_size)
+{
+    size_t n = min(m_Output.size() - m_OutputPos, out_size);
+    if ( n ) {
+        memcpy(out_buf, m_Output.data() + m_OutputPos, n);
+        m_OutputPos += n;
+        IncreaseOutputSize((unsigned long)n);
+    }
+    if ( m_OutputPos == m_Output.size() ) {
+        m_Output.clear();
+        m_OutputPos = 0;
+    }
+    return n;
+}
+
+
+CCompressionProcessor::EStatus CParallelCompressor::x_Drain(
+                      char*       out_buf, size_t  out_size,
+                      /* out */            size_t* out_avail)
+{
+    *out_avail = 0;
+    if ( !m_Block.empty() ) {
+        x_SubmitBlock();
+    }
+    if ( !x_CollectBlocks(0) ) {
+        return eStatus_Error;
+    }
+    *out_avail = x_CopyOutput(out_buf, out_size);
+    if ( m_OutputPos < m_Output.size() ) {
+        return eStatus_Overflow;
+    }
+    return eStatus_Success;
+}
+
+
+END_NCBI_SCOPE
@@ -28,12 +28,24 @@
  */
 
 #include <ncbi_pch.hpp>
+#include <corelib/ncbi_param.hpp>
 #include <util/compress/stream_util.hpp>
+#include <util/compress/parallel.hpp>
 
 
 BEGIN_NCBI_SCOPE
 
 
+// Number of threads used by compression streams for .gz format.
+// If greater than 1, the data is compressed by blocks in parallel and
+// the output is a concatenation of gzip members, readable by any gzip
+// decompressor. bzip2 streams are not affected: concatenated bzip2
+// streams are read by CBZip2Decompressor with fAllowConcatenatedStreams
+// flag only, so existing readers would lose all data after the first block.
+NCBI_PARAM_DEF_EX(unsigned int, Compress, Threads, 1, eParam_NoThread,
+                  COMPRESS_THREADS);
+
+
 // Algorithm-specific defaults
 const ICompression::TFlags kDefault_BZip2    = 0;
 #if defined(HAVE_LIBLZO)
@@ -56,7 +68,8 @@ CCompressionStreamProcessor* s_Init(EInitType                type,
                                     ICompression::ELevel     level)
 {
     CCompressionStreamProcessor* processor = 0;
-
+    unsigned int threads = (type == eCompress) ?
+                           TParamCompressThreads::GetDefault() : 1;
     switch(method) {
     case CCompressStream::eNone:
         processor = new CTransparentStreamProcessor();
@@ -111,7 +124,12 @@ CCompressionStreamProcessor* s_Init(EInitType                type,
             flags |= kDefault_GZipFile;
         }
         if (type == eCompress) {
-            processor = new CZipStreamCompressor(level, flags);
+            if (threads > 1) {
+                processor = new CParallelStreamCompressor(
+                    CParallelCompressor::eGZipFile, level, flags, threads);
+            } else {
+                processor = new CZipStreamCompressor(level, flags);
+            }
         } else {
             processor = new CZipStreamDecompressor(flags);
         }
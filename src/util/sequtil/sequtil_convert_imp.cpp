@@ -37,6 +37,7 @@
 #include "sequtil_convert_imp.hpp"
 #include "sequtil_shared.hpp"
 #include "sequtil_tables.hpp"
+#include "sequtil_simd.hpp"
 
 #include <stdlib.h>
 
@@ -267,7 +268,11 @@ SIZE_TYPE CSeqConvert_imp::x_ConvertIupacnaTo2na
     const Uint1* table = CIupacnaTo2na::GetTable();
     
     const char* src_i = src + pos;
-    for ( size_t count = length / 4; count; --count ) {
+    size_t done = simd_pack_4_to_1(src_i, length / 4, dst, table);
+    src_i += done * 4;
+    dst += done;
+
+    for ( size_t count = length / 4 - done; count; --count ) {
         *dst = 
             table[*src_i * 4          ] | 
             table[*(src_i + 1) * 4 + 1] |
@@ -324,8 +329,11 @@ SIZE_TYPE CSeqConvert_imp::x_ConvertIupacnaTo4na
     const Uint1* table = CIupacnaTo4na::GetTable();
     
     const char* src_i = src + pos;
+    size_t done = simd_pack_2_to_1(src_i, length / 2, dst, table);
+    src_i += done * 2;
+    dst += done;
     
-    for ( size_t count = length / 2; count; --count ) {
+    for ( size_t count = length / 2 - done; count; --count ) {
         *dst = table[*src_i * 2] | table[*(src_i + 1) * 2 + 1];
         src_i += 2;
         ++dst;
@@ -40,6 +40,7 @@
 #include <util/sequtil/sequtil_convert.hpp>
 #include "sequtil_shared.hpp"
 #include "sequtil_tables.hpp"
+#include "sequtil_simd.hpp"
 
 
 BEGIN_NCBI_SCOPE
@@ -464,12 +465,19 @@ static SIZE_TYPE s_Ncbi2naRevCmp
 
     const char* begin = src + (pos / 4);
     const char* iter = src + (pos + length - 1) / 4 + 1;
+    size_t done;
     switch ( offset ) {
     case 0:
     case 1:
     case 2:
         --iter;
-        for ( size_t count = length / 4;  count; --count, ++dst, --iter ) {
+        done = simd_packed_revcmp(iter, length / 4,
+                                  unsigned(3 - offset) * 2, dst,
+                                  C2naRevCmp::GetTable(3));
+        iter -= done;
+        dst += done;
+        for ( size_t count = length / 4 - done;  count;
+              --count, ++dst, --iter ) {
             *dst = 
                 table[static_cast<Uint1>(*iter) * 2] |
                 table[static_cast<Uint1>(*(iter - 1)) * 2 + 1];
@@ -487,6 +495,9 @@ static SIZE_TYPE s_Ncbi2naRevCmp
 
     case 3:
         // aligned operation
+        done = simd_packed_revcmp(iter - 1, iter - begin, 0, dst, table);
+        iter -= done;
+        dst += done;
         for ( ; iter != begin; ++dst ) {
             *dst = table[static_cast<Uint1>(*--iter)];
         }
@@ -529,11 +540,17 @@ static SIZE_TYPE s_Ncbi4naRevCmp
     size_t offset = (pos + length - 1) % 2;
     const Uint1* table = C4naRevCmp::GetTable(offset);
 
+    size_t done;
     switch ( offset ) {
     case 0:
         {{
             --iter;
-            for ( size_t count = length / 2;  count; --count, --iter, ++dst ) {
+            done = simd_packed_revcmp(iter, length / 2, 4, dst,
+                                      C4naRevCmp::GetTable(1));
+            iter -= done;
+            dst += done;
+            for ( size_t count = length / 2 - done;  count;
+                  --count, --iter, ++dst ) {
                 *dst =
                     table[static_cast<Uint1>(*iter) * 2] |
                     table[static_cast<Uint1>(*(iter - 1)) * 2 + 1];
@@ -547,6 +564,9 @@ static SIZE_TYPE s_Ncbi4naRevCmp
 
     case 1:
         {{
+            done = simd_packed_revcmp(iter - 1, iter - begin, 0, dst, table);
+            iter -= done;
+            dst += done;
             for ( ; iter != begin; ++dst ) {
                 *dst = table[static_cast<Uint1>(*--iter)];
             }
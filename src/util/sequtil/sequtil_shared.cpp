@@ -33,6 +33,7 @@
 
 #include <util/sequtil/sequtil.hpp>
 #include "sequtil_shared.hpp"
+#include "sequtil_simd.hpp"
 
 
 BEGIN_NCBI_SCOPE
@@ -48,6 +49,10 @@ SIZE_TYPE convert_1_to_1
     const char* iter = src + pos;
     const char* end = src + pos + length;
 
+    size_t done = simd_convert_1_to_1(iter, length, dst, table);
+    iter += done;
+    dst += done;
+
     for ( ; iter != end; ++iter, ++dst ) {
         *dst = table[static_cast<Uint1>(*iter)];
     }
@@ -75,6 +80,11 @@ SIZE_TYPE convert_1_to_2
         --size;
     }
 
+    size_t done = simd_convert_1_to_2(iter, size / 2, dst, table);
+    iter += done;
+    dst += done * 2;
+    size -= done * 2;
+
     // NB: we "trick" the compiler so that we copy 2 bytes instead
     // of one with each assignment operation
     Uint2* out_i  = reinterpret_cast<Uint2*>(dst);
@@ -116,6 +126,11 @@ SIZE_TYPE convert_1_to_4
         size -= to - (pos % 4);
     }
 
+    size_t done = simd_convert_1_to_4(iter, size / 4, dst, table);
+    iter += done;
+    dst += done * 4;
+    size -= done * 4;
+
     // NB: we "trick" the compiler so that we copy 4 bytes instead
     // of one with each assignment operation
     Uint4* out_i  = reinterpret_cast<Uint4*>(dst);
@@ -148,6 +163,10 @@ SIZE_TYPE copy_1_to_1_reverse
     const char* begin = src + pos;
     const char* iter = src + pos + length;
 
+    size_t done = simd_copy_1_to_1_reverse(iter, length, dst, table);
+    iter -= done;
+    dst += done;
+
     for ( ; iter != begin; ++dst ) {
         *dst = table[static_cast<Uint1>(*--iter)];
     }
@@ -166,6 +185,10 @@ SIZE_TYPE revcmp
     char* last  = first + length - 1;
     char temp;
 
+    size_t done = simd_revcmp(first, last + 1, table);
+    first += done;
+    last -= done;
+
     for ( ; first <= last; ++first, --last ) {
         temp = table[static_cast<Uint1>(*first)];
         *first = table[static_cast<Uint1>(*last)];
@@ -0,0 +1,508 @@
+/*  $Id$
+ * ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ *
+ * File Description:
+ *   Vectorized (SSSE3 / AVX2) kernels for the hot sequtil conversions.
+ */
+#include <ncbi_pch.hpp>
+#include <corelib/ncbistd.hpp>
+
+#include <util/sequtil/sequtil.hpp>
+
+#include "sequtil_simd.hpp"
+
+// The kernels are compiled for SSSE3 and AVX2 with target pragmas, so
+// the rest of the toolkit does not need any special compiler flags; the
+// instruction set is chosen at run time from what the CPU reports.
+#if !defined(__clang__)  &&  defined(__GNUC__)  &&                     \
+    (__GNUC__ > 4  ||  (__GNUC__ == 4  &&  __GNUC_MINOR__ >= 9))  &&   \
+    (defined(__x86_64__)  ||  defined(__i386__))
+#  define SEQUTIL_SIMD 1
+#  include <immintrin.h>
+#endif
+
+
+BEGIN_NCBI_SCOPE
+
+
+#ifdef SEQUTIL_SIMD
+
+/////////////////////////////////////////////////////////////////////////////
+//
+// SSSE3
+
+#pragma GCC push_options
+#pragma GCC target("ssse3")
+
+namespace sequtil_ssse3 {
+
+typedef __m128i TVec;
+
+static inline TVec V_Load(const Uint1* p)
+{
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+}
+
+static inline void V_Store(Uint1* p, TVec v)
+{
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v);
+}
+
+// 16 entry table for V_Shuffle
+static inline TVec V_Table(const Uint1* p)
+{
+    return V_Load(p);
+}
+
+static inline TVec V_Set1(Uint1 c)    { return _mm_set1_epi8(char(c)); }
+static inline TVec V_Set1_16(Uint2 c) { return _mm_set1_epi16(short(c)); }
+static inline TVec V_Set1_32(Uint4 c) { return _mm_set1_epi32(int(c)); }
+
+static inline TVec V_And(TVec a, TVec b)   { return _mm_and_si128(a, b); }
+static inline TVec V_Or(TVec a, TVec b)    { return _mm_or_si128(a, b); }
+static inline TVec V_CmpEq(TVec a, TVec b) { return _mm_cmpeq_epi8(a, b); }
+static inline int  V_MoveMask(TVec a)      { return _mm_movemask_epi8(a); }
+
+static inline TVec V_Shuffle(TVec table, TVec index)
+{
+    return _mm_shuffle_epi8(table, index);
+}
+
+// shifts of 16 bit words; callers mask out the bits crossing bytes
+static inline TVec V_ShiftRight(TVec a, unsigned bits)
+{
+    return _mm_srl_epi16(a, _mm_cvtsi32_si128(int(bits)));
+}
+
+static inline TVec V_ShiftLeft(TVec a, unsigned bits)
+{
+    return _mm_sll_epi16(a, _mm_cvtsi32_si128(int(bits)));
+}
+
+static inline TVec V_Reverse(TVec a)
+{
+    return _mm_shuffle_epi8(a, _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8,
+                                             7, 6, 5, 4, 3, 2, 1, 0));
+}
+
+static inline void V_Interleave8(TVec a, TVec b, TVec& lo, TVec& hi)
+{
+    lo = _mm_unpacklo_epi8(a, b);
+    hi = _mm_unpackhi_epi8(a, b);
+}
+
+static inline void V_Interleave16(TVec a, TVec b, TVec& lo, TVec& hi)
+{
+    lo = _mm_unpacklo_epi16(a, b);
+    hi = _mm_unpackhi_epi16(a, b);
+}
+
+// unsigned bytes times signed weights, adjacent pairs added
+static inline TVec V_MulAdd8(TVec a, TVec weights)
+{
+    return _mm_maddubs_epi16(a, weights);
+}
+
+static inline TVec V_MulAdd16(TVec a, TVec weights)
+{
+    return _mm_madd_epi16(a, weights);
+}
+
+static inline TVec V_Pack16To8(TVec a, TVec b)
+{
+    return _mm_packus_epi16(a, b);
+}
+
+static inline TVec V_Pack32To8(TVec a, TVec b, TVec c, TVec d)
+{
+    return _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+}
+
+#include "sequtil_simd.inc"
+
+} // namespace sequtil_ssse3
+
+#pragma GCC pop_options
+
+
+/////////////////////////////////////////////////////////////////////////////
+//
+// AVX2
+
+#pragma GCC push_options
+#pragma GCC target("avx2")
+
+namespace sequtil_avx2 {
+
+typedef __m256i TVec;
+
+static inline TVec V_Load(const Uint1* p)
+{
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+}
+
+static inline void V_Store(Uint1* p, TVec v)
+{
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v);
+}
+
+// 16 entry table for V_Shuffle, repeated in both lanes
+static inline TVec V_Table(const Uint1* p)
+{
+    return _mm256_broadcastsi128_si256(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+}
+
+static inline TVec V_Set1(Uint1 c)    { return _mm256_set1_epi8(char(c)); }
+static inline TVec V_Set1_16(Uint2 c) { return _mm256_set1_epi16(short(c)); }
+static inline TVec V_Set1_32(Uint4 c) { return _mm256_set1_epi32(int(c)); }
+
+static inline TVec V_And(TVec a, TVec b)   { return _mm256_and_si256(a, b); }
+static inline TVec V_Or(TVec a, TVec b)    { return _mm256_or_si256(a, b); }
+static inline TVec V_CmpEq(TVec a, TVec b) { return _mm256_cmpeq_epi8(a, b); }
+static inline int  V_MoveMask(TVec a)      { return _mm256_movemask_epi8(a); }
+
+static inline TVec V_Shuffle(TVec table, TVec index)
+{
+    return _mm256_shuffle_epi8(table, index);
+}
+
+static inline TVec V_ShiftRight(TVec a, unsigned bits)
+{
+    return _mm256_srl_epi16(a, _mm_cvtsi32_si128(int(bits)));
+}
+
+static inline TVec V_ShiftLeft(TVec a, unsigned bits)
+{
+    return _mm256_sll_epi16(a, _mm_cvtsi32_si128(int(bits)));
+}
+
+static inline TVec V_Reverse(TVec a)
+{
+    TVec r = _mm256_shuffle_epi8(a, _mm256_setr_epi8(
+        15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0,
+        15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0));
+    return _mm256_permute4x64_epi64(r, 0x4E);
+}
+
+// unpack instructions work within 128 bit lanes, restore the order
+static inline void V_Interleave8(TVec a, TVec b, TVec& lo, TVec& hi)
+{
+    TVec l = _mm256_unpacklo_epi8(a, b);
+    TVec h = _mm256_unpackhi_epi8(a, b);
+    lo = _mm256_permute2x128_si256(l, h, 0x20);
+    hi = _mm256_permute2x128_si256(l, h, 0x31);
+}
+
+static inline void V_Interleave16(TVec a, TVec b, TVec& lo, TVec& hi)
+{
+    TVec l = _mm256_unpacklo_epi16(a, b);
+    TVec h = _mm256_unpackhi_epi16(a, b);
+    lo = _mm256_permute2x128_si256(l, h, 0x20);
+    hi = _mm256_permute2x128_si256(l, h, 0x31);
+}
+
+static inline TVec V_MulAdd8(TVec a, TVec weights)
+{
+    return _mm256_maddubs_epi16(a, weights);
+}
+
+static inline TVec V_MulAdd16(TVec a, TVec weights)
+{
+    return _mm256_madd_epi16(a, weights);
+}
+
+static inline TVec V_Pack16To8(TVec a, TVec b)
+{
+    return _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8);
+}
+
+static inline TVec V_Pack32To8(TVec a, TVec b, TVec c, TVec d)
+{
+    TVec r = _mm256_packus_epi16(_mm256_packs_epi32(a, b),
+                                 _mm256_packs_epi32(c, d));
+    return _mm256_permutevar8x32_epi32(r, _mm256_setr_epi32(0, 4, 1, 5,
+                                                            2, 6, 3, 7));
+}
+
+#include "sequtil_simd.inc"
+
+} // namespace sequtil_avx2
+
+#pragma GCC pop_options
+
+
+/////////////////////////////////////////////////////////////////////////////
+//
+// Dispatch
+
+struct SSeqUtilKernels
+{
+    size_t (*convert_1_to_1)(const Uint1*, size_t, Uint1*, const Uint1*);
+    size_t (*copy_1_to_1_reverse)(const Uint1*, size_t, Uint1*,
+                                  const Uint1*);
+    size_t (*revcmp)(Uint1*, Uint1*, const Uint1*);
+    size_t (*convert_1_to_4)(const Uint1*, size_t, Uint1*, const Uint1*);
+    size_t (*convert_1_to_2)(const Uint1*, size_t, Uint1*, const Uint1*);
+    size_t (*pack_4_to_1)(const Uint1*, size_t, Uint1*, const Uint1*);
+    size_t (*pack_2_to_1)(const Uint1*, size_t, Uint1*, const Uint1*);
+    size_t (*packed_revcmp)(const Uint1*, size_t, unsigned, Uint1*,
+                            const Uint1*, const Uint1*);
+};
+
+
+static const SSeqUtilKernels s_KernelsSSSE3 = {
+    sequtil_ssse3::s_Convert1To1,
+    sequtil_ssse3::s_Copy1To1Reverse,
+    sequtil_ssse3::s_RevCmp,
+    sequtil_ssse3::s_Convert1To4,
+    sequtil_ssse3::s_Convert1To2,
+    sequtil_ssse3::s_Pack4To1,
+    sequtil_ssse3::s_Pack2To1,
+    sequtil_ssse3::s_PackedRevCmp
+};
+
+
+static const SSeqUtilKernels s_KernelsAVX2 = {
+    sequtil_avx2::s_Convert1To1,
+    sequtil_avx2::s_Copy1To1Reverse,
+    sequtil_avx2::s_RevCmp,
+    sequtil_avx2::s_Convert1To4,
+    sequtil_avx2::s_Convert1To2,
+    sequtil_avx2::s_Pack4To1,
+    sequtil_avx2::s_Pack2To1,
+    sequtil_avx2::s_PackedRevCmp
+};
+
+
+static const SSeqUtilKernels* s_SelectKernels(void)
+{
+    __builtin_cpu_init();
+    if ( __builtin_cpu_supports("avx2") ) {
+        return &s_KernelsAVX2;
+    }
+    if ( __builtin_cpu_supports("ssse3") ) {
+        return &s_KernelsSSSE3;
+    }
+    return 0;
+}
+
+
+static const SSeqUtilKernels* const s_CpuKernels = s_SelectKernels();
+static const SSeqUtilKernels* s_Kernels = s_CpuKernels;
+
+
+void CSeqUtil::SetSimdEnabled(bool enabled)
+{
+    s_Kernels = enabled ? s_CpuKernels : 0;
+}
+
+
+bool CSeqUtil::IsSimdEnabled(void)
+{
+    return s_Kernels != 0;
+}
+
+
+// Do not bother with kernel setup for short sequences
+static const size_t kMinSimdLength = 64;
+
+
+#define SEQUTIL_KERNELS(length) \
+    const SSeqUtilKernels* kernels = s_Kernels; \
+    if ( !kernels  ||  (length) < kMinSimdLength ) { \
+        return 0; \
+    }
+
+
+size_t simd_convert_1_to_1(const char* src, size_t length,
+                           char* dst,
+                           const Uint1* table)
+{
+    SEQUTIL_KERNELS(length);
+    return kernels->convert_1_to_1(reinterpret_cast<const Uint1*>(src),
+                                   length,
+                                   reinterpret_cast<Uint1*>(dst), table);
+}
+
+
+size_t simd_copy_1_to_1_reverse(const char* src_end, size_t length,
+                                char* dst,
+                                const Uint1* table)
+{
+    SEQUTIL_KERNELS(length);
+    return kernels->copy_1_to_1_reverse(
+        reinterpret_cast<const Uint1*>(src_end), length,
+        reinterpret_cast<Uint1*>(dst), table);
+}
+
+
+size_t simd_revcmp(char* first, char* last_end, const Uint1* table)
+{
+    SEQUTIL_KERNELS(size_t(last_end - first));
+    return kernels->revcmp(reinterpret_cast<Uint1*>(first),
+                           reinterpret_cast<Uint1*>(last_end), table);
+}
+
+
+size_t simd_convert_1_to_4(const char* src, size_t src_bytes,
+                           char* dst,
+                           const Uint1* table)
+{
+    SEQUTIL_KERNELS(src_bytes * 4);
+    return kernels->convert_1_to_4(reinterpret_cast<const Uint1*>(src),
+                                   src_bytes,
+                                   reinterpret_cast<Uint1*>(dst), table);
+}
+
+
+size_t simd_convert_1_to_2(const char* src, size_t src_bytes,
+                           char* dst,
+                           const Uint1* table)
+{
+    SEQUTIL_KERNELS(src_bytes * 2);
+    return kernels->convert_1_to_2(reinterpret_cast<const Uint1*>(src),
+                                   src_bytes,
+                                   reinterpret_cast<Uint1*>(dst), table);
+}
+
+
+size_t simd_pack_4_to_1(const char* src, size_t dst_bytes,
+                        char* dst,
+                        const Uint1* table)
+{
+    SEQUTIL_KERNELS(dst_bytes * 4);
+    // residue code is the value of the last residue in the byte
+    Uint1 codes[128];
+    for ( int c = 0; c < 128; ++c ) {
+        codes[c] = table[c * 4 + 3];
+    }
+    return kernels->pack_4_to_1(reinterpret_cast<const Uint1*>(src),
+                                dst_bytes,
+                                reinterpret_cast<Uint1*>(dst), codes);
+}
+
+
+size_t simd_pack_2_to_1(const char* src, size_t dst_bytes,
+                        char* dst,
+                        const Uint1* table)
+{
+    SEQUTIL_KERNELS(dst_bytes * 2);
+    Uint1 codes[128];
+    for ( int c = 0; c < 128; ++c ) {
+        codes[c] = table[c * 2 + 1];
+    }
+    return kernels->pack_2_to_1(reinterpret_cast<const Uint1*>(src),
+                                dst_bytes,
+                                reinterpret_cast<Uint1*>(dst), codes);
+}
+
+
+size_t simd_packed_revcmp(const char* last, size_t count, unsigned shift,
+                          char* dst,
+                          const Uint1* table)
+{
+    SEQUTIL_KERNELS(count * 2);
+    // reverse complement of a byte is made of the complements of its
+    // two nibbles, each one moved to the other half of the byte
+    Uint1 cmp_hi[16], cmp_lo[16];
+    for ( int n = 0; n < 16; ++n ) {
+        cmp_hi[n] = table[n] & 0xF0;
+        cmp_lo[n] = table[n << 4] & 0x0F;
+    }
+    return kernels->packed_revcmp(reinterpret_cast<const Uint1*>(last),
+                                  count, shift,
+                                  reinterpret_cast<Uint1*>(dst),
+                                  cmp_hi, cmp_lo);
+}
+
+#undef SEQUTIL_KERNELS
+
+
+#else // SEQUTIL_SIMD
+
+void CSeqUtil::SetSimdEnabled(bool /*enabled*/)
+{
+}
+
+
+bool CSeqUtil::IsSimdEnabled(void)
+{
+    return false;
+}
+
+
+size_t simd_convert_1_to_1(const char*, size_t, char*, const Uint1*)
+{
+    return 0;
+}
+
+
+size_t simd_copy_1_to_1_reverse(const char*, size_t, char*, const Uint1*)
+{
+    return 0;
+}
+
+
+size_t simd_revcmp(char*, char*, const Uint1*)
+{
+    return 0;
+}
+
+
+size_t simd_convert_1_to_4(const char*, size_t, char*, const Uint1*)
+{
+    return 0;
+}
+
+
+size_t simd_convert_1_to_2(const char*, size_t, char*, const Uint1*)
+{
+    return 0;
+}
+
+
+size_t simd_pack_4_to_1(const char*, size_t, char*, const Uint1*)
+{
+    return 0;
+}
+
+
+size_t simd_pack_2_to_1(const char*, size_t, char*, const Uint1*)
+{
+    return 0;
+}
+
+
+size_t simd_packed_revcmp(const char*, size_t, unsigned, char*,
+                          const Uint1*)
+{
+    return 0;
+}
+
+#endif // SEQUTIL_SIMD
+
+
+END_NCBI_SCOPE
@@ -0,0 +1,107 @@
+#ifndef UTIL_SEQUTIL___SEQUTIL_SIMD__HPP
+#define UTIL_SEQUTIL___SEQUTIL_SIMD__HPP
+
+/* $Id$
+ * ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ *
+ * File Description:
+ *   Vectorized (SSSE3 / AVX2) kernels for the hot sequtil conversions.
+ *
+ *   The kernel set is chosen at run time according to the CPU.  Every
+ *   kernel processes a prefix of the data in whole vector blocks and
+ *   returns its size (0 if no vector unit is available or the kernels
+ *   were disabled with CSeqUtil::SetSimdEnabled()); the calling table
+ *   driven code converts the rest.  The results are always identical
+ *   to the ones of the table driven code.
+ */
+
+#include <corelib/ncbistd.hpp>
+
+#include <util/sequtil/sequtil.hpp>
+
+
+BEGIN_NCBI_SCOPE
+
+
+// dst[i] = table[src[i]]
+// returns number of bytes converted
+size_t simd_convert_1_to_1(const char* src, size_t length,
+                           char* dst,
+                           const Uint1* table);
+
+// dst[i] = table[src_end[-1-i]]
+// returns number of bytes converted
+size_t simd_copy_1_to_1_reverse(const char* src_end, size_t length,
+                                char* dst,
+                                const Uint1* table);
+
+// In place reverse and translate of [first, last_end) with table,
+// working from both ends towards the middle.
+// returns number of bytes processed at each end
+size_t simd_revcmp(char* first, char* last_end, const Uint1* table);
+
+// Unpack 2 bit (ncbi2na) bytes into 4 residues each using
+// the convert_1_to_4() table.
+// returns number of source bytes converted
+size_t simd_convert_1_to_4(const char* src, size_t src_bytes,
+                           char* dst,
+                           const Uint1* table);
+
+// Unpack 4 bit (ncbi4na) bytes into 2 residues each using
+// the convert_1_to_2() table.
+// returns number of source bytes converted
+size_t simd_convert_1_to_2(const char* src, size_t src_bytes,
+                           char* dst,
+                           const Uint1* table);
+
+// Pack 4 residues into a single 2 bit (ncbi2na) byte using
+// the CIupacnaTo2na table.  Stops before the first non-ASCII residue.
+// returns number of destination bytes produced
+size_t simd_pack_4_to_1(const char* src, size_t dst_bytes,
+                        char* dst,
+                        const Uint1* table);
+
+// Pack 2 residues into a single 4 bit (ncbi4na) byte using
+// the CIupacnaTo4na table.  Stops before the first non-ASCII residue.
+// returns number of destination bytes produced
+size_t simd_pack_2_to_1(const char* src, size_t dst_bytes,
+                        char* dst,
+                        const Uint1* table);
+
+// Reverse complement of packed (ncbi2na or ncbi4na) data into dst.
+// last points to the last source byte, count is the number of
+// destination bytes and shift is the number of bits by which every
+// reversed source byte has to be moved up (0 for aligned data).
+// table is the reverse complement table for aligned data.
+// returns number of destination bytes produced
+size_t simd_packed_revcmp(const char* last, size_t count, unsigned shift,
+                          char* dst,
+                          const Uint1* table);
+
+
+END_NCBI_SCOPE
+
+
+#endif  /* UTIL_SEQUTIL___SEQUTIL_SIMD__HPP */
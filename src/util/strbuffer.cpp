@@ -37,6 +37,12 @@
 #include <util/error_codes.hpp>
 #include <algorithm>
 
+// SSE2 is present on every x86-64 CPU, so no run time check is needed
+#if defined(__SSE2__)  &&  defined(__GNUC__)
+#  define STRBUFFER_SSE2 1
+#  include <emmintrin.h>
+#endif
+
 
 #define NCBI_USE_ERRCODE_X   Util_Stream
 
@@ -222,6 +228,29 @@ char CIStreamBuffer::SkipSpaces(void)
     //     end == m_DataEndPos
     //     pos < end
     for (;;) {
+#ifdef STRBUFFER_SSE2
+        // skip long runs of spaces (indentation) 16 chars at a time
+        if ( *pos == ' ' ) {
+            const __m128i spaces = _mm_set1_epi8(' ');
+            while ( end - pos >= 16 ) {
+                __m128i v = _mm_loadu_si128((const __m128i*)pos);
+                unsigned mask =
+                    _mm_movemask_epi8(_mm_cmpeq_epi8(v, spaces)) ^ 0xFFFF;
+                if ( mask ) {
+                    pos += __builtin_ctz(mask);
+                    m_CurrentPos = pos;
+                    return *pos;
+                }
+                pos += 16;
+            }
+            if ( pos == end ) {
+                m_CurrentPos = pos;
+                pos = FillBuffer(pos);
+                end = m_DataEndPos;
+                continue;
+            }
+        }
+#endif
         // we use do{}while() cycle because
         // condition is true at the beginning ( pos < end )
         do {
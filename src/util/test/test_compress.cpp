@@ -35,6 +35,8 @@
 #include <corelib/ncbi_limits.hpp>
 #include <corelib/ncbifile.hpp>
 #include <util/compress/stream_util.hpp>
+#include <util/compress/parallel.hpp>
+#include <util/compress/bgzf.hpp>
 
 #include <common/test_assert.h>  // This header must go last
 
@@ -141,6 +143,9 @@ public:
     // Additional tests
     void TestEmptyInputData(CCompressStream::EMethod);
     void TestTransparentCopy(const char* src_buf, size_t src_len);
+    void TestParallelCompression(CCompressStream::EMethod,
+                                 const char* src_buf, size_t src_len);
+    void TestBGZF(const char* src_buf, size_t src_len);
 };
 
 
@@ -241,6 +246,25 @@ int CTest::Run(void)
         src_buf[len] = saved;
     }
 
+    // Multi-threaded block compression
+    _TRACE("====================================\nParallel\n\n");
+    {{
+        if (test == "all"  ||  test == "bz2") {
+            TestParallelCompression(CCompressStream::eBZip2,
+                                    src_buf, kBufLen);
+        }
+        if (test== "all"  ||  test == "z") {
+            TestParallelCompression(CCompressStream::eGZipFile,
+                                    src_buf, kBufLen);
+        }
+    }}
+
+    // BGZF (blocked gzip)
+    _TRACE("====================================\nBGZF\n\n");
+    if (test== "all"  ||  test == "z") {
+        TestBGZF(src_buf, kBufLen);
+    }
+
     _TRACE("\nTEST execution completed successfully!\n");
     return 0;
 }
@@ -472,6 +496,268 @@ void CTest::TestTransparentCopy(const char* src_buf, size_t src_len)
 }
 
 
+//------------------------------------------------------------------------
+// Tests for multi-threaded block compression.
+// The output should be readable by the regular (serial) decompressors.
+//------------------------------------------------------------------------
+
+/// Block size for parallel compression tests, several blocks fit kBufLen.
+const size_t       kParallelBlockSize = 16*1024;
+/// Number of threads for parallel compression tests.
+const unsigned int kParallelThreads   = 4;
+
+
+// Compress data with CParallelStreamCompressor,
+// flush the stream after 'flush_pos' bytes if it is inside the data.
+static string s_ParallelCompress(CParallelCompressor::EMethod method,
+                                 ICompression::TFlags flags,
+                                 const char* src_buf, size_t src_len,
+                                 size_t flush_pos)
+{
+    CNcbiOstrstream os_str;
+    CCompressionOStream os(os_str,
+        new CParallelStreamCompressor(method, ICompression::eLevel_Default,
+                                      flags, kParallelThreads,
+                                      kParallelBlockSize,
+                                      kCompressionDefaultBufSize,
+                                      kCompressionDefaultBufSize),
+        CCompressionStream::fOwnProcessor);
+    assert(os.good());
+    if (flush_pos < src_len) {
+        os.write(src_buf, flush_pos);
+        os.flush();
+        assert(os.good());
+        os.write(src_buf + flush_pos, src_len - flush_pos);
+    } else {
+        os.write(src_buf, src_len);
+    }
+    assert(os.good());
+    os.Finalize();
+    assert(os.good());
+    string str = CNcbiOstrstreamToString(os_str);
+    assert(os.GetProcessedSize() == src_len);
+    assert(os.GetOutputSize() == str.size());
+    return str;
+}
+
+
+// Decompress data with a regular decompression stream
+static string s_Decompress(CCompressStream::EMethod method,
+                           ICompression::TFlags flags, const string& data)
+{
+    CNcbiIstrstream is_str(data.data(), data.size());
+    CDecompressIStream is(is_str, method, flags);
+    CNcbiOstrstream os_str;
+    char buf[4096];
+    while (is.read(buf, sizeof(buf))  ||  is.gcount()) {
+        os_str.write(buf, is.gcount());
+    }
+    assert(is.eof());
+    return CNcbiOstrstreamToString(os_str);
+}
+
+
+void CTest::TestParallelCompression(CCompressStream::EMethod method,
+                                    const char* src_buf, size_t src_len)
+{
+    const bool bzip2 = (method == CCompressStream::eBZip2);
+    const CParallelCompressor::EMethod parallel_method =
+        bzip2 ? CParallelCompressor::eBZip2 : CParallelCompressor::eGZipFile;
+    const ICompression::TFlags empty_flag = bzip2 ?
+        CBZip2Compression::fAllowEmptyData : CZipCompression::fAllowEmptyData;
+    // Concatenated .gz members are read by default, bzip2 streams
+    // need an explicit flag
+    const ICompression::TFlags concat_flag = bzip2 ?
+        CBZip2Compression::fAllowConcatenatedStreams : 0;
+
+    const string src(src_buf, src_len);
+    string out;
+
+    // Empty input: nothing, or header/footer only (like serial streams)
+    {{
+        out = s_ParallelCompress(parallel_method, 0, src_buf, 0, 0);
+        assert(out.empty());
+        out = s_ParallelCompress(parallel_method, empty_flag, src_buf, 0, 0);
+        assert(out.size() == (bzip2 ? 14 : 20));
+        assert(s_Decompress(method, concat_flag | empty_flag, out).empty());
+        OK;
+    }}
+
+    // Multi-block input, without and with flush() in the middle
+    // of a block and on a block boundary
+    const size_t flush_pos[] = { src_len, src_len / 3, kParallelBlockSize * 2 };
+    assert(src_len > kParallelBlockSize * 3);
+
+    for (size_t i = 0;  i < ArraySize(flush_pos);  ++i) {
+        out = s_ParallelCompress(parallel_method, 0, src_buf, src_len,
+                                 flush_pos[i]);
+        assert(s_Decompress(method, concat_flag, out) == src);
+        OK;
+    }
+
+    // Every block is a separate stream, so the bzip2 decompressor
+    // stops after the first one unless concatenated streams are allowed
+    if (bzip2) {
+        out = s_ParallelCompress(parallel_method, 0, src_buf, src_len, src_len);
+        assert(s_Decompress(method, CCompressStream::fDefault, out) ==
+               src.substr(0, kParallelBlockSize));
+        OK;
+    }
+
+    // Regular compression stream with [Compress]Threads > 1 must stay
+    // readable by the default decompression stream
+    {{
+        string big;
+        while (big.size() <= 3 * kParallelCompressionDefaultBlockSize) {
+            big += src;
+        }
+        TParamCompressThreads::SetDefault(kParallelThreads);
+        CNcbiOstrstream os_str;
+        {{
+            CCompressOStream os(os_str, method);
+            os.write(big.data(), big.size());
+            os.Finalize();
+            assert(os.good());
+        }}
+        TParamCompressThreads::ResetDefault();
+        out = CNcbiOstrstreamToString(os_str);
+        assert(s_Decompress(method, CCompressStream::fDefault, out) == big);
+        OK;
+    }}
+}
+
+
+//------------------------------------------------------------------------
+// Tests for BGZF compression and random access reading.
+// The output should be readable by the regular gzip decompressor.
+//------------------------------------------------------------------------
+
+/// Size of the BGZF end-of-file block.
+const size_t kBGZFEOFSize = 28;
+
+
+// Compress data into BGZF, flush the stream after 'flush_pos' bytes
+// if it is inside the data.
+static string s_BGZFCompress(const string& src, size_t flush_pos,
+                             ICompression::TFlags flags, CBGZFIndex* index)
+{
+    CNcbiOstrstream os_str;
+    CBGZFStreamCompressor* processor =
+        new CBGZFStreamCompressor(CZipCompression::eLevel_Default, flags);
+    CCompressionOStream os(os_str, processor,
+                           CCompressionStream::fOwnProcessor);
+    if (flush_pos < src.size()) {
+        os.write(src.data(), flush_pos);
+        os.flush();
+        os.write(src.data() + flush_pos, src.size() - flush_pos);
+    } else {
+        os.write(src.data(), src.size());
+    }
+    os.Finalize();
+    assert(os.good());
+    *index = processor->GetIndex();
+    return CNcbiOstrstreamToString(os_str);
+}
+
+
+// Check random access reads of 'src' from BGZF data 'bgzf'
+static void s_BGZFCheckReader(const string& src, const string& bgzf,
+                              const CBGZFIndex* index)
+{
+    CNcbiIstrstream is(bgzf.data(), bgzf.size());
+    CBGZFReader reader(is, index);
+    const CBGZFIndex& idx = reader.GetIndex();
+
+    // The last indexed block is the end-of-file block
+    assert(!idx.GetBlocks().empty());
+    const CBGZFIndex::SBlock& eof_block = idx.GetBlocks().back();
+    assert(eof_block.raw_pos  == bgzf.size() - kBGZFEOFSize);
+    assert(eof_block.data_pos == src.size());
+
+    // Sequential read of the whole data
+    assert(reader.ReadRange(0, src.size() + 1) == src);
+
+    // Random reads, including ones crossing block boundaries
+    for (int i = 0;  i < 100;  ++i) {
+        size_t from = src.empty() ? 0 : size_t(rand()) % src.size();
+        size_t to   = min(src.size(), from + size_t(rand()) % 100000);
+        assert(reader.ReadRange(from, to) == src.substr(from, to - from));
+    }
+    for (size_t b = 1;  b < idx.GetBlocks().size();  ++b) {
+        size_t pos  = (size_t)idx.GetBlocks()[b].data_pos;
+        size_t from = pos < 10 ? 0 : pos - 10;
+        size_t to   = min(src.size(), pos + 10);
+        assert(reader.ReadRange(from, to) == src.substr(from, to - from));
+    }
+
+    // Virtual offsets
+    char buf[100];
+    for (int i = 0;  i < 100  &&  !src.empty();  ++i) {
+        size_t pos = size_t(rand()) % src.size();
+        CBGZFIndex::TVirtualPos vpos = idx.GetVirtualPos(pos);
+        assert(idx.GetDataPos(vpos) == pos);
+        size_t n = reader.ReadVirtual(vpos, buf, sizeof(buf));
+        assert(n == min(sizeof(buf), src.size() - pos));
+        assert(memcmp(buf, src.data() + pos, n) == 0);
+    }
+    // The end of data points to the end-of-file block
+    CBGZFIndex::TVirtualPos eof_vpos = eof_block.raw_pos << 16;
+    assert(idx.GetVirtualPos(src.size()) == eof_vpos);
+    assert(idx.GetDataPos(eof_vpos) == src.size());
+    assert(reader.ReadVirtual(eof_vpos, buf, sizeof(buf)) == 0);
+    assert(reader.Read(src.size(), buf, sizeof(buf)) == 0);
+}
+
+
+void CTest::TestBGZF(const char* src_buf, size_t src_len)
+{
+    // Several BGZF blocks (~64KB of data each)
+    string src;
+    for (int i = 0;  i < 3;  ++i) {
+        src.append(src_buf, src_len);
+    }
+    const size_t flush_pos[] = { src.size(), src_len / 3 };
+
+    for (size_t i = 0;  i < ArraySize(flush_pos);  ++i) {
+        CBGZFIndex index;
+        string out = s_BGZFCompress(src, flush_pos[i], 0, &index);
+
+        // gzip compatibility
+        assert(out.size() > kBGZFEOFSize);
+        assert(s_Decompress(CCompressStream::eGZipFile, 0, out) == src);
+
+        // Random access with the compressor's index, with the index
+        // saved and loaded in .gzi format, and without an index
+        s_BGZFCheckReader(src, out, &index);
+        CNcbiOstrstream gzi_out;
+        index.Write(gzi_out);
+        string gzi = CNcbiOstrstreamToString(gzi_out);
+        CNcbiIstrstream gzi_in(gzi.data(), gzi.size());
+        CBGZFIndex loaded;
+        loaded.Read(gzi_in);
+        assert(loaded.GetBlocks().size() == index.GetBlocks().size());
+        s_BGZFCheckReader(src, out, &loaded);
+        s_BGZFCheckReader(src, out, NULL);
+        OK;
+    }
+
+    // Empty input: the end-of-file block only, like "bgzip"
+    const ICompression::TFlags empty_flags[] = {
+        0, CZipCompression::fAllowEmptyData
+    };
+    for (size_t i = 0;  i < ArraySize(empty_flags);  ++i) {
+        CBGZFIndex index;
+        string out = s_BGZFCompress(kEmptyStr, 0, empty_flags[i], &index);
+        assert(out.size() == kBGZFEOFSize);
+        assert(s_Decompress(CCompressStream::eGZipFile,
+                            CZipCompression::fAllowEmptyData, out).empty());
+        s_BGZFCheckReader(kEmptyStr, out, &index);
+        s_BGZFCheckReader(kEmptyStr, out, NULL);
+        OK;
+    }
+}
+
+
 //////////////////////////////////////////////////////////////////////////////
 //
 // MAIN
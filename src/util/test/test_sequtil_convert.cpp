@@ -0,0 +1,263 @@
+/*  $Id$
+ * ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ *
+ * File Description:
+ *   Check vectorized sequtil conversions against the table driven code
+ *   and compare their throughput.
+ */
+
+#include <ncbi_pch.hpp>
+#include <corelib/ncbiapp.hpp>
+#include <corelib/ncbiargs.hpp>
+#include <corelib/ncbitime.hpp>
+#include <util/random_gen.hpp>
+#include <util/sequtil/sequtil.hpp>
+#include <util/sequtil/sequtil_convert.hpp>
+#include <util/sequtil/sequtil_manip.hpp>
+#include <vector>
+
+// must be last
+#include <common/test_assert.h>
+
+USING_NCBI_SCOPE;
+
+
+class CSeqUtilConvertTestApp : public CNcbiApplication
+{
+public:
+    void Init(void);
+    int  Run (void);
+
+private:
+    enum EOperation {
+        eConvert,
+        eRevCmp,
+        eRevCmpInPlace
+    };
+    struct STest {
+        const char*       name;
+        EOperation        operation;
+        CSeqUtil::TCoding src_coding;
+        CSeqUtil::TCoding dst_coding;
+    };
+
+    // run the operation on residues [pos, pos+length) of src
+    static void x_Run(const STest& test, const vector<char>& src,
+                      TSeqPos pos, TSeqPos length, vector<char>& dst);
+    bool x_Check(const STest& test, const vector<char>& src);
+    double x_Time(const STest& test, const vector<char>& src, bool simd);
+
+    CRandom m_Random;
+    Uint8   m_TotalResidues;
+    TSeqPos m_ChunkResidues;
+};
+
+
+static const char kIupacna[] = "ACGTACGTACGTACGTACGTACGTACGTNacgtRYMKSWHBVD";
+
+
+void CSeqUtilConvertTestApp::Init(void)
+{
+    auto_ptr<CArgDescriptions> arg_desc(new CArgDescriptions);
+    arg_desc->SetUsageContext(GetArguments().GetProgramBasename(),
+                              "Vectorized sequtil conversions test");
+
+    arg_desc->AddDefaultKey("size", "MB",
+                            "Residues processed by every timed conversion, "
+                            "in millions",
+                            CArgDescriptions::eInteger, "256");
+    arg_desc->AddDefaultKey("chunk", "MB",
+                            "Residues converted by a single call, "
+                            "in millions",
+                            CArgDescriptions::eInteger, "16");
+    arg_desc->SetConstraint("chunk", new CArgAllow_Integers(1, 1024));
+    arg_desc->AddFlag("selftest",
+                      "Only compare results with the table driven code");
+
+    SetupArgDescriptions(arg_desc.release());
+}
+
+
+void CSeqUtilConvertTestApp::x_Run(const STest& test,
+                                   const vector<char>& src,
+                                   TSeqPos pos, TSeqPos length,
+                                   vector<char>& dst)
+{
+    switch ( test.operation ) {
+    case eConvert:
+        CSeqConvert::Convert(&src[0], test.src_coding, pos, length,
+                             &dst[0], test.dst_coding);
+        break;
+    case eRevCmp:
+        CSeqManip::ReverseComplement(&src[0], test.src_coding, pos, length,
+                                     &dst[0]);
+        break;
+    case eRevCmpInPlace:
+        copy(src.begin(), src.end(), dst.begin());
+        CSeqManip::ReverseComplement(&dst[0], test.src_coding, pos, length);
+        break;
+    }
+}
+
+
+bool CSeqUtilConvertTestApp::x_Check(const STest& test,
+                                     const vector<char>& src)
+{
+    TSeqPos src_residues = TSeqPos(src.size());
+    if ( test.src_coding == CSeqUtil::e_Ncbi2na ) {
+        src_residues *= 4;
+    }
+    else if ( test.src_coding == CSeqUtil::e_Ncbi4na ) {
+        src_residues *= 2;
+    }
+
+    for ( int i = 0; i < 2000; ++i ) {
+        TSeqPos pos = m_Random.GetRand(0, 40);
+        TSeqPos length = m_Random.GetRand(0, i < 1000 ? 300 : 5000);
+        if ( test.operation == eRevCmpInPlace ) {
+            // the packed in place versions work on the beginning of data
+            pos = 0;
+        }
+        length = min(length, src_residues - pos);
+
+        vector<char> dst_table(src_residues + 16, 0x55);
+        vector<char> dst_simd(src_residues + 16, 0x55);
+        CSeqUtil::SetSimdEnabled(false);
+        x_Run(test, src, pos, length, dst_table);
+        CSeqUtil::SetSimdEnabled(true);
+        x_Run(test, src, pos, length, dst_simd);
+        if ( dst_table != dst_simd ) {
+            ERR_POST(test.name << ": results differ for pos " << pos <<
+                     ", length " << length);
+            return false;
+        }
+    }
+    return true;
+}
+
+
+double CSeqUtilConvertTestApp::x_Time(const STest& test,
+                                      const vector<char>& src, bool simd)
+{
+    vector<char> dst(src.size() * 4 + 16);
+    CSeqUtil::SetSimdEnabled(simd);
+    CStopWatch sw(CStopWatch::eStart);
+    for ( Uint8 done = 0; done < m_TotalResidues; done += m_ChunkResidues ) {
+        x_Run(test, src, 0, m_ChunkResidues, dst);
+    }
+    CSeqUtil::SetSimdEnabled(true);
+    return sw.Elapsed();
+}
+
+
+int CSeqUtilConvertTestApp::Run(void)
+{
+    const CArgs& args = GetArgs();
+    m_TotalResidues = Uint8(args["size"].AsInteger()) * 1000000;
+    m_ChunkResidues = TSeqPos(args["chunk"].AsInteger()) * 1000000;
+    bool selftest = args["selftest"];
+
+    static const STest kTests[] = {
+        { "ncbi2na -> iupacna",  eConvert,
+          CSeqUtil::e_Ncbi2na,   CSeqUtil::e_Iupacna },
+        { "ncbi4na -> iupacna",  eConvert,
+          CSeqUtil::e_Ncbi4na,   CSeqUtil::e_Iupacna },
+        { "iupacna -> ncbi2na",  eConvert,
+          CSeqUtil::e_Iupacna,   CSeqUtil::e_Ncbi2na },
+        { "iupacna -> ncbi4na",  eConvert,
+          CSeqUtil::e_Iupacna,   CSeqUtil::e_Ncbi4na },
+        { "ncbi2na -> ncbi8na",  eConvert,
+          CSeqUtil::e_Ncbi2na,   CSeqUtil::e_Ncbi8na },
+        { "ncbi4na -> ncbi8na",  eConvert,
+          CSeqUtil::e_Ncbi4na,   CSeqUtil::e_Ncbi8na },
+        { "ncbi8na -> iupacna",  eConvert,
+          CSeqUtil::e_Ncbi8na,   CSeqUtil::e_Iupacna },
+        { "iupacna -> ncbi8na",  eConvert,
+          CSeqUtil::e_Iupacna,   CSeqUtil::e_Ncbi8na },
+        { "iupacna revcmp",      eRevCmp,
+          CSeqUtil::e_Iupacna,   CSeqUtil::e_Iupacna },
+        { "ncbi2na revcmp",      eRevCmp,
+          CSeqUtil::e_Ncbi2na,   CSeqUtil::e_Ncbi2na },
+        { "ncbi4na revcmp",      eRevCmp,
+          CSeqUtil::e_Ncbi4na,   CSeqUtil::e_Ncbi4na },
+        { "iupacna revcmp in place", eRevCmpInPlace,
+          CSeqUtil::e_Iupacna,   CSeqUtil::e_Iupacna },
+        { "ncbi4na revcmp in place", eRevCmpInPlace,
+          CSeqUtil::e_Ncbi4na,   CSeqUtil::e_Ncbi4na }
+    };
+
+    if ( !CSeqUtil::IsSimdEnabled() ) {
+        NcbiCout << "No vectorized kernels for this CPU or compiler, "
+                 << "only the table driven code is tested." << NcbiEndl;
+    }
+
+    // source data in every coding, derived from one iupacna sequence
+    size_t size = selftest ? 20000 : m_ChunkResidues;
+    string iupacna(size, 'A');
+    for ( size_t i = 0; i < size; ++i ) {
+        iupacna[i] = kIupacna[m_Random.GetRand(0, sizeof(kIupacna) - 2)];
+    }
+    vector<char> src[CSeqUtil::e_Ncbi8na + 1];
+    src[CSeqUtil::e_Iupacna].assign(iupacna.begin(), iupacna.end());
+    CSeqConvert::Convert(iupacna, CSeqUtil::e_Iupacna, 0, TSeqPos(size),
+                         src[CSeqUtil::e_Ncbi2na], CSeqUtil::e_Ncbi2na);
+    CSeqConvert::Convert(iupacna, CSeqUtil::e_Iupacna, 0, TSeqPos(size),
+                         src[CSeqUtil::e_Ncbi4na], CSeqUtil::e_Ncbi4na);
+    CSeqConvert::Convert(iupacna, CSeqUtil::e_Iupacna, 0, TSeqPos(size),
+                         src[CSeqUtil::e_Ncbi8na], CSeqUtil::e_Ncbi8na);
+
+    int errors = 0;
+    for ( size_t i = 0; i < ArraySize(kTests); ++i ) {
+        const STest& test = kTests[i];
+        const vector<char>& data = src[test.src_coding];
+        if ( selftest ) {
+            if ( !x_Check(test, data) ) {
+                ++errors;
+            }
+            continue;
+        }
+        double table_time = x_Time(test, data, false);
+        double simd_time = x_Time(test, data, true);
+        double mres = double(m_TotalResidues) / 1000000;
+        NcbiCout << setw(24) << left << test.name << right << fixed
+                 << setprecision(0)
+                 << " table: " << setw(6) << mres / table_time << " Mres/s"
+                 << "  simd: " << setw(6) << mres / simd_time << " Mres/s"
+                 << "  x" << setprecision(2) << table_time / simd_time
+                 << NcbiEndl;
+    }
+    if ( errors ) {
+        ERR_POST(errors << " conversions failed");
+        return 1;
+    }
+    NcbiCout << "Passed" << NcbiEndl;
+    return 0;
+}
+
+
+int main(int argc, const char* argv[])
+{
+    return CSeqUtilConvertTestApp().AppMain(argc, argv);
+}
@@ -71,7 +71,9 @@ enum ECheckCancelType {
 
 static CRandom                           s_RNG;
 static CAtomicCounter                    s_SerialNum;
-static CThreadPool*                      s_Pool;
+// The main test runs one pool per scheduling mode; each task goes to
+// the pool selected by its number, flushes and mass cancels go to both
+static CThreadPool*                      s_Pools[2];
 static CStopWatch                        s_Timer;
 
 static vector<EActionType>               s_Actions;
@@ -182,9 +184,13 @@ bool CThreadPoolTester::TestApp_Init(void)
     for (unsigned j = 0; j < 300; j++) {
         unsigned min_threads, max_threads;
         GetMinMaxThreads(&min_threads, &max_threads);
+        CThreadPool::EScheduling scheduling = j % 2
+            ? CThreadPool::eWorkStealing : CThreadPool::ePriorityQueue;
         MSG_POST("Terminator task test. Round: " << j <<
-                 ", min/max threads: " << min_threads << "/" << max_threads);
-        CThreadPool tp(100, max_threads, min_threads);
+                 ", min/max threads: " << min_threads << "/" << max_threads <<
+                 ", work stealing: " << (j % 2));
+        CThreadPool tp(100, max_threads, min_threads, CThread::fRunDefault,
+                       scheduling);
         _ASSERT(s_TaskCounter.Get() == 0);
         for (unsigned i = 0;  i < 98;  i++) {
             tp.AddTask(new CSentinelThreadPool_Task(i));
@@ -196,41 +202,51 @@ bool CThreadPoolTester::TestApp_Init(void)
             s_ZeroSleep = true;
     }
 
-    unsigned min_threads, max_threads;
-    GetMinMaxThreads(&min_threads, &max_threads);
+    for (int stealing = 0;  stealing < 2;  ++stealing) {
+        unsigned min_threads, max_threads;
+        GetMinMaxThreads(&min_threads, &max_threads);
 
-    MSG_POST("One-off exclusive task test, with min/max threads: "
-             << min_threads << "/" << max_threads);
+        MSG_POST("One-off exclusive task test, with min/max threads: "
+                 << min_threads << "/" << max_threads
+                 << ", work stealing: " << stealing);
 
-    CThreadPool tp(100, max_threads, min_threads);
+        CThreadPool tp(100, max_threads, min_threads, CThread::fRunDefault,
+                       stealing ? CThreadPool::eWorkStealing
+                                : CThreadPool::ePriorityQueue);
 
-    _ASSERT(s_TaskCounter.Get() == 0);
-    for (unsigned i = 0;  i < 50;  i++) {
-         tp.AddTask(new CSentinelThreadPool_Task(i));
-    }
-    MSG_POST("(1) Attaching terminator");
-    CTerminator_Task::Wait
-        (tp, CThreadPool::fExecuteQueuedTasks | CThreadPool::fFlushThreads);
-    _ASSERT(s_TaskCounter.Get() == 0);
-    _ASSERT(!tp.GetQueuedTasksCount());
-    _ASSERT(!tp.GetExecutingTasksCount());
-    MSG_POST("(1) Finished");
-
-    _ASSERT(s_TaskCounter.Get() == 0);
-    for (unsigned i = 51;  i < 100;  i++) {
-         tp.AddTask(new CSentinelThreadPool_Task(i));
+        _ASSERT(s_TaskCounter.Get() == 0);
+        for (unsigned i = 0;  i < 50;  i++) {
+             tp.AddTask(new CSentinelThreadPool_Task(i));
+        }
+        MSG_POST("(1) Attaching terminator");
+        CTerminator_Task::Wait
+            (tp, CThreadPool::fExecuteQueuedTasks | CThreadPool::fFlushThreads);
+        _ASSERT(s_TaskCounter.Get() == 0);
+        _ASSERT(!tp.GetQueuedTasksCount());
+        _ASSERT(!tp.GetExecutingTasksCount());
+        MSG_POST("(1) Finished");
+
+        _ASSERT(s_TaskCounter.Get() == 0);
+        for (unsigned i = 51;  i < 100;  i++) {
+             tp.AddTask(new CSentinelThreadPool_Task(i));
+        }
+        MSG_POST("(2) Attaching terminator");
+        CTerminator_Task::Wait
+            (tp, CThreadPool::fExecuteQueuedTasks);
+        _ASSERT(s_TaskCounter.Get() == 0);
+        _ASSERT(!tp.GetQueuedTasksCount());
+        _ASSERT(!tp.GetExecutingTasksCount());
+        MSG_POST("(2) Finished");
     }
-    MSG_POST("(2) Attaching terminator");
-    CTerminator_Task::Wait
-        (tp, CThreadPool::fExecuteQueuedTasks);
-    _ASSERT(s_TaskCounter.Get() == 0);
-    _ASSERT(!tp.GetQueuedTasksCount());
-    _ASSERT(!tp.GetExecutingTasksCount());
-    MSG_POST("(2) Finished");
 
 
     //
-    s_Pool = new CThreadPool(kQueueSize, kMaxThreads);
+    s_Pools[0] = new CThreadPool(kQueueSize, kMaxThreads, 2,
+                                 CThread::fRunDefault,
+                                 CThreadPool::ePriorityQueue);
+    s_Pools[1] = new CThreadPool(kQueueSize, kMaxThreads, 2,
+                                 CThread::fRunDefault,
+                                 CThreadPool::eWorkStealing);
 
     if (s_NumThreads > kQueueSize) {
         s_NumThreads = kQueueSize;
@@ -288,8 +304,10 @@ bool CThreadPoolTester::TestApp_Exit(void)
     MSG_POST("ATTENTION: Can have warnings about the yet unprocessed tasks"
              " being canceled. It's a part of the test; making sure here that"
              " it is handled reasonably gracefully");
-    delete s_Pool;
-    s_Pool = NULL;
+    for (int i = 0;  i < 2;  ++i) {
+        delete s_Pools[i];
+        s_Pools[i] = NULL;
+    }
     MSG_POST("Exiting from app");
     MSG_POST("Test for CThreadPool is finished");
 
@@ -386,13 +404,14 @@ bool CThreadPoolTester::Thread_Run(int /*idx*/)
             switch (s_Actions[serial_num]) {
             case eAddTask:
                 MSG_POST("Task " << req_num << " to be queued");
-                s_Pool->AddTask(new CTestTask(req_num));
+                s_Pools[req_num % 2]->AddTask(new CTestTask(req_num));
                 MSG_POST("Task " << req_num << " queued");
                 break;
 
             case eAddExclusiveTask:
                 MSG_POST("Task " << req_num << " to be queued");
-                s_Pool->RequestExclusiveExecution(new CExclusiveTask(req_num),
+                s_Pools[req_num % 2]->RequestExclusiveExecution(
+                                new CExclusiveTask(req_num),
                                 CThreadPool::fFlushThreads
                                 + CThreadPool::fCancelExecutingTasks
                                 + CThreadPool::fCancelQueuedTasks);
@@ -404,7 +423,7 @@ bool CThreadPoolTester::Thread_Run(int /*idx*/)
                     SleepMilliSec(10);
                 }
                 MSG_POST("Task " << req_num << " to be cancelled");
-                s_Pool->CancelTask(s_Tasks[req_num]);
+                s_Pools[req_num % 2]->CancelTask(s_Tasks[req_num]);
                 MSG_POST("Cancelation of task " << req_num << " requested");
                 break;
 
@@ -413,17 +432,21 @@ bool CThreadPoolTester::Thread_Run(int /*idx*/)
                 MSG_POST("Flushing threads with "
                             << (s_Actions[serial_num] == eFlushWaiting?
                                     "waiting": "immediate restart"));
-                s_Pool->FlushThreads(
+                for (int p = 0;  p < 2;  ++p) {
+                    s_Pools[p]->FlushThreads(
                                 s_Actions[serial_num] == eFlushWaiting?
                                         CThreadPool::eWaitToFinish:
                                         CThreadPool::eStartImmediately);
+                }
                 MSG_POST("Flushing process began");
                 break;
 
             case eCancelAll:
                 MSG_POST("Cancelling all tasks");
-                s_Pool->CancelTasks(CThreadPool::fCancelExecutingTasks
-                                     + CThreadPool::fCancelQueuedTasks);
+                for (int p = 0;  p < 2;  ++p) {
+                    s_Pools[p]->CancelTasks(CThreadPool::fCancelExecutingTasks
+                                            + CThreadPool::fCancelQueuedTasks);
+                }
                 MSG_POST("Cancellation of all tasks requested");
                 break;
             }
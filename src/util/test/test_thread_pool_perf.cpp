@@ -0,0 +1,207 @@
+/*  $Id$
+ * ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ *
+ * File Description:
+ *   CThreadPool throughput with many small tasks: priority queue vs.
+ *   work stealing scheduling.
+ *
+ */
+
+#include <ncbi_pch.hpp>
+#include <corelib/ncbiapp.hpp>
+#include <corelib/ncbiargs.hpp>
+#include <corelib/ncbithr.hpp>
+#include <corelib/ncbitime.hpp>
+#include <util/thread_pool.hpp>
+
+#include <common/test_assert.h>  /* This header must go last */
+
+USING_NCBI_SCOPE;
+
+
+static CAtomicCounter s_Remaining;
+static CSemaphore     s_Done(0, 1);
+
+
+/// Small task; optionally adds more tasks to the pool
+class CPerfTask : public CThreadPool_Task
+{
+public:
+    CPerfTask(CThreadPool& pool, int work, int children)
+        : m_Pool(pool), m_Work(work), m_Children(children)
+    {}
+
+    virtual EStatus Execute(void)
+    {
+        for (int i = 0;  i < m_Children;  ++i) {
+            m_Pool.AddTask(new CPerfTask(m_Pool, m_Work, 0));
+        }
+        volatile unsigned int x = 0;
+        for (int i = 0;  i < m_Work;  ++i) {
+            x = x * 31 + i;
+        }
+        if (s_Remaining.Add(-1) == 0) {
+            s_Done.Post();
+        }
+        return eCompleted;
+    }
+
+private:
+    CThreadPool& m_Pool;
+    int          m_Work;
+    int          m_Children;
+};
+
+
+/// Thread adding tasks to the pool
+class CProducer : public CThread
+{
+public:
+    CProducer(CThreadPool& pool, int tasks, int work, int children)
+        : m_Pool(pool), m_Tasks(tasks), m_Work(work), m_Children(children)
+    {}
+
+protected:
+    virtual void* Main(void)
+    {
+        for (int i = 0;  i < m_Tasks;  ++i) {
+            m_Pool.AddTask(new CPerfTask(m_Pool, m_Work, m_Children));
+        }
+        return NULL;
+    }
+
+private:
+    CThreadPool& m_Pool;
+    int          m_Tasks;
+    int          m_Work;
+    int          m_Children;
+};
+
+
+class CThreadPoolPerfApp : public CNcbiApplication
+{
+public:
+    virtual void Init(void);
+    virtual int  Run (void);
+
+private:
+    double x_Run(CThreadPool::EScheduling scheduling);
+};
+
+
+void CThreadPoolPerfApp::Init(void)
+{
+    auto_ptr<CArgDescriptions> arg_desc(new CArgDescriptions);
+    arg_desc->SetUsageContext(GetArguments().GetProgramBasename(),
+                              "CThreadPool scheduling throughput test");
+
+    arg_desc->AddDefaultKey("threads", "N", "Number of threads in the pool",
+                            CArgDescriptions::eInteger, "8");
+    arg_desc->AddDefaultKey("producers", "N",
+                            "Number of threads adding tasks",
+                            CArgDescriptions::eInteger, "2");
+    arg_desc->AddDefaultKey("tasks", "N",
+                            "Number of tasks added by every producer",
+                            CArgDescriptions::eInteger, "100000");
+    arg_desc->AddDefaultKey("children", "N",
+                            "Number of tasks every task adds to the pool",
+                            CArgDescriptions::eInteger, "0");
+    arg_desc->AddDefaultKey("work", "N",
+                            "Amount of work in every task (loop iterations)",
+                            CArgDescriptions::eInteger, "100");
+    arg_desc->AddDefaultKey("queue", "N", "Maximum size of the pool queue",
+                            CArgDescriptions::eInteger, "10000");
+    arg_desc->AddDefaultKey("scheduling", "Mode", "Scheduling to test",
+                            CArgDescriptions::eString, "both");
+    arg_desc->SetConstraint("scheduling",
+                            &(*new CArgAllow_Strings, "priority", "stealing",
+                              "both"));
+
+    SetupArgDescriptions(arg_desc.release());
+}
+
+
+double CThreadPoolPerfApp::x_Run(CThreadPool::EScheduling scheduling)
+{
+    const CArgs& args = GetArgs();
+    int threads   = args["threads"].AsInteger();
+    int producers = args["producers"].AsInteger();
+    int tasks     = args["tasks"].AsInteger();
+    int children  = args["children"].AsInteger();
+    int work      = args["work"].AsInteger();
+
+    int total     = producers * tasks * (children + 1);
+
+    // Tasks adding tasks must never wait for room in the queue, otherwise
+    // all threads of the pool can get blocked
+    int queue = children ? total : args["queue"].AsInteger();
+    CThreadPool pool(queue, threads, threads, CThread::fRunDefault,
+                     scheduling);
+    s_Remaining.Set(total);
+
+    CStopWatch sw(CStopWatch::eStart);
+    vector< CRef<CProducer> > producer_threads;
+    for (int i = 0;  i < producers;  ++i) {
+        producer_threads.push_back(
+            CRef<CProducer>(new CProducer(pool, tasks, work, children)));
+        producer_threads.back()->Run();
+    }
+    NON_CONST_ITERATE(vector< CRef<CProducer> >, it, producer_threads) {
+        (*it)->Join();
+    }
+    s_Done.Wait();
+    double elapsed = sw.Elapsed();
+
+    _ASSERT(s_Remaining.Get() == 0);
+    _ASSERT(pool.GetQueuedTasksCount() == 0);
+    return elapsed;
+}
+
+
+int CThreadPoolPerfApp::Run(void)
+{
+    const CArgs& args = GetArgs();
+    string mode = args["scheduling"].AsString();
+    double total = double(args["producers"].AsInteger())
+        * args["tasks"].AsInteger() * (args["children"].AsInteger() + 1);
+
+    if (mode != "stealing") {
+        double t = x_Run(CThreadPool::ePriorityQueue);
+        NcbiCout << "priority queue: " << t << " s, "
+                 << size_t(total / t) << " tasks/s" << NcbiEndl;
+    }
+    if (mode != "priority") {
+        double t = x_Run(CThreadPool::eWorkStealing);
+        NcbiCout << "work stealing:  " << t << " s, "
+                 << size_t(total / t) << " tasks/s" << NcbiEndl;
+    }
+    return 0;
+}
+
+
+int main(int argc, const char* argv[])
+{
+    return CThreadPoolPerfApp().AppMain(argc, argv);
+}
@@ -54,6 +54,19 @@ struct SThreadPool_TaskCompare {
 };
 
 
+/// Queue of one thread in the work stealing mode
+struct SThreadPool_WorkQueue {
+    SThreadPool_WorkQueue(void) : size(0) {}
+
+    /// Guards access to the queue
+    CFastMutex                     mutex;
+    /// Tasks, the owner takes them from the front, others from the back
+    deque< CRef<CThreadPool_Task> > tasks;
+    /// Number of tasks, can be read without the mutex as a hint
+    volatile size_t                size;
+};
+
+
 /// Real implementation of all ThreadPool functions
 class CThreadPool_Impl : public CObject
 {
@@ -90,7 +103,9 @@ public:
                      unsigned int      queue_size,
                      unsigned int      max_threads,
                      unsigned int      min_threads,
-                     CThread::TRunMode threads_mode = CThread::fRunDefault);
+                     CThread::TRunMode threads_mode = CThread::fRunDefault,
+                     CThreadPool::EScheduling scheduling
+                                       = CThreadPool::ePriorityQueue);
 
     /// Constructor with explicitly given controller
     /// @param pool_intf
@@ -100,7 +115,9 @@ public:
     CThreadPool_Impl(CThreadPool*        pool_intf,
                      unsigned int        queue_size,
                      CThreadPool_Controller* controller,
-                     CThread::TRunMode   threads_mode = CThread::fRunDefault);
+                     CThread::TRunMode   threads_mode = CThread::fRunDefault,
+                     CThreadPool::EScheduling scheduling
+                                         = CThreadPool::ePriorityQueue);
 
     /// Get pointer to ThreadPool interface object
     CThreadPool* GetPoolInterface(void) const;
@@ -178,7 +195,12 @@ public:
 
     /// Get next task from queue if there is one
     /// If the queue is empty then return NULL.
-    CRef<CThreadPool_Task> TryGetNextTask(void);
+    /// @param thread
+    ///   Thread asking for the task
+    CRef<CThreadPool_Task> TryGetNextTask(CThreadPool_ThreadImpl* thread);
+
+    /// Choose the queue for the new thread in the work stealing mode
+    unsigned int AssignWorkQueue(void);
 
     /// Callback from thread when it is starting to execute task
     void TaskStarting(void);
@@ -276,9 +298,10 @@ private:
     ///   ThreadPool interface object attached to this implementation
     /// @param controller
     ///   Controller for the pool
-    void x_Init(CThreadPool*            pool_intf,
-                CThreadPool_Controller* controller,
-                CThread::TRunMode       threads_mode);
+    void x_Init(CThreadPool*             pool_intf,
+                CThreadPool_Controller*  controller,
+                CThread::TRunMode        threads_mode,
+                CThreadPool::EScheduling scheduling);
 
     /// Destructor. Will be called from CRef
     ~CThreadPool_Impl(void);
@@ -290,6 +313,16 @@ private:
     /// Cancel all tasks waiting in the queue
     void x_CancelQueuedTasks(void);
 
+    /// Put the task to one of the queues in the work stealing mode
+    void x_PushWorkTask(CThreadPool_Task* task, const CTimeSpan* timeout);
+
+    /// Take the task from the thread's own queue or from some other one
+    /// in the work stealing mode
+    CRef<CThreadPool_Task> x_PopWorkTask(unsigned int own_queue);
+
+    /// Wake up idle threads to process queued tasks
+    void x_WakeUpIdleThreads(void);
+
     /// Cancel all currently executing tasks
     void x_CancelExecutingTasks(void);
 
@@ -390,6 +423,19 @@ private:
     CRef<CThreadPool_ServiceThread>  m_ServiceThread;
     /// Queue for information about exclusive tasks
     TExclusiveQueue                  m_ExclusiveQueue;
+    /// If tasks are scheduled with work stealing (m_Queue is not used then)
+    bool                             m_WorkStealing;
+    /// Per thread queues for the work stealing mode
+    vector< AutoPtr<SThreadPool_WorkQueue> > m_WorkQueues;
+    /// Number of tasks in all m_WorkQueues
+    CAtomicCounter                   m_WorkQueuedTasks;
+    /// Queue to assign to the next thread and to put the next task
+    /// added from outside of the pool to
+    CAtomicCounter                   m_NextWorkQueue;
+    /// Semaphore for waiting for room in m_WorkQueues
+    CSemaphore                       m_WorkRoomWait;
+    /// Number of threads in m_IdleThreads, can be read without the mutex
+    CAtomicCounter                   m_IdleThreadsCount;
 };
 
 
@@ -452,6 +498,9 @@ public:
     /// Request to cancel current task execution
     void CancelCurrentTask(void);
 
+    /// Get own queue of the thread in the work stealing mode
+    unsigned int GetWorkQueue(void) const;
+
     /// Implementation of thread Main() method
     ///
     /// @sa CThreadPool_Thread::Main()
@@ -497,6 +546,8 @@ private:
     CSemaphore                   m_IdleTrigger;
     /// General-use mutex for very (very!) trivial ops
     mutable CFastMutex           m_FastMutex;
+    /// Own queue in the work stealing mode
+    const unsigned int           m_WorkQueue;
 };
 
 
@@ -731,6 +782,9 @@ CThreadPool_Impl::GetThreadsCount(void) const
 inline unsigned int
 CThreadPool_Impl::GetQueuedTasksCount(void) const
 {
+    if (m_WorkStealing) {
+        return (unsigned int)m_WorkQueuedTasks.Get();
+    }
     return (unsigned int)m_Queue.GetSize();
 }
 
@@ -820,7 +874,9 @@ CThreadPool_Impl::ThreadStopped(CThreadPool_ThreadImpl* thread)
 
     m_ThreadsCount.Add(-1);
 
-    m_IdleThreads.erase(thread);
+    if (m_IdleThreads.erase(thread) != 0) {
+        m_IdleThreadsCount.Add(-1);
+    }
     m_WorkingThreads.erase(thread);
 
     CallControllerOther();
@@ -829,8 +885,15 @@ CThreadPool_Impl::ThreadStopped(CThreadPool_ThreadImpl* thread)
 }
 
 inline CRef<CThreadPool_Task>
-CThreadPool_Impl::TryGetNextTask(void)
+CThreadPool_Impl::TryGetNextTask(CThreadPool_ThreadImpl* thread)
 {
+    if (m_WorkStealing) {
+        if ( !m_Suspended ) {
+            return x_PopWorkTask(thread->GetWorkQueue());
+        }
+        return CRef<CThreadPool_Task>();
+    }
+
     if ( !m_Suspended ) {
         TQueue::TAccessGuard guard(m_Queue);
 
@@ -1207,7 +1270,8 @@ CThreadPool_ThreadImpl::CThreadPool_ThreadImpl
     m_Finishing(false),
     m_CancelRequested(false),
     m_IsIdle(true),
-    m_IdleTrigger(0, kMax_Int)
+    m_IdleTrigger(0, kMax_Int),
+    m_WorkQueue(pool->AssignWorkQueue())
 {}
 
 inline
@@ -1226,6 +1290,12 @@ CThreadPool_ThreadImpl::IsFinishing(void) const
     return m_Finishing;
 }
 
+inline unsigned int
+CThreadPool_ThreadImpl::GetWorkQueue(void) const
+{
+    return m_WorkQueue;
+}
+
 inline CRef<CThreadPool_Task>
 CThreadPool_ThreadImpl::GetCurrentTask(void) const
 {
@@ -1307,7 +1377,7 @@ CThreadPool_ThreadImpl::Main(void)
         m_CancelRequested = false;
 
         {{
-            CRef<CThreadPool_Task> task = m_Pool->TryGetNextTask();
+            CRef<CThreadPool_Task> task = m_Pool->TryGetNextTask(this);
             CFastMutexGuard fast_guard(m_FastMutex);
             m_CurrentTask = task;
         }}
@@ -1406,32 +1476,37 @@ CThreadPool_Impl::CThreadPool_Impl(CThreadPool*      pool_intf,
                                    unsigned int      queue_size,
                                    unsigned int      max_threads,
                                    unsigned int      min_threads,
-                                   CThread::TRunMode threads_mode)
+                                   CThread::TRunMode threads_mode,
+                                   CThreadPool::EScheduling scheduling)
     : m_Queue(x_GetQueueSize(queue_size)),
       m_RoomWait(0, kMax_Int),
-      m_AbortWait(0, kMax_Int)
+      m_AbortWait(0, kMax_Int),
+      m_WorkRoomWait(0, kMax_Int)
 {
     x_Init(pool_intf,
            new CThreadPool_Controller_PID(max_threads, min_threads),
-           threads_mode);
+           threads_mode, scheduling);
 }
 
 inline
 CThreadPool_Impl::CThreadPool_Impl(CThreadPool*            pool_intf,
                                    unsigned int            queue_size,
                                    CThreadPool_Controller* controller,
-                                   CThread::TRunMode       threads_mode)
+                                   CThread::TRunMode       threads_mode,
+                                   CThreadPool::EScheduling scheduling)
     : m_Queue(x_GetQueueSize(queue_size)),
       m_RoomWait(0, kMax_Int),
-      m_AbortWait(0, kMax_Int)
+      m_AbortWait(0, kMax_Int),
+      m_WorkRoomWait(0, kMax_Int)
 {
-    x_Init(pool_intf, controller, threads_mode);
+    x_Init(pool_intf, controller, threads_mode, scheduling);
 }
 
 void
 CThreadPool_Impl::x_Init(CThreadPool*             pool_intf,
                          CThreadPool_Controller*  controller,
-                         CThread::TRunMode        threads_mode)
+                         CThread::TRunMode        threads_mode,
+                         CThreadPool::EScheduling scheduling)
 {
     m_Interface = pool_intf;
     m_SelfRef = this;
@@ -1445,6 +1520,20 @@ CThreadPool_Impl::x_Init(CThreadPool*             pool_intf,
     m_ThreadsMode = (threads_mode | CThread::fRunDetached)
                      & ~CThread::fRunAllowST;
 
+    m_WorkStealing = scheduling == CThreadPool::eWorkStealing;
+    m_WorkQueuedTasks.Set(0);
+    m_NextWorkQueue.Set(0);
+    m_IdleThreadsCount.Set(0);
+    if (m_WorkStealing) {
+        // One queue per thread; if the controller raises the maximum
+        // later some threads will share their queues
+        unsigned int n_queues = max(controller->GetMaxThreads(), 1u);
+        m_WorkQueues.resize(n_queues);
+        for (unsigned int i = 0;  i < n_queues;  ++i) {
+            m_WorkQueues[i].reset(new SThreadPool_WorkQueue());
+        }
+    }
+
     controller->x_AttachToPool(this);
     m_Controller = controller;
 
@@ -1490,6 +1579,7 @@ CThreadPool_Impl::LaunchThreads(unsigned int count)
         CRef<CThreadPool_Thread> thread(m_Interface->CreateThread());
         m_IdleThreads.insert(
                         CThreadPool_ThreadImpl::s_GetImplPointer(thread));
+        m_IdleThreadsCount.Add(1);
         thread->Run(m_ThreadsMode);
     }
 
@@ -1539,7 +1629,13 @@ CThreadPool_Impl::SetThreadIdle(CThreadPool_ThreadImpl* thread, bool is_idle)
 {
     CThreadPool_Guard guard(this);
 
-    if (is_idle  &&  !m_Suspended  &&  m_Queue.GetSize() != 0) {
+    // The counter goes up before checking the queue: AddTask() in the work
+    // stealing mode checks it after queueing without taking the mutex.
+    if (is_idle) {
+        m_IdleThreadsCount.Add(1);
+    }
+    if (is_idle  &&  !m_Suspended  &&  GetQueuedTasksCount() != 0) {
+        m_IdleThreadsCount.Add(-1);
         thread->WakeUp();
         return false;
     }
@@ -1558,6 +1654,13 @@ CThreadPool_Impl::SetThreadIdle(CThreadPool_ThreadImpl* thread, bool is_idle)
     TThreadsList::iterator it = to_del->find(thread);
     if (it != to_del->end()) {
         to_del->erase(it);
+        if ( !is_idle ) {
+            m_IdleThreadsCount.Add(-1);
+        }
+    }
+    else if (is_idle) {
+        // Thread was already in the list of idle ones
+        m_IdleThreadsCount.Add(-1);
     }
     to_ins->insert(thread);
 
@@ -1691,7 +1794,12 @@ CThreadPool_Impl::AddTask(CThreadPool_Task* task, const CTimeSpan* timeout)
     try {
         // Pushing to queue must be out of mutex to be able to wait
         // for available space.
-        m_Queue.Push(Ref(task), timeout);
+        if (m_WorkStealing) {
+            x_PushWorkTask(task, timeout);
+        }
+        else {
+            m_Queue.Push(Ref(task), timeout);
+        }
     }
     catch (...) {
         task->x_SetStatus(CThreadPool_Task::eIdle);
@@ -1699,6 +1807,27 @@ CThreadPool_Impl::AddTask(CThreadPool_Task* task, const CTimeSpan* timeout)
         throw;
     }
 
+    if (m_WorkStealing  &&  m_IsQueueAllowed) {
+        // Threads take tasks from the queues without the pool mutex, so
+        // it is needed only if some of them sleep
+        CThreadPool::TExclusiveFlags check_flags
+            = CThreadPool::fDoNotAllowNewTasks
+              | CThreadPool::fCancelQueuedTasks;
+        if (m_Aborted  ||  (m_Suspended
+                            &&  (m_SuspendFlags & check_flags) == check_flags))
+        {
+            x_CancelQueuedTasks();
+            return;
+        }
+        m_TotalTasks.Add(1);
+        if (m_IdleThreadsCount.Get() != 0) {
+            guard.Guard();
+            x_WakeUpIdleThreads();
+        }
+        CallControllerOther();
+        return;
+    }
+
     if (m_IsQueueAllowed) {
         guard.Guard();
     }
@@ -1711,7 +1840,7 @@ CThreadPool_Impl::AddTask(CThreadPool_Task* task, const CTimeSpan* timeout)
     if (m_Aborted  ||  (m_Suspended
                         &&  (m_SuspendFlags & check_flags)  == check_flags))
     {
-        if (m_Queue.GetSize() != 0) {
+        if (GetQueuedTasksCount() != 0) {
             x_CancelQueuedTasks();
         }
         return;
@@ -1723,24 +1852,140 @@ CThreadPool_Impl::AddTask(CThreadPool_Task* task, const CTimeSpan* timeout)
         LaunchThreads(cnt_req - GetThreadsCount());
     }
 
+    x_WakeUpIdleThreads();
+
+    CallControllerOther();
+}
+
+void
+CThreadPool_Impl::x_WakeUpIdleThreads(void)
+{
     if (! m_Suspended) {
         int count = GetQueuedTasksCount();
         ITERATE(TThreadsList, it, m_IdleThreads) {
             if (! (*it)->IsFinishing()) {
                 (*it)->WakeUp();
                 --count;
-                if (count == 0)
+                if (count <= 0)
                     break;
             }
         }
     }
+}
 
-    CallControllerOther();
+unsigned int
+CThreadPool_Impl::AssignWorkQueue(void)
+{
+    if ( !m_WorkStealing ) {
+        return 0;
+    }
+    return (unsigned int)(m_NextWorkQueue.Add(1) % m_WorkQueues.size());
+}
+
+void
+CThreadPool_Impl::x_PushWorkTask(CThreadPool_Task* task,
+                                 const CTimeSpan*  timeout)
+{
+    // Wait for room in the queues the same way CSyncQueue does it
+    CAtomicCounter::TValue max_size = m_Queue.GetMaxSize();
+    if (m_WorkQueuedTasks.Get() >= max_size) {
+        CStopWatch timer(CStopWatch::eStart);
+        while (m_WorkQueuedTasks.Get() >= max_size) {
+            // Re-check periodically: the room can be taken by another thread
+            // right after the semaphore is posted
+            double wait_time = 0.01;
+            if (timeout) {
+                double left = timeout->GetAsDouble() - timer.Elapsed();
+                if (left <= 0) {
+                    NCBI_THROW(CSyncQueueException, eNoRoom,
+                               "Cannot add task - the queue is full");
+                }
+                wait_time = min(wait_time, left);
+            }
+            m_WorkRoomWait.TryWait(CTimeout(wait_time));
+        }
+    }
+
+    // Tasks added from the pool's own thread stay with that thread
+    unsigned int idx;
+    CThreadPool_Thread* thread =
+        dynamic_cast<CThreadPool_Thread*>(CThread::GetCurrentThread());
+    CThreadPool_ThreadImpl* thread_impl = thread
+        ? CThreadPool_ThreadImpl::s_GetImplPointer(thread) : NULL;
+    if (thread_impl  &&  thread_impl->GetPool() == m_Interface) {
+        idx = thread_impl->GetWorkQueue();
+    }
+    else {
+        idx = (unsigned int)(m_NextWorkQueue.Add(1) % m_WorkQueues.size());
+    }
+
+    SThreadPool_WorkQueue& queue = *m_WorkQueues[idx];
+    {{
+        CFastMutexGuard guard(queue.mutex);
+        // Count the task before it becomes visible to the workers,
+        // otherwise a worker may pop it and decrement the counter first
+        m_WorkQueuedTasks.Add(1);
+        queue.tasks.push_back(Ref(task));
+        queue.size = queue.tasks.size();
+    }}
+}
+
+CRef<CThreadPool_Task>
+CThreadPool_Impl::x_PopWorkTask(unsigned int own_queue)
+{
+    CRef<CThreadPool_Task> task;
+    size_t n_queues = m_WorkQueues.size();
+    for (size_t i = 0;  i < n_queues  &&  task.IsNull();  ++i) {
+        SThreadPool_WorkQueue& queue = *m_WorkQueues[(own_queue + i)
+                                                     % n_queues];
+        if (queue.size == 0) {
+            continue;
+        }
+        CFastMutexGuard guard(queue.mutex);
+        if (queue.tasks.empty()) {
+            continue;
+        }
+        if (i == 0) {
+            task.Swap(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+        else {
+            // Steal from the other end to interfere less with the owner
+            task.Swap(queue.tasks.back());
+            queue.tasks.pop_back();
+        }
+        queue.size = queue.tasks.size();
+    }
+
+    if (task.NotNull()  &&
+        m_WorkQueuedTasks.Add(-1) + 1 >= (CAtomicCounter::TValue)
+                                         m_Queue.GetMaxSize())
+    {
+        m_WorkRoomWait.Post();
+    }
+    return task;
 }
 
 inline void
 CThreadPool_Impl::x_RemoveTaskFromQueue(const CThreadPool_Task* task)
 {
+    if (m_WorkStealing) {
+        for (size_t i = 0;  i < m_WorkQueues.size();  ++i) {
+            SThreadPool_WorkQueue& queue = *m_WorkQueues[i];
+            CFastMutexGuard guard(queue.mutex);
+            NON_CONST_ITERATE(deque< CRef<CThreadPool_Task> >, it,
+                              queue.tasks) {
+                if (*it == task) {
+                    queue.tasks.erase(it);
+                    queue.size = queue.tasks.size();
+                    m_WorkQueuedTasks.Add(-1);
+                    return;
+                }
+            }
+        }
+        return;
+    }
+
     TQueue::TAccessGuard q_guard(m_Queue);
 
     TQueue::TAccessGuard::TIterator it = q_guard.Begin();
@@ -1848,6 +2093,23 @@ CThreadPool_Impl::x_CancelExecutingTasks(void)
 void
 CThreadPool_Impl::x_CancelQueuedTasks(void)
 {
+    if (m_WorkStealing) {
+        for (size_t i = 0;  i < m_WorkQueues.size();  ++i) {
+            SThreadPool_WorkQueue& queue = *m_WorkQueues[i];
+            CFastMutexGuard guard(queue.mutex);
+            NON_CONST_ITERATE(deque< CRef<CThreadPool_Task> >, it,
+                              queue.tasks) {
+                it->GetNCPointer()->x_RequestToCancel();
+            }
+            m_WorkQueuedTasks.Add(-(CAtomicCounter::TValue)
+                                  queue.tasks.size());
+            queue.tasks.clear();
+            queue.size = 0;
+        }
+        m_WorkRoomWait.Post();
+        return;
+    }
+
     TQueue::TAccessGuard q_guard(m_Queue);
 
     for (TQueue::TAccessGuard::TIterator it = q_guard.Begin();
@@ -2160,18 +2422,21 @@ CThreadPool_Thread::OnExit(void)
 CThreadPool::CThreadPool(unsigned int      queue_size,
                          unsigned int      max_threads,
                          unsigned int      min_threads,
-                         CThread::TRunMode threads_mode)
+                         CThread::TRunMode threads_mode,
+                         EScheduling       scheduling)
 {
     m_Impl = new CThreadPool_Impl(this, queue_size, max_threads, min_threads,
-                                  threads_mode);
+                                  threads_mode, scheduling);
     m_Impl->SetInterfaceStarted();
 }
 
 CThreadPool::CThreadPool(unsigned int            queue_size,
                          CThreadPool_Controller* controller,
-                         CThread::TRunMode       threads_mode)
+                         CThread::TRunMode       threads_mode,
+                         EScheduling             scheduling)
 {
-    m_Impl = new CThreadPool_Impl(this, queue_size, controller, threads_mode);
+    m_Impl = new CThreadPool_Impl(this, queue_size, controller, threads_mode,
+                                  scheduling);
     m_Impl->SetInterfaceStarted();
 }
 